@@ -23,6 +23,14 @@ find_package(Libevent REQUIRED)
 include_directories(SYSTEM ${LIBEVENT_INCLUDE_DIRS})
 list(APPEND Peloton_LINKER_LIBS ${LIBEVENT_LIBRARIES})
 
+# ---[ LZ4 (optional, compresses the write ahead log)
+find_package(LZ4)
+if(LZ4_FOUND)
+  include_directories(SYSTEM ${LZ4_INCLUDE_DIR})
+  list(APPEND Peloton_LINKER_LIBS ${LZ4_LIBRARIES})
+  add_definitions(-DPELOTON_HAVE_LZ4)
+endif()
+
 # ---[ Doxygen
 if(BUILD_docs)
   find_package(Doxygen)
@@ -0,0 +1,160 @@
+#!/bin/bash
+
+## ====================================================
+## Peloton Replication Test
+## ====================================================
+
+# Starts a leader and a follower server on this host, runs single-row insert
+# transactions against the leader in the sync and async replication modes,
+# and reports the leader throughput, the replication lag measured by the
+# leader, and how long the follower took to catch up. It also checks that
+# the follower rejects writes.
+#
+# The log does not carry DDL, so the same tables are created on both servers
+# before the run.
+
+# NOTE: absolute path to peloton directory is calculated from current directory
+# directory structure: peloton/script/testing/replication/<this_file>
+CODE_SOURCE_DIR=$(cd `dirname $0` && pwd)
+PELOTON_DIR="$CODE_SOURCE_DIR/../../.."
+PELOTON_BIN="$PELOTON_DIR/build/bin/peloton"
+
+PELOTON_HOST="localhost"
+PELOTON_USER="postgres"
+PELOTON_ARGS='sslmode=disable'
+
+LEADER_PORT="57721"
+FOLLOWER_PORT="57722"
+LEADER_RPC_PORT="57731"
+FOLLOWER_RPC_PORT="57732"
+
+NUM_TXNS=${NUM_TXNS:-2000}
+CATCH_UP_TIMEOUT=30
+
+WORK_DIR=`mktemp -d /tmp/peloton_replication-XXXXXX`
+LEADER_PID=""
+FOLLOWER_PID=""
+
+## ---------------------------------------------
+## Exit Handler
+## ---------------------------------------------
+set -e
+function cleanup {
+    if [ "$PASS" != "1" ]; then
+        echo "***FAIL***"
+    fi
+    stop_servers
+    rm -rf $WORK_DIR
+}
+trap cleanup EXIT
+
+function stop_servers {
+    if [ -n "$LEADER_PID" ]; then
+        kill -9 $LEADER_PID 2> /dev/null || true
+        LEADER_PID=""
+    fi
+    if [ -n "$FOLLOWER_PID" ]; then
+        kill -9 $FOLLOWER_PID 2> /dev/null || true
+        FOLLOWER_PID=""
+    fi
+}
+
+function run_sql {
+    psql "$PELOTON_ARGS" -U $PELOTON_USER -h $PELOTON_HOST -p $1 \
+        -v VERBOSITY=verbose -t -A -c "$2" 2>&1
+}
+
+function now_ms {
+    date +%s%3N
+}
+
+## ---------------------------------------------
+## One run in the given replication mode
+## ---------------------------------------------
+function run_mode {
+    MODE=$1
+    MODE_DIR="$WORK_DIR/$MODE"
+    mkdir -p $MODE_DIR/leader $MODE_DIR/follower
+
+    # each server keeps its write ahead log in its own directory
+    (cd $MODE_DIR/follower && exec $PELOTON_BIN -port $FOLLOWER_PORT \
+        -replication_role follower -replication_port $FOLLOWER_RPC_PORT \
+        > $MODE_DIR/follower.out 2>&1) &
+    FOLLOWER_PID=$!
+    sleep 3
+
+    (cd $MODE_DIR/leader && exec $PELOTON_BIN -port $LEADER_PORT \
+        -replication_role leader -replication_port $LEADER_RPC_PORT \
+        -follower_address 127.0.0.1:$FOLLOWER_RPC_PORT \
+        -replication_mode $MODE > $MODE_DIR/leader.out 2>&1) &
+    LEADER_PID=$!
+    sleep 3
+
+    for port in $FOLLOWER_PORT $LEADER_PORT; do
+        run_sql $port "CREATE TABLE replication_table(id INT, value INT);" \
+            > /dev/null
+    done
+
+    # the follower only serves reads
+    REJECTED=$(run_sql $FOLLOWER_PORT \
+        "INSERT INTO replication_table VALUES (0, 0);" || true)
+    if [[ "$REJECTED" != *25006* ]]; then
+        echo "[$MODE] the follower accepted a write: $REJECTED"
+        return 1
+    fi
+
+    for txn in $(seq 1 $NUM_TXNS); do
+        echo "INSERT INTO replication_table VALUES ($txn, $txn);"
+    done > $MODE_DIR/insert.sql
+
+    START=$(now_ms)
+    psql "$PELOTON_ARGS" -U $PELOTON_USER -h $PELOTON_HOST -p $LEADER_PORT \
+        -q -f $MODE_DIR/insert.sql > /dev/null
+    LEADER_DONE=$(now_ms)
+
+    # wait until the follower has replayed every transaction
+    COUNT=0
+    while [ $(( $(now_ms) - LEADER_DONE )) -lt $(( CATCH_UP_TIMEOUT * 1000 )) ]
+    do
+        COUNT=$(run_sql $FOLLOWER_PORT \
+            "SELECT COUNT(*) FROM replication_table;" || true)
+        if [ "$COUNT" == "$NUM_TXNS" ]; then
+            break
+        fi
+        sleep 0.1
+    done
+    CAUGHT_UP=$(now_ms)
+
+    if [ "$COUNT" != "$NUM_TXNS" ]; then
+        echo "[$MODE] the follower has $COUNT of $NUM_TXNS rows"
+        return 1
+    fi
+
+    # the leader reports the lag when it shuts down
+    kill -HUP $LEADER_PID
+    wait $LEADER_PID || true
+    LEADER_PID=""
+    stop_servers
+
+    ELAPSED=$(( LEADER_DONE - START ))
+    echo "[$MODE] $NUM_TXNS txns in $ELAPSED ms" \
+         "($(( NUM_TXNS * 1000 / (ELAPSED > 0 ? ELAPSED : 1) )) txn/s)," \
+         "follower caught up $(( CAUGHT_UP - LEADER_DONE )) ms later"
+    grep "replication" $MODE_DIR/leader.out | sed "s/^/[$MODE] /" || true
+}
+
+## ---------------------------------------------
+## MAIN
+## ---------------------------------------------
+
+if [ ! -x "$PELOTON_BIN" ]; then
+    echo "Could not find $PELOTON_BIN, build peloton in $PELOTON_DIR/build"
+    exit 1
+fi
+
+PASS=0
+run_mode sync
+run_mode async
+PASS=1
+echo "***PASS***"
+exit 0
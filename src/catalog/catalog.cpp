@@ -235,7 +235,8 @@ Result Catalog::CreatePrimaryIndex(const std::string &database_name,
 // Function to add non-primary Key index
 Result Catalog::CreateIndex(const std::string &database_name,
     const std::string &table_name, std::vector<std::string> index_attr,
-    std::string index_name, bool unique, IndexType index_type) {
+    std::string index_name, bool unique, IndexType index_type,
+    std::vector<std::string> include_attr) {
   auto database = GetDatabaseWithName(database_name);
   if (database != nullptr) {
     auto table = database->GetTableWithName(table_name);
@@ -267,6 +268,21 @@ Result Catalog::CreateIndex(const std::string &database_name,
       return Result::RESULT_FAILURE;
     }
 
+    // The INCLUDE columns are stored in the index but are not part of the key
+    std::vector<oid_t> include_attrs;
+    for (auto attr : include_attr) {
+      for (uint i = 0; i < columns.size(); ++i) {
+        if (attr == columns[i].column_name) {
+          include_attrs.push_back(i);
+        }
+      }
+    }
+
+    if (include_attrs.size() != include_attr.size()) {
+      LOG_TRACE("Some included columns are missing");
+      return Result::RESULT_FAILURE;
+    }
+
     key_schema = catalog::Schema::CopySchema(schema, key_attrs);
     key_schema->SetIndexedColumns(key_attrs);
 
@@ -274,11 +290,13 @@ Result Catalog::CreateIndex(const std::string &database_name,
     if (unique == false) {
       index_metadata = new index::IndexMetadata(index_name.c_str(),
           GetNextOid(), table->GetOid(), database->GetOid(), index_type,
-          INDEX_CONSTRAINT_TYPE_DEFAULT, schema, key_schema, key_attrs, true);
+          INDEX_CONSTRAINT_TYPE_DEFAULT, schema, key_schema, key_attrs, true,
+          include_attrs);
     } else {
       index_metadata = new index::IndexMetadata(index_name.c_str(),
           GetNextOid(), table->GetOid(), database->GetOid(), index_type,
-          INDEX_CONSTRAINT_TYPE_UNIQUE, schema, key_schema, key_attrs, true);
+          INDEX_CONSTRAINT_TYPE_UNIQUE, schema, key_schema, key_attrs, true,
+          include_attrs);
     }
 
     // Add index to table
@@ -16,6 +16,7 @@
 #include "common/statement.h"
 #include "common/macros.h"
 #include "planner/abstract_plan.h"
+#include "tcop/plan_cache.h"
 
 namespace peloton {
 
@@ -143,4 +144,5 @@ template class Cache<std::string,
                      const planner::AbstractPlan>; /* Actual in use */
 
 template class Cache<std::string, Statement >;
+template class Cache<std::string, tcop::PlanCacheEntry>;
 }
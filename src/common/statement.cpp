@@ -13,6 +13,7 @@
 #include "common/statement.h"
 #include <cstdio>
 #include "common/logger.h"
+#include "executor/plan_executor.h"
 #include "planner/abstract_plan.h"
 
 namespace peloton {
@@ -62,6 +63,12 @@ void Statement::SetTupleDescriptor(
 
 void Statement::SetPlanTree(std::shared_ptr<planner::AbstractPlan> plan_tree) {
   plan_tree_ = std::move(plan_tree);
+  // the executor tree belongs to the old plan
+  executor_tree_.reset();
+}
+
+void Statement::SetExecutorTree(bridge::ExecutorTree* executor_tree) {
+  executor_tree_.reset(executor_tree);
 }
 
 void Statement::SetReferencedTables(const std::set<oid_t> table_ids) {
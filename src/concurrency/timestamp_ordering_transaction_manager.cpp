@@ -86,9 +86,6 @@ void TimestampOrderingTransactionManager::InitTupleReserved(
 }
 
 Transaction *TimestampOrderingTransactionManager::BeginTransaction() {
-  auto &log_manager = logging::LogManager::GetInstance();
-  log_manager.PrepareLogging();
-
   txn_id_t txn_id = GetNextTransactionId();
   cid_t begin_cid = GetNextCommitId();
   Transaction *txn = new Transaction(txn_id, begin_cid);
@@ -379,6 +376,10 @@ bool TimestampOrderingTransactionManager::AcquireOwnership(
 
       GetSpinlockField(tile_group_header, tuple_id)->Unlock();
 
+      // the tuple is going to be modified, so the tile group can no longer
+      // be assumed to be all-visible
+      tile_group_header->ResetAllVisible();
+
       return true;
     }
   }
@@ -620,6 +621,10 @@ void TimestampOrderingTransactionManager::PerformUpdate(
     current_txn->RecordUpdate(old_location);
   }
 
+  // the version is overwritten in place, so its index entries no longer
+  // describe its content
+  tile_group_header->SetInPlaceUpdated();
+
   // Increment table update op stats
   if (FLAGS_stats_mode != STATS_TYPE_INVALID) {
     stats::BackendStatsContext::GetInstance()->IncrementTableUpdates(
@@ -766,6 +771,8 @@ Result TimestampOrderingTransactionManager::CommitTransaction(
 
   // generate transaction id.
   cid_t end_commit_id = current_txn->GetBeginCommitId();
+  // The statements of the transaction may have run on other threads
+  log_manager.PrepareCommit();
   log_manager.LogBeginTransaction(end_commit_id);
 
   auto &rw_set = current_txn->GetReadWriteSet();
@@ -37,6 +37,7 @@ void PrintConfiguration(){
   LOG_INFO("%30s: %10s","Socket Family", FLAGS_socket_family.c_str());
   LOG_INFO("%30s: %10lu","Statistics", FLAGS_stats_mode);
   LOG_INFO("%30s: %10lu","Max Connections", FLAGS_max_connections);
+  LOG_INFO("%30s: %10s","Replication Role", FLAGS_replication_role.c_str());
 
   LOG_INFO(" ");
   LOG_INFO("%30s", "//===---------------------------------------------------===//");
@@ -70,10 +71,34 @@ DEFINE_string(socket_family,
 // RESOURCE USAGE
 //===----------------------------------------------------------------------===//
 
+DEFINE_bool(index_key_filter,
+            false,
+            "Enable bloom filters on index keys (default: false)");
+
 //===----------------------------------------------------------------------===//
 // WRITE AHEAD LOG
 //===----------------------------------------------------------------------===//
 
+//===----------------------------------------------------------------------===//
+// REPLICATION
+//===----------------------------------------------------------------------===//
+
+DEFINE_string(replication_role,
+              "none",
+              "Replication role: none, leader or follower (default: none)");
+
+DEFINE_uint64(replication_port,
+              9000,
+              "Port of the RPC server for log shipping (default: 9000)");
+
+DEFINE_string(follower_address,
+              "",
+              "Follower address (ip:port) of a leader (default: none)");
+
+DEFINE_string(replication_mode,
+              "sync",
+              "Replication mode: sync, semisync or async (default: sync)");
+
 //===----------------------------------------------------------------------===//
 // ERROR REPORTING AND LOGGING
 //===----------------------------------------------------------------------===//
@@ -126,7 +151,71 @@ int64_t peloton_wait_timeout;
 
 int peloton_flush_frequency_micros;
 
+// Bytes of unflushed log records that trigger a group commit flush
+size_t peloton_group_commit_byte_budget = 1024 * 1024;
+
+// Write the WAL with O_DIRECT through an asynchronous log device
+bool peloton_wal_async_io = true;
+
+// Threads that replay the WAL during recovery (0: one per core)
+size_t peloton_recovery_thread_count = 0;
+
+// Threads that write and load parallel checkpoints (0: one per core)
+size_t peloton_checkpoint_thread_count = 0;
+
+// Persist sorted index images with image checkpoints
+bool peloton_checkpoint_index_images = false;
+
+// Batch the tuple records of a transaction in the compact WAL format
+bool peloton_wal_compact_format = false;
+
+// Compress every group commit of compact WAL records with LZ4
+bool peloton_wal_compression = false;
+
 int peloton_flush_mode;
 
 // pcommit latency (for NVM WBL)
 int peloton_pcommit_latency;
+
+// Emulate NVM with a memory-mapped data file (for NVM WBL)
+bool peloton_nvm_emulation = false;
+
+// Cache the plans of simple-protocol queries across connections
+bool peloton_plan_cache = false;
+
+// Number of normalized queries kept in the plan cache
+size_t peloton_plan_cache_size = 1024;
+
+// EXECUTE messages of a prepared INSERT batched before a Sync (<= 1: off)
+size_t peloton_execute_batch_size = 1024;
+
+// Largest size the read buffer of a connection grows to (in bytes)
+size_t peloton_max_socket_buffer_size = 16 * 1024 * 1024;
+
+// Run statements on the transaction worker pool instead of the network threads
+bool peloton_worker_pool = true;
+
+// Threads of the transaction worker pool (0: one per core)
+size_t peloton_worker_thread_count = 0;
+
+// Workers of the pool that run analytic statements (0: a quarter of them)
+size_t peloton_analytic_worker_thread_count = 0;
+
+// Give every network thread its own SO_REUSEPORT listening socket
+bool peloton_reuseport_listeners = false;
+
+// Connections a listening socket queues until they are accepted
+// (0: SOMAXCONN)
+int peloton_listen_backlog = 0;
+
+// Pin every network thread to a core, so its memory stays on the local node
+bool peloton_pin_network_threads = false;
+
+// Suspend connections instead of their thread while their commit is flushed
+bool peloton_async_commit_ack = false;
+
+// Run the statements of a multi-statement simple query in one transaction
+bool peloton_query_batch = true;
+
+// Commit every tile group chunk of a COPY on its own (not all-or-nothing)
+bool peloton_copy_chunk_commit = false;
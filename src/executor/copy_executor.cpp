@@ -165,7 +165,6 @@ bool CopyExecutor::DExecute() {
 
     // vectors for prepared statement parameters
     int num_params = 0;
-    std::vector<std::pair<int, std::string>> bind_parameters;
     std::vector<type::Value> param_values;
     std::vector<int16_t> formats;
     std::vector<int32_t> types;
@@ -224,11 +223,9 @@ bool CopyExecutor::DExecute() {
                     type::Type::VARBINARY);
 
           wire::InputPacket packet(len, val);
-          bind_parameters.resize(num_params);
           param_values.resize(num_params);
           wire::PacketManager::ReadParamValue(&packet, num_params, types,
-                                              bind_parameters, param_values,
-                                              formats);
+                                              param_values, formats);
 
           // Write all the values to output file
           for (int i = 0; i < num_params; i++) {
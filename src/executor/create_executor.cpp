@@ -67,10 +67,11 @@ bool CreateExecutor::DExecute() {
     IndexType index_type = node.GetIndexType();
 
     auto index_attrs = node.GetIndexAttributes();
+    auto include_attrs = node.GetIncludeAttributes();
 
     Result result = catalog::Catalog::GetInstance()->CreateIndex(
         DEFAULT_DB_NAME, table_name, index_attrs, index_name, unique_flag,
-        index_type);
+        index_type, include_attrs);
     current_txn->SetResult(result);
 
     if (current_txn->GetResult() == Result::RESULT_SUCCESS) {
@@ -46,6 +46,16 @@ void ExecutorContext::ClearParams() {
   params_.clear();
 }
 
+void ExecutorContext::Reset(concurrency::Transaction *transaction,
+                            const std::vector<type::Value> &params) {
+  transaction_ = transaction;
+  params_ = params;
+  num_processed = 0;
+
+  // drop the varlen data of the last execution
+  pool_.reset();
+}
+
 type::EphemeralPool *ExecutorContext::GetPool() {
 
   // construct pool if needed
@@ -32,6 +32,8 @@
 #include "storage/masked_tuple.h"
 #include "storage/tile_group.h"
 #include "storage/tile_group_header.h"
+#include "storage/tile.h"
+#include "storage/tuple.h"
 #include "type/types.h"
 #include "type/value.h"
 
@@ -87,7 +89,10 @@ bool IndexScanExecutor::DInit() {
   limit_ = node.GetLimit();
   limit_number_ = node.GetLimitNumber();
   limit_offset_ = node.GetLimitOffset();
-  descend_ = node.GetDescend();
+  scan_direction_ = node.GetScanDirection();
+
+  // The index-only path answers the whole range at once
+  index_only_ = node.IsIndexOnly() && !limit_;
 
   if (runtime_keys_.size() != 0) {
     PL_ASSERT(runtime_keys_.size() == values_.size());
@@ -124,7 +129,13 @@ bool IndexScanExecutor::DExecute() {
   LOG_TRACE("Index Scan executor :: 0 child");
 
   if (!done_) {
-    if (index_->GetIndexType() == INDEX_CONSTRAINT_TYPE_PRIMARY_KEY) {
+    if (index_only_) {
+      auto status = ExecIndexOnlyLookup();
+      if (status == false) return false;
+    } else if (limit_ && limit_number_ >= 0) {
+      auto status = ExecIncrementalLookup();
+      if (status == false) return false;
+    } else if (index_->GetIndexType() == INDEX_CONSTRAINT_TYPE_PRIMARY_KEY) {
       auto status = ExecPrimaryIndexLookup();
       if (status == false) return false;
     } else {
@@ -162,33 +173,7 @@ bool IndexScanExecutor::ExecPrimaryIndexLookup() {
 
   PL_ASSERT(index_->GetIndexType() == INDEX_CONSTRAINT_TYPE_PRIMARY_KEY);
 
-  if (0 == key_column_ids_.size()) {
-    index_->ScanAllKeys(tuple_location_ptrs);
-  } else {
-    // Limit clause accelerate
-    if (limit_) {
-      // invoke index scan limit
-      if (!descend_) {
-        index_->ScanLimit(values_, key_column_ids_, expr_types_,
-                          SCAN_DIRECTION_TYPE_FORWARD, tuple_location_ptrs,
-                          &index_predicate_.GetConjunctionList()[0],
-                          limit_number_, limit_offset_);
-      } else {
-        index_->ScanLimit(values_, key_column_ids_, expr_types_,
-                          SCAN_DIRECTION_TYPE_BACKWARD, tuple_location_ptrs,
-                          &index_predicate_.GetConjunctionList()[0],
-                          limit_number_, limit_offset_);
-      }
-    }
-    // Normal SQL (without limit)
-    else {
-      index_->Scan(values_, key_column_ids_, expr_types_,
-                   SCAN_DIRECTION_TYPE_FORWARD, tuple_location_ptrs,
-                   &index_predicate_.GetConjunctionList()[0]);
-    }
-
-    LOG_TRACE("tuple_location_ptrs:%lu", tuple_location_ptrs.size());
-  }
+  ProbeIndex(tuple_location_ptrs);
 
   if (tuple_location_ptrs.size() == 0) {
     LOG_TRACE("no tuple is retrieved from index.");
@@ -201,7 +186,6 @@ bool IndexScanExecutor::ExecPrimaryIndexLookup() {
   auto current_txn = executor_context_->GetTransaction();
   auto &manager = catalog::Manager::GetInstance();
   std::vector<ItemPointer> visible_tuple_locations;
-  std::map<oid_t, std::vector<oid_t>> visible_tuples;
 
 #ifdef LOG_TRACE_ENABLED
   int num_tuples_examined = 0;
@@ -330,27 +314,98 @@ bool IndexScanExecutor::ExecPrimaryIndexLookup() {
   LOG_TRACE("%ld tuples after pruning boundaries",
             visible_tuple_locations.size());
 
-  for (auto &visible_tuple_location : visible_tuple_locations) {
-    visible_tuples[visible_tuple_location.block].push_back(
-        visible_tuple_location.offset);
+  AddResultTiles(visible_tuple_locations);
+
+  done_ = true;
+
+  LOG_TRACE("Result tiles : %lu", result_.size());
+
+  return true;
+}
+
+bool IndexScanExecutor::ExecSecondaryIndexLookup() {
+  LOG_TRACE("ExecSecondaryIndexLookup");
+  PL_ASSERT(!done_);
+  PL_ASSERT(index_->GetIndexType() != INDEX_CONSTRAINT_TYPE_PRIMARY_KEY);
+
+  std::vector<ItemPointer *> tuple_location_ptrs;
+
+  ProbeIndex(tuple_location_ptrs);
+
+  if (tuple_location_ptrs.size() == 0) {
+    LOG_TRACE("no tuple is retrieved from index.");
+    return false;
   }
 
-  // Construct a logical tile for each block
-  for (auto tuples : visible_tuples) {
-    auto &manager = catalog::Manager::GetInstance();
-    auto tile_group = manager.GetTileGroup(tuples.first);
+  std::vector<ItemPointer> visible_tuple_locations;
+  if (FindVisibleVersions(tuple_location_ptrs, visible_tuple_locations) ==
+      false) {
+    return false;
+  }
 
-    std::unique_ptr<LogicalTile> logical_tile(LogicalTileFactory::GetTile());
-    // Add relevant columns to logical tile
-    logical_tile->AddColumns(tile_group, full_column_ids_);
-    logical_tile->AddPositionList(std::move(tuples.second));
-    if (column_ids_.size() != 0) {
-      logical_tile->ProjectColumns(full_column_ids_, column_ids_);
+  // Check whether the boundaries satisfy the required condition
+  CheckOpenRangeWithReturnedTuples(visible_tuple_locations);
+
+  AddResultTiles(visible_tuple_locations);
+
+  done_ = true;
+
+  LOG_TRACE("Result tiles : %lu", result_.size());
+
+  return true;
+}
+
+bool IndexScanExecutor::ExecIncrementalLookup() {
+  LOG_TRACE("ExecIncrementalLookup");
+  PL_ASSERT(!done_);
+
+  // The limit and the offset are applied above the scan, so the first
+  // limit + offset visible tuples in scan order are needed
+  const size_t required_count =
+      static_cast<size_t>(limit_number_) + static_cast<size_t>(limit_offset_);
+  if (required_count == 0) {
+    done_ = true;
+    return false;
+  }
+
+  auto scan_itr = index_->GetScanIterator(
+      values_, key_column_ids_, expr_types_, scan_direction_,
+      &index_predicate_.GetConjunctionList()[0]);
+
+  std::vector<ItemPointer *> tuple_location_ptrs;
+  std::vector<ItemPointer> visible_tuple_locations;
+
+  // Entries may be invisible or fail the predicate, so the batch grows
+  // geometrically to bound the number of round trips to the index
+  size_t batch_size = required_count;
+  while (visible_tuple_locations.size() < required_count) {
+    tuple_location_ptrs.clear();
+    if (scan_itr->Next(tuple_location_ptrs, batch_size) == 0) {
+      break;
     }
 
-    result_.push_back(logical_tile.release());
+    if (FindVisibleVersions(tuple_location_ptrs, visible_tuple_locations) ==
+        false) {
+      return false;
+    }
+
+    batch_size *= 2;
+  }
+
+  LOG_TRACE("%lu visible tuples for limit %lu", visible_tuple_locations.size(),
+            required_count);
+
+  if (visible_tuple_locations.size() > required_count) {
+    visible_tuple_locations.resize(required_count);
+  }
+
+  if (visible_tuple_locations.size() == 0) {
+    LOG_TRACE("no tuple is retrieved from index.");
+    return false;
   }
 
+  AddResultTiles(visible_tuple_locations);
+
   done_ = true;
 
   LOG_TRACE("Result tiles : %lu", result_.size());
@@ -358,54 +413,175 @@ bool IndexScanExecutor::ExecPrimaryIndexLookup() {
   return true;
 }
 
-bool IndexScanExecutor::ExecSecondaryIndexLookup() {
-  LOG_TRACE("ExecSecondaryIndexLookup");
+bool IndexScanExecutor::ExecIndexOnlyLookup() {
+  LOG_TRACE("ExecIndexOnlyLookup");
   PL_ASSERT(!done_);
-  PL_ASSERT(index_->GetIndexType() != INDEX_CONSTRAINT_TYPE_PRIMARY_KEY);
 
   std::vector<ItemPointer *> tuple_location_ptrs;
+  std::vector<char> payloads;
 
-  // Grab info from plan node
-  bool acquire_owner = GetPlanNode<planner::AbstractScan>().IsForUpdate();
+  index_->ScanCovering(values_, key_column_ids_, expr_types_,
+                       SCAN_DIRECTION_TYPE_FORWARD, tuple_location_ptrs,
+                       payloads, &index_predicate_.GetConjunctionList()[0]);
 
-  if (0 == key_column_ids_.size()) {
-    index_->ScanAllKeys(tuple_location_ptrs);
-  } else {
-    //    // Limit clause accelerate
-    if (limit_) {
-      // invoke index scan limit
-      if (!descend_) {
-        index_->ScanLimit(values_, key_column_ids_, expr_types_,
-                          SCAN_DIRECTION_TYPE_FORWARD, tuple_location_ptrs,
-                          &index_predicate_.GetConjunctionList()[0],
-                          limit_number_, limit_offset_);
-      } else {
-        index_->ScanLimit(values_, key_column_ids_, expr_types_,
-                          SCAN_DIRECTION_TYPE_BACKWARD, tuple_location_ptrs,
-                          &index_predicate_.GetConjunctionList()[0],
-                          limit_number_, limit_offset_);
+  if (tuple_location_ptrs.size() == 0) {
+    LOG_TRACE("no tuple is retrieved from index.");
+    return false;
+  }
+
+  auto index_metadata = index_->GetMetadata();
+  auto covering_schema = index_metadata->GetCoveringSchema();
+  const size_t payload_size = covering_schema->GetLength();
+
+  // Map the table column ids onto the positions inside the covering tuple,
+  // so that key conditions and predicates can be evaluated as if they were
+  // looking at the table
+  std::vector<oid_t> covering_mask(table_->GetSchema()->GetColumnCount(), 0);
+  auto &covered_columns = covering_schema->GetIndexedColumns();
+  for (oid_t position = 0; position < covered_columns.size(); position++) {
+    covering_mask[covered_columns[position]] = position;
+  }
+
+  auto &transaction_manager =
+      concurrency::TransactionManagerFactory::GetInstance();
+  auto current_txn = executor_context_->GetTransaction();
+  const cid_t read_cid = current_txn->GetBeginCommitId();
+  auto &manager = catalog::Manager::GetInstance();
+
+  // Entries that need the regular version chain traversal
+  std::vector<ItemPointer *> fallback_location_ptrs;
+  // Offsets of the payloads that go straight to the output
+  std::vector<size_t> covered_payloads;
+
+  oid_t last_block = INVALID_OID;
+  storage::TileGroupHeader *tile_group_header = nullptr;
+
+  for (size_t entry_itr = 0; entry_itr < tuple_location_ptrs.size();
+       entry_itr++) {
+    auto tuple_location_ptr = tuple_location_ptrs[entry_itr];
+    ItemPointer tuple_location = *tuple_location_ptr;
+    if (tuple_location.block != last_block) {
+      tile_group_header =
+          manager.GetTileGroup(tuple_location.block)->GetHeader();
+      last_block = tuple_location.block;
+    }
+
+    // The payload can only be trusted if the entry still points to the only
+    // version of the tuple and that version is committed and visible.
+    // Updated tuples have a version chain, recycled slots point to another
+    // indirection and in-place updates are tracked per tile group.
+    const oid_t offset = tuple_location.offset;
+    bool trusted =
+        (tile_group_header->GetIndirection(offset) == tuple_location_ptr) &&
+        (tile_group_header->IsInPlaceUpdated() == false);
+    if (trusted == true && tile_group_header->IsAllVisible(read_cid) == false) {
+      trusted =
+          (tile_group_header->GetTransactionId(offset) == INITIAL_TXN_ID) &&
+          (tile_group_header->GetBeginCommitId(offset) <= read_cid) &&
+          (tile_group_header->GetEndCommitId(offset) == MAX_CID) &&
+          (tile_group_header->GetNextItemPointer(offset).IsNull());
+    }
+
+    if (trusted == false) {
+      fallback_location_ptrs.push_back(tuple_location_ptr);
+      continue;
+    }
+
+    const size_t payload_offset = entry_itr * payload_size;
+    storage::Tuple covering_tuple(covering_schema,
+                                  payloads.data() + payload_offset);
+    storage::MaskedTuple tuple(&covering_tuple, covering_mask);
+
+    if (CheckKeyConditions(tuple) == false) {
+      continue;
+    }
+
+    if (predicate_ != nullptr &&
+        predicate_->Evaluate(&tuple, nullptr, executor_context_).IsTrue() ==
+            false) {
+      continue;
+    }
+
+    auto res = transaction_manager.PerformRead(current_txn, tuple_location,
+                                               false);
+    if (!res) {
+      transaction_manager.SetTransactionResult(current_txn, RESULT_FAILURE);
+      return res;
+    }
+
+    covered_payloads.push_back(payload_offset);
+  }
+
+  LOG_TRACE("%lu entries answered by index %s, %lu need the table",
+            covered_payloads.size(), index_->GetName().c_str(),
+            fallback_location_ptrs.size());
+
+  if (covered_payloads.size() != 0) {
+    std::unique_ptr<catalog::Schema> output_schema(
+        catalog::Schema::CopySchema(table_->GetSchema(), column_ids_));
+    std::shared_ptr<storage::Tile> dest_tile(storage::TileFactory::GetTempTile(
+        *output_schema, covered_payloads.size()));
+
+    oid_t tuple_id = 0;
+    for (auto payload_offset : covered_payloads) {
+      storage::Tuple covering_tuple(covering_schema,
+                                    payloads.data() + payload_offset);
+      for (oid_t column_itr = 0; column_itr < column_ids_.size();
+           column_itr++) {
+        dest_tile->SetValue(
+            covering_tuple.GetValue(covering_mask[column_ids_[column_itr]]),
+            tuple_id, column_itr);
       }
+      tuple_id++;
     }
-    // Normal SQL (without limit)
-    else {
-      index_->Scan(values_, key_column_ids_, expr_types_,
-                   SCAN_DIRECTION_TYPE_FORWARD, tuple_location_ptrs,
-                   &index_predicate_.GetConjunctionList()[0]);
+
+    result_.push_back(LogicalTileFactory::WrapTiles({dest_tile}));
+  }
+
+  if (fallback_location_ptrs.size() != 0) {
+    std::vector<ItemPointer> visible_tuple_locations;
+    if (FindVisibleVersions(fallback_location_ptrs, visible_tuple_locations) ==
+        false) {
+      return false;
     }
+
+    CheckOpenRangeWithReturnedTuples(visible_tuple_locations);
+
+    AddResultTiles(visible_tuple_locations);
   }
 
-  if (tuple_location_ptrs.size() == 0) {
-    LOG_TRACE("no tuple is retrieved from index.");
-    return false;
+  done_ = true;
+
+  LOG_TRACE("Result tiles : %lu", result_.size());
+
+  return true;
+}
+
+void IndexScanExecutor::ProbeIndex(
+    std::vector<ItemPointer *> &tuple_location_ptrs) {
+  if (0 == key_column_ids_.size()) {
+    index_->ScanAllKeys(tuple_location_ptrs);
+  } else {
+    // Scans with a pushed down limit go through ExecIncrementalLookup()
+    index_->Scan(values_, key_column_ids_, expr_types_,
+                 SCAN_DIRECTION_TYPE_FORWARD, tuple_location_ptrs,
+                 &index_predicate_.GetConjunctionList()[0]);
+
+    LOG_TRACE("tuple_location_ptrs:%lu", tuple_location_ptrs.size());
   }
+}
+
+bool IndexScanExecutor::FindVisibleVersions(
+    const std::vector<ItemPointer *> &tuple_location_ptrs,
+    std::vector<ItemPointer> &visible_tuple_locations) {
+  // Grab info from plan node
+  bool acquire_owner = GetPlanNode<planner::AbstractScan>().IsForUpdate();
 
   auto &transaction_manager =
       concurrency::TransactionManagerFactory::GetInstance();
 
   auto current_txn = executor_context_->GetTransaction();
 
-  std::vector<ItemPointer> visible_tuple_locations;
-  std::map<oid_t, std::vector<oid_t>> visible_tuples;
   auto &manager = catalog::Manager::GetInstance();
 
   // Quickie Hack
@@ -555,8 +731,12 @@ bool IndexScanExecutor::ExecSecondaryIndexLookup() {
             num_tuples_examined, index_->GetName().c_str(), num_blocks_reused);
 #endif
 
-  // Check whether the boundaries satisfy the required condition
-  CheckOpenRangeWithReturnedTuples(visible_tuple_locations);
+  return true;
+}
+
+void IndexScanExecutor::AddResultTiles(
+    const std::vector<ItemPointer> &visible_tuple_locations) {
+  std::map<oid_t, std::vector<oid_t>> visible_tuples;
 
   for (auto &visible_tuple_location : visible_tuple_locations) {
     visible_tuples[visible_tuple_location.block].push_back(
@@ -578,12 +758,6 @@ bool IndexScanExecutor::ExecSecondaryIndexLookup() {
 
     result_.push_back(logical_tile.release());
   }
-
-  done_ = true;
-
-  LOG_TRACE("Result tiles : %lu", result_.size());
-
-  return true;
 }
 
 void IndexScanExecutor::CheckOpenRangeWithReturnedTuples(
@@ -612,18 +786,22 @@ void IndexScanExecutor::CheckOpenRangeWithReturnedTuples(
 }
 
 bool IndexScanExecutor::CheckKeyConditions(const ItemPointer &tuple_location) {
-  // The size of these three arrays must be the same
-  PL_ASSERT(key_column_ids_.size() == expr_types_.size());
-  PL_ASSERT(expr_types_.size() == values_.size());
-
-  LOG_TRACE("Examining key conditions for the returned tuple.");
-
   auto &manager = catalog::Manager::GetInstance();
 
   auto tile_group = manager.GetTileGroup(tuple_location.block);
   expression::ContainerTuple<storage::TileGroup> tuple(tile_group.get(),
                                                        tuple_location.offset);
 
+  return CheckKeyConditions(tuple);
+}
+
+bool IndexScanExecutor::CheckKeyConditions(const AbstractTuple &tuple) {
+  // The size of these three arrays must be the same
+  PL_ASSERT(key_column_ids_.size() == expr_types_.size());
+  PL_ASSERT(expr_types_.size() == values_.size());
+
+  LOG_TRACE("Examining key conditions for the returned tuple.");
+
   // This is the end of loop
   oid_t cond_num = key_column_ids_.size();
 
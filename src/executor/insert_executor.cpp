@@ -155,6 +155,33 @@ bool InsertExecutor::DExecute() {
       tuple = project_tuple.get();
     }
 
+    // Several raw tuples, e.g. a multi-row VALUES or a chunk of a COPY
+    if (!project_info && bulk_insert_count > 1 &&
+        node.GetTuple(bulk_insert_count - 1) != nullptr) {
+      std::vector<const storage::Tuple *> tuples;
+      tuples.reserve(bulk_insert_count);
+      for (oid_t insert_itr = 0; insert_itr < bulk_insert_count; insert_itr++) {
+        tuples.push_back(node.GetTuple(insert_itr));
+      }
+
+      // The table performs the inserts with the transaction manager
+      std::vector<ItemPointer> locations;
+      if (target_table->InsertTuples(tuples, current_txn, locations) ==
+          false) {
+        LOG_TRACE("Failed to Insert. Set txn failure.");
+        transaction_manager.SetTransactionResult(current_txn,
+                                                 Result::RESULT_FAILURE);
+        return false;
+      }
+
+      LOG_TRACE("Number of tuples in table after insert: %lu",
+                target_table->GetTupleCount());
+
+      executor_context_->num_processed += bulk_insert_count;
+      done_ = true;
+      return true;
+    }
+
     // Bulk Insert Mode
     for (oid_t insert_itr = 0; insert_itr < bulk_insert_count; insert_itr++) {
       // if we are doing a bulk insert from values not project_info
@@ -11,11 +11,13 @@
 //===----------------------------------------------------------------------===//
 
 #include <algorithm>
+#include <cstring>
 #include <iostream>
 
 #include "catalog/schema.h"
 #include "common/macros.h"
 #include "executor/logical_tile.h"
+#include "executor/logical_tile_factory.h"
 #include "storage/data_table.h"
 #include "storage/tile.h"
 #include "storage/tile_group.h"
@@ -311,6 +313,14 @@ LogicalTile::~LogicalTile() {
   // Automatically drops reference on base tiles for each column
 }
 
+void *LogicalTile::operator new(size_t size) {
+  return LogicalTileFactory::AllocateTile(size);
+}
+
+void LogicalTile::operator delete(void *tile) {
+  LogicalTileFactory::ReleaseTile(tile);
+}
+
 LogicalTile::PositionListsBuilder::PositionListsBuilder() {
   // Nothing to do here !
 }
@@ -431,6 +441,112 @@ void LogicalTile::ProjectColumns(const std::vector<oid_t> &original_column_ids,
   schema_ = std::move(new_schema);
 }
 
+namespace {
+
+// Days between 1970-01-01 and the given date of the Gregorian calendar
+int64_t DaysFromCivil(int64_t year, int64_t month, int64_t day) {
+  year -= month <= 2;
+  int64_t era = (year >= 0 ? year : year - 399) / 400;
+  int64_t year_of_era = year - era * 400;
+  int64_t day_of_year =
+      (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  int64_t day_of_era =
+      year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+  return era * 146097 + day_of_era - 719468;
+}
+
+// Microseconds since 2000-01-01 of a timestamp, which is how Postgres sends
+// timestamps in binary format. See TimestampType::ToString for the layout
+int64_t GetPostgresTimestamp(uint64_t timestamp) {
+  int64_t micro = timestamp % 1000000;
+  timestamp /= 1000000;
+  int64_t second = timestamp % 100000;
+  timestamp /= 100000;
+  int64_t year = timestamp % 10000;
+  timestamp /= 10000;
+  // skip the time zone
+  timestamp /= 27;
+  int64_t day = timestamp % 32;
+  timestamp /= 32;
+  int64_t month = timestamp;
+
+  int64_t days = DaysFromCivil(year, month, day) - DaysFromCivil(2000, 1, 1);
+  return (days * 86400 + second) * 1000000 + micro;
+}
+
+template <typename T>
+void AppendBigEndian(std::vector<unsigned char> &buf, T value) {
+  unsigned char bytes[sizeof(T)];
+  PL_MEMCPY(bytes, &value, sizeof(T));
+  for (size_t i = sizeof(T); i > 0; i--) {
+    buf.push_back(bytes[i - 1]);
+  }
+}
+
+// Serialize a value the way the Postgres send functions do. NULLs are left
+// empty
+void SerializeBinaryValue(const type::Value &val,
+                          std::vector<unsigned char> &buf) {
+  if (val.IsNull()) return;
+
+  switch (val.GetTypeId()) {
+    case type::Type::BOOLEAN:
+      buf.push_back(val.GetAs<int8_t>() ? 1 : 0);
+      break;
+    case type::Type::TINYINT:
+      // Postgres has no one byte integer, TINYINT is described as int2
+      AppendBigEndian<int16_t>(buf, val.GetAs<int8_t>());
+      break;
+    case type::Type::SMALLINT:
+      AppendBigEndian<int16_t>(buf, val.GetAs<int16_t>());
+      break;
+    case type::Type::INTEGER:
+      AppendBigEndian<int32_t>(buf, val.GetAs<int32_t>());
+      break;
+    case type::Type::BIGINT:
+      AppendBigEndian<int64_t>(buf, val.GetAs<int64_t>());
+      break;
+    case type::Type::DECIMAL:
+      // DECIMAL is a double and described as float8
+      AppendBigEndian<double>(buf, val.GetAs<double>());
+      break;
+    case type::Type::TIMESTAMP:
+      AppendBigEndian<int64_t>(
+          buf, GetPostgresTimestamp(val.GetAs<uint64_t>()));
+      break;
+    case type::Type::VARCHAR: {
+      // without the terminating '\0'
+      auto data = reinterpret_cast<const unsigned char *>(val.GetData());
+      buf.insert(buf.end(), data, data + val.GetLength() - 1);
+    } break;
+    case type::Type::VARBINARY: {
+      auto data = reinterpret_cast<const unsigned char *>(val.GetData());
+      buf.insert(buf.end(), data, data + val.GetLength());
+    } break;
+    default: {
+      auto str = val.ToString();
+      buf.insert(buf.end(), str.begin(), str.end());
+    } break;
+  }
+}
+
+// Serialize a value in text format. NULLs are left empty
+void SerializeTextValue(const type::Value &val,
+                        std::vector<unsigned char> &buf) {
+  if (val.IsNull()) return;
+
+  if (val.GetTypeId() == type::Type::VARCHAR) {
+    // the text is already there
+    auto data = reinterpret_cast<const unsigned char *>(val.GetData());
+    buf.insert(buf.end(), data, data + val.GetLength() - 1);
+  } else {
+    auto str = val.ToString();
+    buf.insert(buf.end(), str.begin(), str.end());
+  }
+}
+
+}  // namespace
+
 std::vector<std::vector<std::string>> LogicalTile::GetAllValuesAsStrings(
     const std::vector<int> &result_format, bool use_to_string_null) {
   std::vector<std::vector<std::string>> string_tile;
@@ -464,23 +580,9 @@ std::vector<std::vector<std::string>> LogicalTile::GetAllValuesAsStrings(
           row.push_back(val.ToString());
         }
       } else {
-        auto data_length =
-            cp.base_tile->GetSchema()->GetLength(cp.origin_column_id);
-        LOG_TRACE("data length: %ld", data_length);
-        char *val_binary = new char[data_length];
-        bool is_inlined = false;
-
-        val.SerializeTo(val_binary, is_inlined, nullptr);
-
-        // convert little endian to big endian...
-        // TODO: This is stupid.... But I think this hack is fine for now.
-        for (size_t i = 0; i < (data_length >> 1); ++i) {
-          auto tmp_char = val_binary[i];
-          val_binary[i] = val_binary[data_length - i - 1];
-          val_binary[data_length - i - 1] = tmp_char;
-        }
-
-        row.push_back(std::string(val_binary, data_length));
+        std::vector<unsigned char> val_binary;
+        SerializeBinaryValue(val, val_binary);
+        row.push_back(std::string(val_binary.begin(), val_binary.end()));
       }
     }
     string_tile.push_back(row);
@@ -488,6 +590,33 @@ std::vector<std::vector<std::string>> LogicalTile::GetAllValuesAsStrings(
   return string_tile;
 }
 
+void LogicalTile::SerializeResults(const std::vector<int> &result_format,
+                                   std::vector<ResultType> &results) {
+  auto column_count = schema_.size();
+  for (oid_t tuple_itr = 0; tuple_itr < total_tuples_; tuple_itr++) {
+    if (visible_rows_[tuple_itr] == false) continue;
+    for (oid_t column_itr = 0; column_itr < column_count; column_itr++) {
+      const LogicalTile::ColumnInfo &cp = schema_[column_itr];
+      oid_t base_tuple_id = position_lists_[cp.position_list_idx][tuple_itr];
+
+      results.emplace_back();
+      if (base_tuple_id == NULL_OID) {
+        // NULL
+        continue;
+      }
+
+      // read the value from the base physical tile and serialize it in place
+      auto val = cp.base_tile->GetValue(base_tuple_id, cp.origin_column_id);
+      auto &buf = results.back().second;
+      if (column_itr < result_format.size() && result_format[column_itr] != 0) {
+        SerializeBinaryValue(val, buf);
+      } else {
+        SerializeTextValue(val, buf);
+      }
+    }
+  }
+}
+
 const std::string LogicalTile::GetInfo() const {
   std::ostringstream os;
   os << "LOGICAL TILE [TotalTuples=" << total_tuples_ << "]" << std::endl;
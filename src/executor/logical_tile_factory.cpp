@@ -42,6 +42,23 @@ std::vector<oid_t> CreateIdentityPositionList(unsigned int size) {
   return position_list;
 }
 
+/**
+ * @brief Memory of released logical tiles, per thread.
+ */
+struct LogicalTilePool {
+  ~LogicalTilePool() {
+    for (auto tile : tiles) {
+      ::operator delete(tile);
+    }
+  }
+
+  std::vector<void *> tiles;
+
+  size_t reused_count = 0;
+};
+
+thread_local LogicalTilePool logical_tile_pool;
+
 }  // namespace
 
 /**
@@ -109,5 +126,45 @@ LogicalTile *LogicalTileFactory::WrapTileGroup(
   return new_tile.release();
 }
 
+/**
+ * @brief Returns the memory for a new logical tile.
+ * @param size Size of the logical tile.
+ *
+ * @return Memory of a released logical tile if the pool of the thread has
+ *         one, newly allocated memory otherwise.
+ */
+void *LogicalTileFactory::AllocateTile(UNUSED_ATTRIBUTE size_t size) {
+  PL_ASSERT(size == sizeof(LogicalTile));
+  auto &pool = logical_tile_pool;
+  if (pool.tiles.empty()) {
+    return ::operator new(sizeof(LogicalTile));
+  }
+
+  auto tile = pool.tiles.back();
+  pool.tiles.pop_back();
+  pool.reused_count++;
+  return tile;
+}
+
+/**
+ * @brief Keeps the memory of a destroyed logical tile in the pool of the
+ *        thread, or frees it if the pool is full.
+ * @param tile Memory of the logical tile.
+ */
+void LogicalTileFactory::ReleaseTile(void *tile) {
+  if (tile == nullptr) return;
+
+  auto &pool = logical_tile_pool;
+  if (pool.tiles.size() >= LOGICAL_TILE_POOL_SIZE) {
+    ::operator delete(tile);
+    return;
+  }
+  pool.tiles.push_back(tile);
+}
+
+size_t LogicalTileFactory::GetReusedTileCount() {
+  return logical_tile_pool.reused_count;
+}
+
 }  // namespace executor
 }  // namespace peloton
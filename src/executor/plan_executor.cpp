@@ -34,6 +34,13 @@ executor::AbstractExecutor *BuildExecutorTree(
 
 void CleanExecutorTree(executor::AbstractExecutor *root);
 
+peloton_status RunExecutorTree(executor::AbstractExecutor *executor_tree,
+                               executor::ExecutorContext *executor_context,
+                               std::vector<ResultType> &result,
+                               const std::vector<int> &result_format);
+
+void ResetExecutorTree(executor::AbstractExecutor *root);
+
 /**
  * @brief Build a executor tree and execute it.
  * Use std::vector<type::Value> as params to make it more elegant for
@@ -51,8 +58,6 @@ peloton_status PlanExecutor::ExecutePlan(
 
   LOG_TRACE("PlanExecutor Start ");
 
-  bool status;
-
   PL_ASSERT(txn);
 
   LOG_TRACE("Txn ID = %lu ", txn->GetTransactionId());
@@ -67,10 +72,60 @@ peloton_status PlanExecutor::ExecutePlan(
   std::unique_ptr<executor::AbstractExecutor> executor_tree(
       BuildExecutorTree(nullptr, plan, executor_context.get()));
 
+  p_status = RunExecutorTree(executor_tree.get(), executor_context.get(),
+                             result, result_format);
+
+  // clean up executor tree
+  CleanExecutorTree(executor_tree.get());
+
+  return p_status;
+}
+
+/**
+ * @brief Execute the plan of a prepared statement, reusing the executor
+ * tree of its last execution if the plan allows it.
+ * @return status of execution.
+ */
+peloton_status PlanExecutor::ExecutePlan(
+    Statement *statement, concurrency::Transaction *txn,
+    const std::vector<type::Value> &params, std::vector<ResultType> &result,
+    const std::vector<int> &result_format) {
+  auto &plan = statement->GetPlanTree();
+  if (plan.get() == nullptr || ExecutorTree::IsReusable(plan.get()) == false) {
+    return ExecutePlan(plan.get(), txn, params, result, result_format);
+  }
+
+  PL_ASSERT(txn);
+
+  // Build the tree on the first execution or after a replan
+  auto executor_tree = statement->GetExecutorTree();
+  if (executor_tree == nullptr || executor_tree->GetPlan() != plan) {
+    LOG_TRACE("Building the executor tree of statement %s",
+              statement->GetStatementName().c_str());
+    executor_tree = new ExecutorTree(plan);
+    statement->SetExecutorTree(executor_tree);
+  }
+
+  auto root = executor_tree->Reset(txn, params);
+  return RunExecutorTree(root, executor_tree->GetContext(), result,
+                         result_format);
+}
+
+/**
+ * @brief Initialize an executor tree and run it until the root node runs out
+ * of logical tiles.
+ * @return status of execution.
+ */
+peloton_status RunExecutorTree(executor::AbstractExecutor *executor_tree,
+                               executor::ExecutorContext *executor_context,
+                               std::vector<ResultType> &result,
+                               const std::vector<int> &result_format) {
+  peloton_status p_status;
+
   LOG_TRACE("Initializing the executor tree");
 
   // Initialize the executor tree
-  status = executor_tree->Init();
+  bool status = executor_tree->Init();
 
   if (status == true) {
     LOG_TRACE("Running the executor tree");
@@ -86,22 +141,8 @@ peloton_status PlanExecutor::ExecutePlan(
       if (logical_tile.get() != nullptr) {
         LOG_TRACE("Final Answer: %s",
                   logical_tile->GetInfo().c_str());  // Printing the answers
-        std::vector<std::vector<std::string>> answer_tuples;
-        answer_tuples =
-            std::move(logical_tile->GetAllValuesAsStrings(result_format, false));
-
-        // Construct the returned results
-        for (auto &tuple : answer_tuples) {
-          unsigned int col_index = 0;
-          for (unsigned int i = 0; i < logical_tile->GetColumnCount(); i++) {
-            auto res = ResultType();
-            PlanExecutor::copyFromTo(tuple[col_index++], res.second);
-            if (tuple[col_index - 1].c_str() != nullptr) {
-              LOG_TRACE("column content: %s", tuple[col_index - 1].c_str());
-            }
-            result.push_back(std::move(res));
-          }
-        }
+        // Serialize the answers straight from the tiles
+        logical_tile->SerializeResults(result_format, result);
       }
     }
 
@@ -115,9 +156,6 @@ peloton_status PlanExecutor::ExecutePlan(
 
   p_status.m_result_slots = nullptr;
 
-  // clean up executor tree
-  CleanExecutorTree(executor_tree.get());
-
   return p_status;
 }
 
@@ -378,5 +416,69 @@ void CleanExecutorTree(executor::AbstractExecutor *root) {
   }
 }
 
+/**
+ * @brief Reset the state of every executor of the tree, dropping the
+ * outputs that the last execution did not consume.
+ * @param The current executor tree
+ * @return none.
+ */
+void ResetExecutorTree(executor::AbstractExecutor *root) {
+  if (root == nullptr) return;
+
+  std::unique_ptr<executor::LogicalTile> output(root->GetOutput());
+  root->ResetState();
+
+  // Recurse
+  for (auto child : root->GetChildren()) {
+    ResetExecutorTree(child);
+  }
+}
+
+//===--------------------------------------------------------------------===//
+// Executor Tree
+//===--------------------------------------------------------------------===//
+
+ExecutorTree::ExecutorTree(const std::shared_ptr<planner::AbstractPlan> &plan)
+    : plan_(plan) {
+  executor_context_.reset(
+      BuildExecutorContext(std::vector<type::Value>(), nullptr));
+  executor_tree_.reset(
+      BuildExecutorTree(nullptr, plan_.get(), executor_context_.get()));
+}
+
+ExecutorTree::~ExecutorTree() { CleanExecutorTree(executor_tree_.get()); }
+
+bool ExecutorTree::IsReusable(const planner::AbstractPlan *plan) {
+  // The executors whose DInit (with ResetState) starts over
+  switch (plan->GetPlanNodeType()) {
+    case PLAN_NODE_TYPE_SEQSCAN:
+    case PLAN_NODE_TYPE_INDEXSCAN:
+    case PLAN_NODE_TYPE_INSERT:
+    case PLAN_NODE_TYPE_DELETE:
+    case PLAN_NODE_TYPE_UPDATE:
+    case PLAN_NODE_TYPE_LIMIT:
+    case PLAN_NODE_TYPE_PROJECTION:
+    case PLAN_NODE_TYPE_MATERIALIZE:
+      break;
+    default:
+      return false;
+  }
+
+  for (auto &child : plan->GetChildren()) {
+    if (IsReusable(child.get()) == false) {
+      return false;
+    }
+  }
+  return true;
+}
+
+executor::AbstractExecutor *ExecutorTree::Reset(
+    concurrency::Transaction *txn, const std::vector<type::Value> &params) {
+  executor_context_->Reset(txn, params);
+  ResetExecutorTree(executor_tree_.get());
+  execution_count_++;
+  return executor_tree_.get();
+}
+
 }  // namespace bridge
 }  // namespace peloton
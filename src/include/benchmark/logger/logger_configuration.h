@@ -31,7 +31,8 @@ enum ExperimentType {
   EXPERIMENT_TYPE_THROUGHPUT = 1,
   EXPERIMENT_TYPE_RECOVERY = 2,
   EXPERIMENT_TYPE_STORAGE = 3,
-  EXPERIMENT_TYPE_LATENCY = 4
+  EXPERIMENT_TYPE_LATENCY = 4,
+  EXPERIMENT_TYPE_BACKEND_SCALING = 5
 };
 
 enum BenchmarkType {
@@ -50,6 +51,13 @@ enum AsynchronousType {
   ASYNCHRONOUS_TYPE_NO_WRITE = 4
 };
 
+enum ReplicationRole {
+  REPLICATION_ROLE_NONE = 0,
+
+  REPLICATION_ROLE_LEADER = 1,    // ship the log to a follower
+  REPLICATION_ROLE_FOLLOWER = 2   // replay the log of a leader
+};
+
 class configuration {
  public:
   // experiment type
@@ -84,6 +92,28 @@ class configuration {
 
   // asynchronous_mode
   AsynchronousType asynchronous_mode;
+
+  // write the compact WAL format
+  bool compact_log;
+
+  // compress the flushed log records (needs the compact format)
+  bool compress_log;
+
+  // leader or follower of a log shipping pair
+  ReplicationRole replication_role;
+
+  // port of the RPC server of this process
+  int replication_port;
+
+  // address of the follower (ip:port, leader only)
+  std::string follower_address;
+
+  // whether commits wait for the follower
+  ReplicationType replication_mode;
+
+  // keep the tiles in a memory-mapped file and sync their dirty cache lines
+  // at group commit (WBL)
+  bool nvm_emulation;
 };
 
 void Usage(FILE *out);
@@ -40,6 +40,10 @@ extern configuration state;
 
 bool SetupLoggingOnFollower();
 
+void StartReplicationServer();
+
+void ReportReplication(double duration);
+
 bool PrepareLogFile();
 
 //===--------------------------------------------------------------------===//
@@ -56,6 +60,12 @@ void DoRecovery();
 
 void BuildLog();
 
+//===--------------------------------------------------------------------===//
+// BACKEND SCALING
+//===--------------------------------------------------------------------===//
+
+void RunBackendScalingBenchmark();
+
 }  // namespace logger
 }  // namespace benchmark
 }  // namespace peloton
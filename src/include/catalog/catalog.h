@@ -101,7 +101,8 @@ class Catalog {
   Result CreateIndex(const std::string &database_name,
                      const std::string &table_name,
                      std::vector<std::string> index_attr,
-                     std::string index_name, bool unique, IndexType index_type);
+                     std::string index_name, bool unique, IndexType index_type,
+                     std::vector<std::string> include_attr = {});
 
   // Get a index with the oids of index, table, and database.
   index::Index *GetIndexWithOid(const oid_t database_oid, const oid_t table_oid,
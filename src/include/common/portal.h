@@ -44,6 +44,10 @@ class Portal {
     return param_stat_;
   }
 
+  inline void SetParameterBuffer(std::shared_ptr<ByteBuf> param_buffer) {
+    param_buffer_ = param_buffer;
+  }
+
   // Portal name
   std::string portal_name_;
 
@@ -55,6 +59,9 @@ class Portal {
 
   // The serialized params for stats collection
   std::shared_ptr<stats::QueryMetric::QueryParams> param_stat_;
+
+  // Packet the varlen parameters point into, if they do not own their data
+  std::shared_ptr<ByteBuf> param_buffer_;
 };
 
 }  // namespace peloton
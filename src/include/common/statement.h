@@ -25,6 +25,10 @@ namespace planner {
 class AbstractPlan;
 }
 
+namespace bridge {
+class ExecutorTree;
+}
+
 typedef std::pair<std::vector<unsigned char>, std::vector<unsigned char>>
     ResultType;
 
@@ -76,6 +80,13 @@ class Statement : public Printable {
 
   inline void SetNeedsPlan(bool replan) { needs_replan_ = replan; }
 
+  // executor tree kept between executions of the plan tree
+  bridge::ExecutorTree* GetExecutorTree() const {
+    return executor_tree_.get();
+  }
+
+  void SetExecutorTree(bridge::ExecutorTree* executor_tree);
+
   // Get a string representation for debugging
   const std::string GetInfo() const;
 
@@ -104,6 +115,9 @@ class Statement : public Printable {
 
   // If this flag is true, then somebody wants us to replan this query
   bool needs_replan_ = false;
+
+  // executor tree of the last execution
+  std::unique_ptr<bridge::ExecutorTree> executor_tree_;
 };
 
 }  // namespace peloton
@@ -35,10 +35,29 @@ DECLARE_string(socket_family);
 // RESOURCE USAGE
 //===----------------------------------------------------------------------===//
 
+// Screen index point lookups with bloom filters over the index keys
+DECLARE_bool(index_key_filter);
+
 //===----------------------------------------------------------------------===//
 // WRITE AHEAD LOG
 //===----------------------------------------------------------------------===//
 
+//===----------------------------------------------------------------------===//
+// REPLICATION
+//===----------------------------------------------------------------------===//
+
+// Replication role of the server (none, leader or follower)
+DECLARE_string(replication_role);
+
+// Port of the RPC server that carries the shipped log
+DECLARE_uint64(replication_port);
+
+// Address (ip:port) of the follower of a leader
+DECLARE_string(follower_address);
+
+// Replication mode of a leader (sync, semisync or async)
+DECLARE_string(replication_mode);
+
 //===----------------------------------------------------------------------===//
 // ERROR REPORTING AND LOGGING
 //===----------------------------------------------------------------------===//
@@ -37,6 +37,8 @@ class DeleteExecutor : public AbstractExecutor {
 
   ~DeleteExecutor() {}
 
+  void ResetState() { target_table_ = nullptr; }
+
  protected:
   bool DInit();
 
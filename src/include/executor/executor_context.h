@@ -52,6 +52,10 @@ class ExecutorContext {
 
   void ClearParams();
 
+  // Rebind the context to another execution of the same executor tree
+  void Reset(concurrency::Transaction *transaction,
+             const std::vector<type::Value> &params);
+
   // Get a pool
   type::EphemeralPool *GetPool();
 
@@ -56,6 +56,27 @@ class IndexScanExecutor : public AbstractScanExecutor {
   bool ExecPrimaryIndexLookup();
   bool ExecSecondaryIndexLookup();
 
+  // Answers the scan from the INCLUDE columns of a covering index. Entries
+  // whose version chain cannot be trusted from the tile group header alone
+  // are resolved through the regular version chain traversal.
+  bool ExecIndexOnlyLookup();
+
+  // Pulls entries from an index scan iterator in key order until enough
+  // visible tuples for the pushed down LIMIT have been found
+  bool ExecIncrementalLookup();
+
+  // Probe the index with the scan predicate of the plan
+  void ProbeIndex(std::vector<ItemPointer *> &tuple_location_ptrs);
+
+  // Traverse the version chains of the index entries and collect the visible
+  // versions that match the index key and the predicate
+  bool FindVisibleVersions(
+      const std::vector<ItemPointer *> &tuple_location_ptrs,
+      std::vector<ItemPointer> &visible_tuple_locations);
+
+  // Wrap the visible versions into one logical tile per tile group
+  void AddResultTiles(const std::vector<ItemPointer> &visible_tuple_locations);
+
   // When the required scan range has open boundaries, the tuples found by the
   // index might not be exact since the index can only give back tuples in a
   // close range. This function prune the head and the tail of the returned
@@ -67,6 +88,8 @@ class IndexScanExecutor : public AbstractScanExecutor {
   // conditions on key columns
   bool CheckKeyConditions(const ItemPointer &tuple_location);
 
+  bool CheckKeyConditions(const AbstractTuple &tuple);
+
   //===--------------------------------------------------------------------===//
   // Executor State
   //===--------------------------------------------------------------------===//
@@ -127,8 +150,11 @@ class IndexScanExecutor : public AbstractScanExecutor {
   // offset means from which point
   int64_t limit_offset_ = 0;
 
-  // whether order by is descending
-  bool descend_ = false;
+  // the key order in which the index is walked
+  ScanDirectionType scan_direction_ = SCAN_DIRECTION_TYPE_FORWARD;
+
+  // whether the scan is answered from the covering index entries
+  bool index_only_ = false;
 };
 
 }  // namespace executor
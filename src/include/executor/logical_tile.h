@@ -19,6 +19,7 @@
 
 #include "common/macros.h"
 #include "common/printable.h"
+#include "common/statement.h"
 #include "type/types.h"
 #include "type/value.h"
 
@@ -67,6 +68,12 @@ class LogicalTile : public Printable {
 
   ~LogicalTile();
 
+  // Executors create and drop several logical tiles per query, so their
+  // memory is recycled through a per-thread pool (see LogicalTileFactory)
+  static void *operator new(size_t size);
+
+  static void operator delete(void *tile);
+
   void AddColumn(const std::shared_ptr<storage::Tile> &base_tile,
                  oid_t origin_column_id, oid_t position_list_idx);
 
@@ -109,6 +116,11 @@ class LogicalTile : public Printable {
   std::vector<std::vector<std::string>> GetAllValuesAsStrings(
       const std::vector<int> &result_format, bool use_to_string_null);
 
+  // Append the visible rows to the results of the wire protocol, one entry
+  // per value. Columns with a non-zero format code are in binary format
+  void SerializeResults(const std::vector<int> &result_format,
+                        std::vector<ResultType> &results);
+
   // Get a string representation for debugging
   const std::string GetInfo() const;
 
@@ -42,6 +42,19 @@ class LogicalTileFactory {
 
   static LogicalTile *WrapTileGroup(
       const std::shared_ptr<storage::TileGroup> &tile_group);
+
+  // Get the memory of a logical tile, from the pool of the thread if it has
+  // a released one
+  static void *AllocateTile(size_t size);
+
+  // Keep the memory of a destroyed logical tile for the next one
+  static void ReleaseTile(void *tile);
+
+  // Number of logical tiles of the thread that reused pooled memory
+  static size_t GetReusedTileCount();
+
+  // Released logical tiles kept per thread
+  static constexpr size_t LOGICAL_TILE_POOL_SIZE = 256;
 };
 
 }  // namespace executor
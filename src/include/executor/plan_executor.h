@@ -18,6 +18,11 @@
 #include "concurrency/transaction_manager_factory.h"
 
 namespace peloton {
+
+namespace executor {
+class ExecutorContext;
+}
+
 namespace bridge {
 
 //===--------------------------------------------------------------------===//
@@ -45,6 +50,54 @@ typedef struct peloton_status {
 
 } peloton_status;
 
+//===--------------------------------------------------------------------===//
+// Executor Tree
+//===--------------------------------------------------------------------===//
+
+/*
+ * Executor tree of a prepared statement that is kept between executions.
+ * Every execution resets the executors and rebinds the context to its
+ * parameters and transaction instead of building the tree again.
+ */
+class ExecutorTree {
+ public:
+  ExecutorTree(const ExecutorTree &) = delete;
+  ExecutorTree &operator=(const ExecutorTree &) = delete;
+
+  ExecutorTree(const std::shared_ptr<planner::AbstractPlan> &plan);
+
+  ~ExecutorTree();
+
+  // Whether every executor of the plan starts over in Init, so that its
+  // tree can be run again
+  static bool IsReusable(const planner::AbstractPlan *plan);
+
+  // Reset the tree for another execution and return its root
+  executor::AbstractExecutor *Reset(concurrency::Transaction *txn,
+                                    const std::vector<type::Value> &params);
+
+  const std::shared_ptr<planner::AbstractPlan> &GetPlan() const {
+    return plan_;
+  }
+
+  executor::ExecutorContext *GetContext() const {
+    return executor_context_.get();
+  }
+
+  // number of executions of the tree
+  size_t GetExecutionCount() const { return execution_count_; }
+
+ private:
+  // the tree points into the plan, so keep it alive
+  std::shared_ptr<planner::AbstractPlan> plan_;
+
+  std::unique_ptr<executor::ExecutorContext> executor_context_;
+
+  std::unique_ptr<executor::AbstractExecutor> executor_tree_;
+
+  size_t execution_count_ = 0;
+};
+
 class PlanExecutor {
  public:
   PlanExecutor(const PlanExecutor &) = delete;
@@ -84,6 +137,17 @@ class PlanExecutor {
                                     std::vector<ResultType> &result,
                                     const std::vector<int> &result_format);
 
+  /*
+   * @brief Execute the plan of a prepared statement with the executor tree
+   * kept in the statement. The tree is built on the first execution and
+   * whenever the statement was replanned
+   */
+  static peloton_status ExecutePlan(Statement *statement,
+                                    concurrency::Transaction* txn,
+                                    const std::vector<type::Value> &params,
+                                    std::vector<ResultType> &result,
+                                    const std::vector<int> &result_format);
+
   /*
    * @brief When a peloton node recvs a query plan, this function is invoked
    * @param plan and params
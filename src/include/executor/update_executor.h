@@ -29,6 +29,11 @@ class UpdateExecutor : public AbstractExecutor {
   explicit UpdateExecutor(const planner::AbstractPlan *node,
                           ExecutorContext *executor_context);
 
+  void ResetState() {
+    target_table_ = nullptr;
+    project_info_ = nullptr;
+  }
+
  protected:
   bool PerformUpdatePrimaryKey(bool is_owner, oid_t tile_group_id,
                                oid_t physical_tuple_id,
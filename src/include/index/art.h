@@ -0,0 +1,309 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// art.h
+//
+// Identification: src/include/index/art.h
+//
+// Copyright (c) 2015-17, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "common/macros.h"
+#include "type/types.h"
+
+namespace peloton {
+namespace index {
+
+/*
+ * class ArtKey - Binary comparable key of the adaptive radix tree
+ *
+ * Keys are compared byte by byte (memcmp order), so the encoding must
+ * preserve the order of the original values. Every key of a tree must also
+ * be prefix free, i.e. no key may be a proper prefix of another one. Short
+ * keys live in an inline buffer to avoid allocations on the lookup path.
+ */
+class ArtKey {
+ public:
+  static constexpr uint32_t INLINE_KEY_SIZE = 32;
+
+  ArtKey() : data_(inline_data_), length_(0), capacity_(INLINE_KEY_SIZE) {}
+
+  ArtKey(const ArtKey &) = delete;
+  ArtKey &operator=(const ArtKey &) = delete;
+
+  inline void Clear() { length_ = 0; }
+
+  inline void Append(uint8_t byte) {
+    Reserve(length_ + 1);
+    data_[length_++] = byte;
+  }
+
+  inline void Append(const uint8_t *bytes, uint32_t count) {
+    Reserve(length_ + count);
+    PL_MEMCPY(data_ + length_, bytes, count);
+    length_ += count;
+  }
+
+  inline void Assign(const uint8_t *bytes, uint32_t count) {
+    Clear();
+    Append(bytes, count);
+  }
+
+  inline const uint8_t *GetData() const { return data_; }
+
+  inline uint32_t GetLength() const { return length_; }
+
+  inline uint8_t operator[](uint32_t offset) const { return data_[offset]; }
+
+ private:
+  inline void Reserve(uint32_t size) {
+    if (size <= capacity_) return;
+    while (capacity_ < size) capacity_ *= 2;
+    std::unique_ptr<uint8_t[]> new_data(new uint8_t[capacity_]);
+    PL_MEMCPY(new_data.get(), data_, length_);
+    heap_data_ = std::move(new_data);
+    data_ = heap_data_.get();
+  }
+
+  uint8_t inline_data_[INLINE_KEY_SIZE];
+  std::unique_ptr<uint8_t[]> heap_data_;
+  uint8_t *data_;
+  uint32_t length_;
+  uint32_t capacity_;
+};
+
+/*
+ * class ArtTree - Adaptive radix tree with optimistic lock coupling
+ *
+ * This is the ART of Leis et al. (ICDE 2013) synchronized with optimistic
+ * lock coupling (DaMoN 2016). Every node carries a version lock: readers
+ * never write to shared memory and instead validate the version of each node
+ * after reading it, restarting the operation if it has changed. Writers lock
+ * only the (at most two) nodes they modify.
+ *
+ * Inner nodes use path compression and keep the complete compressed path.
+ * Leaves store the full key together with an immutable array of values that
+ * is replaced on every modification, so that readers can copy it without
+ * locking. Inner nodes grow (4 -> 16 -> 48 -> 256) but never shrink; empty
+ * leaves are unlinked.
+ *
+ * Nodes and value arrays that are unlinked are reclaimed through an epoch
+ * based garbage collector, similar to the one used by the BwTree.
+ */
+class ArtTree {
+ public:
+  using ValueType = ItemPointer *;
+
+  ArtTree();
+
+  ~ArtTree();
+
+  ArtTree(const ArtTree &) = delete;
+  ArtTree &operator=(const ArtTree &) = delete;
+
+  // Insert a key-value pair. Returns false if the pair already exists
+  bool Insert(const ArtKey &key, ValueType value);
+
+  // Insert a key-value pair unless one of the values already stored under the
+  // key satisfies the predicate, in which case predicate_satisfied is set
+  bool ConditionalInsert(const ArtKey &key, ValueType value,
+                         std::function<bool(const void *)> predicate,
+                         bool *predicate_satisfied);
+
+  // Remove a key-value pair. Returns false if it does not exist
+  bool Delete(const ArtKey &key, ValueType value);
+
+  // Append all values stored under the key
+  void Lookup(const ArtKey &key, std::vector<ValueType> &result) const;
+
+  // Append the values of all keys in [low_key, high_key] in key order. A
+  // nullptr bound is unbounded. Stops once limit values have been collected
+  // if limit is not zero.
+  void ScanRange(const ArtKey *low_key, const ArtKey *high_key, bool forward,
+                 uint64_t limit, std::vector<ValueType> &result) const;
+
+  // Resumable range scan. Appends the values of whole leaves in key order
+  // until at least max_count values have been added, and stores the key of
+  // the last leaf in last_key so that the next batch can start after it with
+  // an exclusive bound. Returns the number of values appended; zero means
+  // that the range is exhausted.
+  size_t ScanBatch(const ArtKey *low_key, bool low_exclusive,
+                   const ArtKey *high_key, bool high_exclusive, bool forward,
+                   size_t max_count, std::vector<ValueType> &result,
+                   ArtKey &last_key) const;
+
+  // Approximate number of bytes held by nodes, leaves and value arrays
+  size_t GetMemoryFootprint() const { return memory_footprint_.load(); }
+
+  // Whether there is unlinked memory waiting to be reclaimed
+  bool NeedGarbageCollection() const { return garbage_count_.load() != 0; }
+
+  // Start a new epoch and reclaim the garbage of all finished epochs
+  void PerformGarbageCollection();
+
+ private:
+  struct Node;
+  struct Node4;
+  struct Node16;
+  struct Node48;
+  struct Node256;
+  struct Leaf;
+  struct ValueArray;
+  struct GarbageNode;
+  class EpochGuard;
+
+  enum class NodeType : uint8_t { N4, N16, N48, N256, LEAF };
+
+  // State shared by all levels of a range scan
+  struct ScanContext {
+    bool forward;
+    bool low_exclusive;
+    bool high_exclusive;
+    size_t max_result_size;
+    std::vector<ValueType> *result;
+    // Key of the last leaf that contributed values, if not nullptr
+    ArtKey *last_key;
+  };
+
+  //===--------------------------------------------------------------------===//
+  // Optimistic lock coupling
+  //===--------------------------------------------------------------------===//
+
+  static uint64_t ReadLockOrRestart(const Node *node, bool &need_restart);
+
+  static void CheckOrRestart(const Node *node, uint64_t version,
+                             bool &need_restart);
+
+  static void UpgradeToWriteLockOrRestart(Node *node, uint64_t &version,
+                                          bool &need_restart);
+
+  static void WriteUnlock(Node *node);
+
+  static void WriteUnlockObsolete(Node *node);
+
+  //===--------------------------------------------------------------------===//
+  // Node helpers
+  //===--------------------------------------------------------------------===//
+
+  Leaf *NewLeaf(const ArtKey &key, ValueType value);
+
+  Node4 *NewNode4(const uint8_t *prefix, uint32_t prefix_length);
+
+  ValueArray *NewValueArray(uint32_t count);
+
+  static Node *GetChild(const Node *node, uint8_t key_byte);
+
+  static void ChangeChild(Node *node, uint8_t key_byte, Node *child);
+
+  static bool IsFull(const Node *node);
+
+  static void InsertChild(Node *node, uint8_t key_byte, Node *child);
+
+  static void RemoveChild(Node *node, uint8_t key_byte);
+
+  Node *Grow(const Node *node);
+
+  static void SetPrefix(Node *node, const uint8_t *prefix,
+                        uint32_t prefix_length);
+
+  static const uint8_t *GetPrefix(const Node *node);
+
+  static bool LeafMatches(const Leaf *leaf, const ArtKey &key);
+
+  // Values are equal if they point to the same location, as in the BwTree
+  static inline bool ValueEquals(ValueType lhs, ValueType rhs) {
+    return (lhs->block == rhs->block) && (lhs->offset == rhs->offset);
+  }
+
+  // Collect the children of a node (in key byte order) within [low, high]
+  static void GetChildren(const Node *node, uint8_t low, uint8_t high,
+                          std::vector<std::pair<uint8_t, Node *>> &children);
+
+  bool InsertInternal(const ArtKey &key, ValueType value,
+                      std::function<bool(const void *)> *predicate,
+                      bool *predicate_satisfied);
+
+  // Add the value to an existing leaf, or report why this is impossible
+  bool AppendToLeaf(Leaf *leaf, ValueType value,
+                    std::function<bool(const void *)> *predicate,
+                    bool *predicate_satisfied, bool &need_restart);
+
+  // Scan the subtree below node, whose compressed path starts at level.
+  // A bound is nullptr once every key of the subtree is known to satisfy it.
+  // Returns false if the scan has to be restarted.
+  bool ScanNode(const Node *node, uint32_t level, const ArtKey *low_key,
+                const ArtKey *high_key, ScanContext &context) const;
+
+  // Compare a key with a bound in memcmp order
+  static int CompareKeys(const uint8_t *lhs, uint32_t lhs_length,
+                         const ArtKey &rhs);
+
+  // Free a node (or leaf) and its value array right away
+  void FreeNode(Node *node);
+
+  // Recursively free a subtree; only used at destruction
+  void FreeSubtree(Node *node);
+
+  //===--------------------------------------------------------------------===//
+  // Epoch based reclamation
+  //===--------------------------------------------------------------------===//
+
+  // Threads announce themselves in the current epoch for the duration of
+  // every operation. Memory unlinked while the global epoch is e is freed
+  // once the epoch has advanced to e + 2, which requires that no thread is
+  // still inside epoch e. Hence three epoch slots are enough.
+  static constexpr uint64_t EPOCH_SLOT_COUNT = 3;
+
+  // Number of retired objects after which a writer tries to reclaim them
+  static constexpr size_t GC_THRESHOLD = 1024;
+
+  uint64_t JoinEpoch() const;
+
+  void LeaveEpoch(uint64_t epoch) const;
+
+  // Defer freeing a node (or leaf) until no thread can hold a reference
+  void Retire(Node *node);
+
+  // Defer freeing a value array until no thread can hold a reference
+  void Retire(ValueArray *values);
+
+  void Retire(GarbageNode *garbage);
+
+  void FreeGarbageList(GarbageNode *garbage);
+
+  //===--------------------------------------------------------------------===//
+  // Data members
+  //===--------------------------------------------------------------------===//
+
+  // The root is a Node256 without prefix and is never replaced
+  Node *root_;
+
+  std::atomic<size_t> memory_footprint_;
+
+  std::atomic<uint64_t> global_epoch_;
+
+  // Number of threads inside each epoch slot
+  mutable std::atomic<int64_t> active_threads_[EPOCH_SLOT_COUNT];
+
+  // Memory retired in each epoch slot
+  std::atomic<GarbageNode *> garbage_lists_[EPOCH_SLOT_COUNT];
+
+  std::atomic<size_t> garbage_count_;
+
+  // Only one thread reclaims memory at a time
+  std::atomic_flag gc_lock_ = ATOMIC_FLAG_INIT;
+};
+
+}  // End index namespace
+}  // End peloton namespace
@@ -0,0 +1,116 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// art_index.h
+//
+// Identification: src/include/index/art_index.h
+//
+// Copyright (c) 2015-17, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "index/art.h"
+#include "index/index.h"
+#include "type/types.h"
+
+namespace peloton {
+namespace index {
+
+/**
+ * Adaptive radix tree based index implementation.
+ *
+ * Key tuples are encoded into binary comparable byte strings, so that the
+ * tree can compare keys with memcmp. The encoding of every column type is
+ * order preserving and prefix free:
+ *
+ *  - integers: sign bit flipped, big endian
+ *  - decimals: sign bit flipped if positive, all bits flipped if negative
+ *  - varchar/varbinary: 0x01, the bytes with 0x00 escaped as 0x00 0xFF and
+ *    the terminator 0x00 0x00. NULL is encoded as 0x02, which sorts after
+ *    every string, just like the maximum value the scan optimizer uses
+ *
+ * @see Index
+ */
+class ArtIndex : public Index {
+  friend class IndexFactory;
+
+  using ValueType = ItemPointer *;
+
+ public:
+  ArtIndex(IndexMetadata *metadata);
+
+  ~ArtIndex();
+
+  bool InsertEntry(const storage::Tuple *key, ItemPointer *value);
+
+  bool DeleteEntry(const storage::Tuple *key, ItemPointer *value);
+
+  bool CondInsertEntry(const storage::Tuple *key, ItemPointer *value,
+                       std::function<bool(const void *)> predicate);
+
+  void Scan(const std::vector<type::Value> &values,
+            const std::vector<oid_t> &key_column_ids,
+            const std::vector<ExpressionType> &expr_types,
+            ScanDirectionType scan_direction, std::vector<ValueType> &result,
+            const ConjunctionScanPredicate *csp_p);
+
+  void ScanLimit(const std::vector<type::Value> &values,
+                 const std::vector<oid_t> &key_column_ids,
+                 const std::vector<ExpressionType> &expr_types,
+                 ScanDirectionType scan_direction,
+                 std::vector<ValueType> &result,
+                 const ConjunctionScanPredicate *csp_p, uint64_t limit,
+                 uint64_t offset);
+
+  std::unique_ptr<IndexScanIterator> GetScanIterator(
+      const std::vector<type::Value> &value_list,
+      const std::vector<oid_t> &tuple_column_id_list,
+      const std::vector<ExpressionType> &expr_list,
+      ScanDirectionType scan_direction, const ConjunctionScanPredicate *csp_p);
+
+  void ScanCovering(const std::vector<type::Value> &values,
+                    const std::vector<oid_t> &key_column_ids,
+                    const std::vector<ExpressionType> &expr_types,
+                    ScanDirectionType scan_direction,
+                    std::vector<ValueType> &result,
+                    std::vector<char> &payloads,
+                    const ConjunctionScanPredicate *csp_p);
+
+  void ScanAllKeys(std::vector<ValueType> &result);
+
+  void ScanKey(const storage::Tuple *key, std::vector<ValueType> &result);
+
+  std::string GetTypeName() const;
+
+  bool Cleanup() { return true; }
+
+  size_t GetMemoryFootprint() { return container.GetMemoryFootprint(); }
+
+  bool NeedGC() { return container.NeedGarbageCollection(); }
+
+  void PerformGC() {
+    container.PerformGarbageCollection();
+
+    return;
+  }
+
+  // Whether keys of this column type can be encoded
+  static bool IsSupportedKeyType(type::Type::TypeId type_id);
+
+ protected:
+  // Encode the key tuple (laid out as the key schema) into art_key
+  void EncodeKey(const storage::Tuple *key, ArtKey &art_key) const;
+
+  // container
+  ArtTree container;
+};
+
+}  // End index namespace
+}  // End peloton namespace
@@ -8508,6 +8508,27 @@ try_join_again:
     return ForwardIterator{this, start_key};
   }
 
+  /*
+   * ReverseBegin() - Return an iterator on the last data item whose key is
+   *                  less than or equal to the given key
+   *
+   * The iterator is meant to be moved backward using operator--, until
+   * IsREnd() becomes true. Since Begin() stops at the first of the items
+   * equal to the key, we skip them before stepping back once
+   */
+  ForwardIterator ReverseBegin(const KeyType &start_key) {
+    ForwardIterator it{this, start_key};
+
+    while((it.IsEnd() == false) && \
+          (KeyCmpLessEqual(it->first, start_key) == true)) {
+      ++it;
+    }
+
+    --it;
+
+    return it;
+  }
+
   /*
    * NullIterator() - Returns an empty iterator that cannot do anything
    *
@@ -111,6 +111,20 @@ class BWTreeIndex : public Index {
                  uint64_t limit,
                  uint64_t offset);
 
+  std::unique_ptr<IndexScanIterator> GetScanIterator(
+      const std::vector<type::Value> &value_list,
+      const std::vector<oid_t> &tuple_column_id_list,
+      const std::vector<ExpressionType> &expr_list,
+      ScanDirectionType scan_direction, const ConjunctionScanPredicate *csp_p);
+
+  void ScanCovering(const std::vector<type::Value> &values,
+                    const std::vector<oid_t> &key_column_ids,
+                    const std::vector<ExpressionType> &expr_types,
+                    ScanDirectionType scan_direction,
+                    std::vector<ValueType> &result,
+                    std::vector<char> &payloads,
+                    const ConjunctionScanPredicate *csp_p);
+
   void ScanAllKeys(std::vector<ValueType> &result);
 
   void ScanKey(const storage::Tuple *key,
@@ -134,7 +148,28 @@ class BWTreeIndex : public Index {
     return;
   }
 
+  void EnableKeyFilter();
+
+  void RebuildKeyFilter();
+
  protected:
+  // Whether a lookup of the key has to go to the tree. Only false if the
+  // key filter is enabled and rules the key out
+  inline bool MayContainKey(const KeyType &index_key) {
+    return (key_filter == nullptr) ||
+           key_filter->MayContain(hash_func(index_key));
+  }
+
+  // Record a key that has just been inserted into the tree in the filter
+  void InsertIntoKeyFilter(const KeyType &index_key);
+
+  // Append the hash of every distinct key in the tree
+  void CollectKeyHashes(std::vector<uint64_t> &key_hashes);
+
+  // Build a key that is not lower than any key in the tree, to walk back
+  // from the end of it
+  void GetMaxKey(KeyType &index_key);
+
   // equality checker and comparator
   KeyComparator comparator;
   KeyEqualityChecker equals;
@@ -21,6 +21,7 @@
 
 #include "common/logger.h"
 #include "common/printable.h"
+#include "index/key_filter.h"
 #include "type/abstract_pool.h"
 #include "type/types.h"
 #include "type/value.h"
@@ -62,7 +63,8 @@ class IndexMetadata : public Printable {
                 IndexConstraintType index_constraint_type,
                 const catalog::Schema *tuple_schema,
                 const catalog::Schema *key_schema,
-                const std::vector<oid_t> &key_attrs, bool unique_keys);
+                const std::vector<oid_t> &key_attrs, bool unique_keys,
+                const std::vector<oid_t> &include_attrs = {});
 
   ~IndexMetadata();
 
@@ -106,6 +108,33 @@ class IndexMetadata : public Printable {
    */
   inline const std::vector<oid_t> &GetKeyAttrs() const { return key_attrs; }
 
+  /*
+   * GetIncludeAttrs() - Returns the base table columns that are stored in the
+   *                     index payload (INCLUDE columns) but are not part of
+   *                     the key
+   */
+  inline const std::vector<oid_t> &GetIncludeAttrs() const {
+    return include_attrs;
+  }
+
+  // Whether the index stores INCLUDE columns in addition to its key
+  inline bool IsCovering() const { return include_attrs.empty() == false; }
+
+  /*
+   * GetCoveringSchema() - Returns the schema of the tuples stored inside the
+   *                       index, i.e. the key columns followed by the
+   *                       INCLUDE columns
+   *
+   * For indexes without INCLUDE columns this is the key schema. The indexed
+   * columns of this schema are the base table columns in the same order
+   */
+  inline const catalog::Schema *GetCoveringSchema() const {
+    return (covering_schema != nullptr) ? covering_schema : key_schema;
+  }
+
+  // Whether the given base table column can be read from the index
+  bool IsColumnCovered(oid_t tuple_column_id) const;
+
   /*
    * GetTupleToIndexMapping() - Returns the mapping relation between tuple key
    *                            column and index key columns
@@ -160,10 +189,17 @@ class IndexMetadata : public Printable {
   // of the underlying table schema
   const catalog::Schema *key_schema;
 
+  // schema of the key columns followed by the INCLUDE columns
+  // (nullptr if the index has no INCLUDE columns)
+  const catalog::Schema *covering_schema = nullptr;
+
  private:
   // The mapping relation between key schema and tuple schema
   std::vector<oid_t> key_attrs;
 
+  // Base table columns stored in the index payload after the key columns
+  std::vector<oid_t> include_attrs;
+
   // The mapping relation between tuple schema and key schema
   // i.e. if the column in tuple is not indexed, then it is set to INVALID_OID
   //      if the column in tuple is indexed, then it is the index in index_key
@@ -184,6 +220,29 @@ class IndexMetadata : public Printable {
   static bool index_default_visibility;
 };
 
+/////////////////////////////////////////////////////////////////////
+// IndexScanIterator class definition
+/////////////////////////////////////////////////////////////////////
+
+/*
+ * class IndexScanIterator - Pull based cursor over the entries of a scan
+ *
+ * Entries are returned in key order of the requested scan direction, a batch
+ * at a time, so that the consumer can stop as soon as it has seen enough rows
+ * instead of waiting for the whole range to be materialized. Entries whose
+ * key is known to fail the scan predicate may be skipped by the index; the
+ * consumer still has to check the tuples it reads.
+ */
+class IndexScanIterator {
+ public:
+  virtual ~IndexScanIterator() {}
+
+  // Append at most max_count entries to result and return how many were
+  // appended. Returning zero means that the scan is exhausted
+  virtual size_t Next(std::vector<ItemPointer *> &result,
+                      size_t max_count) = 0;
+};
+
 /////////////////////////////////////////////////////////////////////
 // Index class definition
 /////////////////////////////////////////////////////////////////////
@@ -271,6 +330,26 @@ class Index : public Printable {
                         const ScanDirectionType &scan_direction,
                         std::vector<ItemPointer *> &result);
 
+  // Index-only scan: in addition to the locations, the covering tuple
+  // (laid out as IndexMetadata::GetCoveringSchema()) of every match is
+  // copied into payloads, one fixed-size record per location
+  virtual void ScanCovering(const std::vector<type::Value> &value_list,
+                            const std::vector<oid_t> &tuple_column_id_list,
+                            const std::vector<ExpressionType> &expr_list,
+                            ScanDirectionType scan_direction,
+                            std::vector<ItemPointer *> &result,
+                            std::vector<char> &payloads,
+                            const ConjunctionScanPredicate *csp_p) = 0;
+
+  // Pull based flavor of Scan(). The default implementation materializes a
+  // forward Scan() and hands it out in batches; indexes that can walk their
+  // keys lazily override it
+  virtual std::unique_ptr<IndexScanIterator> GetScanIterator(
+      const std::vector<type::Value> &value_list,
+      const std::vector<oid_t> &tuple_column_id_list,
+      const std::vector<ExpressionType> &expr_list,
+      ScanDirectionType scan_direction, const ConjunctionScanPredicate *csp_p);
+
   virtual void ScanAllKeys(std::vector<ItemPointer *> &result) = 0;
 
   virtual void ScanKey(const storage::Tuple *key,
@@ -296,6 +375,22 @@ class Index : public Printable {
   // virtual void *JoinEpoch() = 0;
   // virtual void LeaveEpoch(void *) = 0;
 
+  ///////////////////////////////////////////////////////////////////
+  // Key Filter
+  ///////////////////////////////////////////////////////////////////
+
+  // Screen point lookups with a bloom filter over the keys, starting with
+  // the keys already in the index. This must not race with modifications
+  // of the index. Indexes that cannot use a filter ignore it
+  virtual void EnableKeyFilter() {}
+
+  // Rebuild the bloom filter from the keys in the index, which drops the
+  // keys that have been deleted since it was built
+  virtual void RebuildKeyFilter() {}
+
+  // nullptr if lookups are not screened
+  const KeyFilter *GetKeyFilter() const { return key_filter.get(); }
+
   //===--------------------------------------------------------------------===//
   // STATS
   //===--------------------------------------------------------------------===//
@@ -350,6 +445,12 @@ class Index : public Printable {
                const std::vector<ExpressionType> &expr_types,
                const std::vector<type::Value> &values);
 
+  // Whether every key within the low/high range that the scan optimizer
+  // derives from the predicate satisfies the predicate, i.e. whether keys
+  // inside the range need no further checking
+  bool IsExactScanRange(const std::vector<oid_t> &column_ids,
+                        const std::vector<ExpressionType> &expr_types) const;
+
   type::AbstractPool *GetPool() const { return pool; }
 
   // Garbage collect
@@ -397,6 +498,9 @@ class Index : public Printable {
 
   // This is used by index tuner
   std::atomic<size_t> indexed_tile_group_offset;
+
+  // Bloom filter over the keys, or nullptr if lookups are not screened
+  std::unique_ptr<KeyFilter> key_filter;
 };
 
 }  // End index namespace
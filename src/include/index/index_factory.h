@@ -39,6 +39,12 @@ class IndexFactory {
   static Index *GetBwTreeIntsKeyIndex(IndexMetadata *metadata);
 
   static Index *GetBwTreeGenericKeyIndex(IndexMetadata *metadata);
+
+  //===--------------------------------------------------------------------===//
+  // PELOTON::ART
+  //===--------------------------------------------------------------------===//
+
+  static Index *GetArtIndex(IndexMetadata *metadata);
 };
 
 }  // End index namespace
@@ -0,0 +1,136 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// key_filter.h
+//
+// Identification: src/include/index/key_filter.h
+//
+// Copyright (c) 2015-17, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace peloton {
+namespace index {
+
+/*
+ * class KeyFilter - Blocked bloom filter over the keys of an index
+ *
+ * The filter lets point lookups reject keys that have never been inserted
+ * without traversing the index. It uses the split block layout of Putze et
+ * al.: the hash of a key selects one 64 byte block and sets one bit in each
+ * of its eight words, so that an insert or a probe touches a single cache
+ * line. Bits are set with atomic operations; neither inserts nor probes
+ * take a latch.
+ *
+ * Keys cannot be removed from a bloom filter, so removals are only counted.
+ * Once deleted keys (or keys beyond the capacity the filter was sized for)
+ * make up too large a share, the owner rebuilds the filter by feeding every
+ * key of the index between BeginRebuild() and EndRebuild(). Inserts that
+ * race with a rebuild go to the new bit array as well, so that the rebuilt
+ * filter never misses a key; for this to hold, keys must be inserted into
+ * the filter after they have been inserted into the index.
+ *
+ * Probes may still be reading a bit array after a rebuild has replaced it.
+ * Replaced arrays are therefore never freed before the filter itself, and
+ * are recycled by later rebuilds of the same size instead. A probe detects
+ * that the array it read has been recycled through a sequence number that
+ * is bumped before an array is cleared, and then reports a possible match.
+ */
+class KeyFilter {
+ public:
+  // Number of filter bits reserved for every expected key
+  static constexpr size_t BITS_PER_KEY = 16;
+
+  // Smallest number of blocks of a bit array
+  static constexpr size_t MIN_BLOCK_COUNT = 64;
+
+  KeyFilter(size_t expected_key_count);
+
+  ~KeyFilter();
+
+  KeyFilter(const KeyFilter &) = delete;
+  KeyFilter &operator=(const KeyFilter &) = delete;
+
+  // Record a key after it has been added to the index
+  void Insert(uint64_t key_hash);
+
+  // Record that a key has been removed from the index
+  void Remove() { removed_count_.fetch_add(1, std::memory_order_relaxed); }
+
+  // Returns false only if the key has definitely not been inserted
+  bool MayContain(uint64_t key_hash) const;
+
+  // Whether deleted or excess keys have degraded the filter enough that
+  // rebuilding it from the index pays off
+  bool NeedRebuild() const;
+
+  // Approximate number of keys in the index
+  size_t GetKeyCount() const;
+
+  // Start building a new bit array for the given number of keys. Returns
+  // false if another rebuild is already in progress
+  bool BeginRebuild(size_t key_count);
+
+  // Add a key found in the index while rebuilding
+  void RebuildInsert(uint64_t key_hash);
+
+  // Replace the active bit array with the one that has been rebuilt
+  void EndRebuild();
+
+  // Bytes held by all bit arrays, including replaced ones
+  size_t GetMemoryFootprint() const;
+
+ private:
+  class BitArray;
+
+  // Spread the bits of a (possibly weak) key hash
+  static inline uint64_t MixHash(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+  }
+
+  // Number of keys a bit array of the given number of blocks is sized for
+  static size_t GetCapacity(size_t block_count);
+
+  // Blocks needed for the given number of keys, rounded to a power of two
+  static size_t GetBlockCount(size_t key_count);
+
+  std::atomic<BitArray *> active_;
+
+  // The array being rebuilt, or nullptr outside of a rebuild
+  std::atomic<BitArray *> building_;
+
+  // Bumped before a replaced array is cleared for reuse
+  std::atomic<uint64_t> rebuild_sequence_;
+
+  // Keys inserted and removed since the active array has been built
+  std::atomic<size_t> inserted_count_;
+  std::atomic<size_t> removed_count_;
+
+  // Number of keys the active array has been sized for
+  std::atomic<size_t> capacity_;
+
+  std::atomic<size_t> memory_footprint_;
+
+  // Owns every bit array that has ever been allocated
+  std::vector<std::unique_ptr<BitArray>> arrays_;
+
+  // Held from BeginRebuild() to EndRebuild()
+  std::mutex rebuild_lock_;
+};
+
+}  // End index namespace
+}  // End peloton namespace
@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <vector>
 #include <mutex>
 #include <condition_variable>
@@ -22,7 +23,7 @@
 #include "logging/log_record.h"
 #include "logging/log_buffer.h"
 #include "common/platform.h"
-#include "logging/circular_buffer_pool.h"
+#include "logging/log_buffer_ring.h"
 
 namespace peloton {
 namespace logging {
@@ -56,16 +57,19 @@ class BackendLogger : public Logger {
                                     const void *data = nullptr) = 0;
 
   void SetLoggingCidLowerBound(cid_t cid) {
-    // XXX bad synchronization practice
-    log_buffer_lock.Lock();
-
     logging_cid_lower_bound = cid;
 
     highest_logged_commit_message = INVALID_CID;
 
-    log_buffer_lock.Unlock();
+    PublishCommitIds();
   }
 
+  // the next commit is published as at least this commit id
+  void SetCommitIdFloor(cid_t cid) { commit_id_floor = cid; }
+
+  // commit id published for the last commit of this backend
+  cid_t GetLoggedCommitId() const { return highest_logged_commit_message; }
+
   // FIXME The following methods should be exposed to FrontendLogger only
   // Collect all log buffers to be persisted
   std::vector<std::unique_ptr<LogBuffer>> &GetLogBuffers() {
@@ -94,9 +98,25 @@ class BackendLogger : public Logger {
   // gets the Varlenpool used for log serialization
   type::AbstractPool *GetVarlenPool() { return backend_pool.get(); }
 
+  // number of times this backend waited for the frontend to return a buffer
+  size_t GetBufferWaitCount() const {
+    return available_buffer_pool_->GetEmptyWaitCount();
+  }
+
+  // time this backend spent waiting for a buffer (in microseconds)
+  uint64_t GetBufferWaitTime() const {
+    return available_buffer_pool_->GetWaitTime();
+  }
+
  protected:
-  // the lock for the buffer being used currently
-  Spinlock log_buffer_lock;
+  // hand the current buffer off to the frontend logger
+  void HandOffLogBuffer();
+
+  // make the commit ids of this backend visible to the frontend logger
+  void PublishCommitIds();
+
+  // read the commit ids published by the backend (frontend only)
+  void ReadCommitIds(cid_t &lower_bound, cid_t &highest_commit);
 
   // temporary local_queue used by backend
   std::vector<std::unique_ptr<LogBuffer>> local_queue;
@@ -110,6 +130,9 @@ class BackendLogger : public Logger {
   // lower bound for values this backend may commit
   cid_t logging_cid_lower_bound = INVALID_CID;
 
+  // lowest commit id the next commit is published as
+  cid_t commit_id_floor = INVALID_CID;
+
   // max cid for the current log buffer
   cid_t max_log_id_buffer = 0;
 
@@ -119,11 +142,22 @@ class BackendLogger : public Logger {
   // the current buffer
   std::unique_ptr<LogBuffer> log_buffer_;
 
-  // the pool of available buffers
-  std::unique_ptr<BufferPool> available_buffer_pool_;
+  // the ring of available buffers, filled by the frontend logger
+  std::unique_ptr<LogBufferRing> available_buffer_pool_;
+
+  // the ring of buffers to persist, drained by the frontend logger
+  std::unique_ptr<LogBufferRing> persist_buffer_pool_;
+
+  // commit ids published to the frontend logger. the version is odd while
+  // the backend updates them
+  std::atomic<uint64_t> commit_ids_version_;
+
+  std::atomic<cid_t> published_lower_bound_;
+
+  std::atomic<cid_t> published_commit_;
 
-  // the pool of buffers to persist
-  std::unique_ptr<BufferPool> persist_buffer_pool_;
+  // last commit id reported to the frontend logger (frontend only)
+  cid_t reported_commit_ = INVALID_CID;
 
   // varlen pool for serialization
   std::unique_ptr<type::AbstractPool> backend_pool;
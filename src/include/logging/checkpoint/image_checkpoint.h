@@ -0,0 +1,152 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// image_checkpoint.h
+//
+// Identification: src/include/logging/checkpoint/image_checkpoint.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+/* Checkpoint image format
+ *
+ *     Image :
+ *       - ImageHeader
+ *       - Tile Group Images     : 8 byte aligned
+ *       - Index                 : file offset (uint64) per tile group image
+ *
+ *     Tile Group Image :
+ *       - ImageTileGroupHeader
+ *       - Visibility            : byte per tuple slot, 8 byte aligned
+ *       - Tuple slots           : tuple length per tuple slot
+ *       - Varlen heap           : length (uint32) and data per value
+ *
+ * The tuple slots have the layout of a tile with the schema of the table,
+ * which is what recovery creates, so they are copied into the tile as they
+ * are. Fields of values that are not inlined hold the heap offset of the
+ * value plus one (zero for null) instead of a pointer.
+ *
+ * With index images enabled, the sorted entries of every index are written
+ * to a file of the same version next to the image (see index_image.h).
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "logging/checkpoint.h"
+
+extern size_t peloton_checkpoint_thread_count;
+
+extern bool peloton_checkpoint_index_images;
+
+namespace peloton {
+
+namespace storage {
+class TileGroup;
+}
+
+namespace logging {
+
+struct ImageHeader {
+  uint32_t magic;
+  uint32_t format_version;
+  uint64_t checkpoint_cid;
+  uint64_t index_offset;
+  uint32_t tile_group_count;
+  uint32_t max_tile_group_id;
+};
+
+struct ImageTileGroupHeader {
+  uint32_t database_oid;
+  uint32_t table_oid;
+  uint32_t tile_group_id;
+  uint32_t tuple_slot_count;
+  uint32_t tuple_length;
+  uint32_t column_count;
+  uint64_t heap_size;
+};
+
+//===--------------------------------------------------------------------===//
+// Image Checkpoint
+//===--------------------------------------------------------------------===//
+
+/**
+ * Checkpoint that is recovered by mapping the image and copying the tuple
+ * slots of each tile group into a new tile, instead of deserializing and
+ * inserting one tuple at a time. The tile groups are restored in parallel.
+ */
+class ImageCheckpoint : public Checkpoint {
+ public:
+  ImageCheckpoint(const ImageCheckpoint &) = delete;
+  ImageCheckpoint &operator=(const ImageCheckpoint &) = delete;
+  ImageCheckpoint(ImageCheckpoint &&) = delete;
+  ImageCheckpoint &operator=(ImageCheckpoint &&) = delete;
+  ImageCheckpoint(bool disable_file_access);
+  ~ImageCheckpoint();
+
+  // Inherited functions
+  void DoCheckpoint();
+
+  cid_t DoRecovery();
+
+  // Build the image of the tuples of a tile group that are visible at the
+  // checkpoint cid. Returns the number of tuples
+  static size_t BuildTileGroupImage(storage::TileGroup *tile_group,
+                                    oid_t database_oid, cid_t checkpoint_cid,
+                                    std::vector<char> &image);
+
+  // Restore a tile group from its image. Returns false if the image does
+  // not fit the table
+  bool RestoreTileGroupImage(const char *image, size_t size,
+                             cid_t checkpoint_cid);
+
+  inline void SetThreadCount(size_t thread_count) {
+    thread_count_ = thread_count;
+  }
+
+  inline void SetIndexImages(bool index_images) {
+    index_images_ = index_images;
+  }
+
+  static constexpr uint32_t IMAGE_MAGIC = 0x504c494d;
+
+  static constexpr uint32_t IMAGE_FORMAT_VERSION = 1;
+
+ private:
+  std::string GetImageFileName(int version);
+
+  std::string GetIndexImageFileName(int version);
+
+  void InitVersionNumber();
+
+  size_t GetThreadCount() const;
+
+  // threads that restore the tile groups (0: one per core)
+  size_t thread_count_ = peloton_checkpoint_thread_count;
+
+  // write and load the images of the indexes as well
+  bool index_images_ = peloton_checkpoint_index_images;
+
+  // Keep tracking max oid for setting next_oid in manager
+  // For active processing after recovery
+  oid_t max_oid_ = 0;
+
+  // Serializes the creation of tile groups during recovery
+  std::mutex recovery_mutex_;
+
+  const std::string IMAGE_FILE_PREFIX = "peloton_image_checkpoint_";
+
+  const std::string IMAGE_FILE_SUFFIX = ".img";
+
+  const std::string INDEX_IMAGE_FILE_SUFFIX = ".idx";
+};
+
+}  // namespace logging
+}  // namespace peloton
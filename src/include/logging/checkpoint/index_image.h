@@ -0,0 +1,92 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// index_image.h
+//
+// Identification: src/include/logging/checkpoint/index_image.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+/* Index image format
+ *
+ *     Index images :
+ *       - Magic                 : int
+ *       - Format version        : int
+ *       - Checkpoint cid        : long
+ *       - Index Blocks          : one per index of every table
+ *
+ *     Index Block :
+ *       - Block length          : long
+ *       - Database Oid          : int
+ *       - Table Oid             : int
+ *       - Index Oid             : int
+ *       - Entry count           : int
+ *       - Entries               : tile group id (int), offset (int) and the
+ *                                 values of the key, in key order
+ *
+ * The keys have the covering schema of the index. The locations are only
+ * valid for checkpoints that restore the tuples in their original slots.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "type/serializeio.h"
+#include "type/types.h"
+
+namespace peloton {
+
+namespace index {
+class Index;
+}
+
+namespace storage {
+class DataTable;
+}
+
+namespace logging {
+
+//===--------------------------------------------------------------------===//
+// Index Image
+//===--------------------------------------------------------------------===//
+
+/**
+ * Sorted (key, location) entries of every index at a checkpoint cid.
+ *
+ * Loading the images inserts the entries in key order instead of scanning
+ * the tables and building a key per tuple, so that index recovery only has
+ * to insert the tuples that the WAL added after the checkpoint.
+ */
+class IndexImage {
+ public:
+  // Write the images of all indexes that are visible at the checkpoint cid.
+  // Returns false if the file could not be written
+  static bool Write(const std::string &file_name, cid_t checkpoint_cid,
+                    size_t thread_count);
+
+  // Load the images of the checkpoint cid into the indexes. Returns false
+  // (without touching any index) if the images do not cover every index
+  static bool Load(const std::string &file_name, cid_t checkpoint_cid,
+                   size_t thread_count);
+
+  // Write the sorted entries of an index of the table as one block.
+  // Returns the number of entries
+  static size_t SerializeIndex(storage::DataTable *table, index::Index *index,
+                               oid_t database_oid, cid_t checkpoint_cid,
+                               CopySerializeOutput &output);
+
+  // Insert the entries of a block (without its length) into their index.
+  // Returns false if the block is malformed
+  static bool LoadIndex(const char *data, size_t size);
+
+  static constexpr int32_t INDEX_IMAGE_MAGIC = 0x504c4958;
+
+  static constexpr int32_t INDEX_IMAGE_FORMAT_VERSION = 1;
+};
+
+}  // namespace logging
+}  // namespace peloton
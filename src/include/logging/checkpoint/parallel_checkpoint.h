@@ -0,0 +1,149 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// parallel_checkpoint.h
+//
+// Identification: src/include/logging/checkpoint/parallel_checkpoint.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+/* Parallel checkpoint format
+ *
+ *     Checkpoint part (one file per checkpoint thread) :
+ *       - Tile Group Blocks
+ *
+ *     Tile Group Block :
+ *       - Block length          : int
+ *       - Database Oid          : int
+ *       - Table Oid             : int
+ *       - Tile Group Id         : int
+ *       - Tuple count           : int
+ *       - Tuple slots           : int per tuple
+ *       - Data                  : values of the first column of all tuples,
+ *                                 then of the second column, and so on
+ *
+ *     Manifest (written once all parts are durable) :
+ *       - Checkpoint cid        : long
+ *       - Part count            : int
+ *       - Max tile group id     : int
+ *
+ * A checkpoint without a manifest is incomplete and ignored by recovery.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "logging/checkpoint.h"
+#include "type/serializeio.h"
+
+extern size_t peloton_checkpoint_thread_count;
+
+namespace peloton {
+
+namespace storage {
+class TileGroup;
+}
+
+namespace logging {
+
+//===--------------------------------------------------------------------===//
+// Parallel Checkpoint
+//===--------------------------------------------------------------------===//
+
+/**
+ * Fuzzy checkpoint that does not block transactions.
+ *
+ * The tile groups of all tables are handed out to the checkpoint threads,
+ * which write the tuples that are visible at the checkpoint cid to their own
+ * part of the checkpoint. Committed versions are never modified in place, so
+ * the scan does not need locks. It only keeps the garbage collector from
+ * recycling the versions that it has not read yet.
+ *
+ * Recovery loads the parts in parallel. The WAL is replayed from the
+ * checkpoint cid afterwards.
+ */
+class ParallelCheckpoint : public Checkpoint {
+ public:
+  ParallelCheckpoint(const ParallelCheckpoint &) = delete;
+  ParallelCheckpoint &operator=(const ParallelCheckpoint &) = delete;
+  ParallelCheckpoint(ParallelCheckpoint &&) = delete;
+  ParallelCheckpoint &operator=(ParallelCheckpoint &&) = delete;
+  ParallelCheckpoint(bool disable_file_access);
+  ~ParallelCheckpoint();
+
+  // Inherited functions
+  void DoCheckpoint();
+
+  cid_t DoRecovery();
+
+  // Write the visible tuples of a tile group as one block. Returns the
+  // number of tuples
+  static size_t SerializeTileGroup(storage::TileGroup *tile_group,
+                                   oid_t database_oid, cid_t checkpoint_cid,
+                                   CopySerializeOutput &output);
+
+  // Insert the tuples of a block (without its length) into their tables.
+  // Returns false if the block is malformed
+  bool RecoverTileGroup(const char *data, size_t size, cid_t checkpoint_cid);
+
+  inline void SetThreadCount(size_t thread_count) {
+    thread_count_ = thread_count;
+  }
+
+ private:
+  std::string GetPartFileName(int version, size_t part);
+
+  std::string GetManifestFileName(int version);
+
+  // Write a part of the checkpoint from the tile groups that are handed out
+  bool WritePart(size_t part, cid_t checkpoint_cid);
+
+  bool RecoverPart(size_t part, cid_t checkpoint_cid);
+
+  bool WriteManifest(cid_t checkpoint_cid, size_t part_count);
+
+  bool ReadManifest(int version, cid_t &checkpoint_cid, size_t &part_count,
+                    oid_t &max_tile_group_id);
+
+  void RemoveVersion(int version, size_t part_count);
+
+  void InitVersionNumber();
+
+  size_t GetThreadCount() const;
+
+  // threads that write and load the checkpoint (0: one per core)
+  size_t thread_count_ = peloton_checkpoint_thread_count;
+
+  // tile groups of the current checkpoint
+  struct TileGroupTask {
+    oid_t database_oid;
+    std::shared_ptr<storage::TileGroup> tile_group;
+  };
+
+  std::vector<TileGroupTask> tasks_;
+
+  std::atomic<size_t> next_task_;
+
+  // Keep tracking max oid for setting next_oid in manager
+  // For active processing after recovery
+  std::atomic<oid_t> max_oid_;
+
+  // Serializes the creation of tile groups during recovery
+  std::mutex recovery_mutex_;
+
+  const std::string PART_FILE_PREFIX = "peloton_parallel_checkpoint_";
+
+  const std::string PART_FILE_SUFFIX = ".part";
+
+  const std::string MANIFEST_FILE_SUFFIX = ".manifest";
+};
+
+}  // namespace logging
+}  // namespace peloton
@@ -75,6 +75,11 @@ class CheckpointManager {
 
   cid_t GetRecoveredCid();
 
+  // the cid of the index images that recovery loaded (INVALID_CID: none)
+  void SetIndexRecoveredCid(cid_t index_recovered_cid);
+
+  cid_t GetIndexRecoveredCid();
+
  private:
   CheckpointManager();
   ~CheckpointManager() {}
@@ -93,6 +98,8 @@ class CheckpointManager {
 
   cid_t recovered_cid_ = 0;
 
+  cid_t index_recovered_cid_ = INVALID_CID;
+
   // used for multiple checkpointer
   // std::atomic<unsigned int> status_change_count_;
 
@@ -66,9 +66,19 @@ class FrontendLogger : public Logger {
 
   size_t GetFsyncCount() const { return fsync_count; }
 
+  size_t GetLogBytes() const { return log_bytes; }
+
+  // number of times the backend loggers waited for an empty log buffer
+  size_t GetBufferWaitCount();
+
+  // time the backend loggers spent waiting for a buffer (in microseconds)
+  uint64_t GetBufferWaitTime();
+
   void SetTestMode(bool test_mode) { this->test_mode_ = test_mode; }
 
-  void ReplayLog(const char *, size_t len);
+  // Replay a batch of log records shipped by a leader. Returns false if the
+  // logger can not replay it
+  virtual bool ReplayLog(const char *data, size_t len);
 
   cid_t GetMaxFlushedCommitId();
 
@@ -76,6 +86,10 @@ class FrontendLogger : public Logger {
 
   void SetBackendLoggerLoggedCid(BackendLogger &bel);
 
+  // Same, for a commit whose commit id may be below the ones already seen. It
+  // is published above them, so that it waits for a flush that includes it
+  void SetBackendLoggerCommitCid(BackendLogger &bel);
+
   cid_t GetMaxDelimiterForRecovery() { return max_delimiter_for_recovery; }
 
   void SetIsDistinguishedLogger(bool flag) { is_distinguished_logger = flag; }
@@ -92,6 +106,7 @@ class FrontendLogger : public Logger {
     }
 
     fsync_count = 0;
+    log_bytes = 0;
     max_flushed_commit_id = 0;
     max_collected_commit_id = 0;
     max_seen_commit_id = 0;
@@ -128,6 +143,9 @@ class FrontendLogger : public Logger {
   // stats
   size_t fsync_count = 0;
 
+  // bytes written to the log files
+  size_t log_bytes = 0;
+
   cid_t max_flushed_commit_id = 0;
 
   cid_t max_collected_commit_id = 0;
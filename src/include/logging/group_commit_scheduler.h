@@ -0,0 +1,75 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// group_commit_scheduler.h
+//
+// Identification: src/include/logging/group_commit_scheduler.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+namespace peloton {
+namespace logging {
+
+//===--------------------------------------------------------------------===//
+// Group Commit Scheduler
+//===--------------------------------------------------------------------===//
+
+/**
+ * Decides when a frontend logger makes the log records it has written
+ * durable. While committing backends are waiting for the flush, the next
+ * fsync is issued as soon as the previous one has completed: the batch is
+ * whatever arrived during that fsync, so its size follows the load instead
+ * of a timer. Without waiters (e.g. asynchronous commit) records are
+ * batched until the oldest of them has waited for the latency target or
+ * the batch has reached the byte budget.
+ */
+class GroupCommitScheduler {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  GroupCommitScheduler(std::chrono::microseconds latency_target,
+                       size_t byte_budget);
+
+  // Account for log records that have been written but are not durable
+  void AddPending(size_t byte_count, size_t commit_count);
+
+  inline bool HasPending() const { return pending_; }
+
+  // Whether the pending records should be made durable now
+  bool ShouldFlush(size_t waiter_count) const;
+
+  // Account for a completed flush. Returns the number of commits that it
+  // has made durable
+  size_t Flushed();
+
+  inline size_t GetPendingBytes() const { return pending_bytes_; }
+
+  inline size_t GetPendingCommits() const { return pending_commits_; }
+
+ private:
+  // Longest time a record may wait for a flush without waiters
+  std::chrono::microseconds latency_target_;
+
+  // Number of pending bytes that triggers a flush without waiters
+  size_t byte_budget_;
+
+  bool pending_ = false;
+
+  size_t pending_bytes_ = 0;
+
+  size_t pending_commits_ = 0;
+
+  // When the oldest pending record has been written
+  Clock::time_point oldest_pending_;
+};
+
+}  // namespace logging
+}  // namespace peloton
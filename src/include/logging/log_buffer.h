@@ -67,6 +67,9 @@ class LogBuffer {
 
   inline BackendLogger *GetBackendLogger() { return backend_logger_; }
 
+  // number of transaction commit records in the buffer
+  inline size_t GetCommitCount() { return commit_count_; }
+
  private:
   // write data to the log buffer, return false if not enough space
   bool WriteData(char *data, size_t len);
@@ -84,6 +87,8 @@ class LogBuffer {
 
   // maximum log id seen so far
   cid_t max_log_id = 0;
+
+  size_t commit_count_ = 0;
 };
 
 }  // namespace logging
@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// log_buffer_ring.h
+//
+// Identification: src/include/logging/log_buffer_ring.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "logging/buffer_pool.h"
+#include "common/platform.h"
+
+namespace peloton {
+namespace logging {
+
+//===--------------------------------------------------------------------===//
+// Log Buffer Ring
+//===--------------------------------------------------------------------===//
+
+/**
+ * Bounded ring of log buffers between exactly one producer and one consumer.
+ *
+ * Each side only writes its own index, so neither side takes a lock. Put
+ * waits while the ring is full and Get waits while it is empty; the number
+ * of waits and the time spent waiting are kept as back-pressure metrics.
+ */
+class LogBufferRing : public BufferPool {
+ public:
+  LogBufferRing();
+
+  ~LogBufferRing();
+
+  // put a buffer into the ring (producer only). waits if the ring is full
+  bool Put(std::unique_ptr<LogBuffer>);
+
+  // get a buffer from the ring (consumer only). waits if the ring is empty
+  std::unique_ptr<LogBuffer> Get();
+
+  // get a buffer from the ring (consumer only) without waiting. returns
+  // nullptr if the ring is empty
+  std::unique_ptr<LogBuffer> TryGet();
+
+  // get the number of buffers in the ring
+  unsigned int GetSize();
+
+  // number of times the producer waited for a free slot
+  size_t GetFullWaitCount() const { return full_wait_count_.load(); }
+
+  // number of times the consumer waited for a buffer
+  size_t GetEmptyWaitCount() const { return empty_wait_count_.load(); }
+
+  // total time spent waiting on either side (in microseconds)
+  uint64_t GetWaitTime() const { return wait_time_us_.load(); }
+
+ private:
+  LogBuffer *buffers_[BUFFER_POOL_SIZE];
+
+  // next slot to write, only written by the producer
+  std::atomic<unsigned int> head_;
+
+  // keep the indexes on separate cache lines
+  char padding_[CACHELINE_SIZE];
+
+  // next slot to read, only written by the consumer
+  std::atomic<unsigned int> tail_;
+
+  // back-pressure metrics
+  std::atomic<size_t> full_wait_count_;
+
+  std::atomic<size_t> empty_wait_count_;
+
+  std::atomic<uint64_t> wait_time_us_;
+};
+
+}  // namespace logging
+}  // namespace peloton
@@ -0,0 +1,175 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// log_device.h
+//
+// Identification: src/include/logging/log_device.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <string>
+
+namespace peloton {
+namespace logging {
+
+//===--------------------------------------------------------------------===//
+// Log Device
+//===--------------------------------------------------------------------===//
+
+/**
+ * Asynchronous, append-only writer of a log segment.
+ *
+ * Appended bytes are staged in a block aligned buffer. Flush() hands the
+ * staged bytes to the device as one batch, which is written with O_DIRECT
+ * and made durable with a data sync in the background, and immediately
+ * returns a ticket for the batch. The caller keeps appending while up to
+ * MAX_IN_FLIGHT batches are being written, and learns through
+ * GetDurableTicket() which batches have become durable. Batches become
+ * durable in the order in which they have been flushed.
+ *
+ * Writes cover whole blocks, so the block at the end of a batch is padded
+ * with zeros and written again, completed, by the next batch. Segments are
+ * preallocated, which keeps the file size (and with it the inode) from
+ * changing on every data sync. Readers of a segment must therefore treat a
+ * zero byte where a record type is expected as the end of the segment.
+ *
+ * Create() returns an io_uring device if the kernel supports it and falls
+ * back to a device that writes with pwrite() and fdatasync() on a
+ * background thread otherwise.
+ */
+class LogDevice {
+ public:
+  // Alignment of O_DIRECT buffers, file offsets and write sizes
+  static constexpr size_t LOG_BLOCK_SIZE = 4096;
+
+  // Batches that may be written at the same time
+  static constexpr size_t MAX_IN_FLIGHT = 4;
+
+  static std::unique_ptr<LogDevice> Create();
+
+  virtual ~LogDevice();
+
+  // Create (or truncate) a segment and preallocate the given number of
+  // bytes for it
+  bool Open(const std::string &file_name, size_t preallocate_size);
+
+  // Make everything durable and close the segment
+  void Close();
+
+  inline bool IsOpen() const { return fd_ != -1; }
+
+  inline int GetFD() const { return fd_; }
+
+  // Bytes appended to the segment
+  inline size_t GetSize() const { return size_; }
+
+  // Stage bytes to be written at the end of the segment
+  void Append(const char *data, size_t size);
+
+  // Start making the staged bytes durable. Returns the ticket of the batch,
+  // which is the ticket of the previous batch if nothing has been staged
+  // since. Blocks only while MAX_IN_FLIGHT batches are being written
+  uint64_t Flush();
+
+  // Whether Flush() would start writing a batch without blocking
+  bool CanFlush();
+
+  // Ticket of the last batch that is known to be durable
+  uint64_t GetDurableTicket();
+
+  // Block until the batch with the given ticket is durable
+  void WaitForDurable(uint64_t ticket);
+
+  // Overwrite bytes that have already been appended (e.g. the segment
+  // header), and make them durable. Waits for all pending batches first
+  void Overwrite(size_t offset, const char *data, size_t size);
+
+  // Whether writes bypass the page cache
+  inline bool IsDirect() const { return direct_; }
+
+  virtual const char *GetName() const = 0;
+
+ protected:
+  struct AlignedDeleter {
+    void operator()(char *buffer) const { free(buffer); }
+  };
+
+  typedef std::unique_ptr<char, AlignedDeleter> AlignedBuffer;
+
+  /*
+   * struct Batch - Staged bytes that are written by a single request
+   */
+  struct Batch {
+    uint64_t ticket;
+
+    // Block aligned file offset and length of the write
+    size_t offset;
+    size_t length;
+
+    AlignedBuffer buffer;
+
+    // Set once the bytes are durable
+    std::atomic<bool> done{false};
+  };
+
+  LogDevice();
+
+  static AlignedBuffer AllocateAligned(size_t size);
+
+  // Write a batch in the calling thread
+  static bool WriteBatch(int fd, const Batch &batch);
+
+  static bool SyncData(int fd);
+
+  // Start writing a batch
+  virtual void SubmitBatch(Batch *batch) = 0;
+
+  // Mark completed batches as done. Waits for at least one batch to
+  // complete if wait is set
+  virtual void ReapBatches(bool wait) = 0;
+
+  int fd_ = -1;
+
+  bool direct_ = false;
+
+ private:
+  // Pop the batches that are done and advance the durable ticket
+  void RetireBatches();
+
+  // Make sure the staging buffer can hold the given number of bytes
+  void ReserveStaging(size_t size);
+
+  size_t size_ = 0;
+
+  // Block aligned file offset of the staging buffer. The buffer starts
+  // with the unfinished block at the end of the previous batch
+  size_t staging_offset_ = 0;
+
+  size_t staging_length_ = 0;
+
+  size_t staging_capacity_ = 0;
+
+  AlignedBuffer staging_;
+
+  // Whether bytes have been staged since the last batch
+  bool staging_dirty_ = false;
+
+  uint64_t next_ticket_ = 1;
+
+  uint64_t durable_ticket_ = 0;
+
+  std::deque<std::unique_ptr<Batch>> in_flight_;
+};
+
+}  // namespace logging
+}  // namespace peloton
@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <map>
 #include <mutex>
 #include <vector>
@@ -107,6 +109,22 @@ class LogManager {
   // wait for the flush of a frontend logger (for worker thread)
   void WaitForFlush(cid_t cid);
 
+  // Let the commits of the calling thread return before their log is
+  // flushed. The caller must hold back the reply until the commit is durable
+  void SetDeferFlushWait(bool defer);
+
+  // Largest commit id of the calling thread that was not waited for, or
+  // INVALID_CID. Also stops deferring the waits of the thread
+  cid_t TakeDeferredCommitId();
+
+  // Run the callback on a frontend logger once the commit is flushed. Returns
+  // false, without running it, if the commit is already flushed
+  bool NotifyOnFlush(cid_t cid, std::function<void()> callback);
+
+  // number of worker threads blocked in WaitForFlush, and of commits waiting
+  // for a flush callback
+  inline size_t GetFlushWaiterCount() const { return flush_waiter_count; }
+
   // get the current persistent flushed commit
   cid_t GetPersistentFlushedCommitId();
 
@@ -168,10 +186,19 @@ class LogManager {
   // remove all frontend loggers (used for testing)
   void DropFrontendLoggers();
 
+  // replay a batch of log records that was shipped by a leader (follower
+  // only). returns false if the batch could not be replayed
+  bool ReplayLog(const char *data, size_t len);
+
   // perpare to log must be called before a commit id is generated for a
   // transaction
   void PrepareLogging();
 
+  // prepare to log the commit of a transaction on the calling thread. unlike
+  // PrepareLogging it does not have to be called on the thread that began
+  // the transaction, nor before its commit id was generated
+  void PrepareCommit();
+
   // log the beginning of a commited transaction
   void LogBeginTransaction(cid_t commit_id);
 
@@ -214,6 +241,15 @@ class LogManager {
   // set the maximum commit id which has been persisted to disk
   cid_t GetGlobalMaxFlushedCommitId();
 
+  // bytes that the frontend loggers have written to their log files
+  size_t GetLogBytes();
+
+  // back-pressure on the backend loggers: number of times and time (in
+  // microseconds) they waited for an empty log buffer
+  size_t GetLogBufferWaitCount();
+
+  uint64_t GetLogBufferWaitTime();
+
   // get the list of frontend loggers
   std::vector<std::unique_ptr<FrontendLogger>> &GetFrontendLoggersList() {
     return frontend_loggers;
@@ -240,6 +276,12 @@ class LogManager {
 
   inline bool GetNoWrite() const { return no_write_; }
 
+  // Number of frontend loggers, each of which writes and recovers its own
+  // log stream
+  inline unsigned int GetNumFrontendLoggers() const {
+    return num_frontend_loggers_;
+  }
+
  private:
   LogManager();
   ~LogManager();
@@ -283,6 +325,13 @@ class LogManager {
   std::mutex flush_notify_mutex;
   std::condition_variable flush_notify_cv;
 
+  // Lets frontend loggers flush as soon as a commit is waiting
+  std::atomic<size_t> flush_waiter_count{0};
+
+  // Callbacks of deferred commits by commit id, protected by
+  // flush_notify_mutex
+  std::multimap<cid_t, std::function<void()>> flush_callbacks;
+
   // To update catalog and txn managers
   std::mutex update_managers_mutex;
 
@@ -61,6 +61,11 @@ class LogRecord {
 
   cid_t GetTransactionId() const { return cid; }
 
+  // Whether the record commits its transaction
+  virtual bool IsCommit() const {
+    return log_record_type == LOGRECORD_TYPE_TRANSACTION_COMMIT;
+  }
+
   virtual bool Serialize(CopySerializeOutput &output) = 0;
 
   char *GetMessage(void) const { return message; }
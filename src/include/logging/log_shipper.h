@@ -0,0 +1,172 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// log_shipper.h
+//
+// Identification: src/include/logging/log_shipper.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "type/types.h"
+
+namespace peloton {
+
+namespace networking {
+class RpcChannel;
+class PelotonLoggingService_Stub;
+}
+
+namespace logging {
+
+//===--------------------------------------------------------------------===//
+// Log Shipper
+//===--------------------------------------------------------------------===//
+
+/**
+ * Streams the log batches that the WAL frontend logger writes to a follower
+ * process, which replays them through the recovery code path.
+ *
+ * With synchronous replication a batch is only made durable (and its
+ * transactions acknowledged) once the follower has applied it. With
+ * semi-synchronous replication the follower may be one batch behind, and
+ * with asynchronous replication the leader does not wait at all.
+ *
+ * The follower acknowledges through the RPC server of this process, so it
+ * must be running before shipping starts. A follower that does not
+ * acknowledge a batch in time is no longer waited for until it has caught up
+ * with every shipped batch, so a hung follower does not throttle the leader.
+ */
+class LogShipper {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  LogShipper(const LogShipper &) = delete;
+  LogShipper &operator=(const LogShipper &) = delete;
+  LogShipper(LogShipper &&) = delete;
+  LogShipper &operator=(LogShipper &&) = delete;
+
+  // global singleton
+  static LogShipper &GetInstance(void);
+
+  // Start shipping to the follower at the given address (ip:port). Returns
+  // false if there is no RPC server to receive the acknowledgements
+  bool Start(const std::string &follower_address,
+             ReplicationType replication_type);
+
+  void Stop();
+
+  inline bool IsShipping() const { return shipping_; }
+
+  inline ReplicationType GetReplicationType() const {
+    return replication_type_;
+  }
+
+  // Is the leader not waiting for a follower that fell behind?
+  bool IsDegraded();
+
+  // In test mode the batches are tracked but not sent, and no RPC server is
+  // needed to start shipping
+  void SetTestMode(bool test_mode) { test_mode_ = test_mode; }
+
+  // Ship a batch of log records. Waits for the follower as the replication
+  // type requires (frontend logger only)
+  void ShipLogBatch(const char *data, size_t size);
+
+  // The follower has applied the batch with the given sequence number
+  void Acknowledge(uint64_t sequence_number);
+
+  // Wait until the follower has applied all shipped batches, or the timeout.
+  // Returns false on the timeout
+  bool WaitForFollower();
+
+  //===--------------------------------------------------------------------===//
+  // Statistics
+  //===--------------------------------------------------------------------===//
+
+  size_t GetShippedBatches() const { return shipped_batches_.load(); }
+
+  size_t GetShippedBytes() const { return shipped_bytes_.load(); }
+
+  size_t GetAcknowledgedBatches();
+
+  // number of batches that the follower did not acknowledge in time
+  size_t GetTimeoutCount() const { return timeout_count_.load(); }
+
+  // time from shipping a batch until it is applied (in microseconds)
+  uint64_t GetAverageLag();
+
+  uint64_t GetMaxLag();
+
+  void ResetStatistics();
+
+ private:
+  LogShipper();
+
+  ~LogShipper();
+
+  // Block until the follower has applied the given batch, or the timeout.
+  // Returns false on the timeout
+  bool WaitForAcknowledgement(uint64_t sequence_number);
+
+  // Stop waiting for the follower until it acknowledges the last batch
+  void Degrade();
+
+  std::unique_ptr<networking::RpcChannel> channel_;
+
+  std::unique_ptr<networking::PelotonLoggingService_Stub> stub_;
+
+  std::atomic<bool> shipping_;
+
+  ReplicationType replication_type_ = ASYNC_REPLICATION;
+
+  // protects the sequence numbers and the ship times
+  std::mutex mutex_;
+
+  std::condition_variable acknowledged_cv_;
+
+  uint64_t last_shipped_ = 0;
+
+  uint64_t last_acknowledged_ = 0;
+
+  // set when the follower timed out, until it acknowledges last_shipped_
+  bool degraded_ = false;
+
+  bool test_mode_ = false;
+
+  // when the batches that are not acknowledged yet were shipped
+  std::map<uint64_t, Clock::time_point> ship_times_;
+
+  std::atomic<size_t> shipped_batches_;
+
+  std::atomic<size_t> shipped_bytes_;
+
+  std::atomic<size_t> timeout_count_;
+
+  size_t acknowledged_batches_ = 0;
+
+  uint64_t total_lag_us_ = 0;
+
+  uint64_t max_lag_us_ = 0;
+
+  // longest wait for an acknowledgement before the leader moves on
+  static constexpr std::chrono::milliseconds ACK_TIMEOUT{1000};
+
+  // most batches that are tracked while the follower falls behind
+  static constexpr size_t MAX_UNACKNOWLEDGED_BATCHES = 64 * 1024;
+};
+
+}  // namespace logging
+}  // namespace peloton
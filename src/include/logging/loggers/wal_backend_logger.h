@@ -15,6 +15,9 @@
 
 #include "type/types.h"
 #include "logging/backend_logger.h"
+#include "logging/records/tuple_batch_record.h"
+
+extern bool peloton_wal_compact_format;
 
 namespace peloton {
 namespace logging {
@@ -32,11 +35,21 @@ class WriteAheadBackendLogger : public BackendLogger {
 
   WriteAheadBackendLogger();
 
+  // Batches the tuple records of a transaction in the compact format
+  void Log(LogRecord *record);
+
   LogRecord *GetTupleRecord(LogRecordType log_record_type, txn_id_t txn_id,
                             oid_t table_oid, oid_t db_oid,
                             ItemPointer insert_location,
                             ItemPointer delete_location,
                             const void *data = nullptr);
+
+  // Tuple records of a batch that are flushed before the transaction commits
+  static constexpr size_t MAX_BATCH_SIZE = 64 * 1024;
+
+ private:
+  // tuple records of the current transaction
+  TupleBatchRecord batch_record;
 };
 
 }  // namespace logging
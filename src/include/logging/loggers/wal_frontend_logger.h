@@ -14,17 +14,30 @@
 #pragma once
 
 #include "logging/frontend_logger.h"
+#include "logging/group_commit_scheduler.h"
+#include "logging/log_device.h"
 #include "logging/records/tuple_record.h"
 #include "logging/log_file.h"
 #include "executor/executors.h"
 
 #include <dirent.h>
+#include <deque>
 #include <vector>
 #include <set>
 #include <chrono>
 
 extern int peloton_flush_frequency_micros;
 
+extern size_t peloton_group_commit_byte_budget;
+
+extern bool peloton_wal_async_io;
+
+extern size_t peloton_recovery_thread_count;
+
+extern bool peloton_wal_compact_format;
+
+extern bool peloton_wal_compression;
+
 namespace peloton {
 
 namespace concurrency {
@@ -60,6 +73,9 @@ class WriteAheadFrontendLogger : public FrontendLogger {
 
   void DoRecovery(void);
 
+  // Replay a batch of log records shipped by the leader (follower only)
+  bool ReplayLog(const char *data, size_t len);
+
   void RecoverIndex();
 
   void StartTransactionRecovery(cid_t commit_id);
@@ -107,12 +123,45 @@ class WriteAheadFrontendLogger : public FrontendLogger {
  private:
   std::string GetLogFileName(void);
 
-  bool RecoverTableIndexHelper(storage::DataTable *target_table,
-                               cid_t start_cid);
+  // Insert the visible tuples of a tile group into the indexes of its table,
+  // skipping the tuples that the index images (image_cid) already hold.
+  // Returns the number of tuples
+  size_t RecoverTileGroupIndex(storage::DataTable *target_table,
+                               oid_t tile_group_offset, cid_t start_cid,
+                               cid_t image_cid);
+
+  // Replay the log records from the current file handle. Returns the number
+  // of tuple records
+  int ReplayLogRecords(cid_t start_commit_id, cid_t max_cid_for_recovery);
+
+  // Apply the records of the committed transactions to the tables
+  void ApplyCommittedRecords();
 
   void InsertIndexEntry(storage::Tuple *tuple, storage::DataTable *table,
                         ItemPointer target_location);
 
+  void WriteToLogFile(const char *data, size_t size);
+
+  // Ship the log records written since the last batch to the follower
+  void ShipLogBatch();
+
+  // Write the collected log buffers as one compressed block, or as they are
+  // if that does not pay off
+  void WriteCompressedLogBuffers();
+
+  // Replay the frame of a tuple batch or a compressed block. Returns false
+  // if the frame is malformed
+  bool ReplayCompactRecords(LogRecordType record_type,
+                            const std::vector<char> &frame, cid_t start_cid,
+                            cid_t max_cid_for_recovery);
+
+  bool ReplayTupleBatch(const char *data, size_t size, cid_t start_cid,
+                        cid_t max_cid_for_recovery);
+
+  // Advance the max flushed commit id over the batches that the log device
+  // has made durable. Returns true if it has advanced
+  bool CompleteFlushes(bool wait);
+
   //===--------------------------------------------------------------------===//
   // Member Variables
   //===--------------------------------------------------------------------===//
@@ -120,9 +169,32 @@ class WriteAheadFrontendLogger : public FrontendLogger {
   // File pointer and descriptor
   FileHandle cur_file_handle;
 
+  // Writes the log files if asynchronous I/O is enabled, otherwise they are
+  // written through cur_file_handle.file
+  std::unique_ptr<LogDevice> log_device_;
+
+  // Batches handed to the log device that are not durable yet
+  struct PendingFlush {
+    uint64_t ticket;
+    cid_t commit_id;
+    size_t commit_count;
+  };
+
+  std::deque<PendingFlush> pending_flushes_;
+
   // Txn table during recovery
   std::map<txn_id_t, std::vector<TupleRecord *>> recovery_txn_table;
 
+  // Records of the committed transactions that have not been applied yet.
+  // They are applied in batches that end at an epoch boundary
+  std::vector<TupleRecord *> committed_records_;
+
+  // Committed records that are buffered before they are applied
+  static constexpr size_t RECOVERY_BATCH_SIZE = 64 * 1024;
+
+  // Committed records that are worth a recovery thread
+  static constexpr size_t MIN_RECORDS_PER_RECOVERY_THREAD = 1024;
+
   // Keep tracking max oid for setting next_oid in manager
   // For active processing after recovery
   oid_t max_oid = 0;
@@ -152,15 +224,29 @@ class WriteAheadFrontendLogger : public FrontendLogger {
 
   CopySerializeOutput output_buffer;
 
+  // Log records that are compressed as one block
+  std::vector<char> uncompressed_buffer_;
+
+  CopySerializeOutput compressed_buffer_;
+
+  // Frame of a compact record during recovery
+  std::vector<char> frame_buffer_;
+
+  // Log records written since the last batch that was shipped
+  std::vector<char> replication_buffer_;
+
+  // Whether the file handle is a shipped log batch instead of a log file
+  bool replaying_log_buffer_ = false;
+
   int logger_id;
 
   cid_t max_delimiter_file = 0;
 
   bool should_create_new_file = false;
 
-  TimePoint last_flush = Clock::now();
-
-  Micros flush_frequency{peloton_flush_frequency_micros};
+  // Decides when the written log records are fsynced
+  GroupCommitScheduler group_commit{Micros(peloton_flush_frequency_micros),
+                                    peloton_group_commit_byte_budget};
 };
 
 }  // namespace logging
@@ -14,10 +14,12 @@
 #pragma once
 
 #include <unordered_set>
+#include <vector>
 
 #include "type/types.h"
 #include "logging/backend_logger.h"
 #include "concurrency/transaction_manager_factory.h"
+#include "storage/storage_manager.h"
 
 namespace peloton {
 namespace logging {
@@ -36,6 +38,8 @@ class WriteBehindBackendLogger : public BackendLogger {
 
   WriteBehindBackendLogger() {
     logging_type = LOGGING_TYPE_NVM_WBL;
+    track_dirty_ranges_ =
+        storage::StorageManager::GetInstance().IsEmulatingNVM();
   }
 
   void Log(LogRecord *record);
@@ -49,10 +53,31 @@ class WriteBehindBackendLogger : public BackendLogger {
   void CollectRecordsAndClear(
       std::vector<std::unique_ptr<LogRecord>> &frontend_queue);
 
+  // Move the dirty ranges of the committed transactions into the given
+  // vector. Called by the frontend logger at group commit
+  void CollectDirtyRanges(std::vector<storage::DirtyRange> &ranges);
+
+  bool IsTrackingDirtyRanges() const { return track_dirty_ranges_; }
+
  private:
   void SyncDataForCommit();
 
+  // Add the ranges of a tuple to the dirty ranges of the transaction
+  void AddDirtyRanges(const ItemPointer &location);
+
   std::unordered_set<oid_t> tile_groups_to_sync_;
+
+  // Instead of syncing the modified tile groups at commit, track the
+  // modified cache lines and leave them to the group commit
+  bool track_dirty_ranges_ = false;
+
+  // dirty ranges of the current transaction
+  std::vector<storage::DirtyRange> dirty_ranges_;
+
+  // dirty ranges of the committed transactions, drained by the frontend
+  std::vector<storage::DirtyRange> committed_dirty_ranges_;
+
+  Spinlock dirty_ranges_lock_;
 };
 
 }  // namespace logging
@@ -14,11 +14,13 @@
 #pragma once
 
 #include <set>
+#include <vector>
 
 #include "logging/frontend_logger.h"
 #include "logging/records/transaction_record.h"
 #include "logging/records/tuple_record.h"
 #include "logging/records/log_record_pool.h"
+#include "storage/storage_manager.h"
 
 namespace peloton {
 
@@ -40,6 +42,10 @@ class WriteBehindFrontendLogger : public FrontendLogger {
 
   void FlushLogRecords(void);
 
+  // Sync the dirty ranges of the transactions that committed since the last
+  // group commit (NVM emulation)
+  void SyncDirtyRanges(void);
+
   //===--------------------------------------------------------------------===//
   // Recovery
   //===--------------------------------------------------------------------===//
@@ -73,6 +79,9 @@ class WriteBehindFrontendLogger : public FrontendLogger {
 
   // Keep tracking latest cid for setting next commit in txn manager
   cid_t max_commit_id_seen = INVALID_CID;
+
+  // Dirty ranges of the current group commit
+  std::vector<storage::DirtyRange> dirty_ranges_;
 };
 
 }  // namespace logging
@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "common/logger.h"
 #include "logging/records/transaction_record.h"
 #include "logging/records/tuple_record.h"
@@ -61,6 +63,28 @@ class LoggingUtil {
 
   static void SkipTupleRecordBody(FileHandle &file_handle);
 
+  // Read a varint, e.g. the commit id of a compact delimiter
+  static bool ReadVarint(FileHandle &file_handle, uint64_t &value);
+
+  // Read the bytes of a frame that follow its length
+  static bool ReadFrame(FileHandle &file_handle, std::vector<char> &frame);
+
+  //===--------------------------------------------------------------------===//
+  // Log Compression
+  //===--------------------------------------------------------------------===//
+
+  // Whether peloton has been built with LZ4
+  static bool IsCompressionAvailable();
+
+  // Serialize the given log records as a compressed block. Returns false if
+  // the block would not be smaller than the records
+  static bool CompressLogBlock(const char *data, size_t size,
+                               CopySerializeOutput &output);
+
+  // Decompress the frame of a compressed block
+  static bool DecompressLogBlock(const char *frame, size_t frame_size,
+                                 std::vector<char> &data);
+
   static int GetFileSizeFromFileName(const char *);
 
   static bool CreateDirectory(const char *dir_name, int mode);
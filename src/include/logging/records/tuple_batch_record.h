@@ -0,0 +1,115 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// tuple_batch_record.h
+//
+// Identification: src/include/logging/records/tuple_batch_record.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+/* Compact WAL format
+ *
+ *     Tuple Batch Record :
+ *       - LogRecordType         : enum
+ *       - Frame length          : int
+ *       - Commit Id             : varint
+ *       - Commit flag           : byte
+ *       - Record count          : varint
+ *       - Tuple Records
+ *
+ *     Tuple Record (in a batch) :
+ *       - LogRecordType         : enum
+ *       - Length                : varint
+ *       - Database Oid          : varint
+ *       - Table Oid             : varint
+ *       - Inserted Location     : varint block, varint offset (insert, update)
+ *       - Deleted Location      : varint block, varint offset (update, delete)
+ *       - Changed columns       : bitmap (update)
+ *       - Data                  : values of all columns (insert) or of the
+ *                                 changed columns (update)
+ *
+ * A batch holds the tuple records of one transaction, which share the commit
+ * id. It begins the transaction if it has not been begun by an earlier batch,
+ * and commits it if the commit flag is set. So a transaction that fits into
+ * one batch takes a single record instead of a begin record, one record per
+ * tuple and a commit record.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "logging/log_record.h"
+#include "logging/records/tuple_record.h"
+#include "common/printable.h"
+#include "type/abstract_pool.h"
+#include "type/serializeio.h"
+
+namespace peloton {
+namespace logging {
+
+//===--------------------------------------------------------------------===//
+// TupleBatchRecord
+//===--------------------------------------------------------------------===//
+
+class TupleBatchRecord : public LogRecord, Printable {
+ public:
+  TupleBatchRecord() : LogRecord(LOGRECORD_TYPE_WAL_TUPLE_BATCH, INVALID_CID) {}
+
+  ~TupleBatchRecord() {
+    // Clean up the message
+    delete[] message;
+  }
+
+  // Start an empty batch for the given transaction
+  void Reset(cid_t commit_id);
+
+  // Encode a tuple record of the transaction
+  void AddTupleRecord(TupleRecord &record);
+
+  // Make the batch commit the transaction
+  void SetCommit() { commit = true; }
+
+  bool IsCommit() const override { return commit; }
+
+  size_t GetRecordCount() const { return record_count; }
+
+  // Bytes of the encoded tuple records
+  size_t GetBodySize() const { return body.Size(); }
+
+  //===--------------------------------------------------------------------===//
+  // Serial/Deserialization
+  //===--------------------------------------------------------------------===//
+
+  bool Serialize(CopySerializeOutput &output);
+
+  // Decode a batch from the bytes after its frame length. Records of tables
+  // that do not exist are skipped. Returns false if the batch is malformed
+  static bool Deserialize(const char *data, size_t size, cid_t &commit_id,
+                          bool &commit, std::vector<TupleRecord *> &records,
+                          type::AbstractPool *pool);
+
+  // Get a string representation for debugging
+  const std::string GetInfo() const;
+
+ private:
+  //===--------------------------------------------------------------------===//
+  // Member Variables
+  //===--------------------------------------------------------------------===//
+
+  // encoded tuple records
+  CopySerializeOutput body;
+
+  // encoding of the current tuple record
+  CopySerializeOutput record_buffer;
+
+  size_t record_count = 0;
+
+  bool commit = false;
+};
+
+}  // namespace logging
+}  // namespace peloton
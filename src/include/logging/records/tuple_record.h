@@ -13,6 +13,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "logging/log_record.h"
 #include "storage/tuple.h"
 #include "type/serializer.h"
@@ -78,10 +80,24 @@ class TupleRecord : public LogRecord, Printable {
 
   ItemPointer GetDeleteLocation(void) const { return delete_location; }
 
+  // Tuple data to serialize
+  const void *GetData() const { return data; }
+
   void SetTuple(storage::Tuple *tuple);
 
   storage::Tuple *GetTuple();
 
+  // Columns that an update has changed. Empty if the record carries all the
+  // columns of the new version
+  void SetChangedColumns(const std::vector<bool> &changed_columns) {
+    this->changed_columns = changed_columns;
+  }
+
+  const std::vector<bool> &GetChangedColumns() const { return changed_columns; }
+
+  // Whether the unchanged columns must be taken from the old version
+  bool IsDelta() const { return changed_columns.empty() == false; }
+
   static size_t GetTupleRecordSize(void);
 
   // Get a string representation for debugging
@@ -109,6 +125,9 @@ class TupleRecord : public LogRecord, Printable {
 
   // database id
   oid_t db_oid = DEFAULT_DB_ID;
+
+  // changed columns of an update
+  std::vector<bool> changed_columns;
 };
 
 }  // namespace logging
@@ -0,0 +1,41 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// logging_service.h
+//
+// Identification: src/include/networking/logging_service.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "peloton/proto/logging_service.pb.h"
+
+//===--------------------------------------------------------------------===//
+// Implements PelotonLoggingService
+//===--------------------------------------------------------------------===//
+
+namespace peloton {
+namespace networking {
+
+/**
+ * Log shipping between a leader and its follower.
+ *
+ * On the follower, a request carries a batch of log records that the WAL
+ * frontend logger of the leader has written. It is replayed through the
+ * recovery code path and acknowledged with its sequence number. On the
+ * leader, the acknowledgement is handed to the log shipper.
+ */
+class LoggingService : public PelotonLoggingService {
+ public:
+  virtual void LogRecordReplay(::google::protobuf::RpcController* controller,
+                               const LogRecordReplayRequest* request,
+                               LogRecordReplayResponse* response,
+                               ::google::protobuf::Closure* done);
+};
+
+}  // namespace networking
+}  // namespace peloton
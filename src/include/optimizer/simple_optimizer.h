@@ -88,6 +88,13 @@ class SimpleOptimizer : public AbstractOptimizer {
       storage::DataTable *target_table, std::vector<oid_t> &column_ids,
       expression::AbstractExpression *predicate, bool for_update);
 
+  // create an index scan plan that walks an index in the order of the sort
+  // column, for ORDER BY + LIMIT without a predicate. Returns nullptr if no
+  // index leads with the sort column
+  static std::unique_ptr<planner::AbstractScan> CreateOrderedIndexScanPlan(
+      storage::DataTable *target_table, std::vector<oid_t> &column_ids,
+      const std::string &sort_column, bool for_update);
+
   // create a copy plan for a copy statement
   static std::unique_ptr<planner::AbstractPlan> CreateCopyPlan(
       parser::CopyStatement *copy_stmt);
@@ -97,9 +104,14 @@ class SimpleOptimizer : public AbstractOptimizer {
   static std::unique_ptr<planner::AbstractPlan> CreateJoinPlan(
       parser::SelectStatement *select_stmt);
 
-  static void SetIndexScanFlag(planner::AbstractPlan *select_plan,
-                               uint64_t limit, uint64_t offset,
-                               bool descent = false);
+  // Push a LIMIT into the index scan below the select plan. With ORDER BY,
+  // the limit is only pushed if the index returns tuples sorted on the
+  // sort column, i.e. all key columns before it are fixed by equalities.
+  // The scan direction follows the sort order.
+  static void SetIndexScanFlag(
+      planner::AbstractPlan *select_plan, uint64_t limit, uint64_t offset,
+      ScanDirectionType scan_direction = SCAN_DIRECTION_TYPE_FORWARD,
+      const std::string *sort_column = nullptr);
 };
 }  // namespace optimizer
 }  // namespace peloton
@@ -172,6 +172,11 @@ struct CreateStatement : TableRefStatement {
       delete index_attrs;
     }
 
+    if (include_attrs) {
+      for (auto attr : *include_attrs) free(attr);
+      delete include_attrs;
+    }
+
     free(index_name);
     free(database_name);
   }
@@ -185,6 +190,8 @@ struct CreateStatement : TableRefStatement {
 
   std::vector<ColumnDefinition*>* columns;
   std::vector<char*>* index_attrs = nullptr;
+  // Columns stored in the index in addition to the key (INCLUDE clause)
+  std::vector<char*>* include_attrs = nullptr;
 
   IndexType index_type;
 
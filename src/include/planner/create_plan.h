@@ -66,6 +66,10 @@ class CreatePlan : public AbstractPlan {
 
   std::vector<std::string> GetIndexAttributes() const { return index_attrs; }
 
+  std::vector<std::string> GetIncludeAttributes() const {
+    return include_attrs;
+  }
+
  private:
   // Target Table
   storage::DataTable *target_table_ = nullptr;
@@ -82,6 +86,9 @@ class CreatePlan : public AbstractPlan {
   // Index attributes
   std::vector<std::string> index_attrs;
 
+  // Non-key attributes stored in the index
+  std::vector<std::string> include_attrs;
+
   // Check to either Create Table or INDEX
   CreateType create_type;
 
@@ -152,7 +152,9 @@ class IndexScanPlan : public AbstractScan {
 
   inline int64_t GetLimitOffset() const { return limit_offset_; }
 
-  inline bool GetDescend() const { return descend_; }
+  inline ScanDirectionType GetScanDirection() const { return scan_direction_; }
+
+  inline bool IsIndexOnly() const { return index_only_; }
 
   const std::string GetInfo() const { return "IndexScan"; }
 
@@ -162,7 +164,11 @@ class IndexScanPlan : public AbstractScan {
 
   void SetLimitOffset(int64_t offset) { limit_offset_ = offset; }
 
-  void SetDescend(bool descend) { descend_ = descend; }
+  void SetScanDirection(ScanDirectionType scan_direction) {
+    scan_direction_ = scan_direction;
+  }
+
+  void SetIndexOnly(bool index_only) { index_only_ = index_only; }
 
   void SetParameterValues(std::vector<type::Value> *values);
 
@@ -176,6 +182,11 @@ class IndexScanPlan : public AbstractScan {
                        new_runtime_keys);
     IndexScanPlan *new_plan = new IndexScanPlan(
         GetTable(), GetPredicate()->Copy(), GetColumnIds(), desc, false);
+    new_plan->SetIndexOnly(index_only_);
+    new_plan->SetLimit(limit_);
+    new_plan->SetLimitNumber(limit_number_);
+    new_plan->SetLimitOffset(limit_offset_);
+    new_plan->SetScanDirection(scan_direction_);
     return std::unique_ptr<AbstractPlan>(new_plan);
   }
 
@@ -230,8 +241,12 @@ class IndexScanPlan : public AbstractScan {
   // offset means from which point
   int64_t limit_offset_ = 0;
 
-  // whether order by is descending
-  bool descend_ = false;
+  // the key order in which the index is walked
+  ScanDirectionType scan_direction_ = SCAN_DIRECTION_TYPE_FORWARD;
+
+  // whether the output can be served from the covering index entries
+  // without visiting the table
+  bool index_only_ = false;
 };
 
 }  // namespace planner
@@ -61,10 +61,21 @@ class InsertPlan : public AbstractPlan {
   // Get a varlen pool (will construct the pool only if needed)
   type::AbstractPool *GetPlanPool();
 
+  // Append a raw tuple, its varlen values should live in the plan pool
+  void AddTuple(std::unique_ptr<storage::Tuple> &&tuple);
+
   inline PlanNodeType GetPlanNodeType() const { return PLAN_NODE_TYPE_INSERT; }
 
   void SetParameterValues(std::vector<type::Value> *values);
 
+  // Whether the plan inserts a single tuple of parameters, so that several
+  // bindings of it can be inserted at once
+  bool IsBatchable() const;
+
+  // Build an insert of one tuple per row of parameter values
+  std::unique_ptr<InsertPlan> BindBatch(
+      const std::vector<std::vector<type::Value>> &param_rows) const;
+
   storage::DataTable *GetTable() const { return target_table_; }
 
   const planner::ProjectInfo *GetProjectInfo() const {
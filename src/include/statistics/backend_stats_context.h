@@ -21,6 +21,7 @@
 #include "statistics/table_metric.h"
 #include "statistics/index_metric.h"
 #include "statistics/latency_metric.h"
+#include "statistics/histogram_metric.h"
 #include "statistics/database_metric.h"
 #include "statistics/query_metric.h"
 #include "container/cuckoo_map.h"
@@ -80,6 +81,16 @@ class BackendStatsContext {
   // Returns the latency metric
   LatencyMetric& GetTxnLatencyMetric();
 
+  // Returns the histogram of the time commits wait until they are durable
+  HistogramMetric& GetCommitLatencyHistogram() {
+    return commit_latency_histogram_;
+  }
+
+  // Returns the histogram of the number of commits made durable per fsync
+  HistogramMetric& GetGroupCommitSizeHistogram() {
+    return group_commit_size_histogram_;
+  }
+
   // Increment the read stat for given tile group
   void IncrementTableReads(oid_t tile_group_id);
 
@@ -174,6 +185,12 @@ class BackendStatsContext {
   // Latencies recorded by this worker
   LatencyMetric txn_latencies_;
 
+  // Durable commit latencies recorded by this worker
+  HistogramMetric commit_latency_histogram_;
+
+  // Group commit sizes recorded by this frontend logger
+  HistogramMetric group_commit_size_histogram_;
+
   // Whether this context is registered to the global aggregator
   bool is_registered_to_aggregator_;
 
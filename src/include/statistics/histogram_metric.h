@@ -0,0 +1,100 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// histogram_metric.h
+//
+// Identification: src/statistics/histogram_metric.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <sstream>
+
+#include "type/types.h"
+#include "statistics/abstract_metric.h"
+
+namespace peloton {
+namespace stats {
+
+/**
+ * Metric that counts values in power of two buckets, e.g. commit
+ * latencies or group commit batch sizes. Bucket 0 holds the value zero and
+ * bucket i > 0 holds the values in [2^(i-1), 2^i). Unlike the latency
+ * metric it keeps no history, so it covers every recorded value at a fixed
+ * cost. Buckets are atomic so that the aggregator can read them while the
+ * owning worker keeps recording.
+ */
+class HistogramMetric : public AbstractMetric {
+ public:
+  static constexpr size_t BUCKET_COUNT = 48;
+
+  HistogramMetric(MetricType type, const std::string &name,
+                  const std::string &unit);
+
+  //===--------------------------------------------------------------------===//
+  // ACCESSORS
+  //===--------------------------------------------------------------------===//
+
+  inline void Record(uint64_t value) {
+    buckets_[GetBucket(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  inline uint64_t GetCount() const { return count_.load(); }
+
+  inline uint64_t GetSum() const { return sum_.load(); }
+
+  inline uint64_t GetBucketCount(size_t bucket) const {
+    return buckets_[bucket].load();
+  }
+
+  // Returns the exclusive upper bound of the bucket the given percentile
+  // (0 to 100) falls into, or zero if nothing has been recorded
+  uint64_t GetPercentile(double percentile) const;
+
+  //===--------------------------------------------------------------------===//
+  // HELPER METHODS
+  //===--------------------------------------------------------------------===//
+
+  void Reset();
+
+  // Adds the counts of the source histogram to this histogram
+  void Aggregate(AbstractMetric &source);
+
+  // Returns a string representation of this histogram
+  const std::string GetInfo() const;
+
+  static inline size_t GetBucket(uint64_t value) {
+    size_t bucket = 0;
+    while (value != 0 && bucket < BUCKET_COUNT - 1) {
+      value >>= 1;
+      bucket++;
+    }
+    return bucket;
+  }
+
+ private:
+  //===--------------------------------------------------------------------===//
+  // MEMBERS
+  //===--------------------------------------------------------------------===//
+
+  std::string name_;
+
+  std::string unit_;
+
+  std::atomic<uint64_t> buckets_[BUCKET_COUNT];
+
+  // Number and sum of the recorded values
+  std::atomic<uint64_t> count_;
+  std::atomic<uint64_t> sum_;
+};
+
+}  // namespace stats
+}  // namespace peloton
@@ -120,6 +120,16 @@ class DataTable : public AbstractTable {
   // aggregate_executor.
   ItemPointer InsertTuple(const Tuple *tuple);
 
+  // insert a batch of tuples of the transaction. slots are claimed in ranges
+  // and every index is filled for the whole batch before moving on to the
+  // next one. the tuples are also registered with the transaction manager
+  // before they are indexed, so that duplicate keys within the batch are
+  // detected; callers must not call PerformInsert on them again.
+  // returns false if a constraint is violated.
+  bool InsertTuples(const std::vector<const Tuple *> &tuples,
+                    concurrency::Transaction *transaction,
+                    std::vector<ItemPointer> &locations);
+
   //===--------------------------------------------------------------------===//
   // TILE GROUP
   //===--------------------------------------------------------------------===//
@@ -139,6 +149,9 @@ class DataTable : public AbstractTable {
 
   size_t GetTileGroupCount() const;
 
+  // Number of tuple slots of each default tile group
+  size_t GetTuplesPerTileGroup() const { return tuples_per_tilegroup_; }
+
   // Get a tile group with given layout
   TileGroup *GetTileGroupWithLayout(const column_map_type &partitioning);
 
@@ -249,6 +262,10 @@ class DataTable : public AbstractTable {
                        concurrency::Transaction *transaction,
                        ItemPointer **index_entry_ptr);
 
+  // allocate the indirection that the index entries of the tuple at the
+  // location point to
+  ItemPointer *AllocateIndirection(const ItemPointer &location);
+
   static void SetActiveTileGroupCount(const size_t active_tile_group_count) {
     default_active_tilegroup_count_ = active_tile_group_count;
   }
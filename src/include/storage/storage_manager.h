@@ -12,7 +12,10 @@
 
 #pragma once
 
+#include <cstdint>
 #include <mutex>
+#include <utility>
+#include <vector>
 
 #include "common/platform.h"
 #include "type/types.h"
@@ -31,6 +34,9 @@ namespace storage {
 
 #define TMP_DIR "/tmp/"
 
+// [begin, end) of data that has to be made durable
+typedef std::pair<uintptr_t, uintptr_t> DirtyRange;
+
 //===--------------------------------------------------------------------===//
 // Storage Manager
 //===--------------------------------------------------------------------===//
@@ -50,13 +56,28 @@ class StorageManager {
 
   void Sync(BackendType type, void *address, size_t length);
 
+  // Sync the ranges with one drain. The ranges are sorted and merged at
+  // cache line granularity (and at page granularity for msync)
+  void SyncRanges(BackendType type, std::vector<DirtyRange> &ranges);
+
+  // NVM allocations come from the memory-mapped data file, which is synced
+  // with msync after the cache lines are flushed
+  bool IsEmulatingNVM() const { return nvm_emulation; }
+
   size_t GetMsyncCount() const { return msync_count; }
 
   size_t GetClflushCount() const { return clflush_count; }
 
   size_t GetAllocationCount() const { return allocation_count; }
 
+  size_t GetSyncedBytes() const { return synced_bytes; }
+
  private:
+  void *AllocateFromDataFile(size_t size);
+
+  // msync the pages that cover the range of the data file
+  void SyncDataFile(uintptr_t begin, uintptr_t end);
+
   // data file address
   void *data_file_address;
 
@@ -69,12 +90,17 @@ class StorageManager {
   // data offset
   size_t data_file_offset;
 
+  // NVM is emulated with the data file
+  bool nvm_emulation = false;
+
   // stats
   size_t msync_count = 0;
 
   size_t clflush_count = 0;
 
   size_t allocation_count = 0;
+
+  size_t synced_bytes = 0;
 };
 
 }  // End storage namespace
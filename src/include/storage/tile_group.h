@@ -24,6 +24,7 @@
 #include "common/printable.h"
 #include "type/abstract_pool.h"
 #include "planner/project_info.h"
+#include "storage/storage_manager.h"
 
 namespace peloton {
 
@@ -90,6 +91,11 @@ class TileGroup : public Printable {
   // insert tuple at next available slot in tile if a slot exists
   oid_t InsertTuple(const Tuple *tuple);
 
+  // insert up to count tuples at the next available slots in tile.
+  // returns the number of tuples inserted, starting at first_slot
+  oid_t InsertTuples(const Tuple *const *tuples, const oid_t count,
+                     oid_t &first_slot);
+
   // insert tuple at specific tuple slot
   // used by recovery mode
   oid_t InsertTupleFromRecovery(cid_t commit_id, oid_t tuple_slot_id,
@@ -185,6 +191,11 @@ class TileGroup : public Printable {
   // Sync the contents
   void Sync();
 
+  // Add the ranges of a tuple slot in the tiles and in the header to the
+  // ranges that have to be synced
+  void CollectDirtyRanges(oid_t tuple_slot,
+                          std::vector<DirtyRange> &ranges) const;
+
  protected:
   //===--------------------------------------------------------------------===//
   // Data members
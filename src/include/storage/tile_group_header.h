@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <cstring>
 #include <iostream>
@@ -102,6 +103,22 @@ class TileGroupHeader : public Printable {
     }
   }
 
+  // claim up to count consecutive slots, used by DataTable::InsertTuples().
+  // returns the number of slots claimed, starting at first_slot.
+  oid_t GetNextEmptyTupleSlots(const oid_t count, oid_t &first_slot) {
+    if (next_tuple_slot >= num_tuple_slots) {
+      return 0;
+    }
+
+    first_slot = next_tuple_slot.fetch_add(count, std::memory_order_relaxed);
+
+    if (first_slot >= num_tuple_slots) {
+      return 0;
+    } else {
+      return std::min(count, (oid_t)(num_tuple_slots - first_slot));
+    }
+  }
+
   /**
    * Used by logging
    */
@@ -169,6 +186,11 @@ class TileGroupHeader : public Printable {
     return *(ItemPointer **)(TUPLE_HEADER_LOCATION + indirection_offset);
   }
 
+  // location of the whole header entry of the tuple slot
+  inline char *GetHeaderEntryLocation(const oid_t &tuple_slot_id) const {
+    return TUPLE_HEADER_LOCATION;
+  }
+
   // constraint: at most 16 bytes.
   inline char *GetReservedFieldRef(const oid_t &tuple_slot_id) const {
     return (char *)(TUPLE_HEADER_LOCATION + reserved_field_offset);
@@ -226,6 +248,28 @@ class TileGroupHeader : public Printable {
 
   void PrintVisibility(txn_id_t txn_id, cid_t at_cid);
 
+  //===--------------------------------------------------------------------===//
+  // Visibility summary
+  //===--------------------------------------------------------------------===//
+
+  // Returns true if every slot of this (full) tile group holds a committed,
+  // single-version tuple that is visible at read_cid. Index-only scans use
+  // this to trust the index payload without walking version chains.
+  bool IsAllVisible(const cid_t &read_cid) const;
+
+  // Invalidate the cached summary; called whenever a slot is about to be
+  // modified (i.e. its ownership is acquired)
+  inline void ResetAllVisible() const {
+    all_visible_generation_.fetch_add(1);
+    all_visible_cid_.store(MAX_CID);
+  }
+
+  // Tuples of this tile group have been updated in place by their creating
+  // transaction, so their index entries may not reflect the tuple content
+  inline void SetInPlaceUpdated() const { in_place_updated_.store(true); }
+
+  inline bool IsInPlaceUpdated() const { return in_place_updated_.load(); }
+
   // Getter for spin lock
 
   Spinlock &GetHeaderLock() { return tile_header_lock; }
@@ -283,6 +327,25 @@ class TileGroupHeader : public Printable {
   std::atomic<oid_t> next_tuple_slot;
 
   Spinlock tile_header_lock;
+
+  // largest begin cid of a tile group whose slots are all committed and
+  // visible, or MAX_CID if that is unknown
+  mutable std::atomic<cid_t> all_visible_cid_;
+
+  // bumped on every ResetAllVisible() so that a concurrent IsAllVisible()
+  // does not publish a stale summary
+  mutable std::atomic<uint64_t> all_visible_generation_;
+
+  // the read cid of the last failed summary computation
+  mutable std::atomic<cid_t> all_visible_checked_cid_;
+
+  // set once a tuple of this tile group was modified in place by its
+  // creating transaction
+  mutable std::atomic<bool> in_place_updated_;
+
+  // set once a deleted or superseded version was seen in this tile group;
+  // such tile groups never become all-visible again
+  mutable std::atomic<bool> has_dead_versions_;
 };
 
 }  // End storage namespace
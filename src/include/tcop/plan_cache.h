@@ -0,0 +1,127 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// plan_cache.h
+//
+// Identification: src/include/tcop/plan_cache.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "common/cache.h"
+#include "common/statement.h"
+#include "type/value.h"
+
+namespace peloton {
+namespace tcop {
+
+//===--------------------------------------------------------------------===//
+// Plan Cache Entry
+//===--------------------------------------------------------------------===//
+
+struct PlanCacheEntry {
+  // normalized query text
+  std::string query;
+
+  // catalog version the statements were planned at
+  uint64_t catalog_version = 0;
+
+  // false if the normalized query could not be planned
+  bool cacheable = true;
+
+  // tables referenced by the plan
+  std::set<oid_t> table_ids;
+
+  // every statement of the query, idle or executing
+  std::vector<std::shared_ptr<Statement>> statements;
+
+  // statements that no connection is executing
+  std::vector<std::shared_ptr<Statement>> idle_statements;
+};
+
+//===--------------------------------------------------------------------===//
+// Plan Cache
+//===--------------------------------------------------------------------===//
+
+/**
+ * Server-wide cache of the plans of simple-protocol queries.
+ *
+ * Queries are keyed by their text after the literals were replaced by
+ * parameters, so that queries that only differ in their constants share a
+ * plan. Binding parameters writes into the plan tree, so a statement is only
+ * executed by one connection at a time: Acquire takes an idle statement out
+ * of its entry and Release puts it back. Concurrent executions of the same
+ * query plan their own statement on a miss, which is kept as well.
+ */
+class PlanCache {
+ public:
+  PlanCache(PlanCache const &) = delete;
+
+  static PlanCache &GetInstance();
+
+  // Replace the literals of a SELECT, INSERT, UPDATE or DELETE query by
+  // parameters. Returns false if the query should not be cached
+  static bool NormalizeQuery(const std::string &query,
+                             std::string &normalized_query,
+                             std::vector<type::Value> &params);
+
+  // Take an idle statement of the normalized query out of the cache (nullptr
+  // on a miss). Returns false if the normalized query can not be planned
+  bool Acquire(const std::string &normalized_query, uint64_t catalog_version,
+               std::shared_ptr<Statement> &statement);
+
+  // Give back a statement after executing it, or cache it after a miss
+  void Release(const std::string &normalized_query, uint64_t catalog_version,
+               const std::shared_ptr<Statement> &statement);
+
+  // Remember that the normalized query can not be planned
+  void MarkUncacheable(const std::string &normalized_query,
+                       uint64_t catalog_version);
+
+  // Drop the plans that reference the table
+  void InvalidateTable(oid_t table_id);
+
+  // Called after DDL: plans of older versions are no longer used
+  void BumpCatalogVersion() { catalog_version_++; }
+
+  uint64_t GetCatalogVersion() const { return catalog_version_.load(); }
+
+  // Drop all plans
+  void Clear();
+
+  size_t GetSize();
+
+  size_t GetHitCount() const { return hit_count_.load(); }
+
+  size_t GetMissCount() const { return miss_count_.load(); }
+
+  // statements kept per query
+  static constexpr size_t MAX_STATEMENTS = 16;
+
+ private:
+  PlanCache();
+
+  std::mutex cache_mutex_;
+
+  Cache<std::string, PlanCacheEntry> cache_;
+
+  std::atomic<uint64_t> catalog_version_;
+
+  std::atomic<size_t> hit_count_;
+
+  std::atomic<size_t> miss_count_;
+};
+
+}  // End tcop namespace
+}  // End peloton namespace
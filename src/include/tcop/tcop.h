@@ -62,16 +62,45 @@ class TrafficCop {
       int &rows_change, std::string &error_message);
 
   // ExecutePrepStmt - Helper to handle txn-specifics for the plan-tree of a
-  // statement
+  // statement. If the statement is given, its executor tree is reused
   bridge::peloton_status ExecuteStatementPlan(
       const planner::AbstractPlan *plan, const std::vector<type::Value> &params,
-      std::vector<ResultType> &result, const std::vector<int> &result_format);
+      std::vector<ResultType> &result, const std::vector<int> &result_format,
+      Statement *statement = nullptr);
 
   // InitBindPrepStmt - Prepare and bind a query from a query string
   std::shared_ptr<Statement> PrepareStatement(const std::string &statement_name,
                                               const std::string &query_string,
                                               std::string &error_message);
 
+  // Prepare the statements of a query string that holds several of them,
+  // parsing it only once. statement_queries are their texts, in order
+  bool PrepareStatementList(
+      const std::string &query_string,
+      const std::vector<std::string> &statement_queries,
+      std::vector<std::shared_ptr<Statement>> &statements,
+      std::string &error_message);
+
+  // Execute prepared statements in one transaction, as if they were inside
+  // BEGIN and COMMIT. Stops at the first failure, which aborts all of them.
+  // results and rows_changed get an entry per statement that succeeded
+  Result ExecuteStatementList(
+      const std::vector<std::shared_ptr<Statement>> &statements,
+      std::vector<std::vector<ResultType>> &results,
+      std::vector<int> &rows_changed, std::string &error_message);
+
+  // Open a transaction that the following statements run in, as BEGIN does.
+  // Used by statements whose work spans several messages
+  Result BeginTransaction();
+
+  // Commit or abort the innermost open transaction
+  Result CommitTransaction();
+
+  Result AbortTransaction();
+
+  // Is a transaction open on this connection?
+  bool HasActiveTransaction() const { return tcop_txn_state_.empty() == false; }
+
   std::vector<FieldInfoType> GenerateTupleDescriptor(
       parser::SQLStatement *select_stmt);
 
@@ -103,6 +132,10 @@ class TrafficCop {
   Result CommitQueryHelper();
 
   Result AbortQueryHelper();
+
+  // Plan the first statement of the parse tree into the statement
+  void PlanStatement(const std::unique_ptr<parser::SQLStatementList> &sql_stmt,
+                     Statement *statement);
 };
 
 }  // End tcop namespace
@@ -48,6 +48,20 @@ class SerializeInput {
   inline float ReadFloat() { return ReadPrimitive<float>(); }
   inline double ReadDouble() { return ReadPrimitive<double>(); }
 
+  /** Read an unsigned integer written by SerializeOutput::WriteVarint. */
+  inline uint64_t ReadVarint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      uint8_t byte = static_cast<uint8_t>(ReadByte());
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) break;
+    }
+    return value;
+  }
+
+  /** Number of bytes that are left to read. */
+  inline size_t RemainingBytes() const { return end_ - current_; }
+
   /** Returns a pointer to the internal data buffer, advancing the read position by length. */
   const void* getRawPointer(size_t length) {
     const void* result = current_;
@@ -154,6 +168,16 @@ class SerializeOutput {
   inline void WriteLong(int64_t value) { WritePrimitive(value); }
   inline void WriteFloat(float value) { WritePrimitive(value); }
   inline void WriteDouble(double value) { WritePrimitive(value); }   
+
+  /** Write an unsigned integer in 7 bit groups, least significant first
+  (LEB128), so that small values take a single byte. */
+  inline void WriteVarint(uint64_t value) {
+    while (value >= 0x80) {
+      WriteByte(static_cast<int8_t>((value & 0x7f) | 0x80));
+      value >>= 7;
+    }
+    WriteByte(static_cast<int8_t>(value));
+  }
   inline void WriteEnumInSingleByte(int value) {
     PL_ASSERT(std::numeric_limits<int8_t>::min() <= value &&
       value <= std::numeric_limits<int8_t>::max());
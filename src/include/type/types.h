@@ -314,6 +314,7 @@ enum NetworkMessageType {
   READ_FOR_QUERY = 'Z',
   ROW_DESCRIPTION = 'T',
   DATA_ROW = 'D',
+  COPY_IN_RESPONSE = 'G',
   // Errors
   HUMAN_READABLE_ERROR = 'M',
   SQLSTATE_CODE_ERROR = 'C',
@@ -326,10 +327,14 @@ enum NetworkMessageType {
   PARSE_COMMAND = 'P',
   SIMPLE_QUERY_COMMAND = 'Q',
   CLOSE_COMMAND = 'C',
+  COPY_DATA_COMMAND = 'd',
+  COPY_DONE_COMMAND = 'c',
+  COPY_FAIL_COMMAND = 'f',
 };
 
 enum SqlStateErrorCode {
   SERIALIZATION_ERROR = '1',
+  READ_ONLY_SQL_TRANSACTION = '2',
 };
 
 //===--------------------------------------------------------------------===//
@@ -382,7 +387,8 @@ enum BackendType {
 enum IndexType {
   INDEX_TYPE_INVALID = INVALID_TYPE_ID,  // invalid index type
   INDEX_TYPE_BWTREE = 1,                 // bwtree
-  INDEX_TYPE_HASH = 2                    // hash
+  INDEX_TYPE_HASH = 2,                   // hash
+  INDEX_TYPE_ART = 3                     // adaptive radix tree
 };
 
 enum IndexConstraintType {
@@ -595,6 +601,7 @@ enum InsertType {
 enum CopyType {
   COPY_TYPE_IMPORT_CSV,     // Import csv data to database
   COPY_TYPE_IMPORT_TSV,     // Import tsv data to database
+  COPY_TYPE_IMPORT_BINARY,  // Import postgres binary data to database
   COPY_TYPE_EXPORT_CSV,     // Export data to csv file
   COPY_TYPE_EXPORT_STDOUT,  // Export data to std out
   COPY_TYPE_EXPORT_OTHER,   // Export data to other file format
@@ -718,6 +725,8 @@ enum LoggerMappingStrategyType {
 enum CheckpointType {
   CHECKPOINT_TYPE_INVALID = INVALID_TYPE_ID,
   CHECKPOINT_TYPE_NORMAL = 1,
+  CHECKPOINT_TYPE_PARALLEL = 2,
+  CHECKPOINT_TYPE_IMAGE = 3,
 };
 
 enum ReplicationType {
@@ -761,6 +770,12 @@ enum LogRecordType {
   LOGRECORD_TYPE_WAL_TUPLE_DELETE = 22,
   LOGRECORD_TYPE_WAL_TUPLE_UPDATE = 23,
 
+  // Tuple records of a transaction in the compact WAL format
+  LOGRECORD_TYPE_WAL_TUPLE_BATCH = 24,
+
+  // Compressed log records of a group commit
+  LOGRECORD_TYPE_WAL_COMPRESSED_BLOCK = 25,
+
   // DML records for Write behind logging
   LOGRECORD_TYPE_WBL_TUPLE_INSERT = 31,
   LOGRECORD_TYPE_WBL_TUPLE_DELETE = 32,
@@ -769,6 +784,9 @@ enum LogRecordType {
   // Record for delimiting transactions
   // includes max persistent commit_id
   LOGRECORD_TYPE_ITERATION_DELIMITER = 41,
+
+  // Delimiter in the compact WAL format
+  LOGRECORD_TYPE_COMPACT_ITERATION_DELIMITER = 42,
 };
 
 enum CheckpointStatus {
@@ -815,6 +833,8 @@ enum MetricType {
   QUERY_METRIC = 9,
   // Statistics for CPU
   PROCESSOR_METRIC = 10,
+  // Distribution of values, e.g., commit latencies
+  HISTOGRAM_METRIC = 11,
 };
 
 static const int INVALID_FILE_DESCRIPTOR = -1;
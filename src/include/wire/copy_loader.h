@@ -0,0 +1,143 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// copy_loader.h
+//
+// Identification: src/include/wire/copy_loader.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "type/types.h"
+#include "type/value.h"
+
+namespace peloton {
+
+namespace planner {
+class InsertPlan;
+}
+
+namespace storage {
+class DataTable;
+}
+
+namespace tcop {
+class TrafficCop;
+}
+
+namespace wire {
+
+//===--------------------------------------------------------------------===//
+// Copy Loader
+//===--------------------------------------------------------------------===//
+
+/**
+ * Loads the rows of a COPY ... FROM STDIN into a table.
+ *
+ * The payloads of the CopyData messages are parsed as they arrive, in text,
+ * CSV or binary format. A row may be split across messages, so the tail of
+ * a message that does not end a row is kept until the next one. Rows are
+ * gathered into chunks of one tile group and each chunk is inserted by one
+ * insert plan, which claims its slots and fills the indexes in bulk. Outside
+ * a transaction block the whole COPY is one transaction, which commits when
+ * the last chunk is loaded and aborts on the first error, so either all rows
+ * are loaded or none. Committing every chunk on its own is an option.
+ */
+class CopyLoader {
+ public:
+  CopyLoader(const CopyLoader &) = delete;
+  CopyLoader &operator=(const CopyLoader &) = delete;
+
+  CopyLoader(storage::DataTable *table, CopyType copy_type, char delimiter,
+             tcop::TrafficCop *traffic_cop);
+
+  ~CopyLoader();
+
+  // Parse the payload of a CopyData message. Returns false on error
+  bool Consume(const char *data, size_t len);
+
+  // Load the rows that are left after CopyDone. Returns false on error
+  bool Finish();
+
+  // Is the data in the binary format of Postgres?
+  bool IsBinary() const { return copy_type_ == COPY_TYPE_IMPORT_BINARY; }
+
+  size_t GetColumnCount() const { return column_types_.size(); }
+
+  size_t GetRowCount() const { return row_count_; }
+
+  const std::string &GetErrorMessage() const { return error_message_; }
+
+ private:
+  // Parse the complete rows at the front of the data. consumed is set to the
+  // end of the last complete row
+  bool ParseText(const char *data, size_t len, size_t &consumed);
+
+  bool ParseCSV(const char *data, size_t len, size_t &consumed);
+
+  bool ParseBinary(const char *data, size_t len, size_t &consumed);
+
+  // Add a row of text fields to the chunk
+  bool AddTextRow();
+
+  // Build the value of a field sent in text format
+  bool GetTextValue(const std::string &field, type::Type::TypeId type_id,
+                    type::Value &value);
+
+  // Build the value of a field sent in binary format
+  bool GetBinaryValue(const char *data, int32_t len,
+                      type::Type::TypeId type_id, type::Value &value);
+
+  // Insert the rows of the chunk
+  bool LoadChunk();
+
+  // Record the error and abort the transaction of the COPY
+  bool SetError(const std::string &error_message);
+
+  storage::DataTable *table_;
+
+  CopyType copy_type_;
+
+  char delimiter_;
+
+  tcop::TrafficCop *traffic_cop_;
+
+  std::vector<type::Type::TypeId> column_types_;
+
+  // Rows per chunk
+  size_t chunk_size_;
+
+  // The insert of the rows parsed so far, its pool holds their varlen data
+  std::unique_ptr<planner::InsertPlan> chunk_plan_;
+
+  // Tail of the last message that does not end a row
+  std::string pending_;
+
+  // Fields of the text row being parsed and whether they are NULL
+  std::vector<std::string> fields_;
+  std::vector<bool> null_fields_;
+
+  // Has the binary header been read?
+  bool header_done_ = false;
+
+  // Did we see the end of data marker?
+  bool data_done_ = false;
+
+  // Did we open the transaction that the chunks are loaded in?
+  bool owns_txn_ = false;
+
+  size_t row_count_ = 0;
+
+  std::string error_message_;
+};
+
+}  // End wire namespace
+}  // End peloton namespace
@@ -24,6 +24,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <atomic>
 #include <iostream>
 #include <vector>
 
@@ -53,6 +54,8 @@ enum ConnState {
   CONN_WRITE,      // State the writes data to the network
   CONN_WAIT,       // State for waiting for some event to happen
   CONN_PROCESS,    // State that runs the wire protocol on received data
+  CONN_EXECUTING,  // State while the worker pool runs a received packet,
+                   // or while its commit is flushed
   CONN_CLOSING,    // State for closing the client connection
   CONN_CLOSED,     // State for closed connection
   CONN_INVALID,    // Invalid STate
@@ -84,9 +87,20 @@ void EventHandler(evutil_socket_t connfd, short ev_flags, void *arg);
 /* Helper used by master thread to dispatch new connection to worker thread */
 void DispatchConnection(int new_conn_fd, short event_flags);
 
+/* Creates or reuses the socket object of the fd, owned by the given thread */
+void SetupConnection(int conn_fd, short event_flags, LibeventThread *thread,
+                     ConnState init_state);
+
 /* Runs the state machine for the protocol. Invoked by event handler callback */
 void StateMachine(LibeventSocket *conn);
 
+/* Hands the received packet of the connection to the transaction worker pool.
+ * The worker thread of the connection is notified when it has run */
+void SubmitPacket(LibeventSocket *conn);
+
+/* Tells a client that is over the connection limit to go away */
+void RejectConnection(int new_conn_fd);
+
 // Update event
 void UpdateEvent(LibeventSocket *conn, short flags);
 
@@ -114,7 +128,7 @@ struct Buffer {
 
   inline Buffer() : buf_ptr(0), buf_size(0), buf_flush_ptr(0) {
     // capacity of the buffer
-    buf.reserve(SOCKET_BUFFER_SIZE);
+    buf.resize(SOCKET_BUFFER_SIZE);
   }
 
   inline void Reset() {
@@ -133,7 +147,21 @@ struct Buffer {
 
   inline ByteBuf::const_iterator End() { return std::end(buf); }
 
-  inline size_t GetMaxSize() { return SOCKET_BUFFER_SIZE; }
+  inline size_t GetMaxSize() { return buf.size(); }
+
+  // Grow the capacity to at least size bytes, keeping the contents
+  inline void Grow(size_t size) {
+    auto capacity = buf.size();
+    while (capacity < size) capacity *= 2;
+    buf.resize(capacity);
+  }
+
+  // Go back to the initial capacity
+  inline void Shrink() {
+    if (buf.size() > SOCKET_BUFFER_SIZE) {
+      ByteBuf(SOCKET_BUFFER_SIZE).swap(buf);
+    }
+  }
 };
 
 struct NewConnQueueItem {
@@ -162,6 +190,7 @@ class LibeventSocket {
   PacketManager pkt_manager;       // Stores state for this socket
   ConnState state = CONN_INVALID;  // Initial state of connection
   InputPacket rpkt;                // Used for reading a single Postgres packet
+  bool exec_status = true;         // Result of the packet run by the pool
 
  private:
   Buffer rbuf_;                     // Socket's read buffer
@@ -239,11 +268,29 @@ struct LibeventServer {
   static void CreateNewConn(const int &connfd, short ev_flags,
                             LibeventThread *thread, ConnState init_state);
 
+  // Count a new client connection, returns false if there are already
+  // max_connections of them
+  static bool AdmitConnection();
+
+  // Forget a closed client connection
+  static void ReleaseConnection();
+
+  // Number of open client connections
+  static size_t GetOpenConnectionCount() {
+    return GetConnectionCount().load();
+  }
+
  private:
   /* Maintain a global list of connections.
    * Helps reuse connection objects when possible
    */
   static std::vector<std::unique_ptr<LibeventSocket>> &GetGlobalSocketList();
+
+  // Number of open client connections
+  static std::atomic<size_t> &GetConnectionCount();
+
+  // Create a socket listening on the port, throws on failure
+  int OpenListenSocket(bool reuse_port);
 };
 }
 }
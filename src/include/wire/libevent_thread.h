@@ -42,6 +42,7 @@ namespace wire {
 
 // Forward Declarations
 struct NewConnQueueItem;
+class LibeventSocket;
 
 class LibeventThread {
  protected:
@@ -81,6 +82,9 @@ class LibeventWorkerThread : public LibeventThread {
   /* The queue for new connection requests */
   LockFreeQueue<std::shared_ptr<NewConnQueueItem>> new_conn_queue;
 
+  /* The queue for connections whose packet the worker pool has run */
+  LockFreeQueue<LibeventSocket *> exec_done_queue;
+
  public:
   LibeventWorkerThread(const int thread_id);
 };
@@ -97,6 +101,10 @@ class LibeventMasterThread : public LibeventThread {
 
   void DispatchConnection(int new_conn_fd, short event_flags);
 
+  // Hand a listening socket to the worker, which then accepts on it
+  void DispatchListenSocket(int listen_fd, short event_flags,
+                            LibeventWorkerThread *worker_thread);
+
   std::vector<std::shared_ptr<LibeventWorkerThread>> &GetWorkerThreads();
 
   static void StartWorker(peloton::wire::LibeventWorkerThread *worker_thread);
@@ -12,9 +12,12 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 #include <string>
 
+#include <boost/utility/string_ref.hpp>
+
 #include "common/logger.h"
 #include "type/types.h"
 
@@ -37,6 +40,7 @@ class InputPacket {
 
  private:
   ByteBuf extended_buffer_;  // used to store packets that don't fit in rbuf
+  std::shared_ptr<ByteBuf> detached_buffer_;  // contents owned by the packet
 
  public:
   // reserve buf's size as maximum packet size
@@ -56,6 +60,7 @@ class InputPacket {
     is_initialized = header_parsed = is_extended = false;
     len = ptr = msg_type = 0;
     extended_buffer_.clear();
+    detached_buffer_.reset();
   }
 
   inline void ReserveExtendedBuffer() {
@@ -87,6 +92,16 @@ class InputPacket {
     is_initialized = true;
   }
 
+  // Move the contents into a buffer of the packet's own, so that values can
+  // point into the packet after the socket's read buffer is reused. The
+  // buffer of an extended packet is handed over without a copy
+  std::shared_ptr<ByteBuf> DetachBuffer();
+
+  bool IsDetached() const { return detached_buffer_.get() != nullptr; }
+
+  // Writable contents of a detached packet
+  uchar *GetDetachedData() { return detached_buffer_->data(); }
+
   ByteBuf::const_iterator Begin() { return begin; }
 
   ByteBuf::const_iterator End() { return end; }
@@ -162,6 +177,12 @@ extern int PacketGetInt(InputPacket *pkt, uchar base);
 */
 extern void PacketGetString(InputPacket *pkt, size_t len, std::string &result);
 
+/*
+* packet_get_string_ref - same as packet_get_string, but the result points
+* 		into the packet instead of holding a copy
+*/
+extern boost::string_ref PacketGetStringRef(InputPacket *pkt, size_t len);
+
 /* packet_get_bytes - Parse out "len" bytes of pkt as raw bytes */
 extern void PacketGetBytes(InputPacket *pkt, size_t len, ByteBuf &result);
 
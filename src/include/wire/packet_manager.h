@@ -23,7 +23,9 @@
 #include "common/portal.h"
 #include "common/statement.h"
 #include "tcop/tcop.h"
+#include "wire/copy_loader.h"
 #include "wire/marshal.h"
+#include "wire/transaction_worker_pool.h"
 
 // TXN state definitions
 #define TXN_IDLE 'I'
@@ -52,6 +54,10 @@ class PacketManager {
    * packet. Avoid flushing the response for extended protocols. */
   bool ProcessPacket(InputPacket* pkt);
 
+  // Which queue of the worker pool should run the packet? The packet is not
+  // consumed
+  WorkClass GetWorkClass(InputPacket* pkt);
+
   /* Manage the startup packet */
   //  bool ManageStartupPacket();
   void Reset();
@@ -67,6 +73,18 @@ class PacketManager {
   // Ugh... this should not be here but we have no choice...
   void ReplanPreparedStatement(Statement* statement);
 
+  // Are EXECUTE messages waiting for their batch to run? Their replies are
+  // not filled in until then, so the responses must not be written yet
+  bool HasPendingBatch() const { return batch_plan_.get() != nullptr; }
+
+  // Is a transaction of the client open, a block or a COPY?
+  bool HasOpenTransaction() const {
+    return traffic_cop_->HasActiveTransaction();
+  }
+
+  // Abort the open transactions of a client that went away
+  void AbortOpenTransactions();
+
   //===--------------------------------------------------------------------===//
   // STATIC HELPERS
   //===--------------------------------------------------------------------===//
@@ -79,11 +97,22 @@ class PacketManager {
   static size_t ReadParamFormat(InputPacket* pkt, int num_params_format,
                                 std::vector<int16_t>& formats);
 
-  // Deserialize the parameter value from packet
-  static size_t ReadParamValue(
-      InputPacket* pkt, int num_params, std::vector<int32_t>& param_types,
-      std::vector<std::pair<int, std::string>>& bind_parameters,
-      std::vector<type::Value>& param_values, std::vector<int16_t>& formats);
+  // Deserialize the parameter value from packet. The varlen values of a
+  // detached packet point into it
+  static size_t ReadParamValue(InputPacket* pkt, int num_params,
+                               std::vector<int32_t>& param_types,
+                               std::vector<type::Value>& param_values,
+                               std::vector<int16_t>& formats);
+
+  // Does the plan scan a whole table, join or aggregate?
+  static bool IsAnalyticPlan(const planner::AbstractPlan* plan);
+
+  // Does the query text look like it scans a whole table, joins or
+  // aggregates?
+  static bool IsAnalyticQuery(boost::string_ref query);
+
+  // Does a query of the type change the rows of a table?
+  static bool IsWriteQuery(const std::string& query_type);
 
   static std::vector<PacketManager*> GetPacketManagers() {
     return (PacketManager::packet_managers_);
@@ -106,6 +135,15 @@ class PacketManager {
   // PROTOCOL HANDLING FUNCTIONS
   //===--------------------------------------------------------------------===//
 
+  // Reply with an error if the query writes and the server is a follower.
+  // Returns true if the query is rejected
+  bool RejectWrite(const std::string& query_type);
+
+  // Run the statements of a simple query in one transaction. Returns false,
+  // without replying, if they must run one by one
+  bool ExecQueryBatch(const boost::string_ref& query_string,
+                      const std::vector<boost::string_ref>& queries);
+
   // Generic error protocol packet
   void SendErrorResponse(
       std::vector<std::pair<uchar, std::string>> error_status);
@@ -113,8 +151,11 @@ class PacketManager {
   // Sends ready for query packet to the frontend
   void SendReadyForQuery(uchar txn_status);
 
-  // Sends the attribute headers required by SELECT queries
-  void PutTupleDescriptor(const std::vector<FieldInfoType>& tuple_descriptor);
+  // Sends the attribute headers required by SELECT queries. Columns are in
+  // text format unless their result format code says otherwise
+  void PutTupleDescriptor(
+      const std::vector<FieldInfoType>& tuple_descriptor,
+      const std::vector<int>& result_format = std::vector<int>());
 
   // Send each row, one packet at a time, used by SELECT queries
   void SendDataRows(std::vector<ResultType>& results, int colcount,
@@ -157,6 +198,27 @@ class PacketManager {
   /* Process the optional CLOSE message of the extended query protocol */
   void ExecCloseMessage(InputPacket* pkt);
 
+  /* Add the EXECUTE of a prepared INSERT to the batch of EXECUTE messages.
+   * Returns false if the statement can not be batched */
+  bool BatchExecuteMessage(const std::shared_ptr<Portal>& portal);
+
+  /* Run the batched EXECUTE messages as one multi-row insert and fill in
+   * their replies */
+  void FlushExecuteBatch();
+
+  /* Drop the batched EXECUTE messages without running them */
+  void DiscardExecuteBatch();
+
+  /* Switch to copy-in mode if the query is a COPY FROM STDIN. Returns false
+   * if it is not one */
+  bool StartCopyIn(const std::string& query);
+
+  /* Load the rows of a COPY DATA message */
+  void ExecCopyDataMessage(InputPacket* pkt);
+
+  /* Finish the COPY after a COPY DONE or COPY FAIL message */
+  void ExecCopyDoneMessage(bool copy_failed, const std::string& fail_message);
+
   //===--------------------------------------------------------------------===//
   // MEMBERS
   //===--------------------------------------------------------------------===//
@@ -170,6 +232,9 @@ class PacketManager {
   // global txn state
   uchar txn_state_;
 
+  // The server replays the log of a leader, so writes are rejected
+  bool read_only_;
+
   // state to mang skipped queries
   bool skipped_stmt_ = false;
   std::string skipped_query_string_;
@@ -203,6 +268,21 @@ class PacketManager {
   // The traffic cop used for this connection
   std::unique_ptr<tcop::TrafficCop> traffic_cop_;
 
+  // Plan of the prepared INSERT whose EXECUTE messages are batched
+  std::shared_ptr<planner::AbstractPlan> batch_plan_;
+
+  // Portals of the batched EXECUTE messages
+  std::vector<std::shared_ptr<Portal>> batch_portals_;
+
+  // Parameters of each batched EXECUTE
+  std::vector<std::vector<type::Value>> batch_params_;
+
+  // Positions in responses of the reply of each batched EXECUTE
+  std::vector<size_t> batch_reply_slots_;
+
+  // Loader of the COPY FROM STDIN in progress
+  std::unique_ptr<CopyLoader> copy_loader_;
+
   //===--------------------------------------------------------------------===//
   // STATIC DATA
   //===--------------------------------------------------------------------===//
@@ -0,0 +1,114 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// transaction_worker_pool.h
+//
+// Identification: src/include/wire/transaction_worker_pool.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace peloton {
+namespace wire {
+
+// Classes of work with their own queue
+enum class WorkClass {
+  OLTP = 0,      // short transactions, point lookups and updates
+  ANALYTIC = 1,  // scans, joins, aggregates and bulk loads
+};
+
+//===--------------------------------------------------------------------===//
+// Transaction Worker Pool
+//===--------------------------------------------------------------------===//
+
+/**
+ * Threads that execute the statements of the connections, so that the
+ * network threads only read and write packets.
+ *
+ * Each class of work has its own queue. Only the analytic workers take
+ * analytic work, which limits how many long statements run at the same time,
+ * and they run OLTP work when no analytic work is queued. Short transactions
+ * therefore never wait behind a long statement. The time work spends in its
+ * queue is recorded per class.
+ */
+class TransactionWorkerPool {
+ public:
+  TransactionWorkerPool(TransactionWorkerPool const &) = delete;
+
+  static TransactionWorkerPool &GetInstance();
+
+  // Start worker_count threads, analytic_worker_count of which run analytic
+  // work. Does nothing if the pool is running
+  void Start(size_t worker_count, size_t analytic_worker_count);
+
+  // Run the queued work and join the threads
+  void Stop();
+
+  bool IsRunning() const { return running_.load(); }
+
+  // Queue the work of the given class
+  void Submit(WorkClass work_class, std::function<void()> task);
+
+  size_t GetQueueLength(WorkClass work_class);
+
+  // Work of the class that was started
+  size_t GetExecutedCount(WorkClass work_class) const {
+    return executed_count_[(int)work_class].load();
+  }
+
+  // Total and largest time work of the class waited in its queue
+  uint64_t GetTotalQueueTime(WorkClass work_class) const {
+    return total_queue_micros_[(int)work_class].load();
+  }
+
+  uint64_t GetMaxQueueTime(WorkClass work_class) const {
+    return max_queue_micros_[(int)work_class].load();
+  }
+
+  void ResetStats();
+
+ private:
+  TransactionWorkerPool();
+
+  struct WorkItem {
+    std::function<void()> task;
+    std::chrono::steady_clock::time_point queued_at;
+  };
+
+  void RunWorker(bool analytic_worker);
+
+  // Take the next work item the worker may run
+  bool GetWork(bool analytic_worker, WorkItem &item, WorkClass &work_class);
+
+  std::mutex queue_mutex_;
+
+  std::condition_variable queue_cv_;
+
+  std::deque<WorkItem> queues_[2];
+
+  std::vector<std::thread> workers_;
+
+  std::atomic<bool> running_;
+
+  std::atomic<size_t> executed_count_[2];
+
+  std::atomic<uint64_t> total_queue_micros_[2];
+
+  std::atomic<uint64_t> max_queue_micros_[2];
+};
+
+}  // End wire namespace
+}  // End peloton namespace
@@ -0,0 +1,1207 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// art.cpp
+//
+// Identification: src/index/art.cpp
+//
+// Copyright (c) 2015-17, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "index/art.h"
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+namespace peloton {
+namespace index {
+
+//===--------------------------------------------------------------------===//
+// Node layouts
+//===--------------------------------------------------------------------===//
+
+// Bit 0 of the version marks a node as obsolete, bit 1 as locked
+static constexpr uint64_t OBSOLETE_BIT = 0b01;
+static constexpr uint64_t LOCKED_BIT = 0b10;
+
+// Compressed paths up to this length are stored inside the node
+static constexpr uint32_t INLINE_PREFIX_SIZE = 8;
+
+// Marks an unused slot in the child index of a Node48
+static constexpr uint8_t EMPTY_SLOT = 48;
+
+struct ArtTree::Node {
+  Node(NodeType node_type)
+      : version(0),
+        type(node_type),
+        count(0),
+        prefix_length(0),
+        prefix_buffer(nullptr) {}
+
+  ~Node() { delete[] prefix_buffer; }
+
+  std::atomic<uint64_t> version;
+
+  NodeType type;
+
+  // Number of children
+  uint16_t count;
+
+  // Length of the compressed path. It only shrinks during the lifetime of a
+  // node, so a buffer that was large enough at creation stays large enough
+  uint32_t prefix_length;
+
+  uint8_t prefix[INLINE_PREFIX_SIZE];
+
+  // Holds the compressed path if it does not fit into the node
+  uint8_t *prefix_buffer;
+};
+
+struct ArtTree::Node4 : public ArtTree::Node {
+  Node4() : Node(NodeType::N4) {
+    PL_MEMSET(keys, 0, sizeof(keys));
+    PL_MEMSET(children, 0, sizeof(children));
+  }
+
+  uint8_t keys[4];
+  Node *children[4];
+};
+
+struct ArtTree::Node16 : public ArtTree::Node {
+  Node16() : Node(NodeType::N16) {
+    PL_MEMSET(keys, 0, sizeof(keys));
+    PL_MEMSET(children, 0, sizeof(children));
+  }
+
+  uint8_t keys[16];
+  Node *children[16];
+};
+
+struct ArtTree::Node48 : public ArtTree::Node {
+  Node48() : Node(NodeType::N48) {
+    PL_MEMSET(child_index, EMPTY_SLOT, sizeof(child_index));
+    PL_MEMSET(children, 0, sizeof(children));
+  }
+
+  uint8_t child_index[256];
+  Node *children[48];
+};
+
+struct ArtTree::Node256 : public ArtTree::Node {
+  Node256() : Node(NodeType::N256) {
+    PL_MEMSET(children, 0, sizeof(children));
+  }
+
+  Node *children[256];
+};
+
+/*
+ * struct ValueArray - Immutable array of the values stored under one key
+ *
+ * The values follow the header in the same allocation.
+ */
+struct ArtTree::ValueArray {
+  uint32_t count;
+  uint32_t padding;
+
+  inline ValueType *GetValues() {
+    return reinterpret_cast<ValueType *>(this + 1);
+  }
+
+  static inline size_t GetSize(uint32_t count) {
+    return sizeof(ValueArray) + count * sizeof(ValueType);
+  }
+};
+
+/*
+ * struct Leaf - Complete key and the values stored under it
+ *
+ * The key bytes follow the leaf in the same allocation and never change.
+ * The value array is swapped under the lock of the leaf.
+ */
+struct ArtTree::Leaf : public ArtTree::Node {
+  Leaf(uint32_t length) : Node(NodeType::LEAF), key_length(length) {
+    values.store(nullptr);
+  }
+
+  inline const uint8_t *GetKey() const {
+    return reinterpret_cast<const uint8_t *>(this + 1);
+  }
+
+  inline uint8_t *GetKey() { return reinterpret_cast<uint8_t *>(this + 1); }
+
+  std::atomic<ValueArray *> values;
+  uint32_t key_length;
+};
+
+// A retired node or value array
+struct ArtTree::GarbageNode {
+  Node *node;
+  ValueArray *values;
+  GarbageNode *next;
+};
+
+/*
+ * class EpochGuard - Keeps the calling thread inside an epoch while in scope
+ */
+class ArtTree::EpochGuard {
+ public:
+  EpochGuard(const ArtTree *tree) : tree_(tree), epoch_(tree->JoinEpoch()) {}
+
+  ~EpochGuard() { tree_->LeaveEpoch(epoch_); }
+
+ private:
+  const ArtTree *tree_;
+  uint64_t epoch_;
+};
+
+//===--------------------------------------------------------------------===//
+// Construction
+//===--------------------------------------------------------------------===//
+
+ArtTree::ArtTree()
+    : root_(new Node256()),
+      memory_footprint_(sizeof(Node256)),
+      global_epoch_(0),
+      garbage_count_(0) {
+  for (uint64_t i = 0; i < EPOCH_SLOT_COUNT; i++) {
+    active_threads_[i].store(0);
+    garbage_lists_[i].store(nullptr);
+  }
+}
+
+ArtTree::~ArtTree() {
+  for (uint64_t i = 0; i < EPOCH_SLOT_COUNT; i++) {
+    FreeGarbageList(garbage_lists_[i].exchange(nullptr));
+  }
+  FreeSubtree(root_);
+}
+
+//===--------------------------------------------------------------------===//
+// Optimistic lock coupling
+//===--------------------------------------------------------------------===//
+
+uint64_t ArtTree::ReadLockOrRestart(const Node *node, bool &need_restart) {
+  uint64_t version = node->version.load();
+  while ((version & LOCKED_BIT) != 0) {
+    std::this_thread::yield();
+    version = node->version.load();
+  }
+  if ((version & OBSOLETE_BIT) != 0) {
+    need_restart = true;
+  }
+  return version;
+}
+
+void ArtTree::CheckOrRestart(const Node *node, uint64_t version,
+                             bool &need_restart) {
+  // Make sure that the reads of the node happen before the validation
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (node->version.load(std::memory_order_relaxed) != version) {
+    need_restart = true;
+  }
+}
+
+void ArtTree::UpgradeToWriteLockOrRestart(Node *node, uint64_t &version,
+                                          bool &need_restart) {
+  if (node->version.compare_exchange_strong(version, version + LOCKED_BIT)) {
+    version = version + LOCKED_BIT;
+  } else {
+    need_restart = true;
+  }
+}
+
+void ArtTree::WriteUnlock(Node *node) { node->version.fetch_add(LOCKED_BIT); }
+
+void ArtTree::WriteUnlockObsolete(Node *node) {
+  node->version.fetch_add(LOCKED_BIT | OBSOLETE_BIT);
+}
+
+//===--------------------------------------------------------------------===//
+// Node helpers
+//===--------------------------------------------------------------------===//
+
+ArtTree::Leaf *ArtTree::NewLeaf(const ArtKey &key, ValueType value) {
+  size_t size = sizeof(Leaf) + key.GetLength();
+  Leaf *leaf = new (::operator new(size)) Leaf(key.GetLength());
+  PL_MEMCPY(leaf->GetKey(), key.GetData(), key.GetLength());
+
+  ValueArray *values = NewValueArray(1);
+  values->GetValues()[0] = value;
+  leaf->values.store(values);
+
+  memory_footprint_.fetch_add(size);
+  return leaf;
+}
+
+ArtTree::Node4 *ArtTree::NewNode4(const uint8_t *prefix,
+                                  uint32_t prefix_length) {
+  Node4 *node = new Node4();
+  SetPrefix(node, prefix, prefix_length);
+  memory_footprint_.fetch_add(sizeof(Node4));
+  return node;
+}
+
+ArtTree::ValueArray *ArtTree::NewValueArray(uint32_t count) {
+  size_t size = ValueArray::GetSize(count);
+  ValueArray *values = static_cast<ValueArray *>(::operator new(size));
+  values->count = count;
+  values->padding = 0;
+  memory_footprint_.fetch_add(size);
+  return values;
+}
+
+ArtTree::Node *ArtTree::GetChild(const Node *node, uint8_t key_byte) {
+  switch (node->type) {
+    case NodeType::N4: {
+      auto n = static_cast<const Node4 *>(node);
+      uint16_t count = std::min<uint16_t>(n->count, 4);
+      for (uint16_t i = 0; i < count; i++) {
+        if (n->keys[i] == key_byte) return n->children[i];
+      }
+      return nullptr;
+    }
+    case NodeType::N16: {
+      auto n = static_cast<const Node16 *>(node);
+      uint16_t count = std::min<uint16_t>(n->count, 16);
+      for (uint16_t i = 0; i < count; i++) {
+        if (n->keys[i] == key_byte) return n->children[i];
+      }
+      return nullptr;
+    }
+    case NodeType::N48: {
+      auto n = static_cast<const Node48 *>(node);
+      uint8_t slot = n->child_index[key_byte];
+      if (slot == EMPTY_SLOT) return nullptr;
+      return n->children[slot];
+    }
+    case NodeType::N256:
+      return static_cast<const Node256 *>(node)->children[key_byte];
+    case NodeType::LEAF:
+      break;
+  }
+  return nullptr;
+}
+
+void ArtTree::ChangeChild(Node *node, uint8_t key_byte, Node *child) {
+  switch (node->type) {
+    case NodeType::N4: {
+      auto n = static_cast<Node4 *>(node);
+      for (uint16_t i = 0; i < n->count; i++) {
+        if (n->keys[i] == key_byte) {
+          n->children[i] = child;
+          return;
+        }
+      }
+      break;
+    }
+    case NodeType::N16: {
+      auto n = static_cast<Node16 *>(node);
+      for (uint16_t i = 0; i < n->count; i++) {
+        if (n->keys[i] == key_byte) {
+          n->children[i] = child;
+          return;
+        }
+      }
+      break;
+    }
+    case NodeType::N48: {
+      auto n = static_cast<Node48 *>(node);
+      PL_ASSERT(n->child_index[key_byte] != EMPTY_SLOT);
+      n->children[n->child_index[key_byte]] = child;
+      return;
+    }
+    case NodeType::N256:
+      static_cast<Node256 *>(node)->children[key_byte] = child;
+      return;
+    case NodeType::LEAF:
+      break;
+  }
+  PL_ASSERT(false);
+}
+
+bool ArtTree::IsFull(const Node *node) {
+  switch (node->type) {
+    case NodeType::N4:
+      return node->count == 4;
+    case NodeType::N16:
+      return node->count == 16;
+    case NodeType::N48:
+      return node->count == 48;
+    default:
+      return false;
+  }
+}
+
+/*
+ * InsertSorted() - Insert into the sorted key/child arrays of a Node4/16
+ */
+template <typename NodeClass, typename ChildType>
+static void InsertSorted(NodeClass *node, uint8_t key_byte, ChildType *child) {
+  uint16_t pos = 0;
+  while (pos < node->count && node->keys[pos] < key_byte) pos++;
+  for (uint16_t i = node->count; i > pos; i--) {
+    node->keys[i] = node->keys[i - 1];
+    node->children[i] = node->children[i - 1];
+  }
+  node->keys[pos] = key_byte;
+  node->children[pos] = child;
+  node->count++;
+}
+
+template <typename NodeClass>
+static void RemoveSorted(NodeClass *node, uint8_t key_byte) {
+  uint16_t pos = 0;
+  while (pos < node->count && node->keys[pos] != key_byte) pos++;
+  PL_ASSERT(pos < node->count);
+  for (uint16_t i = pos; i + 1 < node->count; i++) {
+    node->keys[i] = node->keys[i + 1];
+    node->children[i] = node->children[i + 1];
+  }
+  node->count--;
+}
+
+void ArtTree::InsertChild(Node *node, uint8_t key_byte, Node *child) {
+  PL_ASSERT(IsFull(node) == false);
+  switch (node->type) {
+    case NodeType::N4:
+      InsertSorted(static_cast<Node4 *>(node), key_byte, child);
+      break;
+    case NodeType::N16:
+      InsertSorted(static_cast<Node16 *>(node), key_byte, child);
+      break;
+    case NodeType::N48: {
+      auto n = static_cast<Node48 *>(node);
+      // Slots of removed children may be anywhere
+      uint8_t slot = 0;
+      while (n->children[slot] != nullptr) slot++;
+      n->children[slot] = child;
+      n->child_index[key_byte] = slot;
+      n->count++;
+      break;
+    }
+    case NodeType::N256:
+      static_cast<Node256 *>(node)->children[key_byte] = child;
+      node->count++;
+      break;
+    case NodeType::LEAF:
+      PL_ASSERT(false);
+      break;
+  }
+}
+
+void ArtTree::RemoveChild(Node *node, uint8_t key_byte) {
+  switch (node->type) {
+    case NodeType::N4:
+      RemoveSorted(static_cast<Node4 *>(node), key_byte);
+      break;
+    case NodeType::N16:
+      RemoveSorted(static_cast<Node16 *>(node), key_byte);
+      break;
+    case NodeType::N48: {
+      auto n = static_cast<Node48 *>(node);
+      uint8_t slot = n->child_index[key_byte];
+      PL_ASSERT(slot != EMPTY_SLOT);
+      n->children[slot] = nullptr;
+      n->child_index[key_byte] = EMPTY_SLOT;
+      n->count--;
+      break;
+    }
+    case NodeType::N256:
+      static_cast<Node256 *>(node)->children[key_byte] = nullptr;
+      node->count--;
+      break;
+    case NodeType::LEAF:
+      PL_ASSERT(false);
+      break;
+  }
+}
+
+/*
+ * Grow() - Copy a full node into a node of the next larger type
+ *
+ * The caller holds the write lock of the node and replaces it in its parent.
+ */
+ArtTree::Node *ArtTree::Grow(const Node *node) {
+  std::vector<std::pair<uint8_t, Node *>> children;
+  GetChildren(node, 0, 255, children);
+
+  Node *bigger = nullptr;
+  size_t size = 0;
+  switch (node->type) {
+    case NodeType::N4:
+      bigger = new Node16();
+      size = sizeof(Node16);
+      break;
+    case NodeType::N16:
+      bigger = new Node48();
+      size = sizeof(Node48);
+      break;
+    case NodeType::N48:
+      bigger = new Node256();
+      size = sizeof(Node256);
+      break;
+    default:
+      PL_ASSERT(false);
+      return nullptr;
+  }
+
+  SetPrefix(bigger, GetPrefix(node), node->prefix_length);
+  for (auto &child : children) {
+    InsertChild(bigger, child.first, child.second);
+  }
+  memory_footprint_.fetch_add(size);
+  return bigger;
+}
+
+void ArtTree::SetPrefix(Node *node, const uint8_t *prefix,
+                        uint32_t prefix_length) {
+  // The source may overlap with the current path of the node when the path
+  // is shortened, hence memmove
+  if (prefix_length <= INLINE_PREFIX_SIZE) {
+    std::memmove(node->prefix, prefix, prefix_length);
+  } else {
+    if (node->prefix_buffer == nullptr) {
+      node->prefix_buffer = new uint8_t[prefix_length];
+    }
+    std::memmove(node->prefix_buffer, prefix, prefix_length);
+  }
+  node->prefix_length = prefix_length;
+}
+
+const uint8_t *ArtTree::GetPrefix(const Node *node) {
+  if (node->prefix_length <= INLINE_PREFIX_SIZE) {
+    return node->prefix;
+  }
+  return node->prefix_buffer;
+}
+
+bool ArtTree::LeafMatches(const Leaf *leaf, const ArtKey &key) {
+  return leaf->key_length == key.GetLength() &&
+         std::memcmp(leaf->GetKey(), key.GetData(), key.GetLength()) == 0;
+}
+
+int ArtTree::CompareKeys(const uint8_t *lhs, uint32_t lhs_length,
+                         const ArtKey &rhs) {
+  uint32_t length = std::min(lhs_length, rhs.GetLength());
+  int ret = std::memcmp(lhs, rhs.GetData(), length);
+  if (ret != 0) return ret;
+  if (lhs_length == rhs.GetLength()) return 0;
+  return (lhs_length < rhs.GetLength()) ? -1 : 1;
+}
+
+void ArtTree::GetChildren(const Node *node, uint8_t low, uint8_t high,
+                          std::vector<std::pair<uint8_t, Node *>> &children) {
+  switch (node->type) {
+    case NodeType::N4: {
+      auto n = static_cast<const Node4 *>(node);
+      uint16_t count = std::min<uint16_t>(n->count, 4);
+      for (uint16_t i = 0; i < count; i++) {
+        if (n->keys[i] >= low && n->keys[i] <= high) {
+          children.emplace_back(n->keys[i], n->children[i]);
+        }
+      }
+      break;
+    }
+    case NodeType::N16: {
+      auto n = static_cast<const Node16 *>(node);
+      uint16_t count = std::min<uint16_t>(n->count, 16);
+      for (uint16_t i = 0; i < count; i++) {
+        if (n->keys[i] >= low && n->keys[i] <= high) {
+          children.emplace_back(n->keys[i], n->children[i]);
+        }
+      }
+      break;
+    }
+    case NodeType::N48: {
+      auto n = static_cast<const Node48 *>(node);
+      for (uint32_t b = low; b <= high; b++) {
+        uint8_t slot = n->child_index[b];
+        if (slot != EMPTY_SLOT && n->children[slot] != nullptr) {
+          children.emplace_back(b, n->children[slot]);
+        }
+      }
+      break;
+    }
+    case NodeType::N256: {
+      auto n = static_cast<const Node256 *>(node);
+      for (uint32_t b = low; b <= high; b++) {
+        if (n->children[b] != nullptr) {
+          children.emplace_back(b, n->children[b]);
+        }
+      }
+      break;
+    }
+    case NodeType::LEAF:
+      break;
+  }
+}
+
+void ArtTree::FreeNode(Node *node) {
+  if (node->type == NodeType::LEAF) {
+    Leaf *leaf = static_cast<Leaf *>(node);
+    ValueArray *values = leaf->values.load();
+    if (values != nullptr) {
+      memory_footprint_.fetch_sub(ValueArray::GetSize(values->count));
+      ::operator delete(values);
+    }
+    memory_footprint_.fetch_sub(sizeof(Leaf) + leaf->key_length);
+    leaf->~Leaf();
+    ::operator delete(leaf);
+    return;
+  }
+
+  switch (node->type) {
+    case NodeType::N4:
+      memory_footprint_.fetch_sub(sizeof(Node4));
+      delete static_cast<Node4 *>(node);
+      break;
+    case NodeType::N16:
+      memory_footprint_.fetch_sub(sizeof(Node16));
+      delete static_cast<Node16 *>(node);
+      break;
+    case NodeType::N48:
+      memory_footprint_.fetch_sub(sizeof(Node48));
+      delete static_cast<Node48 *>(node);
+      break;
+    case NodeType::N256:
+      memory_footprint_.fetch_sub(sizeof(Node256));
+      delete static_cast<Node256 *>(node);
+      break;
+    case NodeType::LEAF:
+      break;
+  }
+}
+
+void ArtTree::FreeSubtree(Node *node) {
+  if (node->type != NodeType::LEAF) {
+    std::vector<std::pair<uint8_t, Node *>> children;
+    GetChildren(node, 0, 255, children);
+    for (auto &child : children) {
+      FreeSubtree(child.second);
+    }
+  }
+  FreeNode(node);
+}
+
+//===--------------------------------------------------------------------===//
+// Insert
+//===--------------------------------------------------------------------===//
+
+bool ArtTree::Insert(const ArtKey &key, ValueType value) {
+  return InsertInternal(key, value, nullptr, nullptr);
+}
+
+bool ArtTree::ConditionalInsert(const ArtKey &key, ValueType value,
+                                std::function<bool(const void *)> predicate,
+                                bool *predicate_satisfied) {
+  *predicate_satisfied = false;
+  return InsertInternal(key, value, &predicate, predicate_satisfied);
+}
+
+/*
+ * InsertInternal() - Insert following the OLC algorithm of Leis et al.
+ *
+ * The tree is traversed optimistically. Only the node that is modified is
+ * locked, plus its parent if the node has to be replaced. The new leaf is
+ * created at most once and reused across restarts.
+ */
+bool ArtTree::InsertInternal(const ArtKey &key, ValueType value,
+                             std::function<bool(const void *)> *predicate,
+                             bool *predicate_satisfied) {
+  EpochGuard guard(this);
+  Leaf *new_leaf = nullptr;
+  bool ret = false;
+
+restart:
+  bool need_restart = false;
+  Node *node = nullptr;
+  Node *next_node = root_;
+  Node *parent_node = nullptr;
+  uint8_t parent_key = 0;
+  uint8_t node_key = 0;
+  uint64_t parent_version = 0;
+  uint32_t level = 0;
+
+  while (true) {
+    parent_node = node;
+    parent_key = node_key;
+    node = next_node;
+
+    uint64_t version = ReadLockOrRestart(node, need_restart);
+    if (need_restart) goto restart;
+
+    // Compare the compressed path
+    const uint8_t *prefix = GetPrefix(node);
+    uint32_t prefix_length = node->prefix_length;
+    uint32_t mismatch = 0;
+    while (mismatch < prefix_length &&
+           level + mismatch < key.GetLength() &&
+           prefix[mismatch] == key[level + mismatch]) {
+      mismatch++;
+    }
+
+    if (mismatch < prefix_length) {
+      // Keys are prefix free, so the key differs within the path
+      PL_ASSERT(level + mismatch < key.GetLength());
+      // The root has no compressed path, so there is a parent
+      PL_ASSERT(parent_node != nullptr);
+
+      UpgradeToWriteLockOrRestart(parent_node, parent_version, need_restart);
+      if (need_restart) goto restart;
+      UpgradeToWriteLockOrRestart(node, version, need_restart);
+      if (need_restart) {
+        WriteUnlock(parent_node);
+        goto restart;
+      }
+
+      // Put a new node with the common part of the path above the node
+      if (new_leaf == nullptr) new_leaf = NewLeaf(key, value);
+      Node4 *new_node = NewNode4(prefix, mismatch);
+      InsertChild(new_node, key[level + mismatch], new_leaf);
+      InsertChild(new_node, prefix[mismatch], node);
+      ChangeChild(parent_node, parent_key, new_node);
+      WriteUnlock(parent_node);
+
+      SetPrefix(node, prefix + mismatch + 1, prefix_length - mismatch - 1);
+      WriteUnlock(node);
+      return true;
+    }
+
+    level += prefix_length;
+    PL_ASSERT(level < key.GetLength());
+    node_key = key[level];
+    next_node = GetChild(node, node_key);
+    CheckOrRestart(node, version, need_restart);
+    if (need_restart) goto restart;
+
+    if (next_node == nullptr) {
+      if (new_leaf == nullptr) new_leaf = NewLeaf(key, value);
+
+      if (IsFull(node)) {
+        // The root never fills up, so there is a parent
+        PL_ASSERT(parent_node != nullptr);
+
+        UpgradeToWriteLockOrRestart(parent_node, parent_version,
+                                    need_restart);
+        if (need_restart) goto restart;
+        UpgradeToWriteLockOrRestart(node, version, need_restart);
+        if (need_restart) {
+          WriteUnlock(parent_node);
+          goto restart;
+        }
+
+        Node *bigger = Grow(node);
+        InsertChild(bigger, node_key, new_leaf);
+        ChangeChild(parent_node, parent_key, bigger);
+        WriteUnlockObsolete(node);
+        WriteUnlock(parent_node);
+        Retire(node);
+      } else {
+        UpgradeToWriteLockOrRestart(node, version, need_restart);
+        if (need_restart) goto restart;
+        if (parent_node != nullptr) {
+          CheckOrRestart(parent_node, parent_version, need_restart);
+          if (need_restart) {
+            WriteUnlock(node);
+            goto restart;
+          }
+        }
+
+        InsertChild(node, node_key, new_leaf);
+        WriteUnlock(node);
+      }
+      return true;
+    }
+
+    if (parent_node != nullptr) {
+      CheckOrRestart(parent_node, parent_version, need_restart);
+      if (need_restart) goto restart;
+    }
+
+    if (next_node->type == NodeType::LEAF) {
+      Leaf *leaf = static_cast<Leaf *>(next_node);
+
+      if (LeafMatches(leaf, key)) {
+        ret = AppendToLeaf(leaf, value, predicate, predicate_satisfied,
+                           need_restart);
+        if (need_restart) goto restart;
+        break;
+      }
+
+      // Replace the leaf by a node holding both the old and the new leaf
+      UpgradeToWriteLockOrRestart(node, version, need_restart);
+      if (need_restart) goto restart;
+
+      const uint8_t *leaf_key = leaf->GetKey();
+      uint32_t common = 0;
+      while (level + 1 + common < key.GetLength() &&
+             level + 1 + common < leaf->key_length &&
+             key[level + 1 + common] == leaf_key[level + 1 + common]) {
+        common++;
+      }
+      PL_ASSERT(level + 1 + common < key.GetLength());
+      PL_ASSERT(level + 1 + common < leaf->key_length);
+
+      if (new_leaf == nullptr) new_leaf = NewLeaf(key, value);
+      Node4 *new_node = NewNode4(key.GetData() + level + 1, common);
+      InsertChild(new_node, key[level + 1 + common], new_leaf);
+      InsertChild(new_node, leaf_key[level + 1 + common], leaf);
+      ChangeChild(node, node_key, new_node);
+      WriteUnlock(node);
+      return true;
+    }
+
+    level++;
+    parent_version = version;
+  }
+
+  // The key already existed; the new leaf has never been published
+  if (new_leaf != nullptr) FreeNode(new_leaf);
+  return ret;
+}
+
+bool ArtTree::AppendToLeaf(Leaf *leaf, ValueType value,
+                           std::function<bool(const void *)> *predicate,
+                           bool *predicate_satisfied, bool &need_restart) {
+  uint64_t version = ReadLockOrRestart(leaf, need_restart);
+  if (need_restart) return false;
+  UpgradeToWriteLockOrRestart(leaf, version, need_restart);
+  if (need_restart) return false;
+
+  ValueArray *old_values = leaf->values.load();
+  ValueType *old_items = old_values->GetValues();
+  for (uint32_t i = 0; i < old_values->count; i++) {
+    if (predicate != nullptr && (*predicate)(old_items[i])) {
+      *predicate_satisfied = true;
+      WriteUnlock(leaf);
+      return false;
+    }
+    if (ValueEquals(old_items[i], value)) {
+      WriteUnlock(leaf);
+      return false;
+    }
+  }
+
+  ValueArray *new_values = NewValueArray(old_values->count + 1);
+  PL_MEMCPY(new_values->GetValues(), old_items,
+            old_values->count * sizeof(ValueType));
+  new_values->GetValues()[old_values->count] = value;
+  leaf->values.store(new_values);
+  WriteUnlock(leaf);
+
+  Retire(old_values);
+  return true;
+}
+
+//===--------------------------------------------------------------------===//
+// Delete
+//===--------------------------------------------------------------------===//
+
+/*
+ * Delete() - Remove a key-value pair
+ *
+ * The node pointing to the leaf is locked before the leaf itself, so that an
+ * empty leaf can be unlinked. Inner nodes are never shrunk or merged.
+ */
+bool ArtTree::Delete(const ArtKey &key, ValueType value) {
+  EpochGuard guard(this);
+
+restart:
+  bool need_restart = false;
+  Node *node = root_;
+  uint32_t level = 0;
+
+  uint64_t version = ReadLockOrRestart(node, need_restart);
+  if (need_restart) goto restart;
+
+  while (true) {
+    const uint8_t *prefix = GetPrefix(node);
+    uint32_t prefix_length = node->prefix_length;
+    bool match = (level + prefix_length < key.GetLength()) &&
+                 std::memcmp(prefix, key.GetData() + level, prefix_length) == 0;
+    if (match == false) {
+      CheckOrRestart(node, version, need_restart);
+      if (need_restart) goto restart;
+      return false;
+    }
+
+    level += prefix_length;
+    uint8_t node_key = key[level];
+    Node *child = GetChild(node, node_key);
+    CheckOrRestart(node, version, need_restart);
+    if (need_restart) goto restart;
+
+    if (child == nullptr) return false;
+
+    if (child->type == NodeType::LEAF) {
+      Leaf *leaf = static_cast<Leaf *>(child);
+      if (LeafMatches(leaf, key) == false) return false;
+
+      UpgradeToWriteLockOrRestart(node, version, need_restart);
+      if (need_restart) goto restart;
+      uint64_t leaf_version = ReadLockOrRestart(leaf, need_restart);
+      if (need_restart == false) {
+        UpgradeToWriteLockOrRestart(leaf, leaf_version, need_restart);
+      }
+      if (need_restart) {
+        WriteUnlock(node);
+        goto restart;
+      }
+
+      ValueArray *old_values = leaf->values.load();
+      ValueType *old_items = old_values->GetValues();
+      uint32_t pos = 0;
+      while (pos < old_values->count &&
+             ValueEquals(old_items[pos], value) == false) {
+        pos++;
+      }
+      if (pos == old_values->count) {
+        WriteUnlock(leaf);
+        WriteUnlock(node);
+        return false;
+      }
+
+      if (old_values->count == 1) {
+        RemoveChild(node, node_key);
+        WriteUnlockObsolete(leaf);
+        WriteUnlock(node);
+        Retire(leaf);
+        return true;
+      }
+
+      ValueArray *new_values = NewValueArray(old_values->count - 1);
+      ValueType *new_items = new_values->GetValues();
+      for (uint32_t i = 0, j = 0; i < old_values->count; i++) {
+        if (i != pos) new_items[j++] = old_items[i];
+      }
+      leaf->values.store(new_values);
+      WriteUnlock(leaf);
+      WriteUnlock(node);
+      Retire(old_values);
+      return true;
+    }
+
+    level++;
+    uint64_t child_version = ReadLockOrRestart(child, need_restart);
+    if (need_restart) goto restart;
+    CheckOrRestart(node, version, need_restart);
+    if (need_restart) goto restart;
+
+    node = child;
+    version = child_version;
+  }
+}
+
+//===--------------------------------------------------------------------===//
+// Lookup and scan
+//===--------------------------------------------------------------------===//
+
+void ArtTree::Lookup(const ArtKey &key, std::vector<ValueType> &result) const {
+  EpochGuard guard(this);
+  size_t original_size = result.size();
+
+restart:
+  result.resize(original_size);
+  bool need_restart = false;
+  const Node *node = root_;
+  uint32_t level = 0;
+
+  uint64_t version = ReadLockOrRestart(node, need_restart);
+  if (need_restart) goto restart;
+
+  while (true) {
+    const uint8_t *prefix = GetPrefix(node);
+    uint32_t prefix_length = node->prefix_length;
+    bool match = (level + prefix_length < key.GetLength()) &&
+                 std::memcmp(prefix, key.GetData() + level, prefix_length) == 0;
+    if (match == false) {
+      CheckOrRestart(node, version, need_restart);
+      if (need_restart) goto restart;
+      return;
+    }
+
+    level += prefix_length;
+    const Node *child = GetChild(node, key[level]);
+    CheckOrRestart(node, version, need_restart);
+    if (need_restart) goto restart;
+
+    if (child == nullptr) return;
+
+    if (child->type == NodeType::LEAF) {
+      auto leaf = static_cast<const Leaf *>(child);
+      uint64_t leaf_version = ReadLockOrRestart(leaf, need_restart);
+      if (need_restart) goto restart;
+      if (LeafMatches(leaf, key)) {
+        ValueArray *values = leaf->values.load();
+        result.insert(result.end(), values->GetValues(),
+                      values->GetValues() + values->count);
+      }
+      CheckOrRestart(leaf, leaf_version, need_restart);
+      if (need_restart) goto restart;
+      return;
+    }
+
+    level++;
+    uint64_t child_version = ReadLockOrRestart(child, need_restart);
+    if (need_restart) goto restart;
+    CheckOrRestart(node, version, need_restart);
+    if (need_restart) goto restart;
+
+    node = child;
+    version = child_version;
+  }
+}
+
+void ArtTree::ScanRange(const ArtKey *low_key, const ArtKey *high_key,
+                        bool forward, uint64_t limit,
+                        std::vector<ValueType> &result) const {
+  EpochGuard guard(this);
+  size_t original_size = result.size();
+  ScanContext context;
+  context.forward = forward;
+  context.low_exclusive = false;
+  context.high_exclusive = false;
+  context.max_result_size = (limit == 0) ? std::numeric_limits<size_t>::max()
+                                         : original_size + limit;
+  context.result = &result;
+  context.last_key = nullptr;
+
+  while (true) {
+    result.resize(original_size);
+    if (ScanNode(root_, 0, low_key, high_key, context)) {
+      break;
+    }
+  }
+
+  // The last leaf may have contributed more values than needed
+  if (result.size() > context.max_result_size) {
+    result.resize(context.max_result_size);
+  }
+}
+
+/*
+ * ScanBatch() - Range scan that can be resumed after the last leaf
+ *
+ * Values are never truncated within a leaf, since the next batch continues
+ * after the key of the last leaf.
+ */
+size_t ArtTree::ScanBatch(const ArtKey *low_key, bool low_exclusive,
+                          const ArtKey *high_key, bool high_exclusive,
+                          bool forward, size_t max_count,
+                          std::vector<ValueType> &result,
+                          ArtKey &last_key) const {
+  EpochGuard guard(this);
+  size_t original_size = result.size();
+  ScanContext context;
+  context.forward = forward;
+  context.low_exclusive = low_exclusive;
+  context.high_exclusive = high_exclusive;
+  context.max_result_size = original_size + std::max<size_t>(max_count, 1);
+  context.result = &result;
+  context.last_key = &last_key;
+
+  while (true) {
+    result.resize(original_size);
+    if (ScanNode(root_, 0, low_key, high_key, context)) {
+      break;
+    }
+  }
+
+  return result.size() - original_size;
+}
+
+/*
+ * ScanNode() - Recursive range scan below a node
+ *
+ * A bound stays active only along the path that equals the bound so far. As
+ * soon as a byte of the path is strictly between the bounds they are dropped,
+ * and if it is outside of them the whole subtree is skipped.
+ */
+bool ArtTree::ScanNode(const Node *node, uint32_t level, const ArtKey *low_key,
+                       const ArtKey *high_key, ScanContext &context) const {
+  bool need_restart = false;
+  uint64_t version = ReadLockOrRestart(node, need_restart);
+  if (need_restart) return false;
+
+  const uint8_t *prefix = GetPrefix(node);
+  uint32_t prefix_length = node->prefix_length;
+  bool skip = false;
+  for (uint32_t i = 0; i < prefix_length && skip == false; i++) {
+    uint8_t byte = prefix[i];
+    if (low_key != nullptr) {
+      if (level + i >= low_key->GetLength() || byte > (*low_key)[level + i]) {
+        low_key = nullptr;
+      } else if (byte < (*low_key)[level + i]) {
+        skip = true;
+      }
+    }
+    if (high_key != nullptr && skip == false) {
+      if (level + i >= high_key->GetLength() ||
+          byte > (*high_key)[level + i]) {
+        skip = true;
+      } else if (byte < (*high_key)[level + i]) {
+        high_key = nullptr;
+      }
+    }
+  }
+  level += prefix_length;
+
+  uint8_t low_byte = 0;
+  uint8_t high_byte = 255;
+  if (low_key != nullptr) {
+    if (level >= low_key->GetLength()) {
+      low_key = nullptr;
+    } else {
+      low_byte = (*low_key)[level];
+    }
+  }
+  if (high_key != nullptr) {
+    if (level >= high_key->GetLength()) {
+      skip = true;
+    } else {
+      high_byte = (*high_key)[level];
+    }
+  }
+
+  std::vector<std::pair<uint8_t, Node *>> children;
+  if (skip == false && low_byte <= high_byte) {
+    GetChildren(node, low_byte, high_byte, children);
+  }
+  CheckOrRestart(node, version, need_restart);
+  if (need_restart) return false;
+
+  if (context.forward == false) {
+    std::reverse(children.begin(), children.end());
+  }
+
+  for (auto &entry : children) {
+    const ArtKey *child_low =
+        (low_key != nullptr && entry.first == low_byte) ? low_key : nullptr;
+    const ArtKey *child_high =
+        (high_key != nullptr && entry.first == high_byte) ? high_key : nullptr;
+
+    if (entry.second->type != NodeType::LEAF) {
+      if (ScanNode(entry.second, level + 1, child_low, child_high, context) ==
+          false) {
+        return false;
+      }
+    } else {
+      auto leaf = static_cast<const Leaf *>(entry.second);
+      uint64_t leaf_version = ReadLockOrRestart(leaf, need_restart);
+      // A leaf that has been unlinked meanwhile is simply skipped
+      if (need_restart) {
+        need_restart = false;
+        continue;
+      }
+
+      const uint8_t *leaf_key = leaf->GetKey();
+      int low_cmp = (child_low == nullptr)
+                        ? 1
+                        : CompareKeys(leaf_key, leaf->key_length, *child_low);
+      int high_cmp = (child_high == nullptr)
+                         ? -1
+                         : CompareKeys(leaf_key, leaf->key_length, *child_high);
+      bool in_range = (context.low_exclusive ? low_cmp > 0 : low_cmp >= 0) &&
+                      (context.high_exclusive ? high_cmp < 0 : high_cmp <= 0);
+      std::vector<ValueType> &result = *context.result;
+      size_t size_before = result.size();
+      if (in_range) {
+        ValueArray *values = leaf->values.load();
+        result.insert(result.end(), values->GetValues(),
+                      values->GetValues() + values->count);
+        if (context.last_key != nullptr && values->count != 0) {
+          context.last_key->Assign(leaf_key, leaf->key_length);
+        }
+      }
+      CheckOrRestart(leaf, leaf_version, need_restart);
+      if (need_restart) {
+        result.resize(size_before);
+        return false;
+      }
+    }
+
+    if (context.result->size() >= context.max_result_size) break;
+  }
+  return true;
+}
+
+//===--------------------------------------------------------------------===//
+// Epoch based reclamation
+//===--------------------------------------------------------------------===//
+
+uint64_t ArtTree::JoinEpoch() const {
+  while (true) {
+    uint64_t epoch = global_epoch_.load();
+    active_threads_[epoch % EPOCH_SLOT_COUNT].fetch_add(1);
+    // The epoch may have advanced before the thread became visible
+    if (global_epoch_.load() == epoch) return epoch;
+    active_threads_[epoch % EPOCH_SLOT_COUNT].fetch_sub(1);
+  }
+}
+
+void ArtTree::LeaveEpoch(uint64_t epoch) const {
+  active_threads_[epoch % EPOCH_SLOT_COUNT].fetch_sub(1);
+}
+
+void ArtTree::Retire(Node *node) {
+  Retire(new GarbageNode{node, nullptr, nullptr});
+}
+
+void ArtTree::Retire(ValueArray *values) {
+  Retire(new GarbageNode{nullptr, values, nullptr});
+}
+
+void ArtTree::Retire(GarbageNode *garbage) {
+  // Tag the garbage with the epoch at the time it has become unreachable
+  uint64_t epoch = global_epoch_.load();
+  auto &list = garbage_lists_[epoch % EPOCH_SLOT_COUNT];
+  garbage->next = list.load();
+  while (list.compare_exchange_weak(garbage->next, garbage) == false) {
+  }
+
+  if (garbage_count_.fetch_add(1) + 1 >= GC_THRESHOLD) {
+    PerformGarbageCollection();
+  }
+}
+
+/*
+ * PerformGarbageCollection() - Advance the epoch if possible
+ *
+ * Moving from epoch e to e + 1 requires that no thread is left in e - 1.
+ * All garbage tagged with e - 1 then is unreachable for every thread and is
+ * freed. Its slot is reused by epoch e + 2.
+ */
+void ArtTree::PerformGarbageCollection() {
+  if (gc_lock_.test_and_set()) return;
+
+  uint64_t epoch = global_epoch_.load();
+  uint64_t previous_slot = (epoch + EPOCH_SLOT_COUNT - 1) % EPOCH_SLOT_COUNT;
+  if (active_threads_[previous_slot].load() == 0) {
+    global_epoch_.store(epoch + 1);
+    FreeGarbageList(garbage_lists_[previous_slot].exchange(nullptr));
+  }
+
+  gc_lock_.clear();
+}
+
+void ArtTree::FreeGarbageList(GarbageNode *garbage) {
+  while (garbage != nullptr) {
+    GarbageNode *next = garbage->next;
+    if (garbage->node != nullptr) {
+      FreeNode(garbage->node);
+    } else {
+      memory_footprint_.fetch_sub(ValueArray::GetSize(garbage->values->count));
+      ::operator delete(garbage->values);
+    }
+    delete garbage;
+    garbage_count_.fetch_sub(1);
+    garbage = next;
+  }
+}
+
+}  // End index namespace
+}  // End peloton namespace
@@ -0,0 +1,425 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// art_index.cpp
+//
+// Identification: src/index/art_index.cpp
+//
+// Copyright (c) 2015-17, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "index/art_index.h"
+
+#include <type_traits>
+
+#include "common/logger.h"
+#include "index/scan_optimizer.h"
+#include "statistics/stats_aggregator.h"
+#include "storage/tuple.h"
+
+namespace peloton {
+namespace index {
+
+// Markers of the variable length encoding. NULL sorts after all strings
+static constexpr uint8_t ART_VARLEN_MARKER = 0x01;
+static constexpr uint8_t ART_VARLEN_NULL = 0x02;
+static constexpr uint8_t ART_VARLEN_ESCAPE = 0xFF;
+
+/*
+ * AppendBigEndian() - Append the bytes of an unsigned integer, most
+ *                     significant byte first
+ */
+template <typename UnsignedType>
+static inline void AppendBigEndian(ArtKey &art_key, UnsignedType value) {
+  for (int shift = (sizeof(UnsignedType) - 1) * 8; shift >= 0; shift -= 8) {
+    art_key.Append(static_cast<uint8_t>(value >> shift));
+  }
+}
+
+/*
+ * AppendSigned() - Flip the sign bit so that negative numbers sort first
+ */
+template <typename SignedType>
+static inline void AppendSigned(ArtKey &art_key, SignedType value) {
+  using UnsignedType = typename std::make_unsigned<SignedType>::type;
+  UnsignedType bits = static_cast<UnsignedType>(value);
+  bits ^= static_cast<UnsignedType>(1) << (sizeof(UnsignedType) * 8 - 1);
+  AppendBigEndian(art_key, bits);
+}
+
+namespace {
+
+/*
+ * class ArtScanIterator - Walks a key range of the tree batch by batch
+ *
+ * Each batch restarts from the root after the last leaf of the previous one,
+ * so no node is referenced between calls and writers are never blocked.
+ */
+class ArtScanIterator : public IndexScanIterator {
+ public:
+  ArtScanIterator(const ArtTree &container, IndexMetadata *metadata,
+                  bool forward)
+      : container_(container),
+        metadata_(metadata),
+        forward_(forward),
+        has_low_key_(false),
+        has_high_key_(false),
+        low_exclusive_(false),
+        high_exclusive_(false),
+        exhausted_(false) {}
+
+  ArtKey &GetLowKey() {
+    has_low_key_ = true;
+    return low_key_;
+  }
+
+  ArtKey &GetHighKey() {
+    has_high_key_ = true;
+    return high_key_;
+  }
+
+  size_t Next(std::vector<ItemPointer *> &result, size_t max_count) {
+    if (exhausted_ == true || max_count == 0) return 0;
+
+    size_t count = container_.ScanBatch(
+        has_low_key_ ? &low_key_ : nullptr, low_exclusive_,
+        has_high_key_ ? &high_key_ : nullptr, high_exclusive_, forward_,
+        max_count, result, last_key_);
+    if (count == 0) {
+      exhausted_ = true;
+      return 0;
+    }
+
+    // Continue after the last leaf
+    if (forward_ == true) {
+      GetLowKey().Assign(last_key_.GetData(), last_key_.GetLength());
+      low_exclusive_ = true;
+    } else {
+      GetHighKey().Assign(last_key_.GetData(), last_key_.GetLength());
+      high_exclusive_ = true;
+    }
+
+    if (FLAGS_stats_mode != STATS_TYPE_INVALID) {
+      stats::BackendStatsContext::GetInstance()->IncrementIndexReads(
+          count, metadata_);
+    }
+
+    return count;
+  }
+
+ private:
+  const ArtTree &container_;
+  IndexMetadata *metadata_;
+  bool forward_;
+  ArtKey low_key_;
+  ArtKey high_key_;
+  ArtKey last_key_;
+  bool has_low_key_;
+  bool has_high_key_;
+  bool low_exclusive_;
+  bool high_exclusive_;
+  bool exhausted_;
+};
+
+}  // namespace
+
+ArtIndex::ArtIndex(IndexMetadata *metadata)
+    :  // Base class
+      Index{metadata},
+      container{} {
+  return;
+}
+
+ArtIndex::~ArtIndex() {}
+
+bool ArtIndex::IsSupportedKeyType(type::Type::TypeId type_id) {
+  switch (type_id) {
+    case type::Type::BOOLEAN:
+    case type::Type::TINYINT:
+    case type::Type::SMALLINT:
+    case type::Type::INTEGER:
+    case type::Type::BIGINT:
+    case type::Type::DECIMAL:
+    case type::Type::TIMESTAMP:
+    case type::Type::VARCHAR:
+    case type::Type::VARBINARY:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/*
+ * EncodeKey() - Builds the binary comparable key from a key tuple
+ *
+ * Fixed length columns are read directly from the tuple; only variable
+ * length columns go through a Value.
+ */
+void ArtIndex::EncodeKey(const storage::Tuple *key, ArtKey &art_key) const {
+  const catalog::Schema *key_schema = metadata->GetKeySchema();
+  art_key.Clear();
+
+  for (oid_t column_id = 0; column_id < key_schema->GetColumnCount();
+       column_id++) {
+    switch (key_schema->GetType(column_id)) {
+      case type::Type::BOOLEAN:
+      case type::Type::TINYINT:
+        AppendSigned(art_key, key->GetInlinedDataOfType<int8_t>(column_id));
+        break;
+      case type::Type::SMALLINT:
+        AppendSigned(art_key, key->GetInlinedDataOfType<int16_t>(column_id));
+        break;
+      case type::Type::INTEGER:
+        AppendSigned(art_key, key->GetInlinedDataOfType<int32_t>(column_id));
+        break;
+      case type::Type::BIGINT:
+        AppendSigned(art_key, key->GetInlinedDataOfType<int64_t>(column_id));
+        break;
+      case type::Type::TIMESTAMP:
+        AppendBigEndian(art_key,
+                        key->GetInlinedDataOfType<uint64_t>(column_id));
+        break;
+      case type::Type::DECIMAL: {
+        double value = key->GetInlinedDataOfType<double>(column_id);
+        uint64_t bits;
+        PL_MEMCPY(&bits, &value, sizeof(bits));
+        // Negative numbers sort in reverse order of their magnitude
+        if ((bits >> 63) != 0) {
+          bits = ~bits;
+        } else {
+          bits |= static_cast<uint64_t>(1) << 63;
+        }
+        AppendBigEndian(art_key, bits);
+        break;
+      }
+      case type::Type::VARCHAR:
+      case type::Type::VARBINARY: {
+        type::Value value = key->GetValue(column_id);
+        if (value.IsNull()) {
+          art_key.Append(ART_VARLEN_NULL);
+          break;
+        }
+        art_key.Append(ART_VARLEN_MARKER);
+        auto data = reinterpret_cast<const uint8_t *>(value.GetData());
+        uint32_t length = value.GetLength();
+        // VARCHAR values carry their null terminator in the length
+        if (key_schema->GetType(column_id) == type::Type::VARCHAR &&
+            length > 0 && data[length - 1] == '\0') {
+          length--;
+        }
+        for (uint32_t i = 0; i < length; i++) {
+          art_key.Append(data[i]);
+          if (data[i] == 0x00) art_key.Append(ART_VARLEN_ESCAPE);
+        }
+        art_key.Append(0x00);
+        art_key.Append(0x00);
+        break;
+      }
+      default:
+        throw IndexException("Unsupported key type for ART index " +
+                             metadata->GetName());
+    }
+  }
+}
+
+/*
+ * InsertEntry() - insert a key-value pair into the map
+ *
+ * If the key value pair already exists in the map, just return false
+ */
+bool ArtIndex::InsertEntry(const storage::Tuple *key, ItemPointer *value) {
+  ArtKey index_key;
+  EncodeKey(key, index_key);
+
+  bool ret = container.Insert(index_key, value);
+
+  if (FLAGS_stats_mode != STATS_TYPE_INVALID) {
+    stats::BackendStatsContext::GetInstance()->IncrementIndexInserts(metadata);
+  }
+
+  return ret;
+}
+
+/*
+ * DeleteEntry() - Removes a key-value pair
+ *
+ * If the key-value pair does not exists yet in the map return false
+ */
+bool ArtIndex::DeleteEntry(const storage::Tuple *key, ItemPointer *value) {
+  ArtKey index_key;
+  EncodeKey(key, index_key);
+
+  bool ret = container.Delete(index_key, value);
+
+  if (FLAGS_stats_mode != STATS_TYPE_INVALID) {
+    stats::BackendStatsContext::GetInstance()->IncrementIndexDeletes(
+        ret ? 1 : 0, metadata);
+  }
+  return ret;
+}
+
+bool ArtIndex::CondInsertEntry(const storage::Tuple *key, ItemPointer *value,
+                               std::function<bool(const void *)> predicate) {
+  ArtKey index_key;
+  EncodeKey(key, index_key);
+
+  bool predicate_satisfied = false;
+
+  // The predicate is evaluated on the existing values under the lock of the
+  // leaf, so checking and inserting happen in one step
+  bool ret = container.ConditionalInsert(index_key, value, predicate,
+                                         &predicate_satisfied);
+
+  if (FLAGS_stats_mode != STATS_TYPE_INVALID) {
+    stats::BackendStatsContext::GetInstance()->IncrementIndexInserts(metadata);
+  }
+
+  return ret;
+}
+
+/*
+ * Scan() - Scans a range inside the index using index scan optimizer
+ *
+ * Unlike the BwTree the ART can walk its keys in both directions, so the
+ * scan direction is honored.
+ */
+void ArtIndex::Scan(UNUSED_ATTRIBUTE const std::vector<type::Value> &values,
+                    UNUSED_ATTRIBUTE const std::vector<oid_t> &key_column_ids,
+                    UNUSED_ATTRIBUTE const std::vector<ExpressionType> &expr_types,
+                    ScanDirectionType scan_direction,
+                    std::vector<ValueType> &result,
+                    const ConjunctionScanPredicate *csp_p) {
+  if (scan_direction == SCAN_DIRECTION_TYPE_INVALID) {
+    throw Exception("Invalid scan direction \n");
+  }
+  bool forward = (scan_direction == SCAN_DIRECTION_TYPE_FORWARD);
+
+  LOG_TRACE("Scan() Point Query = %d; Full Scan = %d ", csp_p->IsPointQuery(),
+            csp_p->IsFullIndexScan());
+
+  if (csp_p->IsPointQuery() == true) {
+    ArtKey point_query_key;
+    EncodeKey(csp_p->GetPointQueryKey(), point_query_key);
+
+    container.Lookup(point_query_key, result);
+  } else if (csp_p->IsFullIndexScan() == true) {
+    container.ScanRange(nullptr, nullptr, forward, 0, result);
+  } else {
+    ArtKey index_low_key;
+    ArtKey index_high_key;
+    EncodeKey(csp_p->GetLowKey(), index_low_key);
+    EncodeKey(csp_p->GetHighKey(), index_high_key);
+
+    container.ScanRange(&index_low_key, &index_high_key, forward, 0, result);
+  }
+
+  if (FLAGS_stats_mode != STATS_TYPE_INVALID) {
+    stats::BackendStatsContext::GetInstance()->IncrementIndexReads(
+        result.size(), metadata);
+  }
+
+  return;
+}
+
+/*
+ * ScanLimit() - Scan the index with predicate and limit/offset
+ *
+ * As with the BwTree, only limit == 1 and offset == 0 on a forward scan is
+ * pushed into the tree, since the index cannot check visibility or the non
+ * exact bounds of the predicate.
+ */
+void ArtIndex::ScanLimit(const std::vector<type::Value> &values,
+                         const std::vector<oid_t> &key_column_ids,
+                         const std::vector<ExpressionType> &expr_types,
+                         ScanDirectionType scan_direction,
+                         std::vector<ValueType> &result,
+                         const ConjunctionScanPredicate *csp_p, uint64_t limit,
+                         uint64_t offset) {
+  if (csp_p->IsPointQuery() == false && limit == 1 && offset == 0 &&
+      scan_direction == SCAN_DIRECTION_TYPE_FORWARD) {
+    ArtKey index_low_key;
+    ArtKey index_high_key;
+    EncodeKey(csp_p->GetLowKey(), index_low_key);
+    EncodeKey(csp_p->GetHighKey(), index_high_key);
+
+    container.ScanRange(&index_low_key, &index_high_key, true, 1, result);
+  } else {
+    Scan(values, key_column_ids, expr_types, scan_direction, result, csp_p);
+  }
+
+  return;
+}
+
+/*
+ * GetScanIterator() - Pull based scan in either direction
+ *
+ * Point queries touch a single leaf and are looked up at once.
+ */
+std::unique_ptr<IndexScanIterator> ArtIndex::GetScanIterator(
+    const std::vector<type::Value> &value_list,
+    const std::vector<oid_t> &tuple_column_id_list,
+    const std::vector<ExpressionType> &expr_list,
+    ScanDirectionType scan_direction, const ConjunctionScanPredicate *csp_p) {
+  if (scan_direction == SCAN_DIRECTION_TYPE_INVALID) {
+    throw Exception("Invalid scan direction \n");
+  }
+
+  if (csp_p->IsPointQuery() == true) {
+    return Index::GetScanIterator(value_list, tuple_column_id_list, expr_list,
+                                  scan_direction, csp_p);
+  }
+
+  auto iterator = new ArtScanIterator(
+      container, metadata, scan_direction == SCAN_DIRECTION_TYPE_FORWARD);
+  std::unique_ptr<IndexScanIterator> ret(iterator);
+  if (csp_p->IsFullIndexScan() == false) {
+    EncodeKey(csp_p->GetLowKey(), iterator->GetLowKey());
+    EncodeKey(csp_p->GetHighKey(), iterator->GetHighKey());
+  }
+
+  return ret;
+}
+
+void ArtIndex::ScanCovering(
+    UNUSED_ATTRIBUTE const std::vector<type::Value> &values,
+    UNUSED_ATTRIBUTE const std::vector<oid_t> &key_column_ids,
+    UNUSED_ATTRIBUTE const std::vector<ExpressionType> &expr_types,
+    UNUSED_ATTRIBUTE ScanDirectionType scan_direction,
+    UNUSED_ATTRIBUTE std::vector<ValueType> &result,
+    UNUSED_ATTRIBUTE std::vector<char> &payloads,
+    UNUSED_ATTRIBUTE const ConjunctionScanPredicate *csp_p) {
+  throw IndexException("Index " + metadata->GetName() +
+                       " does not support index-only scans");
+}
+
+void ArtIndex::ScanAllKeys(std::vector<ValueType> &result) {
+  container.ScanRange(nullptr, nullptr, true, 0, result);
+
+  if (FLAGS_stats_mode != STATS_TYPE_INVALID) {
+    stats::BackendStatsContext::GetInstance()->IncrementIndexReads(
+        result.size(), metadata);
+  }
+  return;
+}
+
+void ArtIndex::ScanKey(const storage::Tuple *key,
+                       std::vector<ValueType> &result) {
+  ArtKey index_key;
+  EncodeKey(key, index_key);
+
+  container.Lookup(index_key, result);
+
+  if (FLAGS_stats_mode != STATS_TYPE_INVALID) {
+    stats::BackendStatsContext::GetInstance()->IncrementIndexReads(
+        result.size(), metadata);
+  }
+
+  return;
+}
+
+std::string ArtIndex::GetTypeName() const { return "ART"; }
+
+}  // End index namespace
+}  // End peloton namespace
@@ -12,6 +12,7 @@
 #include "index/bwtree_index.h"
 
 #include "common/logger.h"
+#include "configuration/configuration.h"
 #include "index/index_key.h"
 #include "index/scan_optimizer.h"
 #include "statistics/stats_aggregator.h"
@@ -20,6 +21,46 @@
 namespace peloton {
 namespace index {
 
+/*
+ * SetIndexKey() - Builds the index key from a key tuple
+ *
+ * Key tuples of covering indexes carry the INCLUDE columns after the key
+ * columns. Only generic keys have room for such a payload; they copy the
+ * whole tuple but keep comparing, hashing and checking equality on the key
+ * schema only, so the payload never takes part in ordering or uniqueness.
+ */
+template <typename KeyType>
+static inline void SetIndexKey(KeyType &index_key, const storage::Tuple *key,
+                               const catalog::Schema *) {
+  index_key.SetFromKey(key);
+}
+
+template <std::size_t KeySize>
+static inline void SetIndexKey(GenericKey<KeySize> &index_key,
+                               const storage::Tuple *key,
+                               const catalog::Schema *key_schema) {
+  index_key.SetFromKey(key);
+  index_key.schema = key_schema;
+}
+
+/*
+ * CopyCoveringPayload() - Copies the covering tuple out of an index key
+ *
+ * Returns false if the key type does not keep the tuple layout
+ */
+template <typename KeyType>
+static inline bool CopyCoveringPayload(const KeyType &, char *, size_t) {
+  return false;
+}
+
+template <std::size_t KeySize>
+static inline bool CopyCoveringPayload(const GenericKey<KeySize> &index_key,
+                                       char *payload, size_t payload_size) {
+  PL_ASSERT(payload_size <= KeySize);
+  PL_MEMCPY(payload, index_key.data, payload_size);
+  return true;
+}
+
 BWTREE_TEMPLATE_ARGUMENTS
 BWTREE_INDEX_TYPE::BWTreeIndex(IndexMetadata *metadata)
     :  // Base class
@@ -36,6 +77,10 @@ BWTREE_INDEX_TYPE::BWTreeIndex(IndexMetadata *metadata)
       // NOTE 2: We set the first parameter to false to disable automatic GC
       //
       container{false, comparator, equals, hash_func} {
+  if (FLAGS_index_key_filter == true) {
+    key_filter.reset(new KeyFilter(0));
+  }
+
   return;
 }
 
@@ -51,10 +96,14 @@ BWTREE_TEMPLATE_ARGUMENTS
 bool BWTREE_INDEX_TYPE::InsertEntry(const storage::Tuple *key,
                                     ItemPointer *value) {
   KeyType index_key;
-  index_key.SetFromKey(key);
+  SetIndexKey(index_key, key, metadata->GetKeySchema());
 
   bool ret = container.Insert(index_key, value);
 
+  if ((ret == true) && (key_filter != nullptr)) {
+    InsertIntoKeyFilter(index_key);
+  }
+
   if (FLAGS_stats_mode != STATS_TYPE_INVALID) {
     stats::BackendStatsContext::GetInstance()->IncrementIndexInserts(metadata);
   }
@@ -71,13 +120,23 @@ BWTREE_TEMPLATE_ARGUMENTS
 bool BWTREE_INDEX_TYPE::DeleteEntry(const storage::Tuple *key,
                                     ItemPointer *value) {
   KeyType index_key;
-  index_key.SetFromKey(key);
+  SetIndexKey(index_key, key, metadata->GetKeySchema());
   size_t delete_count = 0;
 
   // In Delete() since we just use the value for comparison (i.e. read-only)
   // it is unnecessary for us to allocate memory
   bool ret = container.Delete(index_key, value);
 
+  // Entries are only deleted by the garbage collector once their versions
+  // are dead, so it is also the one that rebuilds the filter when too many
+  // of its keys have become stale
+  if ((ret == true) && (key_filter != nullptr)) {
+    key_filter->Remove();
+    if (key_filter->NeedRebuild() == true) {
+      RebuildKeyFilter();
+    }
+  }
+
   if (FLAGS_stats_mode != STATS_TYPE_INVALID) {
     stats::BackendStatsContext::GetInstance()->IncrementIndexDeletes(
         delete_count, metadata);
@@ -90,7 +149,7 @@ bool BWTREE_INDEX_TYPE::CondInsertEntry(
     const storage::Tuple *key, ItemPointer *value,
     std::function<bool(const void *)> predicate) {
   KeyType index_key;
-  index_key.SetFromKey(key);
+  SetIndexKey(index_key, key, metadata->GetKeySchema());
 
   bool predicate_satisfied = false;
 
@@ -108,6 +167,13 @@ bool BWTREE_INDEX_TYPE::CondInsertEntry(
     assert(ret == false);
   }
 
+  // NOTE: The uniqueness check cannot consult the key filter. It has to
+  // happen atomically with the insert on the leaf delta chain, which the
+  // tree traverses to anyway
+  if ((ret == true) && (key_filter != nullptr)) {
+    InsertIntoKeyFilter(index_key);
+  }
+
   if (FLAGS_stats_mode != STATS_TYPE_INVALID) {
     stats::BackendStatsContext::GetInstance()->IncrementIndexInserts(metadata);
   }
@@ -115,6 +181,143 @@ bool BWTREE_INDEX_TYPE::CondInsertEntry(
   return ret;
 }
 
+/*
+ * KeySatisfiesPredicate() - Checks an index key against the scan predicate
+ *
+ * Tuple keys only point to the tuple they were built from, so they are
+ * never checked here and are left to the caller
+ */
+template <typename KeyType>
+static inline bool KeySatisfiesPredicate(
+    Index *index, const KeyType &index_key,
+    const std::vector<type::Value> &value_list,
+    const std::vector<oid_t> &tuple_column_id_list,
+    const std::vector<ExpressionType> &expr_list) {
+  // GetTupleForComparison() of generic keys is not const, though it only
+  // wraps the key data
+  const storage::Tuple key_tuple =
+      const_cast<KeyType &>(index_key)
+          .GetTupleForComparison(index->GetMetadata()->GetKeySchema());
+  return index->Compare(key_tuple, tuple_column_id_list, expr_list,
+                        value_list);
+}
+
+static inline bool KeySatisfiesPredicate(
+    Index *, const TupleKey &, const std::vector<type::Value> &,
+    const std::vector<oid_t> &, const std::vector<ExpressionType> &) {
+  return true;
+}
+
+/*
+ * class BWTreeScanIterator - Pulls a key range out of the BwTree
+ *
+ * The BwTree iterator works on a private copy of the current leaf, so it can
+ * be kept between calls without pinning any part of the tree. Forward scans
+ * stop after the high key and backward scans before the low key. Keys that
+ * are inside the scan range but do not satisfy the predicate are skipped,
+ * unless the range is known to be exact.
+ */
+template <typename KeyType, typename MapType>
+class BWTreeScanIterator : public IndexScanIterator {
+ public:
+  BWTreeScanIterator(Index *index, MapType &container,
+                     const typename MapType::ForwardIterator &scan_itr,
+                     bool forward, const KeyType *end_key,
+                     const std::vector<type::Value> &value_list,
+                     const std::vector<oid_t> &tuple_column_id_list,
+                     const std::vector<ExpressionType> &expr_list,
+                     bool check_predicate)
+      : index_(index),
+        container_(container),
+        scan_itr_(scan_itr),
+        forward_(forward),
+        has_end_key_(end_key != nullptr),
+        value_list_(value_list),
+        tuple_column_id_list_(tuple_column_id_list),
+        expr_list_(expr_list),
+        check_predicate_(check_predicate),
+        exhausted_(false) {
+    if (end_key != nullptr) {
+      end_key_ = *end_key;
+    }
+  }
+
+  size_t Next(std::vector<ItemPointer *> &result, size_t max_count) {
+    size_t count = 0;
+    while (count < max_count && exhausted_ == false) {
+      if ((forward_ == true && scan_itr_.IsEnd() == true) ||
+          (forward_ == false && scan_itr_.IsREnd() == true) ||
+          PastEndKey() == true) {
+        // Drop the buffered leaf page, it is not needed any more
+        exhausted_ = true;
+        scan_itr_ = typename MapType::ForwardIterator();
+        break;
+      }
+
+      if (check_predicate_ == false ||
+          KeySatisfiesPredicate(index_, scan_itr_->first, value_list_,
+                                tuple_column_id_list_, expr_list_) == true) {
+        result.push_back(scan_itr_->second);
+        count++;
+      }
+
+      if (forward_ == true) {
+        ++scan_itr_;
+      } else {
+        --scan_itr_;
+      }
+    }
+
+    if (FLAGS_stats_mode != STATS_TYPE_INVALID) {
+      stats::BackendStatsContext::GetInstance()->IncrementIndexReads(
+          count, index_->GetMetadata());
+    }
+
+    return count;
+  }
+
+ private:
+  inline bool PastEndKey() {
+    if (has_end_key_ == false) return false;
+
+    if (forward_ == true) {
+      return container_.KeyCmpLessEqual(scan_itr_->first, end_key_) == false;
+    }
+    return container_.KeyCmpLess(scan_itr_->first, end_key_);
+  }
+
+  Index *index_;
+  MapType &container_;
+  typename MapType::ForwardIterator scan_itr_;
+  bool forward_;
+  bool has_end_key_;
+  KeyType end_key_;
+  std::vector<type::Value> value_list_;
+  std::vector<oid_t> tuple_column_id_list_;
+  std::vector<ExpressionType> expr_list_;
+  bool check_predicate_;
+  bool exhausted_;
+};
+
+/*
+ * GetMaxKey() - Builds a key no lower than any key in the index
+ *
+ * Every key column gets the maximum value of its type, as the scan optimizer
+ * does for a missing upper bound.
+ */
+BWTREE_TEMPLATE_ARGUMENTS
+void BWTREE_INDEX_TYPE::GetMaxKey(KeyType &index_key) {
+  auto key_schema = metadata->GetKeySchema();
+  storage::Tuple max_key(key_schema, true);
+  for (oid_t column_itr = 0; column_itr < key_schema->GetColumnCount();
+       column_itr++) {
+    type::Value max_value(
+        type::Type::GetMaxValue(key_schema->GetType(column_itr)));
+    max_key.SetValue(column_itr, max_value, GetPool());
+  }
+  SetIndexKey(index_key, &max_key, key_schema);
+}
+
 /*
  * Scan() - Scans a range inside the index using index scan optimizer
  *
@@ -130,10 +333,10 @@ void BWTREE_INDEX_TYPE::Scan(
     ScanDirectionType scan_direction, 
     std::vector<ValueType> &result,
     const ConjunctionScanPredicate *csp_p) {
-  // This is a hack - we do not support backward scan
   if (scan_direction == SCAN_DIRECTION_TYPE_INVALID) {
     throw Exception("Invalid scan direction \n");
   }
+  bool forward = (scan_direction == SCAN_DIRECTION_TYPE_FORWARD);
 
   LOG_TRACE("Scan() Point Query = %d; Full Scan = %d ", 
             csp_p->IsPointQuery(),
@@ -149,15 +352,27 @@ void BWTREE_INDEX_TYPE::Scan(
     // (slightly less code), but since ScanKey() is a virtual function
     // this would induce an overhead for point query, which must be highly
     // optimized and super fast
-    container.GetValue(point_query_key, result);
+    if (MayContainKey(point_query_key) == true) {
+      container.GetValue(point_query_key, result);
+    }
   } else if (csp_p->IsFullIndexScan() == true) {
-    // If it is a full index scan, then just do the scan
-    // until we have reached the end of the index by the same
-    // we take the snapshot of the last leaf node
-    for (auto scan_itr = container.Begin(); (scan_itr.IsEnd() == false);
-         scan_itr++) {
-      result.push_back(scan_itr->second);
-    }  // for it from begin() to end()
+    if (forward == true) {
+      // If it is a full index scan, then just do the scan
+      // until we have reached the end of the index by the same
+      // we take the snapshot of the last leaf node
+      for (auto scan_itr = container.Begin(); (scan_itr.IsEnd() == false);
+           scan_itr++) {
+        result.push_back(scan_itr->second);
+      }  // for it from begin() to end()
+    } else {
+      // Walk back from the last key of the index
+      KeyType index_max_key;
+      GetMaxKey(index_max_key);
+      for (auto scan_itr = container.ReverseBegin(index_max_key);
+           (scan_itr.IsREnd() == false); scan_itr--) {
+        result.push_back(scan_itr->second);
+      }
+    }
   } else {
     const storage::Tuple *low_key_p = csp_p->GetLowKey();
     const storage::Tuple *high_key_p = csp_p->GetHighKey();
@@ -172,15 +387,26 @@ void BWTREE_INDEX_TYPE::Scan(
     index_low_key.SetFromKey(low_key_p);
     index_high_key.SetFromKey(high_key_p);
 
-    // We use bwtree Begin() to first reach the lower bound
-    // of the search key
-    // Also we keep scanning until we have reached the end of the index
-    // or we have seen a key higher than the high key
-    for (auto scan_itr = container.Begin(index_low_key);
-         (scan_itr.IsEnd() == false) &&
-             (container.KeyCmpLessEqual(scan_itr->first, index_high_key));
-         scan_itr++) {
-      result.push_back(scan_itr->second);
+    if (forward == true) {
+      // We use bwtree Begin() to first reach the lower bound
+      // of the search key
+      // Also we keep scanning until we have reached the end of the index
+      // or we have seen a key higher than the high key
+      for (auto scan_itr = container.Begin(index_low_key);
+           (scan_itr.IsEnd() == false) &&
+               (container.KeyCmpLessEqual(scan_itr->first, index_high_key));
+           scan_itr++) {
+        result.push_back(scan_itr->second);
+      }
+    } else {
+      // Walk back from the last key within the high key until we have seen
+      // a key lower than the low key
+      for (auto scan_itr = container.ReverseBegin(index_high_key);
+           (scan_itr.IsREnd() == false) &&
+               (container.KeyCmpGreaterEqual(scan_itr->first, index_low_key));
+           scan_itr--) {
+        result.push_back(scan_itr->second);
+      }
     }
   }  // if is full scan
 
@@ -218,6 +444,23 @@ void BWTREE_INDEX_TYPE::ScanLimit(
   // the index just fetches the first qualified key without further checking
   // including checking for non-exact bounds!!!
   if(csp_p->IsPointQuery() == false && \
+     csp_p->IsFullIndexScan() == false && \
+     limit == 1 && \
+     offset == 0 && \
+     scan_direction == SCAN_DIRECTION_TYPE_BACKWARD) {
+    // Same as below, but "max" walking back from the high key
+    KeyType index_low_key;
+    KeyType index_high_key;
+    index_low_key.SetFromKey(csp_p->GetLowKey());
+    index_high_key.SetFromKey(csp_p->GetHighKey());
+
+    auto scan_itr = container.ReverseBegin(index_high_key);
+    if((scan_itr.IsREnd() == false) && \
+       (container.KeyCmpGreaterEqual(scan_itr->first, index_low_key))) {
+
+      result.push_back(scan_itr->second);
+    }
+  } else if(csp_p->IsPointQuery() == false && \
      limit == 1 && \
      offset == 0 && \
      scan_direction == SCAN_DIRECTION_TYPE_FORWARD) {
@@ -299,6 +542,134 @@ void BWTREE_INDEX_TYPE::ScanLimit(
   return;
 }
 
+/*
+ * GetScanIterator() - Pull based scan using the BwTree iterator
+ *
+ * Point queries are answered at once. Backward full scans walk back from a
+ * key made of the maximum value of every key column.
+ */
+BWTREE_TEMPLATE_ARGUMENTS
+std::unique_ptr<IndexScanIterator> BWTREE_INDEX_TYPE::GetScanIterator(
+    const std::vector<type::Value> &value_list,
+    const std::vector<oid_t> &tuple_column_id_list,
+    const std::vector<ExpressionType> &expr_list,
+    ScanDirectionType scan_direction, const ConjunctionScanPredicate *csp_p) {
+  if (scan_direction == SCAN_DIRECTION_TYPE_INVALID) {
+    throw Exception("Invalid scan direction \n");
+  }
+  bool forward = (scan_direction == SCAN_DIRECTION_TYPE_FORWARD);
+
+  if (csp_p->IsPointQuery() == true) {
+    return Index::GetScanIterator(value_list, tuple_column_id_list, expr_list,
+                                  scan_direction, csp_p);
+  }
+
+  using IteratorType = BWTreeScanIterator<KeyType, MapType>;
+
+  if (csp_p->IsFullIndexScan() == true && forward == true) {
+    return std::unique_ptr<IndexScanIterator>(new IteratorType(
+        this, container, container.Begin(), true, nullptr, value_list,
+        tuple_column_id_list, expr_list, value_list.empty() == false));
+  } else if (csp_p->IsFullIndexScan() == true) {
+    KeyType index_max_key;
+    GetMaxKey(index_max_key);
+    return std::unique_ptr<IndexScanIterator>(new IteratorType(
+        this, container, container.ReverseBegin(index_max_key), false,
+        nullptr, value_list, tuple_column_id_list, expr_list,
+        value_list.empty() == false));
+  }
+
+  KeyType index_low_key;
+  KeyType index_high_key;
+  index_low_key.SetFromKey(csp_p->GetLowKey());
+  index_high_key.SetFromKey(csp_p->GetHighKey());
+  bool check_predicate =
+      (IsExactScanRange(tuple_column_id_list, expr_list) == false);
+
+  if (forward == true) {
+    return std::unique_ptr<IndexScanIterator>(new IteratorType(
+        this, container, container.Begin(index_low_key), true,
+        &index_high_key, value_list, tuple_column_id_list, expr_list,
+        check_predicate));
+  }
+
+  return std::unique_ptr<IndexScanIterator>(new IteratorType(
+      this, container, container.ReverseBegin(index_high_key), false,
+      &index_low_key, value_list, tuple_column_id_list, expr_list,
+      check_predicate));
+}
+
+/*
+ * ScanCovering() - Scans a range inside the index and returns the covering
+ *                  tuples along with the locations
+ *
+ * This is the index-only flavor of Scan(). Point queries are answered by
+ * iterating from the point key as well, since GetValue() does not return
+ * the stored keys
+ */
+BWTREE_TEMPLATE_ARGUMENTS
+void BWTREE_INDEX_TYPE::ScanCovering(
+    UNUSED_ATTRIBUTE const std::vector<type::Value> &value_list,
+    UNUSED_ATTRIBUTE const std::vector<oid_t> &tuple_column_id_list,
+    UNUSED_ATTRIBUTE const std::vector<ExpressionType> &expr_list,
+    ScanDirectionType scan_direction,
+    std::vector<ValueType> &result,
+    std::vector<char> &payloads,
+    const ConjunctionScanPredicate *csp_p) {
+  if (scan_direction == SCAN_DIRECTION_TYPE_INVALID) {
+    throw Exception("Invalid scan direction \n");
+  }
+
+  const size_t payload_size = metadata->GetCoveringSchema()->GetLength();
+
+  auto append_entry = [&](const KeyType &index_key, ValueType value) {
+    size_t payload_offset = payloads.size();
+    payloads.resize(payload_offset + payload_size);
+    if (CopyCoveringPayload(index_key, payloads.data() + payload_offset,
+                            payload_size) == false) {
+      throw IndexException("Index " + metadata->GetName() +
+                           " does not support index-only scans");
+    }
+    result.push_back(value);
+  };
+
+  if (csp_p->IsFullIndexScan() == true) {
+    for (auto scan_itr = container.Begin(); (scan_itr.IsEnd() == false);
+         scan_itr++) {
+      append_entry(scan_itr->first, scan_itr->second);
+    }
+  } else {
+    KeyType index_low_key;
+    KeyType index_high_key;
+
+    if (csp_p->IsPointQuery() == true) {
+      index_low_key.SetFromKey(csp_p->GetPointQueryKey());
+      index_high_key = index_low_key;
+    } else {
+      index_low_key.SetFromKey(csp_p->GetLowKey());
+      index_high_key.SetFromKey(csp_p->GetHighKey());
+    }
+
+    // Point queries for keys the filter rules out have nothing to scan
+    if ((csp_p->IsPointQuery() == false) ||
+        (MayContainKey(index_low_key) == true)) {
+      for (auto scan_itr = container.Begin(index_low_key);
+           (scan_itr.IsEnd() == false) &&
+               (container.KeyCmpLessEqual(scan_itr->first, index_high_key));
+           scan_itr++) {
+        append_entry(scan_itr->first, scan_itr->second);
+      }
+    }
+  }
+
+  if (FLAGS_stats_mode != STATS_TYPE_INVALID) {
+    stats::BackendStatsContext::GetInstance()->IncrementIndexReads(
+        result.size(), metadata);
+  }
+
+  return;
+}
+
 BWTREE_TEMPLATE_ARGUMENTS
 void BWTREE_INDEX_TYPE::ScanAllKeys(std::vector<ValueType> &result) {
   auto it = container.Begin();
@@ -323,7 +694,9 @@ void BWTREE_INDEX_TYPE::ScanKey(const storage::Tuple *key,
   index_key.SetFromKey(key);
 
   // This function in BwTree fills a given vector
-  container.GetValue(index_key, result);
+  if (MayContainKey(index_key) == true) {
+    container.GetValue(index_key, result);
+  }
 
   if (FLAGS_stats_mode != STATS_TYPE_INVALID) {
     stats::BackendStatsContext::GetInstance()->IncrementIndexReads(
@@ -333,6 +706,95 @@ void BWTREE_INDEX_TYPE::ScanKey(const storage::Tuple *key,
   return;
 }
 
+/*
+ * InsertIntoKeyFilter() - Adds a key to the filter after the tree
+ *
+ * The filter grows by being rebuilt once it holds more keys than it has
+ * been sized for; like a hash table resize, this is amortized over the
+ * inserts that filled it
+ */
+BWTREE_TEMPLATE_ARGUMENTS
+void BWTREE_INDEX_TYPE::InsertIntoKeyFilter(const KeyType &index_key) {
+  key_filter->Insert(hash_func(index_key));
+
+  if (key_filter->NeedRebuild() == true) {
+    RebuildKeyFilter();
+  }
+
+  return;
+}
+
+/*
+ * CollectKeyHashes() - Hashes every distinct key of the tree
+ *
+ * All values of a key are adjacent in key order, so every key is hashed
+ * only once
+ */
+BWTREE_TEMPLATE_ARGUMENTS
+void BWTREE_INDEX_TYPE::CollectKeyHashes(std::vector<uint64_t> &key_hashes) {
+  auto scan_itr = container.Begin();
+
+  while (scan_itr.IsEnd() == false) {
+    KeyType key = scan_itr->first;
+    key_hashes.push_back(hash_func(key));
+
+    do {
+      scan_itr++;
+    } while ((scan_itr.IsEnd() == false) &&
+             (container.KeyCmpEqual(scan_itr->first, key) == true));
+  }
+
+  return;
+}
+
+BWTREE_TEMPLATE_ARGUMENTS
+void BWTREE_INDEX_TYPE::EnableKeyFilter() {
+  if (key_filter != nullptr) {
+    return;
+  }
+
+  std::vector<uint64_t> key_hashes;
+  CollectKeyHashes(key_hashes);
+
+  std::unique_ptr<KeyFilter> filter(new KeyFilter(key_hashes.size()));
+  for (auto key_hash : key_hashes) {
+    filter->Insert(key_hash);
+  }
+
+  key_filter = std::move(filter);
+
+  return;
+}
+
+/*
+ * RebuildKeyFilter() - Builds a new filter from the keys in the tree
+ *
+ * Concurrent inserts and lookups keep going against the old filter while
+ * the tree is scanned. If another thread is already rebuilding the filter
+ * this returns right away
+ */
+BWTREE_TEMPLATE_ARGUMENTS
+void BWTREE_INDEX_TYPE::RebuildKeyFilter() {
+  if ((key_filter == nullptr) ||
+      (key_filter->BeginRebuild(key_filter->GetKeyCount()) == false)) {
+    return;
+  }
+
+  std::vector<uint64_t> key_hashes;
+  CollectKeyHashes(key_hashes);
+
+  for (auto key_hash : key_hashes) {
+    key_filter->RebuildInsert(key_hash);
+  }
+
+  key_filter->EndRebuild();
+
+  LOG_TRACE("Rebuilt the key filter of index %s with %lu keys",
+            GetName().c_str(), key_hashes.size());
+
+  return;
+}
+
 BWTREE_TEMPLATE_ARGUMENTS
 std::string BWTREE_INDEX_TYPE::GetTypeName() const { return "BWTree"; }
 
@@ -53,7 +53,8 @@ IndexMetadata::IndexMetadata(std::string index_name, oid_t index_oid,
                              const catalog::Schema *tuple_schema,
                              const catalog::Schema *key_schema,
                              const std::vector<oid_t> &key_attrs,
-                             bool unique_keys)
+                             bool unique_keys,
+                             const std::vector<oid_t> &include_attrs)
     : name_(index_name),
       index_oid(index_oid),
       table_oid(table_oid),
@@ -63,6 +64,7 @@ IndexMetadata::IndexMetadata(std::string index_name, oid_t index_oid,
       tuple_schema(tuple_schema),
       key_schema(key_schema),
       key_attrs(key_attrs),
+      include_attrs(include_attrs),
       tuple_attrs(),
       unique_keys(unique_keys),
       visible_(IndexMetadata::index_default_visibility) {
@@ -83,6 +85,18 @@ IndexMetadata::IndexMetadata(std::string index_name, oid_t index_oid,
     tuple_attrs[tuple_column_id] = i;
   }
 
+  // The covering schema lays out the INCLUDE columns right after the key
+  // columns, so the key part of a covering tuple is a valid key tuple
+  if (include_attrs.empty() == false) {
+    std::vector<oid_t> covering_attrs(key_attrs);
+    covering_attrs.insert(covering_attrs.end(), include_attrs.begin(),
+                          include_attrs.end());
+
+    auto schema = catalog::Schema::CopySchema(tuple_schema, covering_attrs);
+    schema->SetIndexedColumns(covering_attrs);
+    covering_schema = schema;
+  }
+
   // Just in case somebody forgets they set our flag to default and
   // was wondering why there indexes weren't working...
   if (visible_ == false) {
@@ -97,11 +111,22 @@ IndexMetadata::IndexMetadata(std::string index_name, oid_t index_oid,
 IndexMetadata::~IndexMetadata() {
   // clean up key schema
   delete key_schema;
+  delete covering_schema;
 
   // no need to clean the tuple schema
   return;
 }
 
+bool IndexMetadata::IsColumnCovered(oid_t tuple_column_id) const {
+  if (tuple_column_id < tuple_attrs.size() &&
+      tuple_attrs[tuple_column_id] != INVALID_OID) {
+    return true;
+  }
+
+  return std::find(include_attrs.begin(), include_attrs.end(),
+                   tuple_column_id) != include_attrs.end();
+}
+
 const std::string IndexMetadata::GetInfo() const {
   std::stringstream os;
 
@@ -116,6 +141,10 @@ const std::string IndexMetadata::GetInfo() const {
 
   os << " -> " << key_schema->GetInfo();
 
+  if (covering_schema != nullptr) {
+    os << " INCLUDE " << covering_schema->GetInfo();
+  }
+
   return os.str();
 }
 
@@ -184,6 +213,54 @@ oid_t Index::TupleColumnToKeyColumn(oid_t tuple_column_id) const {
   return key_column_id;
 }
 
+namespace {
+
+/*
+ * class MaterializedScanIterator - Hands out a materialized scan result
+ */
+class MaterializedScanIterator : public IndexScanIterator {
+ public:
+  MaterializedScanIterator(std::vector<ItemPointer *> &&entries)
+      : entries_(std::move(entries)), next_entry_(0) {}
+
+  size_t Next(std::vector<ItemPointer *> &result, size_t max_count) {
+    size_t count = std::min(max_count, entries_.size() - next_entry_);
+    result.insert(result.end(), entries_.begin() + next_entry_,
+                  entries_.begin() + next_entry_ + count);
+    next_entry_ += count;
+    return count;
+  }
+
+ private:
+  std::vector<ItemPointer *> entries_;
+  size_t next_entry_;
+};
+
+}  // namespace
+
+/*
+ * GetScanIterator() - Default pull based scan on top of Scan()
+ *
+ * Not every index can walk its keys backward, so the forward result is
+ * reversed for backward scans.
+ */
+std::unique_ptr<IndexScanIterator> Index::GetScanIterator(
+    const std::vector<type::Value> &value_list,
+    const std::vector<oid_t> &tuple_column_id_list,
+    const std::vector<ExpressionType> &expr_list,
+    ScanDirectionType scan_direction, const ConjunctionScanPredicate *csp_p) {
+  std::vector<ItemPointer *> entries;
+  Scan(value_list, tuple_column_id_list, expr_list,
+       SCAN_DIRECTION_TYPE_FORWARD, entries, csp_p);
+
+  if (scan_direction == SCAN_DIRECTION_TYPE_BACKWARD) {
+    std::reverse(entries.begin(), entries.end());
+  }
+
+  return std::unique_ptr<IndexScanIterator>(
+      new MaterializedScanIterator(std::move(entries)));
+}
+
 /*
  * ScanTest() - This is used inside the unit test to check correctness of
  *              scan optimizer - do not change or remove this
@@ -204,6 +281,76 @@ void Index::ScanTest(const std::vector<type::Value> &value_list,
   return;
 }
 
+/*
+ * IsExactScanRange() - Whether the scan range equals the predicate
+ *
+ * The scan optimizer turns the predicate into one closed key range. The range
+ * is exact if the predicate is made of equalities on a prefix of the key
+ * columns, optionally followed by >= and/or <= on the next key column.
+ * Anything else (strict bounds, gaps in the key, other operators) lets keys
+ * into the range that do not satisfy the predicate.
+ */
+bool Index::IsExactScanRange(
+    const std::vector<oid_t> &tuple_column_id_list,
+    const std::vector<ExpressionType> &expr_list) const {
+  static constexpr uint8_t HAS_EQUAL = 0x1;
+  static constexpr uint8_t HAS_LOWER_BOUND = 0x2;
+  static constexpr uint8_t HAS_UPPER_BOUND = 0x4;
+
+  const std::vector<oid_t> &tuple_to_index_map =
+      metadata->GetTupleToIndexMapping();
+  std::vector<uint8_t> conditions(GetColumnCount(), 0);
+
+  for (oid_t i = 0; i < tuple_column_id_list.size(); i++) {
+    oid_t tuple_column_id = tuple_column_id_list[i];
+    if (tuple_column_id >= tuple_to_index_map.size() ||
+        tuple_to_index_map[tuple_column_id] == INVALID_OID) {
+      return false;
+    }
+
+    uint8_t condition;
+    switch (expr_list[i]) {
+      case EXPRESSION_TYPE_COMPARE_EQUAL:
+        condition = HAS_EQUAL;
+        break;
+      case EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO:
+        condition = HAS_LOWER_BOUND;
+        break;
+      case EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO:
+        condition = HAS_UPPER_BOUND;
+        break;
+      default:
+        return false;
+    }
+
+    // Repeated conditions on a column are left to the caller
+    uint8_t &column_conditions = conditions[tuple_to_index_map[tuple_column_id]];
+    if ((column_conditions & condition) != 0) {
+      return false;
+    }
+    column_conditions |= condition;
+  }
+
+  oid_t key_column_id = 0;
+  while (key_column_id < conditions.size() &&
+         conditions[key_column_id] == HAS_EQUAL) {
+    key_column_id++;
+  }
+
+  if (key_column_id < conditions.size() &&
+      (conditions[key_column_id] & HAS_EQUAL) == 0) {
+    key_column_id++;
+  }
+
+  for (; key_column_id < conditions.size(); key_column_id++) {
+    if (conditions[key_column_id] != 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 /*
  * Compare() - Check whether a given index key satisfies a predicate
  *
@@ -14,6 +14,7 @@
 
 #include "common/logger.h"
 #include "common/macros.h"
+#include "index/art_index.h"
 #include "index/bwtree_index.h"
 #include "index/index_factory.h"
 #include "index/index_key.h"
@@ -50,6 +51,16 @@ Index *IndexFactory::GetIndex(IndexMetadata *metadata) {
     ints_only = false;
   }
 
+  // Covering indexes keep the INCLUDE columns inside the key, which only
+  // the fixed size GenericKey can hold next to the key columns
+  if (metadata->IsCovering()) {
+    ints_only = false;
+    if (metadata->GetCoveringSchema()->GetLength() > 256) {
+      throw IndexException("Covering index " + metadata->GetName() +
+                           " exceeds the maximum key size");
+    }
+  }
+
   auto index_type = metadata->GetIndexType();
   Index *index = nullptr;
   LOG_TRACE("Index type : %d", index_type);
@@ -64,6 +75,12 @@ Index *IndexFactory::GetIndex(IndexMetadata *metadata) {
       index = IndexFactory::GetBwTreeGenericKeyIndex(metadata);
     }
 
+    // -----------------------
+    // ART
+    // -----------------------
+  } else if (index_type == INDEX_TYPE_ART) {
+    index = IndexFactory::GetArtIndex(metadata);
+
     // -----------------------
     // ERROR
     // -----------------------
@@ -133,8 +150,8 @@ Index *IndexFactory::GetBwTreeGenericKeyIndex(IndexMetadata *metadata) {
   // Our new Index!
   Index *index = nullptr;
 
-  // The size of the key in bytes
-  const auto key_size = metadata->key_schema->GetLength();
+  // The size of the key in bytes (including the INCLUDE columns)
+  const auto key_size = metadata->GetCoveringSchema()->GetLength();
 
 // Debug Output
 #ifdef LOG_TRACE_ENABLED
@@ -212,5 +229,28 @@ std::string IndexFactory::GetInfo(IndexMetadata *metadata,
   return (os.str());
 }
 
+Index *IndexFactory::GetArtIndex(IndexMetadata *metadata) {
+  // The ART keeps its own binary comparable keys, which cannot carry the
+  // INCLUDE columns of a covering index
+  if (metadata->IsCovering()) {
+    throw IndexException("ART index " + metadata->GetName() +
+                         " does not support INCLUDE columns");
+  }
+
+  for (auto column : metadata->key_schema->GetColumns()) {
+    if (ArtIndex::IsSupportedKeyType(column.GetType()) == false) {
+      throw IndexException("Unsupported key type for ART index " +
+                           metadata->GetName());
+    }
+  }
+
+  Index *index = new ArtIndex(metadata);
+
+#ifdef LOG_TRACE_ENABLED
+  LOG_TRACE("%s", IndexFactory::GetInfo(metadata, "ArtKey").c_str());
+#endif
+  return (index);
+}
+
 }  // End index namespace
 }  // End peloton namespace
@@ -0,0 +1,253 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// key_filter.cpp
+//
+// Identification: src/index/key_filter.cpp
+//
+// Copyright (c) 2015-17, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "index/key_filter.h"
+
+#include <algorithm>
+
+#include "common/macros.h"
+
+namespace peloton {
+namespace index {
+
+// A block is one cache line of eight 64 bit words
+static constexpr size_t WORDS_PER_BLOCK = 8;
+static constexpr size_t BLOCK_SIZE = WORDS_PER_BLOCK * sizeof(uint64_t);
+static constexpr size_t BLOCK_BITS = BLOCK_SIZE * 8;
+
+// Odd multipliers that derive the bit of every word from the low half of
+// the key hash
+static constexpr uint32_t BIT_SALTS[WORDS_PER_BLOCK] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+/*
+ * class BitArray - The blocks of a filter
+ *
+ * The number of blocks is a power of two, and the high half of the key
+ * hash selects the block.
+ */
+class KeyFilter::BitArray {
+ public:
+  BitArray(size_t block_count)
+      : block_count_(block_count),
+        storage_(new std::atomic<uint64_t>[(block_count + 1) *
+                                           WORDS_PER_BLOCK]) {
+    // Align the blocks with cache lines
+    auto address = reinterpret_cast<uintptr_t>(storage_.get());
+    address = (address + BLOCK_SIZE - 1) & ~(BLOCK_SIZE - 1);
+    words_ = reinterpret_cast<std::atomic<uint64_t> *>(address);
+
+    Clear();
+  }
+
+  inline size_t GetBlockCount() const { return block_count_; }
+
+  inline size_t GetMemoryFootprint() const {
+    return (block_count_ + 1) * BLOCK_SIZE;
+  }
+
+  inline void Clear() {
+    for (size_t i = 0; i < block_count_ * WORDS_PER_BLOCK; i++) {
+      words_[i].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  inline void Insert(uint64_t hash) {
+    std::atomic<uint64_t> *block = GetBlock(hash);
+    for (size_t i = 0; i < WORDS_PER_BLOCK; i++) {
+      uint64_t mask = GetMask(hash, i);
+      // Avoid dirtying the cache line if the bit is already set
+      if ((block[i].load(std::memory_order_relaxed) & mask) == 0) {
+        block[i].fetch_or(mask, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  inline bool Contains(uint64_t hash) const {
+    const std::atomic<uint64_t> *block = GetBlock(hash);
+    for (size_t i = 0; i < WORDS_PER_BLOCK; i++) {
+      if ((block[i].load(std::memory_order_relaxed) & GetMask(hash, i)) ==
+          0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  inline std::atomic<uint64_t> *GetBlock(uint64_t hash) const {
+    return words_ + ((hash >> 32) & (block_count_ - 1)) * WORDS_PER_BLOCK;
+  }
+
+  static inline uint64_t GetMask(uint64_t hash, size_t word) {
+    uint32_t bit = (static_cast<uint32_t>(hash) * BIT_SALTS[word]) >> 26;
+    return 1ULL << bit;
+  }
+
+  size_t block_count_;
+  std::unique_ptr<std::atomic<uint64_t>[]> storage_;
+  std::atomic<uint64_t> *words_;
+};
+
+KeyFilter::KeyFilter(size_t expected_key_count)
+    : building_(nullptr),
+      rebuild_sequence_(0),
+      inserted_count_(0),
+      removed_count_(0) {
+  size_t block_count = GetBlockCount(expected_key_count);
+  arrays_.emplace_back(new BitArray(block_count));
+  active_.store(arrays_.back().get());
+  capacity_.store(GetCapacity(block_count));
+  memory_footprint_.store(arrays_.back()->GetMemoryFootprint());
+}
+
+KeyFilter::~KeyFilter() {}
+
+size_t KeyFilter::GetCapacity(size_t block_count) {
+  return block_count * BLOCK_BITS / BITS_PER_KEY;
+}
+
+size_t KeyFilter::GetBlockCount(size_t key_count) {
+  // Leave room for the index to double before the filter is over capacity
+  size_t bit_count = std::max<size_t>(key_count, 1) * 2 * BITS_PER_KEY;
+  size_t block_count = MIN_BLOCK_COUNT;
+  while (block_count * BLOCK_BITS < bit_count) block_count *= 2;
+  return block_count;
+}
+
+/*
+ * Insert() - Adds a key to the filter
+ *
+ * A rebuild publishes its array before it starts reading the index, and
+ * activates it before it stops accepting inserts. Hence loading the array
+ * being rebuilt before the active one guarantees that a key inserted into
+ * the index before this call is either seen by a concurrent rebuild or
+ * added to the array it builds.
+ */
+void KeyFilter::Insert(uint64_t key_hash) {
+  uint64_t hash = MixHash(key_hash);
+
+  BitArray *building = building_.load();
+  if (building != nullptr) {
+    building->Insert(hash);
+  }
+
+  BitArray *active = active_.load();
+  if (active != building) {
+    active->Insert(hash);
+  }
+
+  inserted_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+/*
+ * MayContain() - Probes the filter for a key
+ *
+ * This follows the read side of a sequence lock: if the array has been
+ * cleared for reuse while it was probed, the sequence number has changed
+ * and the key is reported as possibly present.
+ */
+bool KeyFilter::MayContain(uint64_t key_hash) const {
+  uint64_t hash = MixHash(key_hash);
+
+  uint64_t sequence = rebuild_sequence_.load(std::memory_order_acquire);
+  if (active_.load()->Contains(hash) == true) {
+    return true;
+  }
+
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return rebuild_sequence_.load(std::memory_order_relaxed) != sequence;
+}
+
+bool KeyFilter::NeedRebuild() const {
+  size_t inserted = inserted_count_.load(std::memory_order_relaxed);
+  size_t removed = removed_count_.load(std::memory_order_relaxed);
+  size_t capacity = capacity_.load(std::memory_order_relaxed);
+
+  // Most of the keys have been deleted and no longer need to be filtered
+  if ((removed > inserted / 2) && (removed > capacity / 8)) {
+    return true;
+  }
+
+  // The filter holds more keys than it has been sized for, so its false
+  // positive rate has gone up
+  return inserted > capacity;
+}
+
+size_t KeyFilter::GetKeyCount() const {
+  size_t inserted = inserted_count_.load(std::memory_order_relaxed);
+  size_t removed = removed_count_.load(std::memory_order_relaxed);
+  return (inserted > removed) ? (inserted - removed) : 0;
+}
+
+bool KeyFilter::BeginRebuild(size_t key_count) {
+  if (rebuild_lock_.try_lock() == false) {
+    return false;
+  }
+
+  size_t block_count = GetBlockCount(key_count);
+  BitArray *active = active_.load();
+  BitArray *array = nullptr;
+
+  for (auto &candidate : arrays_) {
+    if ((candidate.get() != active) &&
+        (candidate->GetBlockCount() == block_count)) {
+      array = candidate.get();
+      break;
+    }
+  }
+
+  if (array == nullptr) {
+    arrays_.emplace_back(new BitArray(block_count));
+    array = arrays_.back().get();
+    memory_footprint_.fetch_add(array->GetMemoryFootprint());
+  } else {
+    // Probes that may still be reading the replaced array have to notice
+    // that it is being cleared
+    rebuild_sequence_.fetch_add(1, std::memory_order_acq_rel);
+    std::atomic_thread_fence(std::memory_order_release);
+    array->Clear();
+  }
+
+  inserted_count_.store(0);
+  removed_count_.store(0);
+  building_.store(array);
+
+  return true;
+}
+
+void KeyFilter::RebuildInsert(uint64_t key_hash) {
+  BitArray *building = building_.load(std::memory_order_relaxed);
+  PL_ASSERT(building != nullptr);
+
+  building->Insert(MixHash(key_hash));
+  inserted_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void KeyFilter::EndRebuild() {
+  BitArray *building = building_.load(std::memory_order_relaxed);
+  PL_ASSERT(building != nullptr);
+
+  capacity_.store(GetCapacity(building->GetBlockCount()));
+  active_.store(building);
+  building_.store(nullptr);
+
+  rebuild_lock_.unlock();
+}
+
+size_t KeyFilter::GetMemoryFootprint() const {
+  return memory_footprint_.load();
+}
+
+}  // End index namespace
+}  // End peloton namespace
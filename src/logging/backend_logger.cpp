@@ -10,6 +10,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+
 #include "logging/backend_logger.h"
 #include "common/logger.h"
 #include "logging/log_manager.h"
@@ -25,9 +27,11 @@ namespace logging {
 BackendLogger::BackendLogger()
     : log_buffer_(std::unique_ptr<LogBuffer>(nullptr)),
       available_buffer_pool_(
-          std::unique_ptr<BufferPool>(new CircularBufferPool())),
-      persist_buffer_pool_(
-          std::unique_ptr<BufferPool>(new CircularBufferPool())) {
+          std::unique_ptr<LogBufferRing>(new LogBufferRing())),
+      persist_buffer_pool_(std::unique_ptr<LogBufferRing>(new LogBufferRing())),
+      commit_ids_version_(0),
+      published_lower_bound_(INVALID_CID),
+      published_commit_(INVALID_CID) {
   logger_type = LOGGER_TYPE_BACKEND;
   backend_pool.reset(new type::EphemeralPool());
   frontend_logger_id = -1;
@@ -64,26 +68,18 @@ BackendLogger *BackendLogger::GetBackendLogger(LoggingType logging_type) {
 /**
  * @brief log log a log record
  * @param log record
+ *
+ * Only the backend thread touches the current buffer. The buffer is handed
+ * off to the frontend logger through the persist ring once it is full or
+ * the transaction commits, so the frontend logger never waits on a backend.
  */
 void BackendLogger::Log(LogRecord *record) {
   // Enqueue the serialized log record into the queue
   record->Serialize(output_buffer);
 
-  this->log_buffer_lock.Lock();
   if (!log_buffer_) {
-    LOG_TRACE("Acquire the first log buffer in backend logger");
-    this->log_buffer_lock.Unlock();
-    std::unique_ptr<LogBuffer> new_buff =
-        std::move(available_buffer_pool_->Get());
-    this->log_buffer_lock.Lock();
-    log_buffer_ = std::move(new_buff);
-  }
-  // update max logged commit id
-  if (record->GetType() == LOGRECORD_TYPE_TRANSACTION_COMMIT) {
-    auto new_log_commit_id = record->GetTransactionId();
-    PL_ASSERT(new_log_commit_id > highest_logged_commit_message);
-    highest_logged_commit_message = new_log_commit_id;
-    logging_cid_lower_bound = INVALID_CID;
+    LOG_TRACE("Acquire a log buffer in backend logger");
+    log_buffer_ = available_buffer_pool_->Get();
   }
 
   // update the max logged id for the current buffer
@@ -97,27 +93,69 @@ void BackendLogger::Log(LogRecord *record) {
 
   if (!log_buffer_->WriteRecord(record)) {
     LOG_TRACE("Log buffer is full - Attempt to acquire a new one");
-    // put back a buffer
-    max_log_id_buffer = 0;  // reset
-    persist_buffer_pool_->Put(std::move(log_buffer_));
-    this->log_buffer_lock.Unlock();
+    HandOffLogBuffer();
 
     // get a new one
-    std::unique_ptr<LogBuffer> new_buff =
-        std::move(available_buffer_pool_->Get());
-    this->log_buffer_lock.Lock();
-    log_buffer_ = std::move(new_buff);
+    log_buffer_ = available_buffer_pool_->Get();
+    log_buffer_->SetMaxLogId(cur_log_id);
+    max_log_id_buffer = cur_log_id;
 
     // write to the new log buffer
     auto success = log_buffer_->WriteRecord(record);
     if (!success) {
       LOG_ERROR("Write record to log buffer failed");
-      this->log_buffer_lock.Unlock();
       return;
     }
   }
 
-  this->log_buffer_lock.Unlock();
+  // update max logged commit id once the commit is in the persist ring
+  if (record->IsCommit()) {
+    auto new_log_commit_id =
+        std::max(record->GetTransactionId(), commit_id_floor);
+    commit_id_floor = INVALID_CID;
+    PL_ASSERT(new_log_commit_id > highest_logged_commit_message);
+    HandOffLogBuffer();
+
+    highest_logged_commit_message = new_log_commit_id;
+    logging_cid_lower_bound = INVALID_CID;
+    PublishCommitIds();
+  }
+}
+
+void BackendLogger::HandOffLogBuffer() {
+  if (log_buffer_ && log_buffer_->GetSize() > 0) {
+    max_log_id_buffer = 0;  // reset
+    persist_buffer_pool_->Put(std::move(log_buffer_));
+  }
+}
+
+// single writer sequence lock, the backend never waits for the frontend
+void BackendLogger::PublishCommitIds() {
+  auto version = commit_ids_version_.load(std::memory_order_relaxed);
+  commit_ids_version_.store(version + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  published_lower_bound_.store(logging_cid_lower_bound,
+                               std::memory_order_relaxed);
+  published_commit_.store(highest_logged_commit_message,
+                          std::memory_order_relaxed);
+
+  commit_ids_version_.store(version + 2, std::memory_order_release);
+}
+
+void BackendLogger::ReadCommitIds(cid_t &lower_bound, cid_t &highest_commit) {
+  while (true) {
+    auto version = commit_ids_version_.load(std::memory_order_acquire);
+    lower_bound = published_lower_bound_.load(std::memory_order_relaxed);
+    highest_commit = published_commit_.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    if ((version & 1) == 0 &&
+        commit_ids_version_.load(std::memory_order_relaxed) == version) {
+      return;
+    }
+    _mm_pause();
+  }
 }
 
 // used by the frontend logger to collect data on the current state of the
@@ -126,31 +164,31 @@ void BackendLogger::Log(LogRecord *record) {
 // logger may
 // commit, The second is the maximum id this worker has committed
 std::pair<cid_t, cid_t> BackendLogger::PrepareLogBuffers() {
-  this->log_buffer_lock.Lock();
   std::pair<cid_t, cid_t> ret(INVALID_CID, INVALID_CID);
-  // prepare the cid's seen so far
-  if (logging_cid_lower_bound != INVALID_CID ||
-      (log_buffer_ && log_buffer_->GetSize() > 0)) {
-    ret.second = highest_logged_commit_message;
-    if (logging_cid_lower_bound > highest_logged_commit_message) {
-      ret.first = logging_cid_lower_bound;
-    }
-  }
-  if (log_buffer_ && log_buffer_->GetSize() > 0) {
-    // put back a buffer
-    LOG_TRACE(
-        "Move the current log buffer to buffer pool, "
-        "highest_logged_commit_message: %d, logging_cid_lower_bound: %d",
-        (int)highest_logged_commit_message, (int)logging_cid_lower_bound);
-    persist_buffer_pool_->Put(std::move(log_buffer_));
+
+  // A commit id is published after its buffer is handed off, so read the
+  // commit ids before draining the ring
+  cid_t lower_bound, highest_commit;
+  ReadCommitIds(lower_bound, highest_commit);
+
+  for (auto log_buffer = persist_buffer_pool_->TryGet(); log_buffer;
+       log_buffer = persist_buffer_pool_->TryGet()) {
+    local_queue.push_back(std::move(log_buffer));
   }
-  this->log_buffer_lock.Unlock();
 
-  auto num_log_buffer = persist_buffer_pool_->GetSize();
-  while (num_log_buffer > 0) {
-    local_queue.push_back(persist_buffer_pool_->Get());
-    num_log_buffer--;
+  // prepare the cid's seen so far
+  if (lower_bound != INVALID_CID || local_queue.empty() == false ||
+      highest_commit != reported_commit_) {
+    ret.second = highest_commit;
+    if (lower_bound > highest_commit) {
+      ret.first = lower_bound;
+    }
+    reported_commit_ = highest_commit;
   }
+  LOG_TRACE(
+      "Collected %lu log buffers, highest_logged_commit_message: %d, "
+      "logging_cid_lower_bound: %d",
+      local_queue.size(), (int)highest_commit, (int)lower_bound);
   return ret;
 }
 
@@ -14,6 +14,8 @@
 #include "logging/checkpoint.h"
 #include "logging/logging_util.h"
 #include "logging/checkpoint/simple_checkpoint.h"
+#include "logging/checkpoint/parallel_checkpoint.h"
+#include "logging/checkpoint/image_checkpoint.h"
 #include "logging/log_manager.h"
 #include "logging/checkpoint_manager.h"
 #include "logging/backend_logger.h"
@@ -102,6 +104,14 @@ std::unique_ptr<Checkpoint> Checkpoint::GetCheckpoint(
     std::unique_ptr<Checkpoint> checkpoint(
         new SimpleCheckpoint(disable_file_access));
     return std::move(checkpoint);
+  } else if (checkpoint_type == CHECKPOINT_TYPE_PARALLEL) {
+    std::unique_ptr<Checkpoint> checkpoint(
+        new ParallelCheckpoint(disable_file_access));
+    return std::move(checkpoint);
+  } else if (checkpoint_type == CHECKPOINT_TYPE_IMAGE) {
+    std::unique_ptr<Checkpoint> checkpoint(
+        new ImageCheckpoint(disable_file_access));
+    return std::move(checkpoint);
   }
   return std::move(std::unique_ptr<Checkpoint>(nullptr));
 }
@@ -0,0 +1,541 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// image_checkpoint.cpp
+//
+// Identification: src/logging/checkpoint/image_checkpoint.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+
+#include "logging/checkpoint/image_checkpoint.h"
+#include "logging/checkpoint/index_image.h"
+#include "logging/checkpoint_tile_scanner.h"
+#include "logging/checkpoint_manager.h"
+#include "logging/log_manager.h"
+#include "logging/logging_util.h"
+
+#include "catalog/catalog.h"
+#include "catalog/manager.h"
+#include "concurrency/epoch_manager_factory.h"
+#include "concurrency/transaction_manager_factory.h"
+#include "storage/data_table.h"
+#include "storage/database.h"
+#include "storage/tile.h"
+#include "storage/tile_group.h"
+#include "storage/tile_group_header.h"
+
+#include "common/logger.h"
+
+namespace peloton {
+namespace logging {
+
+// Images are 8 byte aligned, so that their headers can be read in place
+static size_t AlignImageSize(size_t size) { return (size + 7) & ~7UL; }
+
+static bool IsVarlenColumn(const catalog::Schema *schema, oid_t column_id) {
+  auto type_id = schema->GetType(column_id);
+  return (type_id == type::Type::VARCHAR || type_id == type::Type::VARBINARY) &&
+         schema->IsInlined(column_id) == false;
+}
+
+//===--------------------------------------------------------------------===//
+// Image Checkpoint
+//===--------------------------------------------------------------------===//
+
+ImageCheckpoint::ImageCheckpoint(bool disable_file_access)
+    : Checkpoint(disable_file_access) {
+  InitDirectory();
+  InitVersionNumber();
+}
+
+ImageCheckpoint::~ImageCheckpoint() {}
+
+void ImageCheckpoint::DoCheckpoint() {
+  auto &log_manager = LogManager::GetInstance();
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+
+  cid_t checkpoint_cid = log_manager.GetGlobalMaxFlushedCommitId();
+  if (checkpoint_cid == INVALID_CID) {
+    checkpoint_cid = txn_manager.GetMaxCommittedCid();
+  }
+
+  LOG_TRACE("DoCheckpoint cid = %lu", checkpoint_cid);
+
+  int version = ++checkpoint_version;
+  std::string file_name = GetImageFileName(version);
+  std::string temp_file_name = file_name + ".tmp";
+
+  FileHandle file_handle;
+  if (!disable_file_access &&
+      !LoggingUtil::InitFileHandle(temp_file_name.c_str(), file_handle,
+                                   "wb")) {
+    checkpoint_version--;
+    return;
+  }
+
+  // The header is written once the index is known
+  ImageHeader header;
+  PL_MEMSET(&header, 0, sizeof(header));
+  header.magic = IMAGE_MAGIC;
+  header.format_version = IMAGE_FORMAT_VERSION;
+  header.checkpoint_cid = checkpoint_cid;
+
+  bool succeeded = true;
+  auto write = [&](const void *data, size_t size) {
+    if (!disable_file_access && succeeded &&
+        fwrite(data, 1, size, file_handle.file) != size) {
+      LOG_ERROR("Failed to write checkpoint image %s", file_name.c_str());
+      succeeded = false;
+    }
+  };
+  write(&header, sizeof(header));
+
+  // Keep the versions that are visible at the checkpoint cid from being
+  // recycled while we copy them
+  auto &epoch_manager = concurrency::EpochManagerFactory::GetInstance();
+  auto epoch_id = epoch_manager.EnterReadOnlyEpoch(checkpoint_cid);
+
+  std::vector<uint64_t> image_offsets;
+  std::vector<char> image;
+  uint64_t position = sizeof(header);
+
+  auto catalog = catalog::Catalog::GetInstance();
+  auto database_count = catalog->GetDatabaseCount();
+  for (oid_t database_idx = 1; database_idx < database_count; database_idx++) {
+    auto database = catalog->GetDatabaseWithOffset(database_idx);
+    auto table_count = database->GetTableCount();
+
+    for (oid_t table_idx = 0; table_idx < table_count; table_idx++) {
+      storage::DataTable *target_table = database->GetTable(table_idx);
+      PL_ASSERT(target_table);
+      auto tile_group_count = target_table->GetTileGroupCount();
+      for (oid_t tile_group_offset = START_OID;
+           tile_group_offset < tile_group_count; tile_group_offset++) {
+        auto tile_group = target_table->GetTileGroup(tile_group_offset);
+        if (tile_group == nullptr ||
+            BuildTileGroupImage(tile_group.get(), database->GetOid(),
+                                checkpoint_cid, image) == 0) {
+          continue;
+        }
+
+        image_offsets.push_back(position);
+        write(image.data(), image.size());
+        position += image.size();
+        header.max_tile_group_id = std::max<uint32_t>(
+            header.max_tile_group_id, tile_group->GetTileGroupId());
+      }
+    }
+  }
+
+  // The index images are optional, recovery rebuilds the indexes without
+  bool index_images_written = false;
+  if (!disable_file_access && succeeded && index_images_) {
+    index_images_written = IndexImage::Write(GetIndexImageFileName(version),
+                                             checkpoint_cid, GetThreadCount());
+  }
+
+  epoch_manager.ExitReadOnlyEpoch(epoch_id);
+
+  header.index_offset = position;
+  header.tile_group_count = image_offsets.size();
+  write(image_offsets.data(), image_offsets.size() * sizeof(uint64_t));
+
+  if (!disable_file_access) {
+    if (succeeded) {
+      fseek(file_handle.file, 0, SEEK_SET);
+      write(&header, sizeof(header));
+      LoggingUtil::FFlushFsync(file_handle);
+    }
+    fclose(file_handle.file);
+
+    // The image only becomes visible under its name once it is complete
+    if (!succeeded || rename(temp_file_name.c_str(), file_name.c_str()) != 0) {
+      LOG_ERROR("Failed to write checkpoint %d", version);
+      remove(temp_file_name.c_str());
+      if (index_images_written) {
+        remove(GetIndexImageFileName(version).c_str());
+      }
+      checkpoint_version--;
+      return;
+    }
+
+    // Remove previous version
+    if (version > 0) {
+      auto previous_version = GetImageFileName(version - 1);
+      if (remove(previous_version.c_str()) != 0) {
+        LOG_TRACE("Failed to remove file %s", previous_version.c_str());
+      }
+      remove(GetIndexImageFileName(version - 1).c_str());
+    }
+  }
+
+  // Truncate logs
+  log_manager.TruncateLogs(checkpoint_cid);
+  most_recent_checkpoint_cid = checkpoint_cid;
+}
+
+cid_t ImageCheckpoint::DoRecovery() {
+  // No checkpoint to recover from
+  if (checkpoint_version < 0 || disable_file_access) {
+    return 0;
+  }
+
+  CheckpointManager::GetInstance().SetIndexRecoveredCid(INVALID_CID);
+
+  std::string file_name = GetImageFileName(checkpoint_version);
+  int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd == -1) {
+    LOG_ERROR("Failed to open checkpoint image %s", file_name.c_str());
+    return 0;
+  }
+
+  struct stat image_stat;
+  if (fstat(fd, &image_stat) != 0 ||
+      (size_t)image_stat.st_size < sizeof(ImageHeader)) {
+    LOG_ERROR("Invalid checkpoint image %s", file_name.c_str());
+    close(fd);
+    return 0;
+  }
+
+  size_t image_size = image_stat.st_size;
+  void *mapping = mmap(nullptr, image_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    LOG_ERROR("Failed to map checkpoint image %s", file_name.c_str());
+    return 0;
+  }
+  madvise(mapping, image_size, MADV_WILLNEED);
+
+  auto data = reinterpret_cast<const char *>(mapping);
+  auto header = reinterpret_cast<const ImageHeader *>(data);
+  if (header->magic != IMAGE_MAGIC ||
+      header->format_version != IMAGE_FORMAT_VERSION ||
+      header->index_offset +
+              header->tile_group_count * sizeof(uint64_t) >
+          image_size) {
+    LOG_ERROR("Invalid checkpoint image %s", file_name.c_str());
+    munmap(mapping, image_size);
+    return 0;
+  }
+
+  cid_t checkpoint_cid = header->checkpoint_cid;
+  size_t tile_group_count = header->tile_group_count;
+  auto image_offsets =
+      reinterpret_cast<const uint64_t *>(data + header->index_offset);
+
+  // Restore the tile groups in parallel
+  std::atomic<size_t> next_image(0);
+  std::atomic<bool> succeeded(true);
+  size_t thread_count =
+      std::min(GetThreadCount(), std::max<size_t>(1, tile_group_count));
+  std::vector<std::thread> threads;
+  for (size_t thread_itr = 0; thread_itr < thread_count; thread_itr++) {
+    threads.emplace_back([&]() {
+      while (true) {
+        size_t image_itr = next_image.fetch_add(1);
+        if (image_itr >= tile_group_count) {
+          break;
+        }
+
+        uint64_t image_begin = image_offsets[image_itr];
+        uint64_t image_end = (image_itr + 1 < tile_group_count)
+                                 ? image_offsets[image_itr + 1]
+                                 : header->index_offset;
+        if (image_begin > image_end || image_end > header->index_offset ||
+            !RestoreTileGroupImage(data + image_begin, image_end - image_begin,
+                                   checkpoint_cid)) {
+          succeeded = false;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  max_oid_ = header->max_tile_group_id;
+  munmap(mapping, image_size);
+
+  if (!succeeded) {
+    LOG_ERROR("Failed to restore some tile groups of checkpoint %d",
+              checkpoint_version);
+  }
+
+  // After finishing recovery, set the next oid with maximum oid
+  // observed during the recovery
+  auto &manager = catalog::Manager::GetInstance();
+  if (max_oid_ > manager.GetNextTileGroupId()) {
+    manager.SetNextTileGroupId(max_oid_);
+  }
+
+  // The restored tuples keep their slots, so the index images still point
+  // to them. Index recovery then only adds the tuples from the WAL
+  if (index_images_ && succeeded &&
+      IndexImage::Load(GetIndexImageFileName(checkpoint_version),
+                       checkpoint_cid, GetThreadCount())) {
+    CheckpointManager::GetInstance().SetIndexRecoveredCid(checkpoint_cid);
+  }
+
+  concurrency::TransactionManagerFactory::GetInstance().SetNextCid(
+      checkpoint_cid);
+  CheckpointManager::GetInstance().SetRecoveredCid(checkpoint_cid);
+  most_recent_checkpoint_cid = checkpoint_cid;
+  return checkpoint_cid;
+}
+
+/**
+ * @brief Copy the visible tuples of a tile group into the layout of a tile
+ * with the schema of the table
+ */
+size_t ImageCheckpoint::BuildTileGroupImage(storage::TileGroup *tile_group,
+                                            oid_t database_oid,
+                                            cid_t checkpoint_cid,
+                                            std::vector<char> &image) {
+  auto table =
+      static_cast<storage::DataTable *>(tile_group->GetAbstractTable());
+  auto schema = table->GetSchema();
+  oid_t column_count = schema->GetColumnCount();
+  oid_t tuple_slot_count = tile_group->GetNextTupleSlot();
+  size_t tuple_length = schema->GetLength();
+
+  size_t visibility_offset = sizeof(ImageTileGroupHeader);
+  size_t slots_offset = visibility_offset + AlignImageSize(tuple_slot_count);
+  image.assign(slots_offset + tuple_slot_count * tuple_length, 0);
+
+  auto tile_group_header = tile_group->GetHeader();
+  CheckpointTileScanner scanner;
+  std::vector<char> heap;
+  size_t tuple_count = 0;
+
+  // Tile groups in the default layout have a single tile with the schema of
+  // the table, whose slots are copied as they are
+  bool single_tile = (tile_group->GetTileCount() == 1);
+
+  for (oid_t tuple_slot = 0; tuple_slot < tuple_slot_count; tuple_slot++) {
+    if (!scanner.IsVisible(tile_group_header, tuple_slot, checkpoint_cid)) {
+      continue;
+    }
+    image[visibility_offset + tuple_slot] = 1;
+    tuple_count++;
+
+    char *slot = image.data() + slots_offset + tuple_slot * tuple_length;
+    if (single_tile && schema->IsInlined()) {
+      PL_MEMCPY(slot, tile_group->GetTile(0)->GetTupleLocation(tuple_slot),
+                tuple_length);
+      continue;
+    }
+
+    for (oid_t column_itr = 0; column_itr < column_count; column_itr++) {
+      oid_t tile_offset, tile_column_itr;
+      tile_group->LocateTileAndColumn(column_itr, tile_offset,
+                                      tile_column_itr);
+      auto tile = tile_group->GetTile(tile_offset);
+      const char *field = tile->GetTupleLocation(tuple_slot) +
+                          tile->GetSchema()->GetOffset(tile_column_itr);
+      char *image_field = slot + schema->GetOffset(column_itr);
+
+      if (IsVarlenColumn(schema, column_itr)) {
+        const char *varlen = *reinterpret_cast<const char *const *>(field);
+        uint64_t heap_reference = 0;
+        if (varlen != nullptr) {
+          uint32_t length = *reinterpret_cast<const uint32_t *>(varlen);
+          heap_reference = heap.size() + 1;
+          heap.insert(heap.end(), varlen, varlen + sizeof(uint32_t) + length);
+        }
+        PL_MEMCPY(image_field, &heap_reference, sizeof(heap_reference));
+      } else {
+        PL_MEMCPY(image_field, field, schema->GetLength(column_itr));
+      }
+    }
+  }
+
+  if (tuple_count == 0) {
+    image.clear();
+    return 0;
+  }
+
+  ImageTileGroupHeader image_header;
+  image_header.database_oid = database_oid;
+  image_header.table_oid = table->GetOid();
+  image_header.tile_group_id = tile_group->GetTileGroupId();
+  image_header.tuple_slot_count = tuple_slot_count;
+  image_header.tuple_length = tuple_length;
+  image_header.column_count = column_count;
+  image_header.heap_size = heap.size();
+  PL_MEMCPY(image.data(), &image_header, sizeof(image_header));
+
+  image.insert(image.end(), heap.begin(), heap.end());
+  image.resize(AlignImageSize(image.size()), 0);
+  return tuple_count;
+}
+
+/**
+ * @brief Restore a tile group by copying the tuple slots of its image into
+ * a new tile. Only the values that are not inlined are copied one at a time
+ */
+bool ImageCheckpoint::RestoreTileGroupImage(const char *image, size_t size,
+                                            cid_t checkpoint_cid) {
+  if (size < sizeof(ImageTileGroupHeader)) {
+    return false;
+  }
+
+  auto image_header = reinterpret_cast<const ImageTileGroupHeader *>(image);
+  auto table = catalog::Catalog::GetInstance()->GetTableWithOid(
+      image_header->database_oid, image_header->table_oid);
+  if (table == nullptr) {
+    // the table was deleted
+    LOG_TRACE("Skip tile group %u of table %u", image_header->tile_group_id,
+              image_header->table_oid);
+    return true;
+  }
+
+  auto schema = table->GetSchema();
+  oid_t tuple_slot_count = image_header->tuple_slot_count;
+  size_t tuple_length = schema->GetLength();
+  size_t visibility_offset = sizeof(ImageTileGroupHeader);
+  size_t slots_offset = visibility_offset + AlignImageSize(tuple_slot_count);
+  size_t heap_offset = slots_offset + tuple_slot_count * tuple_length;
+
+  if (image_header->tuple_length != tuple_length ||
+      image_header->column_count != schema->GetColumnCount() ||
+      heap_offset + image_header->heap_size > size) {
+    LOG_ERROR("Image of tile group %u does not fit table %u",
+              image_header->tile_group_id, image_header->table_oid);
+    return false;
+  }
+
+  auto &manager = catalog::Manager::GetInstance();
+  oid_t tile_group_id = image_header->tile_group_id;
+  auto tile_group = manager.GetTileGroup(tile_group_id);
+  if (tile_group == nullptr) {
+    std::lock_guard<std::mutex> lock(recovery_mutex_);
+    tile_group = manager.GetTileGroup(tile_group_id);
+    if (tile_group == nullptr) {
+      table->AddTileGroupWithOidForRecovery(tile_group_id);
+      tile_group = manager.GetTileGroup(tile_group_id);
+    }
+  }
+
+  auto tile = tile_group->GetTile(0);
+  if (tile_group->GetTileCount() != 1 ||
+      tuple_slot_count > tile->GetAllocatedTupleCount()) {
+    LOG_ERROR("Tile group %u does not fit its image", tile_group_id);
+    return false;
+  }
+
+  // Copy the tuple slots in one go
+  PL_MEMCPY(tile->GetTupleLocation(0), image + slots_offset,
+            tuple_slot_count * tuple_length);
+
+  const char *visibility = image + visibility_offset;
+  const char *heap = image + heap_offset;
+  auto tile_group_header = tile_group->GetHeader();
+  oid_t column_count = schema->GetColumnCount();
+  size_t tuple_count = 0;
+
+  for (oid_t tuple_slot = 0; tuple_slot < tuple_slot_count; tuple_slot++) {
+    if (visibility[tuple_slot] == 0) {
+      continue;
+    }
+
+    // Turn heap references into values of the tile pool
+    if (schema->IsInlined() == false) {
+      char *slot = tile->GetTupleLocation(tuple_slot);
+      for (oid_t column_itr = 0; column_itr < column_count; column_itr++) {
+        if (!IsVarlenColumn(schema, column_itr)) {
+          continue;
+        }
+
+        char *field = slot + schema->GetOffset(column_itr);
+        uint64_t heap_reference;
+        PL_MEMCPY(&heap_reference, field, sizeof(heap_reference));
+
+        char *varlen = nullptr;
+        if (heap_reference != 0) {
+          const char *value = heap + heap_reference - 1;
+          uint32_t length = *reinterpret_cast<const uint32_t *>(value);
+          varlen = reinterpret_cast<char *>(
+              tile->GetPool()->Allocate(sizeof(uint32_t) + length));
+          PL_MEMCPY(varlen, value, sizeof(uint32_t) + length);
+        }
+        PL_MEMCPY(field, &varlen, sizeof(varlen));
+      }
+    }
+
+    // Set MVCC info
+    tile_group_header->GetEmptyTupleSlot(tuple_slot);
+    tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
+    tile_group_header->SetBeginCommitId(tuple_slot, checkpoint_cid);
+    tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+    tile_group_header->SetNextItemPointer(tuple_slot, INVALID_ITEMPOINTER);
+    tuple_count++;
+  }
+
+  table->IncreaseTupleCount(tuple_count);
+
+  LOG_TRACE("Restored %lu tuples of tile group %u", tuple_count,
+            tile_group_id);
+  return true;
+}
+
+// Private Functions
+std::string ImageCheckpoint::GetImageFileName(int version) {
+  return checkpoint_dir + "/" + IMAGE_FILE_PREFIX + std::to_string(version) +
+         IMAGE_FILE_SUFFIX;
+}
+
+std::string ImageCheckpoint::GetIndexImageFileName(int version) {
+  return checkpoint_dir + "/" + IMAGE_FILE_PREFIX + std::to_string(version) +
+         INDEX_IMAGE_FILE_SUFFIX;
+}
+
+void ImageCheckpoint::InitVersionNumber() {
+  // Get the version of the most recent complete image
+  LOG_TRACE("Trying to read checkpoint directory");
+  struct dirent *file;
+  auto dirp = opendir(checkpoint_dir.c_str());
+  if (dirp == nullptr) {
+    LOG_TRACE("Opendir failed: Errno: %d, error: %s", errno, strerror(errno));
+    return;
+  }
+
+  while ((file = readdir(dirp)) != NULL) {
+    std::string file_name(file->d_name);
+    if (file_name.compare(0, IMAGE_FILE_PREFIX.length(), IMAGE_FILE_PREFIX) ==
+            0 &&
+        file_name.length() > IMAGE_FILE_SUFFIX.length() &&
+        file_name.compare(file_name.length() - IMAGE_FILE_SUFFIX.length(),
+                          IMAGE_FILE_SUFFIX.length(), IMAGE_FILE_SUFFIX) == 0) {
+      LOG_TRACE("Found a checkpoint image with name %s", file->d_name);
+      int version = LoggingUtil::ExtractNumberFromFileName(file->d_name);
+      if (version > checkpoint_version) {
+        checkpoint_version = version;
+      }
+    }
+  }
+  closedir(dirp);
+  LOG_TRACE("set checkpoint version to: %d", checkpoint_version);
+}
+
+size_t ImageCheckpoint::GetThreadCount() const {
+  size_t thread_count = thread_count_;
+  if (thread_count == 0) {
+    thread_count = std::thread::hardware_concurrency();
+  }
+  return std::max<size_t>(1, thread_count);
+}
+
+}  // namespace logging
+}  // namespace peloton
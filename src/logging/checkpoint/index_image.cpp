@@ -0,0 +1,442 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// index_image.cpp
+//
+// Identification: src/logging/checkpoint/index_image.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <tuple>
+
+#include "logging/checkpoint/index_image.h"
+#include "logging/checkpoint_tile_scanner.h"
+#include "logging/logging_util.h"
+
+#include "catalog/catalog.h"
+#include "catalog/manager.h"
+#include "index/index.h"
+#include "storage/data_table.h"
+#include "storage/database.h"
+#include "storage/tile_group.h"
+#include "storage/tile_group_header.h"
+#include "storage/tuple.h"
+#include "type/ephemeral_pool.h"
+
+#include "common/logger.h"
+
+namespace peloton {
+namespace logging {
+
+struct IndexImageEntry {
+  ItemPointer location;
+  std::vector<type::Value> key;
+};
+
+// Nulls sort first, the values of the key are compared in order
+static bool KeyLessThan(const IndexImageEntry &lhs,
+                        const IndexImageEntry &rhs) {
+  for (size_t value_itr = 0; value_itr < lhs.key.size(); value_itr++) {
+    auto &lhs_value = lhs.key[value_itr];
+    auto &rhs_value = rhs.key[value_itr];
+    if (lhs_value.IsNull() || rhs_value.IsNull()) {
+      if (lhs_value.IsNull() != rhs_value.IsNull()) {
+        return lhs_value.IsNull();
+      }
+      continue;
+    }
+    if (lhs_value.CompareLessThan(rhs_value) == type::CMP_TRUE) {
+      return true;
+    }
+    if (rhs_value.CompareLessThan(lhs_value) == type::CMP_TRUE) {
+      return false;
+    }
+  }
+  return false;
+}
+
+//===--------------------------------------------------------------------===//
+// Index Image
+//===--------------------------------------------------------------------===//
+
+bool IndexImage::Write(const std::string &file_name, cid_t checkpoint_cid,
+                       size_t thread_count) {
+  std::vector<std::pair<oid_t, storage::DataTable *>> tables;
+  auto catalog = catalog::Catalog::GetInstance();
+  auto database_count = catalog->GetDatabaseCount();
+  for (oid_t database_idx = 1; database_idx < database_count; database_idx++) {
+    auto database = catalog->GetDatabaseWithOffset(database_idx);
+    auto table_count = database->GetTableCount();
+    for (oid_t table_idx = 0; table_idx < table_count; table_idx++) {
+      storage::DataTable *target_table = database->GetTable(table_idx);
+      PL_ASSERT(target_table);
+      tables.emplace_back(database->GetOid(), target_table);
+    }
+  }
+
+  std::string temp_file_name = file_name + ".tmp";
+  FileHandle file_handle;
+  if (!LoggingUtil::InitFileHandle(temp_file_name.c_str(), file_handle,
+                                   "wb")) {
+    return false;
+  }
+
+  std::mutex file_mutex;
+  std::atomic<bool> succeeded(true);
+  auto write = [&](const CopySerializeOutput &output) {
+    std::lock_guard<std::mutex> lock(file_mutex);
+    if (succeeded && fwrite(output.Data(), 1, output.Size(),
+                            file_handle.file) != output.Size()) {
+      LOG_ERROR("Failed to write index images %s", file_name.c_str());
+      succeeded = false;
+    }
+  };
+
+  CopySerializeOutput header;
+  header.WriteInt(INDEX_IMAGE_MAGIC);
+  header.WriteInt(INDEX_IMAGE_FORMAT_VERSION);
+  header.WriteLong(checkpoint_cid);
+  write(header);
+
+  // Each thread scans and sorts the indexes of one table at a time
+  std::atomic<size_t> next_table(0);
+  thread_count = std::min(std::max<size_t>(1, thread_count),
+                          std::max<size_t>(1, tables.size()));
+  std::vector<std::thread> threads;
+  for (size_t thread_itr = 0; thread_itr < thread_count; thread_itr++) {
+    threads.emplace_back([&]() {
+      CopySerializeOutput output;
+      size_t table_itr;
+      while ((table_itr = next_table.fetch_add(1)) < tables.size()) {
+        auto target_table = tables[table_itr].second;
+        for (oid_t index_itr = 0; index_itr < target_table->GetIndexCount();
+             index_itr++) {
+          output.Reset();
+          SerializeIndex(target_table, target_table->GetIndex(index_itr).get(),
+                         tables[table_itr].first, checkpoint_cid, output);
+          write(output);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  if (succeeded) {
+    LoggingUtil::FFlushFsync(file_handle);
+  }
+  fclose(file_handle.file);
+
+  // The images only become visible under their name once they are complete
+  if (!succeeded || rename(temp_file_name.c_str(), file_name.c_str()) != 0) {
+    LOG_ERROR("Failed to write index images %s", file_name.c_str());
+    remove(temp_file_name.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool IndexImage::Load(const std::string &file_name, cid_t checkpoint_cid,
+                      size_t thread_count) {
+  if (checkpoint_cid == INVALID_CID) {
+    return false;
+  }
+
+  int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd == -1) {
+    LOG_TRACE("No index images %s", file_name.c_str());
+    return false;
+  }
+
+  struct stat image_stat;
+  size_t header_size = 2 * sizeof(int32_t) + sizeof(int64_t);
+  if (fstat(fd, &image_stat) != 0 ||
+      (size_t)image_stat.st_size < header_size) {
+    LOG_ERROR("Invalid index images %s", file_name.c_str());
+    close(fd);
+    return false;
+  }
+
+  size_t image_size = image_stat.st_size;
+  void *mapping = mmap(nullptr, image_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    LOG_ERROR("Failed to map index images %s", file_name.c_str());
+    return false;
+  }
+  madvise(mapping, image_size, MADV_WILLNEED);
+  auto data = reinterpret_cast<const char *>(mapping);
+
+  ReferenceSerializeInput header(data, header_size);
+  int32_t magic = header.ReadInt();
+  int32_t format_version = header.ReadInt();
+  cid_t image_cid = header.ReadLong();
+  if (magic != INDEX_IMAGE_MAGIC ||
+      format_version != INDEX_IMAGE_FORMAT_VERSION ||
+      image_cid != checkpoint_cid) {
+    LOG_ERROR("Index images %s do not belong to the checkpoint",
+              file_name.c_str());
+    munmap(mapping, image_size);
+    return false;
+  }
+
+  // Find the blocks of every table. The indexes of a table share the
+  // indirections of its tuples, so they are loaded by the same thread
+  typedef std::vector<std::pair<const char *, size_t>> IndexBlocks;
+  std::map<std::pair<oid_t, oid_t>, IndexBlocks> table_blocks;
+  std::set<std::tuple<oid_t, oid_t, oid_t>> image_indexes;
+  size_t block_header_size = 4 * sizeof(int32_t);
+  size_t position = header_size;
+  bool succeeded = true;
+  while (position < image_size) {
+    if (image_size - position < sizeof(int64_t)) {
+      succeeded = false;
+      break;
+    }
+
+    ReferenceSerializeInput length_input(data + position, sizeof(int64_t));
+    size_t block_size = length_input.ReadLong();
+    position += sizeof(int64_t);
+    if (block_size < block_header_size || block_size > image_size - position) {
+      succeeded = false;
+      break;
+    }
+
+    ReferenceSerializeInput block_input(data + position, block_header_size);
+    oid_t database_oid = block_input.ReadInt();
+    oid_t table_oid = block_input.ReadInt();
+    oid_t index_oid = block_input.ReadInt();
+    table_blocks[std::make_pair(database_oid, table_oid)].emplace_back(
+        data + position, block_size);
+    image_indexes.emplace(database_oid, table_oid, index_oid);
+    position += block_size;
+  }
+
+  // Every index must have an image, since recovery only adds the entries
+  // of the tuples that were recovered from the WAL
+  auto catalog = catalog::Catalog::GetInstance();
+  auto database_count = catalog->GetDatabaseCount();
+  for (oid_t database_idx = 1; succeeded && database_idx < database_count;
+       database_idx++) {
+    auto database = catalog->GetDatabaseWithOffset(database_idx);
+    auto table_count = database->GetTableCount();
+    for (oid_t table_idx = 0; succeeded && table_idx < table_count;
+         table_idx++) {
+      storage::DataTable *target_table = database->GetTable(table_idx);
+      for (oid_t index_itr = 0; index_itr < target_table->GetIndexCount();
+           index_itr++) {
+        auto index_oid = target_table->GetIndex(index_itr)->GetOid();
+        if (image_indexes.count(std::make_tuple(
+                database->GetOid(), target_table->GetOid(), index_oid)) == 0) {
+          LOG_TRACE("Index %u has no image", index_oid);
+          succeeded = false;
+          break;
+        }
+      }
+    }
+  }
+
+  if (!succeeded) {
+    LOG_ERROR("Index images %s do not cover all indexes", file_name.c_str());
+    munmap(mapping, image_size);
+    return false;
+  }
+
+  std::vector<IndexBlocks *> tasks;
+  for (auto &blocks : table_blocks) {
+    tasks.push_back(&blocks.second);
+  }
+
+  std::atomic<size_t> next_task(0);
+  std::atomic<bool> loaded(true);
+  thread_count = std::min(std::max<size_t>(1, thread_count),
+                          std::max<size_t>(1, tasks.size()));
+  std::vector<std::thread> threads;
+  for (size_t thread_itr = 0; thread_itr < thread_count; thread_itr++) {
+    threads.emplace_back([&]() {
+      size_t task_itr;
+      while ((task_itr = next_task.fetch_add(1)) < tasks.size()) {
+        for (auto &block : *tasks[task_itr]) {
+          if (!LoadIndex(block.first, block.second)) {
+            loaded = false;
+          }
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  munmap(mapping, image_size);
+
+  if (!loaded) {
+    LOG_ERROR("Failed to load some index images of %s", file_name.c_str());
+  }
+  return loaded;
+}
+
+/**
+ * @brief Collect the keys of the tuples that are visible at the checkpoint
+ * cid and write them in key order
+ */
+size_t IndexImage::SerializeIndex(storage::DataTable *table,
+                                  index::Index *index, oid_t database_oid,
+                                  cid_t checkpoint_cid,
+                                  CopySerializeOutput &output) {
+  auto index_schema = index->GetMetadata()->GetCoveringSchema();
+  auto indexed_columns = index_schema->GetIndexedColumns();
+
+  CheckpointTileScanner scanner;
+  std::vector<IndexImageEntry> entries;
+  auto tile_group_count = table->GetTileGroupCount();
+  for (oid_t tile_group_offset = START_OID;
+       tile_group_offset < tile_group_count; tile_group_offset++) {
+    auto tile_group = table->GetTileGroup(tile_group_offset);
+    if (tile_group == nullptr) {
+      continue;
+    }
+
+    auto tile_group_header = tile_group->GetHeader();
+    oid_t tuple_slot_count = tile_group->GetNextTupleSlot();
+    for (oid_t tuple_slot = 0; tuple_slot < tuple_slot_count; tuple_slot++) {
+      if (!scanner.IsVisible(tile_group_header, tuple_slot, checkpoint_cid)) {
+        continue;
+      }
+
+      IndexImageEntry entry;
+      entry.location = ItemPointer(tile_group->GetTileGroupId(), tuple_slot);
+      entry.key.reserve(indexed_columns.size());
+      for (auto column_id : indexed_columns) {
+        entry.key.push_back(tile_group->GetValue(tuple_slot, column_id));
+      }
+      entries.push_back(std::move(entry));
+    }
+  }
+
+  std::sort(entries.begin(), entries.end(), KeyLessThan);
+
+  size_t block_begin = output.Size();
+  output.WriteLong(0);
+  output.WriteInt(database_oid);
+  output.WriteInt(table->GetOid());
+  output.WriteInt(index->GetOid());
+  output.WriteInt(entries.size());
+  for (auto &entry : entries) {
+    output.WriteInt(entry.location.block);
+    output.WriteInt(entry.location.offset);
+    for (auto &value : entry.key) {
+      value.SerializeTo(output);
+    }
+  }
+  output.WritePrimitiveAt<int64_t>(
+      block_begin, output.Size() - block_begin - sizeof(int64_t));
+
+  return entries.size();
+}
+
+/**
+ * @brief Insert the entries of an index block in key order. The entries
+ * point to the indirections of the restored tuples
+ */
+bool IndexImage::LoadIndex(const char *data, size_t size) {
+  if (size < 4 * sizeof(int32_t)) {
+    return false;
+  }
+
+  ReferenceSerializeInput input(data, size);
+  oid_t database_oid = input.ReadInt();
+  oid_t table_oid = input.ReadInt();
+  oid_t index_oid = input.ReadInt();
+  size_t entry_count = input.ReadInt();
+
+  auto table = catalog::Catalog::GetInstance()->GetTableWithOid(database_oid,
+                                                                table_oid);
+  if (table == nullptr) {
+    // the table was deleted
+    LOG_TRACE("Skip index %u of table %u", index_oid, table_oid);
+    return true;
+  }
+
+  std::shared_ptr<index::Index> index;
+  for (oid_t index_itr = 0; index_itr < table->GetIndexCount(); index_itr++) {
+    if (table->GetIndex(index_itr)->GetOid() == index_oid) {
+      index = table->GetIndex(index_itr);
+      break;
+    }
+  }
+  if (index == nullptr) {
+    // the index was dropped
+    LOG_TRACE("Skip index %u of table %u", index_oid, table_oid);
+    return true;
+  }
+
+  auto index_schema = index->GetMetadata()->GetCoveringSchema();
+  oid_t column_count = index_schema->GetColumnCount();
+  auto &manager = catalog::Manager::GetInstance();
+  type::EphemeralPool pool;
+  std::shared_ptr<storage::TileGroup> tile_group;
+  size_t entry_itr;
+
+  for (entry_itr = 0; entry_itr < entry_count; entry_itr++) {
+    if (input.RemainingBytes() < 2 * sizeof(int32_t)) {
+      break;
+    }
+
+    ItemPointer location;
+    location.block = input.ReadInt();
+    location.offset = input.ReadInt();
+
+    storage::Tuple key(index_schema, true);
+    for (oid_t column_itr = 0; column_itr < column_count; column_itr++) {
+      auto value = type::Value::DeserializeFrom(
+          input, index_schema->GetType(column_itr), &pool);
+      key.SetValue(column_itr, value, index->GetPool());
+    }
+
+    if (tile_group == nullptr ||
+        tile_group->GetTileGroupId() != location.block) {
+      tile_group = manager.GetTileGroup(location.block);
+    }
+    if (tile_group == nullptr ||
+        location.offset >= tile_group->GetAllocatedTupleCount()) {
+      LOG_ERROR("Index %u refers to missing tuple (%u, %u)", index_oid,
+                location.block, location.offset);
+      break;
+    }
+
+    // The indexes of a table share the indirection of a tuple
+    auto tile_group_header = tile_group->GetHeader();
+    ItemPointer *indirection =
+        tile_group_header->GetIndirection(location.offset);
+    if (indirection == nullptr) {
+      indirection = table->AllocateIndirection(location);
+      tile_group_header->SetIndirection(location.offset, indirection);
+    }
+
+    index->InsertEntry(&key, indirection);
+  }
+
+  index->IncreaseNumberOfTuplesBy(entry_itr);
+
+  LOG_TRACE("Loaded %lu entries of index %u", entry_itr, index_oid);
+  return entry_itr == entry_count;
+}
+
+}  // namespace logging
+}  // namespace peloton
@@ -0,0 +1,502 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// parallel_checkpoint.cpp
+//
+// Identification: src/logging/checkpoint/parallel_checkpoint.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <dirent.h>
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+
+#include "logging/checkpoint/parallel_checkpoint.h"
+#include "logging/checkpoint_tile_scanner.h"
+#include "logging/checkpoint_manager.h"
+#include "logging/log_manager.h"
+#include "logging/logging_util.h"
+
+#include "catalog/catalog.h"
+#include "catalog/manager.h"
+#include "concurrency/epoch_manager_factory.h"
+#include "concurrency/transaction_manager_factory.h"
+#include "storage/data_table.h"
+#include "storage/database.h"
+#include "storage/tile_group.h"
+#include "storage/tile_group_header.h"
+#include "storage/tuple.h"
+
+#include "common/logger.h"
+#include "type/ephemeral_pool.h"
+
+namespace peloton {
+namespace logging {
+
+//===--------------------------------------------------------------------===//
+// Parallel Checkpoint
+//===--------------------------------------------------------------------===//
+
+ParallelCheckpoint::ParallelCheckpoint(bool disable_file_access)
+    : Checkpoint(disable_file_access), next_task_(0), max_oid_(0) {
+  InitDirectory();
+  InitVersionNumber();
+}
+
+ParallelCheckpoint::~ParallelCheckpoint() {}
+
+void ParallelCheckpoint::DoCheckpoint() {
+  auto &log_manager = LogManager::GetInstance();
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+
+  cid_t checkpoint_cid = log_manager.GetGlobalMaxFlushedCommitId();
+  if (checkpoint_cid == INVALID_CID) {
+    checkpoint_cid = txn_manager.GetMaxCommittedCid();
+  }
+
+  LOG_TRACE("DoCheckpoint cid = %lu", checkpoint_cid);
+
+  // Keep the versions that are visible at the checkpoint cid from being
+  // recycled while we scan them
+  auto &epoch_manager = concurrency::EpochManagerFactory::GetInstance();
+  auto epoch_id = epoch_manager.EnterReadOnlyEpoch(checkpoint_cid);
+
+  // Collect the tile groups of all tables. Tile groups that are added later
+  // only hold tuples that are not visible at the checkpoint cid
+  tasks_.clear();
+  auto catalog = catalog::Catalog::GetInstance();
+  auto database_count = catalog->GetDatabaseCount();
+  for (oid_t database_idx = 1; database_idx < database_count; database_idx++) {
+    auto database = catalog->GetDatabaseWithOffset(database_idx);
+    auto table_count = database->GetTableCount();
+
+    for (oid_t table_idx = 0; table_idx < table_count; table_idx++) {
+      storage::DataTable *target_table = database->GetTable(table_idx);
+      PL_ASSERT(target_table);
+      auto tile_group_count = target_table->GetTileGroupCount();
+      for (oid_t tile_group_offset = START_OID;
+           tile_group_offset < tile_group_count; tile_group_offset++) {
+        auto tile_group = target_table->GetTileGroup(tile_group_offset);
+        if (tile_group != nullptr) {
+          tasks_.push_back({database->GetOid(), tile_group});
+        }
+      }
+    }
+  }
+
+  size_t part_count =
+      std::min(GetThreadCount(), std::max<size_t>(1, tasks_.size()));
+  int version = ++checkpoint_version;
+  next_task_ = 0;
+
+  std::vector<char> part_succeeded(part_count, false);
+  std::vector<std::thread> threads;
+  for (size_t part = 0; part < part_count; part++) {
+    threads.emplace_back([this, part, checkpoint_cid, &part_succeeded]() {
+      part_succeeded[part] = WritePart(part, checkpoint_cid);
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  epoch_manager.ExitReadOnlyEpoch(epoch_id);
+  tasks_.clear();
+
+  bool succeeded = std::all_of(part_succeeded.begin(), part_succeeded.end(),
+                               [](char part) { return part != false; });
+  if (!succeeded || !WriteManifest(checkpoint_cid, part_count)) {
+    LOG_ERROR("Failed to write checkpoint %d", version);
+    RemoveVersion(version, part_count);
+    checkpoint_version--;
+    return;
+  }
+
+  // Remove previous version
+  cid_t previous_cid;
+  size_t previous_part_count;
+  oid_t previous_max_oid;
+  if (version > 0 && ReadManifest(version - 1, previous_cid,
+                                  previous_part_count, previous_max_oid)) {
+    RemoveVersion(version - 1, previous_part_count);
+  }
+
+  // Truncate logs
+  log_manager.TruncateLogs(checkpoint_cid);
+  most_recent_checkpoint_cid = checkpoint_cid;
+}
+
+cid_t ParallelCheckpoint::DoRecovery() {
+  // No checkpoint to recover from
+  if (checkpoint_version < 0 || disable_file_access) {
+    return 0;
+  }
+
+  cid_t checkpoint_cid;
+  size_t part_count;
+  oid_t max_tile_group_id;
+  if (!ReadManifest(checkpoint_version, checkpoint_cid, part_count,
+                    max_tile_group_id)) {
+    return 0;
+  }
+  max_oid_ = max_tile_group_id;
+
+  // Load the parts in parallel
+  std::vector<char> part_succeeded(part_count, false);
+  std::vector<std::thread> threads;
+  for (size_t part = 0; part < part_count; part++) {
+    threads.emplace_back([this, part, checkpoint_cid, &part_succeeded]() {
+      part_succeeded[part] = RecoverPart(part, checkpoint_cid);
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (size_t part = 0; part < part_count; part++) {
+    if (!part_succeeded[part]) {
+      LOG_ERROR("Failed to recover part %lu of checkpoint %d", part,
+                checkpoint_version);
+    }
+  }
+
+  // After finishing recovery, set the next oid with maximum oid
+  // observed during the recovery
+  auto &manager = catalog::Manager::GetInstance();
+  if (max_oid_ > manager.GetNextTileGroupId()) {
+    manager.SetNextTileGroupId(max_oid_);
+  }
+
+  concurrency::TransactionManagerFactory::GetInstance().SetNextCid(
+      checkpoint_cid);
+  CheckpointManager::GetInstance().SetRecoveredCid(checkpoint_cid);
+  most_recent_checkpoint_cid = checkpoint_cid;
+  return checkpoint_cid;
+}
+
+/**
+ * @brief Serialize the tuples of a tile group that are visible at the
+ * checkpoint cid, column by column
+ */
+size_t ParallelCheckpoint::SerializeTileGroup(storage::TileGroup *tile_group,
+                                              oid_t database_oid,
+                                              cid_t checkpoint_cid,
+                                              CopySerializeOutput &output) {
+  auto tile_group_header = tile_group->GetHeader();
+  oid_t active_tuple_count = tile_group->GetNextTupleSlot();
+  CheckpointTileScanner scanner;
+
+  std::vector<oid_t> tuple_slots;
+  for (oid_t tuple_id = 0; tuple_id < active_tuple_count; tuple_id++) {
+    if (scanner.IsVisible(tile_group_header, tuple_id, checkpoint_cid)) {
+      tuple_slots.push_back(tuple_id);
+    }
+  }
+
+  output.Reset();
+  if (tuple_slots.empty()) {
+    return 0;
+  }
+
+  auto table =
+      static_cast<storage::DataTable *>(tile_group->GetAbstractTable());
+  oid_t column_count = table->GetSchema()->GetColumnCount();
+
+  // reserve 4 bytes for the block length
+  output.WriteInt(0);
+  output.WriteInt(database_oid);
+  output.WriteInt(table->GetOid());
+  output.WriteInt(tile_group->GetTileGroupId());
+  output.WriteInt(tuple_slots.size());
+  for (auto tuple_slot : tuple_slots) {
+    output.WriteInt(tuple_slot);
+  }
+
+  for (oid_t column_itr = 0; column_itr < column_count; column_itr++) {
+    for (auto tuple_slot : tuple_slots) {
+      tile_group->GetValue(tuple_slot, column_itr).SerializeTo(output);
+    }
+  }
+
+  output.WriteIntAt(0, static_cast<int32_t>(output.Size() - sizeof(int32_t)));
+  return tuple_slots.size();
+}
+
+/**
+ * @brief Insert the tuples of a tile group block into their tile group
+ */
+bool ParallelCheckpoint::RecoverTileGroup(const char *data, size_t size,
+                                          cid_t checkpoint_cid) {
+  CopySerializeInput input(data, size);
+  if (size < 4 * sizeof(int32_t)) {
+    return false;
+  }
+
+  oid_t database_oid = input.ReadInt();
+  oid_t table_oid = input.ReadInt();
+  oid_t tile_group_id = input.ReadInt();
+  size_t tuple_count = input.ReadInt();
+  if (tuple_count * sizeof(int32_t) > input.RemainingBytes()) {
+    return false;
+  }
+
+  auto table = catalog::Catalog::GetInstance()->GetTableWithOid(database_oid,
+                                                                table_oid);
+  if (table == nullptr) {
+    // the table was deleted
+    LOG_TRACE("Skip tile group %u of table %u", tile_group_id, table_oid);
+    return true;
+  }
+
+  std::vector<oid_t> tuple_slots(tuple_count);
+  for (auto &tuple_slot : tuple_slots) {
+    tuple_slot = input.ReadInt();
+  }
+
+  // Build the tuples column by column
+  auto schema = table->GetSchema();
+  oid_t column_count = schema->GetColumnCount();
+  type::EphemeralPool pool;
+  std::vector<std::unique_ptr<storage::Tuple>> tuples(tuple_count);
+  for (auto &tuple : tuples) {
+    tuple.reset(new storage::Tuple(schema, true));
+  }
+  for (oid_t column_itr = 0; column_itr < column_count; column_itr++) {
+    auto column_type = schema->GetType(column_itr);
+    for (auto &tuple : tuples) {
+      auto value = type::Value::DeserializeFrom(input, column_type, &pool);
+      tuple->SetValue(column_itr, value, &pool);
+    }
+  }
+
+  auto &manager = catalog::Manager::GetInstance();
+  auto tile_group = manager.GetTileGroup(tile_group_id);
+  if (tile_group == nullptr) {
+    std::lock_guard<std::mutex> lock(recovery_mutex_);
+    tile_group = manager.GetTileGroup(tile_group_id);
+    if (tile_group == nullptr) {
+      table->AddTileGroupWithOidForRecovery(tile_group_id);
+      tile_group = manager.GetTileGroup(tile_group_id);
+    }
+  }
+
+  size_t inserted_count = 0;
+  for (size_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+    auto inserted_slot = tile_group->InsertTupleFromCheckpoint(
+        tuple_slots[tuple_itr], tuples[tuple_itr].get(), checkpoint_cid);
+    if (inserted_slot != INVALID_OID) {
+      inserted_count++;
+    }
+  }
+  table->IncreaseTupleCount(inserted_count);
+
+  LOG_TRACE("Recovered %lu tuples of tile group %u", inserted_count,
+            tile_group_id);
+  return true;
+}
+
+// Private Functions
+std::string ParallelCheckpoint::GetPartFileName(int version, size_t part) {
+  return checkpoint_dir + "/" + PART_FILE_PREFIX + std::to_string(version) +
+         "_" + std::to_string(part) + PART_FILE_SUFFIX;
+}
+
+std::string ParallelCheckpoint::GetManifestFileName(int version) {
+  return checkpoint_dir + "/" + PART_FILE_PREFIX + std::to_string(version) +
+         MANIFEST_FILE_SUFFIX;
+}
+
+bool ParallelCheckpoint::WritePart(size_t part, cid_t checkpoint_cid) {
+  FileHandle file_handle;
+  if (!disable_file_access) {
+    std::string file_name = GetPartFileName(checkpoint_version, part);
+    if (!LoggingUtil::InitFileHandle(file_name.c_str(), file_handle, "wb")) {
+      return false;
+    }
+  }
+
+  CopySerializeOutput output;
+  bool succeeded = true;
+  size_t tuple_count = 0;
+
+  while (true) {
+    size_t task_itr = next_task_.fetch_add(1);
+    if (task_itr >= tasks_.size()) {
+      break;
+    }
+
+    auto &task = tasks_[task_itr];
+    tuple_count += SerializeTileGroup(task.tile_group.get(), task.database_oid,
+                                      checkpoint_cid, output);
+
+    auto tile_group_id = task.tile_group->GetTileGroupId();
+    oid_t max_oid = max_oid_.load();
+    while (tile_group_id > max_oid &&
+           !max_oid_.compare_exchange_weak(max_oid, tile_group_id)) {
+    }
+
+    if (output.Size() > 0 && !disable_file_access) {
+      if (fwrite(output.Data(), 1, output.Size(), file_handle.file) !=
+          output.Size()) {
+        LOG_ERROR("Failed to write checkpoint part %lu", part);
+        succeeded = false;
+        break;
+      }
+    }
+  }
+
+  if (!disable_file_access) {
+    LoggingUtil::FFlushFsync(file_handle);
+    fclose(file_handle.file);
+  }
+
+  LOG_TRACE("Checkpoint part %lu holds %lu tuples", part, tuple_count);
+  return succeeded;
+}
+
+bool ParallelCheckpoint::RecoverPart(size_t part, cid_t checkpoint_cid) {
+  std::string file_name = GetPartFileName(checkpoint_version, part);
+  FileHandle file_handle;
+  if (!LoggingUtil::InitFileHandle(file_name.c_str(), file_handle, "rb")) {
+    return false;
+  }
+
+  bool succeeded = true;
+  std::vector<char> block;
+  while (true) {
+    char length_buffer[sizeof(int32_t)];
+    size_t read_size =
+        fread(length_buffer, 1, sizeof(length_buffer), file_handle.file);
+    if (read_size == 0) {
+      break;
+    }
+
+    CopySerializeInput length_input(length_buffer, read_size);
+    if (read_size != sizeof(length_buffer)) {
+      succeeded = false;
+      break;
+    }
+
+    size_t block_size = length_input.ReadInt();
+    block.resize(block_size);
+    if (fread(block.data(), 1, block_size, file_handle.file) != block_size ||
+        !RecoverTileGroup(block.data(), block_size, checkpoint_cid)) {
+      succeeded = false;
+      break;
+    }
+  }
+
+  fclose(file_handle.file);
+  return succeeded;
+}
+
+bool ParallelCheckpoint::WriteManifest(cid_t checkpoint_cid,
+                                       size_t part_count) {
+  if (disable_file_access) return true;
+
+  FileHandle file_handle;
+  std::string file_name = GetManifestFileName(checkpoint_version);
+  if (!LoggingUtil::InitFileHandle(file_name.c_str(), file_handle, "wb")) {
+    return false;
+  }
+
+  CopySerializeOutput output;
+  output.WriteLong(checkpoint_cid);
+  output.WriteInt(part_count);
+  output.WriteInt(max_oid_.load());
+
+  bool succeeded =
+      fwrite(output.Data(), 1, output.Size(), file_handle.file) ==
+      output.Size();
+  LoggingUtil::FFlushFsync(file_handle);
+  fclose(file_handle.file);
+  return succeeded;
+}
+
+bool ParallelCheckpoint::ReadManifest(int version, cid_t &checkpoint_cid,
+                                      size_t &part_count,
+                                      oid_t &max_tile_group_id) {
+  if (disable_file_access) return false;
+
+  std::string file_name = GetManifestFileName(version);
+  FileHandle file_handle;
+  if (!LoggingUtil::InitFileHandle(file_name.c_str(), file_handle, "rb")) {
+    return false;
+  }
+
+  char manifest[sizeof(int64_t) + 2 * sizeof(int32_t)];
+  size_t read_size = fread(manifest, 1, sizeof(manifest), file_handle.file);
+  fclose(file_handle.file);
+  if (read_size != sizeof(manifest)) {
+    LOG_ERROR("Torn checkpoint manifest %s", file_name.c_str());
+    return false;
+  }
+
+  CopySerializeInput input(manifest, sizeof(manifest));
+  checkpoint_cid = input.ReadLong();
+  part_count = input.ReadInt();
+  max_tile_group_id = input.ReadInt();
+  return true;
+}
+
+void ParallelCheckpoint::RemoveVersion(int version, size_t part_count) {
+  if (disable_file_access) return;
+
+  // Remove the manifest first, so that a partially removed version is
+  // never recovered
+  auto manifest_name = GetManifestFileName(version);
+  if (remove(manifest_name.c_str()) != 0) {
+    LOG_TRACE("Failed to remove file %s", manifest_name.c_str());
+  }
+
+  for (size_t part = 0; part < part_count; part++) {
+    auto file_name = GetPartFileName(version, part);
+    if (remove(file_name.c_str()) != 0) {
+      LOG_TRACE("Failed to remove file %s", file_name.c_str());
+    }
+  }
+}
+
+void ParallelCheckpoint::InitVersionNumber() {
+  // Get the version of the most recent complete checkpoint
+  LOG_TRACE("Trying to read checkpoint directory");
+  struct dirent *file;
+  auto dirp = opendir(checkpoint_dir.c_str());
+  if (dirp == nullptr) {
+    LOG_TRACE("Opendir failed: Errno: %d, error: %s", errno, strerror(errno));
+    return;
+  }
+
+  while ((file = readdir(dirp)) != NULL) {
+    std::string file_name(file->d_name);
+    if (file_name.compare(0, PART_FILE_PREFIX.length(), PART_FILE_PREFIX) ==
+            0 &&
+        file_name.length() > MANIFEST_FILE_SUFFIX.length() &&
+        file_name.compare(file_name.length() - MANIFEST_FILE_SUFFIX.length(),
+                          MANIFEST_FILE_SUFFIX.length(),
+                          MANIFEST_FILE_SUFFIX) == 0) {
+      LOG_TRACE("Found a checkpoint manifest with name %s", file->d_name);
+      int version = LoggingUtil::ExtractNumberFromFileName(file->d_name);
+      if (version > checkpoint_version) {
+        checkpoint_version = version;
+      }
+    }
+  }
+  closedir(dirp);
+  LOG_TRACE("set checkpoint version to: %d", checkpoint_version);
+}
+
+size_t ParallelCheckpoint::GetThreadCount() const {
+  size_t thread_count = thread_count_;
+  if (thread_count == 0) {
+    thread_count = std::thread::hardware_concurrency();
+  }
+  return std::max<size_t>(1, thread_count);
+}
+
+}  // namespace logging
+}  // namespace peloton
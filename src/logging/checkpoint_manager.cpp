@@ -104,5 +104,13 @@ void CheckpointManager::SetRecoveredCid(cid_t recovered_cid) {
 
 cid_t CheckpointManager::GetRecoveredCid() { return recovered_cid_; }
 
+void CheckpointManager::SetIndexRecoveredCid(cid_t index_recovered_cid) {
+  this->index_recovered_cid_ = index_recovered_cid;
+}
+
+cid_t CheckpointManager::GetIndexRecoveredCid() {
+  return index_recovered_cid_;
+}
+
 }  // logging
 }  // peloton
@@ -261,18 +261,51 @@ void FrontendLogger::CollectLogRecordsFromBackendLoggers() {
   }
 }
 
+bool FrontendLogger::ReplayLog(UNUSED_ATTRIBUTE const char *data,
+                               UNUSED_ATTRIBUTE size_t len) {
+  LOG_ERROR("This frontend logger can not replay a shipped log");
+  return false;
+}
+
 cid_t FrontendLogger::GetMaxFlushedCommitId() { return max_flushed_commit_id; }
 
 void FrontendLogger::SetMaxFlushedCommitId(cid_t cid) {
   max_flushed_commit_id = cid;
 }
 
+size_t FrontendLogger::GetBufferWaitCount() {
+  size_t wait_count = 0;
+  backend_loggers_lock.Lock();
+  for (auto backend_logger : backend_loggers) {
+    wait_count += backend_logger->GetBufferWaitCount();
+  }
+  backend_loggers_lock.Unlock();
+  return wait_count;
+}
+
+uint64_t FrontendLogger::GetBufferWaitTime() {
+  uint64_t wait_time = 0;
+  backend_loggers_lock.Lock();
+  for (auto backend_logger : backend_loggers) {
+    wait_time += backend_logger->GetBufferWaitTime();
+  }
+  backend_loggers_lock.Unlock();
+  return wait_time;
+}
+
 void FrontendLogger::SetBackendLoggerLoggedCid(BackendLogger &bel) {
   backend_loggers_lock.Lock();
   bel.SetLoggingCidLowerBound(max_seen_commit_id);
   backend_loggers_lock.Unlock();
 }
 
+void FrontendLogger::SetBackendLoggerCommitCid(BackendLogger &bel) {
+  backend_loggers_lock.Lock();
+  bel.SetLoggingCidLowerBound(max_seen_commit_id);
+  bel.SetCommitIdFloor(max_seen_commit_id + 1);
+  backend_loggers_lock.Unlock();
+}
+
 /**
  * @brief Add backend logger to the list of backend loggers
  * @param backend logger
@@ -0,0 +1,60 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// group_commit_scheduler.cpp
+//
+// Identification: src/logging/group_commit_scheduler.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "logging/group_commit_scheduler.h"
+
+namespace peloton {
+namespace logging {
+
+GroupCommitScheduler::GroupCommitScheduler(
+    std::chrono::microseconds latency_target, size_t byte_budget)
+    : latency_target_(latency_target), byte_budget_(byte_budget) {}
+
+void GroupCommitScheduler::AddPending(size_t byte_count, size_t commit_count) {
+  if (pending_ == false) {
+    pending_ = true;
+    oldest_pending_ = Clock::now();
+  }
+
+  pending_bytes_ += byte_count;
+  pending_commits_ += commit_count;
+}
+
+bool GroupCommitScheduler::ShouldFlush(size_t waiter_count) const {
+  if (pending_ == false) {
+    return false;
+  }
+
+  // Committing backends are blocked on this flush
+  if (waiter_count > 0) {
+    return true;
+  }
+
+  if (byte_budget_ != 0 && pending_bytes_ >= byte_budget_) {
+    return true;
+  }
+
+  return Clock::now() - oldest_pending_ >= latency_target_;
+}
+
+size_t GroupCommitScheduler::Flushed() {
+  size_t batch_size = pending_commits_;
+
+  pending_ = false;
+  pending_bytes_ = 0;
+  pending_commits_ = 0;
+
+  return batch_size;
+}
+
+}  // namespace logging
+}  // namespace peloton
@@ -32,10 +32,16 @@ LogBuffer::LogBuffer(BackendLogger *backend_logger)
 
 bool LogBuffer::WriteRecord(LogRecord *record) {
   bool success = WriteData(record->GetMessage(), record->GetMessageLength());
+  if (success && record->IsCommit()) {
+    commit_count_++;
+  }
   return success;
 }
 
-void LogBuffer::ResetData() { size_ = 0; }
+void LogBuffer::ResetData() {
+  size_ = 0;
+  commit_count_ = 0;
+}
 
 // Internal Methods
 bool LogBuffer::WriteData(char *data, size_t len) {
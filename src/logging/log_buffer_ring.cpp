@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// log_buffer_ring.cpp
+//
+// Identification: src/logging/log_buffer_ring.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>
+#include <xmmintrin.h>
+
+#include "logging/log_buffer_ring.h"
+#include "common/logger.h"
+
+namespace peloton {
+namespace logging {
+
+//===--------------------------------------------------------------------===//
+// Log Buffer Ring
+//===--------------------------------------------------------------------===//
+LogBufferRing::LogBufferRing()
+    : head_(0),
+      tail_(0),
+      full_wait_count_(0),
+      empty_wait_count_(0),
+      wait_time_us_(0) {
+  PL_MEMSET(buffers_, 0, sizeof(buffers_));
+}
+
+LogBufferRing::~LogBufferRing() {
+  while (TryGet()) {
+  }
+}
+
+bool LogBufferRing::Put(std::unique_ptr<LogBuffer> buffer) {
+  auto head = head_.load(std::memory_order_relaxed);
+
+  if (head - tail_.load(std::memory_order_acquire) == BUFFER_POOL_SIZE) {
+    auto start = std::chrono::steady_clock::now();
+    while (head - tail_.load(std::memory_order_acquire) == BUFFER_POOL_SIZE) {
+      _mm_pause();
+    }
+    full_wait_count_++;
+    wait_time_us_ += std::chrono::duration_cast<std::chrono::microseconds>(
+                         std::chrono::steady_clock::now() - start).count();
+  }
+
+  LOG_TRACE("LogBufferRing::Put - head: %u", head);
+  buffers_[head & (BUFFER_POOL_SIZE - 1)] = buffer.release();
+  head_.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+std::unique_ptr<LogBuffer> LogBufferRing::Get() {
+  auto tail = tail_.load(std::memory_order_relaxed);
+
+  if (head_.load(std::memory_order_acquire) == tail) {
+    auto start = std::chrono::steady_clock::now();
+    while (head_.load(std::memory_order_acquire) == tail) {
+      _mm_pause();
+    }
+    empty_wait_count_++;
+    wait_time_us_ += std::chrono::duration_cast<std::chrono::microseconds>(
+                         std::chrono::steady_clock::now() - start).count();
+  }
+
+  return TryGet();
+}
+
+std::unique_ptr<LogBuffer> LogBufferRing::TryGet() {
+  auto tail = tail_.load(std::memory_order_relaxed);
+  if (head_.load(std::memory_order_acquire) == tail) {
+    return std::unique_ptr<LogBuffer>(nullptr);
+  }
+
+  LOG_TRACE("LogBufferRing::Get - tail: %u", tail);
+  std::unique_ptr<LogBuffer> buffer(buffers_[tail & (BUFFER_POOL_SIZE - 1)]);
+  buffers_[tail & (BUFFER_POOL_SIZE - 1)] = nullptr;
+  tail_.store(tail + 1, std::memory_order_release);
+  return buffer;
+}
+
+unsigned int LogBufferRing::GetSize() {
+  auto tail = tail_.load(std::memory_order_acquire);
+  return head_.load(std::memory_order_acquire) - tail;
+}
+
+}  // namespace logging
+}  // namespace peloton
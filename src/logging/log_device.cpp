@@ -0,0 +1,611 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// log_device.cpp
+//
+// Identification: src/logging/log_device.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "logging/log_device.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+// IORING_OP_WRITE needs the headers of Linux 5.6 or newer
+#if defined(__NR_io_uring_setup) && defined(IORING_FEAT_RW_CUR_POS)
+#define PELOTON_HAVE_IO_URING
+#endif
+#endif
+#endif
+
+#include "common/logger.h"
+#include "common/macros.h"
+
+namespace peloton {
+namespace logging {
+
+static inline size_t RoundUpToBlock(size_t size) {
+  return (size + LogDevice::LOG_BLOCK_SIZE - 1) & ~(LogDevice::LOG_BLOCK_SIZE - 1);
+}
+
+// Initial size of the staging buffer
+static constexpr size_t INITIAL_STAGING_CAPACITY = 64 * 1024;
+
+LogDevice::LogDevice() {}
+
+LogDevice::~LogDevice() {}
+
+LogDevice::AlignedBuffer LogDevice::AllocateAligned(size_t size) {
+  void *buffer = nullptr;
+  if (posix_memalign(&buffer, LOG_BLOCK_SIZE, size) != 0) {
+    throw std::bad_alloc();
+  }
+  return AlignedBuffer(static_cast<char *>(buffer));
+}
+
+bool LogDevice::Open(const std::string &file_name, size_t preallocate_size) {
+  PL_ASSERT(fd_ == -1);
+
+  direct_ = true;
+  fd_ = open(file_name.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_DIRECT, 0666);
+  if (fd_ == -1 && errno == EINVAL) {
+    // The file system does not support direct I/O (e.g. tmpfs)
+    LOG_TRACE("O_DIRECT is not supported for %s", file_name.c_str());
+    direct_ = false;
+    fd_ = open(file_name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+  }
+  if (fd_ == -1) {
+    LOG_ERROR("Could not open log segment %s: %s", file_name.c_str(),
+              strerror(errno));
+    return false;
+  }
+
+  if (preallocate_size != 0 &&
+      fallocate(fd_, 0, 0, RoundUpToBlock(preallocate_size)) != 0) {
+    // Not fatal, the segment then grows with every write
+    LOG_TRACE("Could not preallocate log segment %s: %s", file_name.c_str(),
+              strerror(errno));
+  }
+
+  size_ = 0;
+  staging_offset_ = 0;
+  staging_length_ = 0;
+  staging_dirty_ = false;
+  if (staging_ == nullptr) {
+    staging_capacity_ = INITIAL_STAGING_CAPACITY;
+    staging_ = AllocateAligned(staging_capacity_);
+  }
+
+  return true;
+}
+
+void LogDevice::Close() {
+  if (fd_ == -1) {
+    return;
+  }
+
+  WaitForDurable(Flush());
+
+  if (close(fd_) != 0) {
+    LOG_ERROR("Error occured while closing log segment: %s", strerror(errno));
+  }
+  fd_ = -1;
+}
+
+void LogDevice::ReserveStaging(size_t size) {
+  if (size <= staging_capacity_) {
+    return;
+  }
+
+  size_t capacity = staging_capacity_;
+  while (capacity < size) capacity *= 2;
+
+  AlignedBuffer staging = AllocateAligned(capacity);
+  memcpy(staging.get(), staging_.get(), staging_length_);
+  staging_ = std::move(staging);
+  staging_capacity_ = capacity;
+}
+
+void LogDevice::Append(const char *data, size_t size) {
+  PL_ASSERT(fd_ != -1);
+
+  // Leave room for padding the last block
+  ReserveStaging(RoundUpToBlock(staging_length_ + size));
+  memcpy(staging_.get() + staging_length_, data, size);
+  staging_length_ += size;
+  size_ += size;
+  staging_dirty_ = true;
+}
+
+uint64_t LogDevice::Flush() {
+  if (staging_dirty_ == false) {
+    return next_ticket_ - 1;
+  }
+
+  while (in_flight_.size() >= MAX_IN_FLIGHT) {
+    ReapBatches(true);
+    RetireBatches();
+  }
+
+  size_t length = RoundUpToBlock(staging_length_);
+  memset(staging_.get() + staging_length_, 0, length - staging_length_);
+
+  std::unique_ptr<Batch> batch(new Batch());
+  batch->ticket = next_ticket_++;
+  batch->offset = staging_offset_;
+  batch->length = length;
+
+  // The unfinished last block is completed and written again by the next
+  // batch
+  size_t finished = staging_length_ & ~(LOG_BLOCK_SIZE - 1);
+  size_t unfinished = staging_length_ - finished;
+
+  AlignedBuffer staging = AllocateAligned(staging_capacity_);
+  memcpy(staging.get(), staging_.get() + finished, unfinished);
+
+  batch->buffer = std::move(staging_);
+  staging_ = std::move(staging);
+  staging_offset_ += finished;
+  staging_length_ = unfinished;
+  staging_dirty_ = false;
+
+  Batch *submitted = batch.get();
+  in_flight_.push_back(std::move(batch));
+  SubmitBatch(submitted);
+
+  return submitted->ticket;
+}
+
+bool LogDevice::CanFlush() {
+  ReapBatches(false);
+  RetireBatches();
+  return in_flight_.size() < MAX_IN_FLIGHT;
+}
+
+uint64_t LogDevice::GetDurableTicket() {
+  if (in_flight_.empty() == false) {
+    ReapBatches(false);
+    RetireBatches();
+  }
+  return durable_ticket_;
+}
+
+void LogDevice::WaitForDurable(uint64_t ticket) {
+  PL_ASSERT(ticket < next_ticket_);
+
+  RetireBatches();
+  while (durable_ticket_ < ticket) {
+    ReapBatches(true);
+    RetireBatches();
+  }
+}
+
+void LogDevice::RetireBatches() {
+  while (in_flight_.empty() == false &&
+         in_flight_.front()->done.load(std::memory_order_acquire) == true) {
+    durable_ticket_ = in_flight_.front()->ticket;
+    in_flight_.pop_front();
+  }
+}
+
+void LogDevice::Overwrite(size_t offset, const char *data, size_t size) {
+  PL_ASSERT(fd_ != -1);
+  PL_ASSERT(offset + size <= size_);
+
+  WaitForDurable(Flush());
+
+  Batch batch;
+  batch.offset = offset & ~(LOG_BLOCK_SIZE - 1);
+  batch.length = RoundUpToBlock(offset + size) - batch.offset;
+  batch.buffer = AllocateAligned(batch.length);
+
+  // Read back the blocks to patch
+  size_t read = 0;
+  while (read < batch.length) {
+    ssize_t ret = pread(fd_, batch.buffer.get() + read, batch.length - read,
+                        batch.offset + read);
+    if (ret < 0 && errno == EINTR) continue;
+    if (ret <= 0) break;
+    read += ret;
+  }
+  memset(batch.buffer.get() + read, 0, batch.length - read);
+  memcpy(batch.buffer.get() + (offset - batch.offset), data, size);
+
+  if (WriteBatch(fd_, batch) == false || SyncData(fd_) == false) {
+    LOG_ERROR("Could not overwrite %lu bytes at offset %lu", size, offset);
+  }
+
+  // The unfinished block in the staging buffer must not undo the change
+  size_t staging_end = staging_offset_ + staging_length_;
+  if (offset + size > staging_offset_ && offset < staging_end) {
+    size_t begin = std::max(offset, staging_offset_);
+    size_t end = std::min(offset + size, staging_end);
+    memcpy(staging_.get() + (begin - staging_offset_), data + (begin - offset),
+           end - begin);
+  }
+}
+
+bool LogDevice::WriteBatch(int fd, const Batch &batch) {
+  size_t written = 0;
+  while (written < batch.length) {
+    ssize_t ret = pwrite(fd, batch.buffer.get() + written,
+                         batch.length - written, batch.offset + written);
+    if (ret < 0) {
+      if (errno == EINTR) continue;
+      LOG_ERROR("Error occured in pwrite(%s)", strerror(errno));
+      return false;
+    }
+    written += ret;
+  }
+  return true;
+}
+
+bool LogDevice::SyncData(int fd) {
+  if (fdatasync(fd) != 0) {
+    LOG_ERROR("Error occured in fdatasync(%s)", strerror(errno));
+    return false;
+  }
+  return true;
+}
+
+//===--------------------------------------------------------------------===//
+// pwrite() Device
+//===--------------------------------------------------------------------===//
+
+/*
+ * class PwriteLogDevice - Writes batches on a background thread
+ *
+ * All batches that are queued when the thread wakes up are written in
+ * order and made durable with a single fdatasync(). A single thread is
+ * enough: the batches of a segment are written sequentially anyway, since
+ * each one rewrites the last block of its predecessor.
+ */
+class PwriteLogDevice : public LogDevice {
+ public:
+  PwriteLogDevice() : writer_(&PwriteLogDevice::WriterLoop, this) {}
+
+  ~PwriteLogDevice() {
+    Close();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    queued_cv_.notify_all();
+    writer_.join();
+  }
+
+  const char *GetName() const { return "pwrite"; }
+
+ protected:
+  void SubmitBatch(Batch *batch) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      queue_.push_back(batch);
+    }
+    queued_cv_.notify_all();
+  }
+
+  void ReapBatches(bool wait) {
+    if (wait == false) {
+      return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    completed_cv_.wait(lock, [this] { return completed_ != reaped_; });
+    reaped_ = completed_;
+  }
+
+ private:
+  void WriterLoop() {
+    std::vector<Batch *> batches;
+
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        queued_cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+        if (queue_.empty()) {
+          return;
+        }
+        batches.assign(queue_.begin(), queue_.end());
+        queue_.clear();
+      }
+
+      for (auto batch : batches) {
+        WriteBatch(fd_, *batch);
+      }
+      SyncData(fd_);
+
+      for (auto batch : batches) {
+        batch->done.store(true, std::memory_order_release);
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        completed_ += batches.size();
+      }
+      completed_cv_.notify_all();
+    }
+  }
+
+  std::mutex mutex_;
+
+  std::condition_variable queued_cv_;
+
+  std::condition_variable completed_cv_;
+
+  std::deque<Batch *> queue_;
+
+  // Number of batches written by the thread, and seen by ReapBatches()
+  size_t completed_ = 0;
+  size_t reaped_ = 0;
+
+  bool stop_ = false;
+
+  std::thread writer_;
+};
+
+#ifdef PELOTON_HAVE_IO_URING
+
+//===--------------------------------------------------------------------===//
+// io_uring Device
+//===--------------------------------------------------------------------===//
+
+// Entries of the submission queue
+static constexpr unsigned RING_ENTRIES = 64;
+
+// Writes that a batch is split into, and the smallest size of a write
+static constexpr size_t MAX_WRITES_PER_BATCH = 8;
+static constexpr size_t MIN_WRITE_SIZE = 64 * 1024;
+
+/*
+ * class IoUringLogDevice - Writes batches through an io_uring
+ *
+ * A batch is split into up to MAX_WRITES_PER_BATCH writes that the kernel
+ * may execute in parallel, followed by a data sync that drains the ring.
+ * The drain orders the sync after the writes of its batch. The next batch
+ * (which rewrites its last block) is only submitted once the sync has
+ * completed, so a failed or short write can be completed synchronously
+ * before anything else writes to its blocks.
+ *
+ * The ring is set up with raw system calls so that the build does not
+ * depend on liburing.
+ */
+class IoUringLogDevice : public LogDevice {
+ public:
+  ~IoUringLogDevice() {
+    Close();
+    if (sqes_ != nullptr) munmap(sqes_, sqes_size_);
+    if (cq_ring_ != nullptr) munmap(cq_ring_, cq_ring_size_);
+    if (sq_ring_ != nullptr) munmap(sq_ring_, sq_ring_size_);
+    if (ring_fd_ != -1) close(ring_fd_);
+  }
+
+  const char *GetName() const { return "io_uring"; }
+
+  // Returns nullptr if the kernel does not support io_uring (or does not
+  // allow it)
+  static std::unique_ptr<LogDevice> Create() {
+    std::unique_ptr<IoUringLogDevice> device(new IoUringLogDevice());
+    if (device->SetUp() == false) {
+      return nullptr;
+    }
+    return std::unique_ptr<LogDevice>(device.release());
+  }
+
+ protected:
+  void SubmitBatch(Batch *batch) {
+    queued_.push_back(batch);
+    if (submitted_ == nullptr) {
+      SubmitNextBatch();
+    }
+  }
+
+  void ReapBatches(bool wait) {
+    if (wait) {
+      int ret = syscall(__NR_io_uring_enter, ring_fd_, 0, 1,
+                        IORING_ENTER_GETEVENTS, nullptr, 0);
+      if (ret < 0 && errno != EINTR) {
+        LOG_ERROR("Error occured in io_uring_enter(%s)", strerror(errno));
+      }
+    }
+
+    unsigned head = *cq_head_;
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    for (; head != tail; head++) {
+      const io_uring_cqe &cqe = cqes_[head & *cq_mask_];
+      Batch *batch = reinterpret_cast<Batch *>(cqe.user_data & ~SYNC_TAG);
+
+      if ((cqe.user_data & SYNC_TAG) == 0) {
+        if (cqe.res > 0) {
+          written_ += cqe.res;
+        }
+        continue;
+      }
+
+      // A failed or short write is completed synchronously. The next batch
+      // has not been submitted yet, so nothing else writes to its blocks
+      PL_ASSERT(batch == submitted_);
+      if (cqe.res < 0 || written_ != batch->length) {
+        LOG_ERROR("Asynchronous log write failed, retrying synchronously");
+        WriteBatch(fd_, *batch);
+        SyncData(fd_);
+      }
+      batch->done.store(true, std::memory_order_release);
+      submitted_ = nullptr;
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+
+    if (submitted_ == nullptr && queued_.empty() == false) {
+      SubmitNextBatch();
+    }
+  }
+
+ private:
+  // Tags the user data of syncs; batches are at least 8 byte aligned
+  static constexpr uint64_t SYNC_TAG = 1;
+
+  IoUringLogDevice() {}
+
+  // Submit the writes and the data sync of the oldest queued batch
+  void SubmitNextBatch() {
+    Batch *batch = queued_.front();
+    queued_.pop_front();
+    submitted_ = batch;
+    written_ = 0;
+
+    size_t write_size =
+        std::max<size_t>(MIN_WRITE_SIZE,
+                 RoundUpToBlock((batch->length + MAX_WRITES_PER_BATCH - 1) /
+                                MAX_WRITES_PER_BATCH));
+
+    unsigned count = 0;
+    for (size_t offset = 0; offset < batch->length; offset += write_size) {
+      io_uring_sqe *sqe = GetSqe(count++);
+      sqe->opcode = IORING_OP_WRITE;
+      sqe->fd = fd_;
+      sqe->addr = reinterpret_cast<uint64_t>(batch->buffer.get() + offset);
+      sqe->len = std::min<size_t>(write_size, batch->length - offset);
+      sqe->off = batch->offset + offset;
+      sqe->user_data = reinterpret_cast<uint64_t>(batch);
+    }
+
+    io_uring_sqe *sqe = GetSqe(count++);
+    sqe->opcode = IORING_OP_FSYNC;
+    sqe->flags = IOSQE_IO_DRAIN;
+    sqe->fd = fd_;
+    sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+    sqe->user_data = reinterpret_cast<uint64_t>(batch) | SYNC_TAG;
+
+    __atomic_store_n(sq_tail_, *sq_tail_ + count, __ATOMIC_RELEASE);
+
+    while (count > 0) {
+      int ret = syscall(__NR_io_uring_enter, ring_fd_, count, 0, 0, nullptr, 0);
+      if (ret < 0) {
+        if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+          ReapBatches(false);
+          continue;
+        }
+        LOG_ERROR("Error occured in io_uring_enter(%s)", strerror(errno));
+        break;
+      }
+      count -= ret;
+    }
+  }
+
+  bool SetUp() {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    ring_fd_ = syscall(__NR_io_uring_setup, RING_ENTRIES, &params);
+    if (ring_fd_ < 0) {
+      LOG_TRACE("io_uring is not available: %s", strerror(errno));
+      ring_fd_ = -1;
+      return false;
+    }
+
+    // IORING_OP_WRITE is available from the same kernel version on
+    if ((params.features & IORING_FEAT_RW_CUR_POS) == 0) {
+      LOG_TRACE("io_uring does not support IORING_OP_WRITE");
+      return false;
+    }
+
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ =
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+
+    sq_ring_ = MapRing(sq_ring_size_, IORING_OFF_SQ_RING);
+    cq_ring_ = MapRing(cq_ring_size_, IORING_OFF_CQ_RING);
+    sqes_ = static_cast<io_uring_sqe *>(MapRing(sqes_size_, IORING_OFF_SQES));
+    if (sq_ring_ == nullptr || cq_ring_ == nullptr || sqes_ == nullptr) {
+      return false;
+    }
+
+    char *sq_ring = static_cast<char *>(sq_ring_);
+    sq_tail_ = reinterpret_cast<unsigned *>(sq_ring + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned *>(sq_ring + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned *>(sq_ring + params.sq_off.array);
+
+    char *cq_ring = static_cast<char *>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned *>(cq_ring + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned *>(cq_ring + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned *>(cq_ring + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe *>(cq_ring + params.cq_off.cqes);
+
+    return true;
+  }
+
+  void *MapRing(size_t size, off_t offset) {
+    void *ring = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring_fd_, offset);
+    return (ring == MAP_FAILED) ? nullptr : ring;
+  }
+
+  // Returns the index-th entry after the submission queue tail. At most one
+  // batch of MAX_WRITES_PER_BATCH + 1 entries is ever outstanding, so the
+  // queue cannot be full
+  io_uring_sqe *GetSqe(unsigned index) {
+    unsigned position = (*sq_tail_ + index) & *sq_mask_;
+    sq_array_[position] = position;
+    io_uring_sqe *sqe = &sqes_[position];
+    memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+  }
+
+  int ring_fd_ = -1;
+
+  void *sq_ring_ = nullptr;
+  void *cq_ring_ = nullptr;
+  io_uring_sqe *sqes_ = nullptr;
+
+  size_t sq_ring_size_ = 0;
+  size_t cq_ring_size_ = 0;
+  size_t sqes_size_ = 0;
+
+  unsigned *sq_tail_ = nullptr;
+  unsigned *sq_mask_ = nullptr;
+  unsigned *sq_array_ = nullptr;
+
+  unsigned *cq_head_ = nullptr;
+  unsigned *cq_tail_ = nullptr;
+  unsigned *cq_mask_ = nullptr;
+  io_uring_cqe *cqes_ = nullptr;
+
+  // Batches that wait for the sync of the submitted batch
+  std::deque<Batch *> queued_;
+
+  // Batch whose sync has not completed, and the bytes written for it
+  Batch *submitted_ = nullptr;
+  size_t written_ = 0;
+};
+
+#endif
+
+std::unique_ptr<LogDevice> LogDevice::Create() {
+#ifdef PELOTON_HAVE_IO_URING
+  auto device = IoUringLogDevice::Create();
+  if (device != nullptr) {
+    return device;
+  }
+#endif
+  return std::unique_ptr<LogDevice>(new PwriteLogDevice());
+}
+
+}  // namespace logging
+}  // namespace peloton
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <condition_variable>
 #include <memory>
 
@@ -18,10 +19,13 @@
 #include "common/logger.h"
 #include "common/macros.h"
 #include "concurrency/transaction_manager_factory.h"
+#include "configuration/configuration.h"
 #include "executor/executor_context.h"
 #include "logging/log_manager.h"
 #include "logging/logging_util.h"
 #include "logging/records/transaction_record.h"
+#include "logging/records/tuple_record.h"
+#include "statistics/backend_stats_context.h"
 #include "storage/data_table.h"
 #include "storage/database.h"
 #include "storage/tile_group.h"
@@ -33,6 +37,12 @@ namespace logging {
 // Each thread gets a backend logger
 thread_local static BackendLogger *backend_logger = nullptr;
 
+// Does the thread return from commits before they are flushed?
+thread_local static bool defer_flush_wait = false;
+
+// Largest commit id of the thread that was not waited for
+thread_local static cid_t deferred_commit_id = INVALID_CID;
+
 LogManager::LogManager() {
   Configure(peloton_logging_mode, false, DEFAULT_NUM_FRONTEND_LOGGERS,
             LOGGER_MAPPING_TYPE_ROUND_ROBIN);
@@ -159,9 +169,18 @@ void LogManager::PrepareLogging() {
   }
 }
 
+void LogManager::PrepareCommit() {
+  if (this->IsInLoggingMode()) {
+    auto logger = this->GetBackendLogger();
+    int frontend_logger_id = logger->GetFrontendLoggerID();
+    frontend_loggers[frontend_logger_id]->SetBackendLoggerCommitCid(*logger);
+  }
+}
+
 void LogManager::DoneLogging() {
   if (this->IsInLoggingMode()) {
     auto logger = this->GetBackendLogger();
+    logger->SetCommitIdFloor(INVALID_CID);
     logger->SetLoggingCidLowerBound(INVALID_CID);
   }
 }
@@ -204,6 +223,26 @@ void LogManager::LogUpdate(cid_t commit_id, const ItemPointer &old_version,
                                  new_tuple_tile_group->GetTableId(),
                                  new_tuple_tile_group->GetDatabaseId(),
                                  new_version, old_version, tuple.get()));
+
+      // The compact format only logs the changed columns. Recovery takes
+      // the others from the old version, which must therefore be in the
+      // same log stream
+      if (peloton_wal_compact_format && num_frontend_loggers_ == 1 &&
+          replicating_ == false) {
+        auto old_tuple_tile_group = manager.GetTileGroup(old_version.block);
+        std::vector<bool> changed_columns(schema->GetColumnCount());
+        for (oid_t col = 0; col < schema->GetColumnCount(); col++) {
+          type::Value old_val =
+              old_tuple_tile_group->GetValue(old_version.offset, col);
+          type::Value new_val = tuple->GetValue(col);
+          changed_columns[col] =
+              (old_val.IsNull() != new_val.IsNull()) ||
+              (!new_val.IsNull() &&
+               old_val.CompareEquals(new_val) != type::CMP_TRUE);
+        }
+        static_cast<TupleRecord *>(record.get())
+            ->SetChangedColumns(changed_columns);
+      }
     } else {
       // if wbl without replication, do not include tuple data
       record.reset(logger->GetTupleRecord(
@@ -272,11 +311,25 @@ void LogManager::LogDelete(cid_t commit_id,
 
 void LogManager::LogCommitTransaction(cid_t commit_id) {
   if (this->IsInLoggingMode()) {
+    auto start = std::chrono::steady_clock::now();
     auto logger = this->GetBackendLogger();
     TransactionRecord record(LOGRECORD_TYPE_TRANSACTION_COMMIT, commit_id);
     logger->Log(&record);
-    if (syncronization_commit) {
+    // a commit below the ids already seen is published above them
+    commit_id = std::max(commit_id, logger->GetLoggedCommitId());
+    if (syncronization_commit && defer_flush_wait) {
+      // The caller waits for the flush without blocking the thread
+      deferred_commit_id = std::max(deferred_commit_id, commit_id);
+    } else if (syncronization_commit) {
       WaitForFlush(commit_id);
+
+      if (FLAGS_stats_mode != STATS_TYPE_INVALID) {
+        auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start);
+        stats::BackendStatsContext::GetInstance()
+            ->GetCommitLatencyHistogram()
+            .Record(latency.count());
+      }
     }
     // logger->GetVarlenPool()->Purge();
   }
@@ -343,6 +396,18 @@ FrontendLogger *LogManager::GetFrontendLogger(unsigned int logger_idx) {
   return frontend_loggers[logger_idx].get();
 }
 
+/**
+ * @brief Replay a batch of log records shipped by a leader. The batches are
+ * replayed by the first frontend logger, in the order they arrive
+ */
+bool LogManager::ReplayLog(const char *data, size_t len) {
+  if (frontend_loggers.size() == 0) {
+    LOG_ERROR("No frontend logger to replay the log batch");
+    return false;
+  }
+  return frontend_loggers[0]->ReplayLog(data, len);
+}
+
 bool LogManager::ContainsFrontendLogger(void) {
   return (frontend_loggers.size() != 0);
 }
@@ -443,6 +508,30 @@ cid_t LogManager::GetGlobalMaxFlushedCommitId() {
   return global_max_flushed_commit_id;
 }
 
+size_t LogManager::GetLogBytes() {
+  size_t log_bytes = 0;
+  for (auto &frontend_logger : frontend_loggers) {
+    log_bytes += frontend_logger->GetLogBytes();
+  }
+  return log_bytes;
+}
+
+size_t LogManager::GetLogBufferWaitCount() {
+  size_t wait_count = 0;
+  for (auto &frontend_logger : frontend_loggers) {
+    wait_count += frontend_logger->GetBufferWaitCount();
+  }
+  return wait_count;
+}
+
+uint64_t LogManager::GetLogBufferWaitTime() {
+  uint64_t wait_time = 0;
+  for (auto &frontend_logger : frontend_loggers) {
+    wait_time += frontend_logger->GetBufferWaitTime();
+  }
+  return wait_time;
+}
+
 void LogManager::SetGlobalMaxFlushedCommitId(cid_t new_max) {
   if (new_max != global_max_flushed_commit_id) {
     LOG_TRACE("Setting global_max_flushed_commit_id to %d", (int)new_max);
@@ -474,10 +563,45 @@ cid_t LogManager::GetPersistentFlushedCommitId() {
 }
 
 void LogManager::FrontendLoggerFlushed() {
+  std::vector<std::function<void()>> flushed_callbacks;
   {
     std::unique_lock<std::mutex> wait_lock(flush_notify_mutex);
     flush_notify_cv.notify_all();
+
+    if (flush_callbacks.empty() == false) {
+      auto flushed_end =
+          flush_callbacks.upper_bound(this->GetPersistentFlushedCommitId());
+      for (auto itr = flush_callbacks.begin(); itr != flushed_end; itr++) {
+        flushed_callbacks.push_back(std::move(itr->second));
+      }
+      flush_callbacks.erase(flush_callbacks.begin(), flushed_end);
+      flush_waiter_count -= flushed_callbacks.size();
+    }
   }
+
+  // Run them outside of the lock, they may register new callbacks
+  for (auto &callback : flushed_callbacks) {
+    callback();
+  }
+}
+
+void LogManager::SetDeferFlushWait(bool defer) { defer_flush_wait = defer; }
+
+cid_t LogManager::TakeDeferredCommitId() {
+  auto commit_id = deferred_commit_id;
+  deferred_commit_id = INVALID_CID;
+  defer_flush_wait = false;
+  return commit_id;
+}
+
+bool LogManager::NotifyOnFlush(cid_t cid, std::function<void()> callback) {
+  std::unique_lock<std::mutex> wait_lock(flush_notify_mutex);
+  if (this->GetPersistentFlushedCommitId() >= cid) {
+    return false;
+  }
+  flush_callbacks.emplace(cid, std::move(callback));
+  flush_waiter_count++;
+  return true;
 }
 
 void LogManager::WaitForFlush(cid_t cid) {
@@ -485,12 +609,14 @@ void LogManager::WaitForFlush(cid_t cid) {
   {
     std::unique_lock<std::mutex> wait_lock(flush_notify_mutex);
 
+    flush_waiter_count++;
     while (this->GetPersistentFlushedCommitId() < cid) {
       LOG_TRACE(
           "Logs up to %lu cid is flushed. %lu cid is not flushed yet. Wait...",
           this->GetPersistentFlushedCommitId(), cid);
       flush_notify_cv.wait(wait_lock);
     }
+    flush_waiter_count--;
     LOG_TRACE(
         "Flushes done! Can return! Got persistent flushed commit id as %d",
         (int)this->GetPersistentFlushedCommitId());
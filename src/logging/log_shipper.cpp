@@ -0,0 +1,241 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// log_shipper.cpp
+//
+// Identification: src/logging/log_shipper.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "logging/log_shipper.h"
+#include "networking/connection_manager.h"
+#include "networking/logging_service.h"
+#include "networking/rpc_channel.h"
+#include "networking/rpc_controller.h"
+#include "common/logger.h"
+
+namespace peloton {
+namespace logging {
+
+constexpr std::chrono::milliseconds LogShipper::ACK_TIMEOUT;
+
+constexpr size_t LogShipper::MAX_UNACKNOWLEDGED_BATCHES;
+
+LogShipper &LogShipper::GetInstance(void) {
+  static LogShipper log_shipper;
+  return log_shipper;
+}
+
+LogShipper::LogShipper()
+    : shipping_(false),
+      shipped_batches_(0),
+      shipped_bytes_(0),
+      timeout_count_(0) {}
+
+LogShipper::~LogShipper() { Stop(); }
+
+bool LogShipper::Start(const std::string &follower_address,
+                       ReplicationType replication_type) {
+  if (test_mode_ == false) {
+    if (networking::ConnectionManager::GetInstance().GetEventBase() == NULL) {
+      LOG_ERROR("Log shipping needs a running RPC server");
+      return false;
+    }
+
+    channel_.reset(new networking::RpcChannel(follower_address));
+    stub_.reset(new networking::PelotonLoggingService_Stub(channel_.get()));
+  }
+  replication_type_ = replication_type;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    last_shipped_ = 0;
+    last_acknowledged_ = 0;
+    degraded_ = false;
+    ship_times_.clear();
+  }
+
+  shipping_ = true;
+  LOG_INFO("Shipping the log to %s", follower_address.c_str());
+  return true;
+}
+
+void LogShipper::Stop() {
+  if (shipping_ == false) {
+    return;
+  }
+
+  shipping_ = false;
+  stub_.reset();
+  channel_.reset();
+}
+
+/**
+ * @brief Ship a batch of log records to the follower. The follower replays
+ * the batches in the order of their sequence numbers
+ */
+void LogShipper::ShipLogBatch(const char *data, size_t size) {
+  if (shipping_ == false || size == 0) {
+    return;
+  }
+
+  uint64_t sequence_number;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sequence_number = ++last_shipped_;
+    ship_times_[sequence_number] = Clock::now();
+
+    // stop tracking the oldest batches of a follower that is gone
+    while (ship_times_.size() > MAX_UNACKNOWLEDGED_BATCHES) {
+      ship_times_.erase(ship_times_.begin());
+    }
+  }
+
+  networking::LogRecordReplayRequest request;
+  request.set_log(data, size);
+  request.set_sequence_number(sequence_number);
+  switch (replication_type_) {
+    case SYNC_REPLICATION:
+      request.set_sync_type(networking::SYNC);
+      break;
+    case SEMISYNC_REPLICATION:
+      request.set_sync_type(networking::SEMISYNC);
+      break;
+    default:
+      request.set_sync_type(networking::ASYNC);
+      break;
+  }
+
+  // The channel does not wait for the response. It arrives through the
+  // logging service of this process
+  if (test_mode_ == false) {
+    networking::LogRecordReplayResponse response;
+    networking::RpcController controller;
+    stub_->LogRecordReplay(&controller, &request, &response, NULL);
+
+    if (controller.Failed()) {
+      LOG_ERROR("Could not ship log batch %lu: %s", sequence_number,
+                controller.ErrorText().c_str());
+      return;
+    }
+  }
+
+  shipped_batches_++;
+  shipped_bytes_ += size;
+
+  if (replication_type_ == ASYNC_REPLICATION || IsDegraded() == true) {
+    return;
+  }
+
+  // Semi-synchronous replication lets the follower be one batch behind
+  uint64_t wait_sequence_number = sequence_number;
+  if (replication_type_ == SEMISYNC_REPLICATION) {
+    wait_sequence_number--;
+  }
+  if (WaitForAcknowledgement(wait_sequence_number) == false) {
+    Degrade();
+  }
+}
+
+void LogShipper::Degrade() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (degraded_ == true || last_acknowledged_ >= last_shipped_) {
+    return;
+  }
+  degraded_ = true;
+  LOG_ERROR(
+      "Follower did not acknowledge log batch %lu in time, not waiting for it "
+      "until it acknowledges log batch %lu",
+      last_acknowledged_ + 1, last_shipped_);
+}
+
+bool LogShipper::IsDegraded() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return degraded_;
+}
+
+bool LogShipper::WaitForAcknowledgement(uint64_t sequence_number) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (acknowledged_cv_.wait_for(lock, ACK_TIMEOUT, [&] {
+        return last_acknowledged_ >= sequence_number;
+      }) == false) {
+    timeout_count_++;
+    return false;
+  }
+  return true;
+}
+
+bool LogShipper::WaitForFollower() {
+  uint64_t sequence_number;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sequence_number = last_shipped_;
+  }
+  return WaitForAcknowledgement(sequence_number);
+}
+
+void LogShipper::Acknowledge(uint64_t sequence_number) {
+  auto now = Clock::now();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (sequence_number > last_acknowledged_) {
+      last_acknowledged_ = sequence_number;
+    }
+
+    // wait for the follower again once it has caught up
+    if (degraded_ == true && last_acknowledged_ >= last_shipped_) {
+      degraded_ = false;
+      LOG_INFO("Follower caught up with log batch %lu", last_acknowledged_);
+    }
+
+    // the batches are applied in order, so the earlier ones are done too
+    auto end = ship_times_.upper_bound(sequence_number);
+    for (auto itr = ship_times_.begin(); itr != end; itr++) {
+      uint64_t lag = std::chrono::duration_cast<std::chrono::microseconds>(
+                         now - itr->second).count();
+      total_lag_us_ += lag;
+      max_lag_us_ = std::max(max_lag_us_, lag);
+      acknowledged_batches_++;
+    }
+    ship_times_.erase(ship_times_.begin(), end);
+  }
+  acknowledged_cv_.notify_all();
+}
+
+//===--------------------------------------------------------------------===//
+// Statistics
+//===--------------------------------------------------------------------===//
+
+size_t LogShipper::GetAcknowledgedBatches() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return acknowledged_batches_;
+}
+
+uint64_t LogShipper::GetAverageLag() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (acknowledged_batches_ == 0) {
+    return 0;
+  }
+  return total_lag_us_ / acknowledged_batches_;
+}
+
+uint64_t LogShipper::GetMaxLag() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return max_lag_us_;
+}
+
+void LogShipper::ResetStatistics() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  shipped_batches_ = 0;
+  shipped_bytes_ = 0;
+  timeout_count_ = 0;
+  acknowledged_batches_ = 0;
+  total_lag_us_ = 0;
+  max_lag_us_ = 0;
+}
+
+}  // namespace logging
+}  // namespace peloton
@@ -28,6 +28,46 @@ WriteAheadBackendLogger::WriteAheadBackendLogger() : BackendLogger() {
   LOG_TRACE("INSIDE CONSTRUCTOR");
 }
 
+/**
+ * @brief log a log record
+ *
+ * In the compact format, the begin record and the tuple records of a
+ * transaction are held back and logged as one batch along with the commit
+ * record. Large transactions log a batch every MAX_BATCH_SIZE bytes.
+ */
+void WriteAheadBackendLogger::Log(LogRecord *record) {
+  if (peloton_wal_compact_format == false) {
+    BackendLogger::Log(record);
+    return;
+  }
+
+  switch (record->GetType()) {
+    case LOGRECORD_TYPE_TRANSACTION_BEGIN:
+      batch_record.Reset(record->GetTransactionId());
+      break;
+
+    case LOGRECORD_TYPE_WAL_TUPLE_INSERT:
+    case LOGRECORD_TYPE_WAL_TUPLE_DELETE:
+    case LOGRECORD_TYPE_WAL_TUPLE_UPDATE:
+      batch_record.AddTupleRecord(*static_cast<TupleRecord *>(record));
+      if (batch_record.GetBodySize() >= MAX_BATCH_SIZE) {
+        BackendLogger::Log(&batch_record);
+        batch_record.Reset(record->GetTransactionId());
+      }
+      break;
+
+    case LOGRECORD_TYPE_TRANSACTION_COMMIT:
+      PL_ASSERT(batch_record.GetTransactionId() == record->GetTransactionId());
+      batch_record.SetCommit();
+      BackendLogger::Log(&batch_record);
+      break;
+
+    default:
+      BackendLogger::Log(record);
+      break;
+  }
+}
+
 // create a tuple record for this logger
 LogRecord *WriteAheadBackendLogger::GetTupleRecord(
     LogRecordType log_record_type, txn_id_t txn_id, oid_t table_oid,
@@ -15,7 +15,11 @@
 #include <sys/mman.h>
 #include <algorithm>
 #include <dirent.h>
+#include <mutex>
 #include <numeric>
+#include <set>
+#include <thread>
+#include <unordered_map>
 
 #include "catalog/catalog.h"
 #include "catalog/manager.h"
@@ -24,10 +28,14 @@
 #include "concurrency/transaction.h"
 #include "concurrency/transaction_manager_factory.h"
 #include "concurrency/transaction_manager.h"
+#include "configuration/configuration.h"
 
 #include "logging/log_manager.h"
+#include "logging/log_shipper.h"
 #include "logging/records/transaction_record.h"
 #include "logging/records/tuple_record.h"
+#include "logging/records/tuple_batch_record.h"
+#include "statistics/backend_stats_context.h"
 #include "logging/loggers/wal_frontend_logger.h"
 #include "logging/loggers/wal_backend_logger.h"
 #include "logging/checkpoint_tile_scanner.h"
@@ -37,6 +45,7 @@
 #include "storage/database.h"
 #include "storage/data_table.h"
 #include "storage/tile_group.h"
+#include "storage/tile_group_header.h"
 #include "storage/tuple.h"
 #include "common/logger.h"
 #include "index/index.h"
@@ -54,6 +63,15 @@ namespace logging {
 // Utility functions
 //===--------------------------------------------------------------------===//
 
+// Number of threads that replay one log stream, or rebuild the indexes
+static size_t GetRecoveryThreadCount(size_t stream_count) {
+  size_t thread_count = peloton_recovery_thread_count;
+  if (thread_count == 0) {
+    thread_count = std::thread::hardware_concurrency();
+  }
+  return std::max<size_t>(1, thread_count / std::max<size_t>(1, stream_count));
+}
+
 WriteAheadFrontendLogger::WriteAheadFrontendLogger()
     : WriteAheadFrontendLogger(false) {}
 
@@ -91,6 +109,12 @@ void WriteAheadFrontendLogger::InitSelf() {
             (int)max_delimiter_for_recovery);
   cur_file_handle.fd = -1;  // this is a restart or a new start
   max_log_id_file = 0;      // 0 is unused
+
+  if (peloton_wal_async_io) {
+    log_device_ = LogDevice::Create();
+    LOG_TRACE("Writing the log through the %s log device",
+              log_device_->GetName());
+  }
 }
 
 /**
@@ -98,6 +122,7 @@ void WriteAheadFrontendLogger::InitSelf() {
  */
 WriteAheadFrontendLogger::~WriteAheadFrontendLogger() {
   // close the log file
+  log_device_.reset();
   if (cur_file_handle.file != nullptr) {
     int ret = fclose(cur_file_handle.file);
     if (ret != 0) {
@@ -110,6 +135,14 @@ WriteAheadFrontendLogger::~WriteAheadFrontendLogger() {
   delete recovery_pool;
 }
 
+static void RecordGroupCommit(size_t batch_size) {
+  if (FLAGS_stats_mode != STATS_TYPE_INVALID) {
+    stats::BackendStatsContext::GetInstance()
+        ->GetGroupCommitSizeHistogram()
+        .Record(batch_size);
+  }
+}
+
 /**
  * @brief flush all the log records to the file
  */
@@ -118,9 +151,18 @@ void WriteAheadFrontendLogger::FlushLogRecords(void) {
 
   bool will_write_to_file;
 
+  // the log device may still be making earlier commits durable
+  cid_t max_written_commit_id = pending_flushes_.empty()
+                                    ? max_flushed_commit_id
+                                    : pending_flushes_.back().commit_id;
+
+  // make everything durable before the logger stops
+  bool stopping = LogManager::GetInstance().GetLoggingStatus() !=
+                  LOGGING_STATUS_TYPE_LOGGING;
+
   // check if we will end up writing something to disk
   will_write_to_file =
-      ((max_collected_commit_id != max_flushed_commit_id) || global_queue_size);
+      ((max_collected_commit_id != max_written_commit_id) || global_queue_size);
 
   if (will_write_to_file) {
     if (cur_file_handle.fd == -1) {
@@ -131,18 +173,30 @@ void WriteAheadFrontendLogger::FlushLogRecords(void) {
     }
   }
 
-  TransactionRecord delimiter_rec(LOGRECORD_TYPE_ITERATION_DELIMITER,
+  TransactionRecord delimiter_rec(peloton_wal_compact_format
+                                      ? LOGRECORD_TYPE_COMPACT_ITERATION_DELIMITER
+                                      : LOGRECORD_TYPE_ITERATION_DELIMITER,
                                   this->max_collected_commit_id);
   delimiter_rec.Serialize(output_buffer);
 
+  size_t written_bytes = 0;
+  size_t written_commits = 0;
+
+  // Compressed blocks only hold tuple batches, which need the compact format
+  bool compressed = false;
+  if (peloton_wal_compact_format && peloton_wal_compression &&
+      global_queue_size > 0 && !test_mode_ && !no_write_) {
+    WriteCompressedLogBuffers();
+    compressed = true;
+  }
+
   // First, write all the record in the queue
   for (oid_t global_queue_itr = 0; global_queue_itr < global_queue_size;
        global_queue_itr++) {
     auto &log_buffer = global_queue[global_queue_itr];
 
-    if (!test_mode_ && !no_write_) {
-      fwrite(log_buffer->GetData(), sizeof(char), log_buffer->GetSize(),
-             cur_file_handle.file);
+    if (!test_mode_ && !no_write_ && !compressed) {
+      WriteToLogFile(log_buffer->GetData(), log_buffer->GetSize());
     }
 
     LOG_TRACE("Log buffer get max log id returned %d",
@@ -153,6 +207,9 @@ void WriteAheadFrontendLogger::FlushLogRecords(void) {
       LOG_TRACE("Max log id file so far is %d", (int)this->max_log_id_file);
     }
 
+    written_bytes += log_buffer->GetSize();
+    written_commits += log_buffer->GetCommitCount();
+
     // return empty buffer
     auto backend_logger = log_buffer->GetBackendLogger();
     log_buffer->ResetData();
@@ -161,24 +218,43 @@ void WriteAheadFrontendLogger::FlushLogRecords(void) {
 
   bool flushed = false;
 
-  if (max_collected_commit_id != max_flushed_commit_id) {
+  if (max_collected_commit_id != max_written_commit_id) {
+    group_commit.AddPending(written_bytes, written_commits);
+
+    // Flush right away if committing backends are blocked on the flush,
+    // otherwise keep batching up to the latency target or byte budget
+    bool flush_now = stopping || group_commit.ShouldFlush(
+        LogManager::GetInstance().GetFlushWaiterCount());
+
     if (!test_mode_) {
       PL_ASSERT(cur_file_handle.fd != -1);
       if (cur_file_handle.fd != -1) {
         if (!no_write_) {
-          fwrite(delimiter_rec.GetMessage(), sizeof(char),
-                 delimiter_rec.GetMessageLength(), cur_file_handle.file);
+          WriteToLogFile(delimiter_rec.GetMessage(),
+                         delimiter_rec.GetMessageLength());
         }
         LOG_TRACE("Wrote delimiter to log file with commit_id %ld",
                   this->max_collected_commit_id);
 
+        // the follower gets the batch before it is durable here, so that
+        // synchronous replication holds back the commits until it has
+        // applied them
+        ShipLogBatch();
+
         // by moving the fflush and sync here, we ensure that this file will
         // have at least 1 delimiter
-        if (Clock::now() > last_flush + flush_frequency) {
+        if (log_device_ != nullptr) {
+          // hand the batch to the log device and keep collecting while it
+          // is written, unless as many batches as it takes are in flight
+          if (flush_now && (stopping || log_device_->CanFlush())) {
+            auto ticket = log_device_->Flush();
+            pending_flushes_.push_back(
+                {ticket, max_collected_commit_id, group_commit.Flushed()});
+          }
+        } else if (flush_now) {
           if (!no_write_) {
             LoggingUtil::FFlushFsync(cur_file_handle);
           }
-          last_flush = Clock::now();
           if (this->max_collected_commit_id > max_flushed_commit_id) {
             max_flushed_commit_id = this->max_collected_commit_id;
           }
@@ -195,8 +271,7 @@ void WriteAheadFrontendLogger::FlushLogRecords(void) {
         if (FileSwitchCondIsTrue()) should_create_new_file = true;
       }
     } else {
-      if (Clock::now() > last_flush + flush_frequency) {
-        last_flush = Clock::now();
+      if (flush_now) {
         if (this->max_collected_commit_id > max_flushed_commit_id) {
           max_flushed_commit_id = this->max_collected_commit_id;
         }
@@ -210,12 +285,99 @@ void WriteAheadFrontendLogger::FlushLogRecords(void) {
   // Clean up the frontend logger's queue
   global_queue.clear();
 
+  if (flushed) {
+    RecordGroupCommit(group_commit.Flushed());
+  }
+
+  if (log_device_ != nullptr && CompleteFlushes(stopping)) {
+    flushed = true;
+  }
+
   if (flushed) {
     // signal that we have flushed
     LogManager::GetInstance().FrontendLoggerFlushed();
   }
 }
 
+void WriteAheadFrontendLogger::WriteToLogFile(const char *data, size_t size) {
+  if (log_device_ != nullptr) {
+    log_device_->Append(data, size);
+  } else {
+    fwrite(data, sizeof(char), size, cur_file_handle.file);
+  }
+  log_bytes += size;
+
+  if (LogShipper::GetInstance().IsShipping()) {
+    replication_buffer_.insert(replication_buffer_.end(), data, data + size);
+  }
+}
+
+/**
+ * @brief Ship the log records written since the last delimiter to the
+ * follower
+ */
+void WriteAheadFrontendLogger::ShipLogBatch() {
+  if (replication_buffer_.empty()) {
+    return;
+  }
+
+  LogShipper::GetInstance().ShipLogBatch(replication_buffer_.data(),
+                                         replication_buffer_.size());
+  replication_buffer_.clear();
+}
+
+/**
+ * @brief Write the buffers in the global queue as one compressed block
+ */
+void WriteAheadFrontendLogger::WriteCompressedLogBuffers() {
+  uncompressed_buffer_.clear();
+  for (auto &log_buffer : global_queue) {
+    uncompressed_buffer_.insert(uncompressed_buffer_.end(),
+                                log_buffer->GetData(),
+                                log_buffer->GetData() + log_buffer->GetSize());
+  }
+
+  if (uncompressed_buffer_.empty()) {
+    return;
+  }
+
+  if (LoggingUtil::CompressLogBlock(uncompressed_buffer_.data(),
+                                    uncompressed_buffer_.size(),
+                                    compressed_buffer_)) {
+    WriteToLogFile(compressed_buffer_.Data(), compressed_buffer_.Size());
+  } else {
+    WriteToLogFile(uncompressed_buffer_.data(), uncompressed_buffer_.size());
+  }
+}
+
+bool WriteAheadFrontendLogger::CompleteFlushes(bool wait) {
+  if (pending_flushes_.empty()) {
+    return false;
+  }
+
+  if (wait) {
+    log_device_->WaitForDurable(pending_flushes_.back().ticket);
+  }
+
+  auto durable_ticket = log_device_->GetDurableTicket();
+  bool completed = false;
+
+  while (pending_flushes_.empty() == false &&
+         pending_flushes_.front().ticket <= durable_ticket) {
+    auto &pending_flush = pending_flushes_.front();
+    if (pending_flush.commit_id > max_flushed_commit_id) {
+      max_flushed_commit_id = pending_flush.commit_id;
+    }
+
+    fsync_count++;
+    RecordGroupCommit(pending_flush.commit_count);
+    pending_flushes_.pop_front();
+    completed = true;
+  }
+
+  return completed;
+}
+
 //===--------------------------------------------------------------------===//
 // Recovery
 //===--------------------------------------------------------------------===//
@@ -227,7 +389,6 @@ void WriteAheadFrontendLogger::DoRecovery() {
   // FIXME GetNextCommitId() increments next_cid!!!
   cid_t start_commit_id = CheckpointManager::GetInstance().GetRecoveredCid();
   auto &log_manager = logging::LogManager::GetInstance();
-  int num_inserts = 0;
   cid_t global_max_flushed_id_for_recovery;
   log_file_cursor_ = 0;
 
@@ -239,6 +400,30 @@ void WriteAheadFrontendLogger::DoRecovery() {
   // open first file
   OpenNextLogFile();
 
+  UNUSED_ATTRIBUTE int num_inserts =
+      ReplayLogRecords(start_commit_id, global_max_flushed_id_for_recovery);
+
+  ApplyCommittedRecords();
+
+  // Finally, abort ACTIVE transactions in recovery_txn_table
+  AbortActiveTransactions();
+
+  // After finishing recovery, set the next oid with maximum oid
+  // observed during the recovery
+  log_manager.UpdateCatalogAndTxnManagers(max_oid, max_cid);
+
+  LOG_TRACE("This thread did %d inserts", (int)num_inserts);
+  cur_file_handle = INVALID_FILE_HANDLE;
+}
+
+/**
+ * @brief Replay the log records from the current file handle until the end
+ * of the log. Returns the number of tuple records that were read
+ */
+int WriteAheadFrontendLogger::ReplayLogRecords(cid_t start_commit_id,
+                                               cid_t max_cid_for_recovery) {
+  int num_inserts = 0;
+
   // Go over the log file if needed
   bool reached_end_of_log = false;
 
@@ -258,12 +443,12 @@ void WriteAheadFrontendLogger::DoRecovery() {
         TransactionRecord txn_rec(record_type);
         if (LoggingUtil::ReadTransactionRecordHeader(
                 txn_rec, cur_file_handle) == false) {
-          cur_file_handle = INVALID_FILE_HANDLE;
-          return;
+          reached_end_of_log = true;
+          break;
         }
         log_id = txn_rec.GetTransactionId();
         if (log_id <= start_commit_id ||
-            log_id > global_max_flushed_id_for_recovery) {
+            log_id > max_cid_for_recovery) {
           LOG_TRACE("SKIP");
           continue;
         }
@@ -276,15 +461,16 @@ void WriteAheadFrontendLogger::DoRecovery() {
         if (LoggingUtil::ReadTupleRecordHeader(*tuple_record,
                                                cur_file_handle) == false) {
           LOG_ERROR("Could not read tuple record header.");
-          cur_file_handle = INVALID_FILE_HANDLE;
-          return;
+          delete tuple_record;
+          reached_end_of_log = true;
+          break;
         }
 
         log_id = tuple_record->GetTransactionId();
         auto table = LoggingUtil::GetTable(*tuple_record);
 
         if (!table || log_id <= start_commit_id ||
-            log_id > global_max_flushed_id_for_recovery) {
+            log_id > max_cid_for_recovery) {
           LoggingUtil::SkipTupleRecordBody(cur_file_handle);
           LOG_TRACE("Skip a tuple, log id is %d", (int)log_id);
           delete tuple_record;
@@ -294,8 +480,9 @@ void WriteAheadFrontendLogger::DoRecovery() {
         if (recovery_txn_table.find(log_id) == recovery_txn_table.end()) {
           LOG_ERROR("Insert txd id %d not found in recovery txn table",
                     (int)log_id);
-          cur_file_handle = INVALID_FILE_HANDLE;
-          return;
+          delete tuple_record;
+          reached_end_of_log = true;
+          break;
         }
 
         // Read off the tuple record body from the log
@@ -309,24 +496,52 @@ void WriteAheadFrontendLogger::DoRecovery() {
         // Check for torn log write
         if (LoggingUtil::ReadTupleRecordHeader(*tuple_record,
                                                cur_file_handle) == false) {
-          cur_file_handle = INVALID_FILE_HANDLE;
-          return;
+          delete tuple_record;
+          reached_end_of_log = true;
+          break;
         }
 
         log_id = tuple_record->GetTransactionId();
         if (log_id <= start_commit_id ||
-            log_id > global_max_flushed_id_for_recovery) {
+            log_id > max_cid_for_recovery) {
           delete tuple_record;
           continue;
         }
         if (recovery_txn_table.find(log_id) == recovery_txn_table.end()) {
           LOG_TRACE("Delete txd id %d not found in recovery txn table",
                     (int)log_id);
-          cur_file_handle = INVALID_FILE_HANDLE;
-          return;
+          delete tuple_record;
+          reached_end_of_log = true;
+          break;
+        }
+        break;
+      }
+      case LOGRECORD_TYPE_COMPACT_ITERATION_DELIMITER: {
+        uint64_t commit_id;
+        if (LoggingUtil::ReadVarint(cur_file_handle, commit_id) == false) {
+          reached_end_of_log = true;
+          break;
+        }
+        log_id = commit_id;
+        if (log_id <= start_commit_id ||
+            log_id > max_cid_for_recovery) {
+          continue;
         }
         break;
       }
+      case LOGRECORD_TYPE_WAL_TUPLE_BATCH:
+      case LOGRECORD_TYPE_WAL_COMPRESSED_BLOCK: {
+        // Batches carry their own begin and commit, so they are replayed
+        // right here
+        if (LoggingUtil::ReadFrame(cur_file_handle, frame_buffer_) == false ||
+            ReplayCompactRecords(record_type, frame_buffer_, start_commit_id,
+                                 max_cid_for_recovery) == false) {
+          LOG_ERROR("Could not replay a compact log record");
+          reached_end_of_log = true;
+          break;
+        }
+        continue;
+      }
       default:
         reached_end_of_log = true;
         break;
@@ -354,11 +569,14 @@ void WriteAheadFrontendLogger::DoRecovery() {
           recovery_txn_table[tuple_record->GetTransactionId()]
               .push_back(tuple_record);
           break;
-        case LOGRECORD_TYPE_ITERATION_DELIMITER: {
-          // Do nothing if we hit the delimiter, because the delimiters help
-          // us only to find
-          // the max persistent commit id, and should be ignored during actual
-          // recovery
+        case LOGRECORD_TYPE_ITERATION_DELIMITER:
+        case LOGRECORD_TYPE_COMPACT_ITERATION_DELIMITER: {
+          // The delimiters help us only to find the max persistent commit id.
+          // They do end an epoch though, so this is where we apply the
+          // committed transactions once enough of them have piled up
+          if (committed_records_.size() >= RECOVERY_BATCH_SIZE) {
+            ApplyCommittedRecords();
+          }
           break;
         }
 
@@ -369,26 +587,159 @@ void WriteAheadFrontendLogger::DoRecovery() {
     }
   }
 
-  // Finally, abort ACTIVE transactions in recovery_txn_table
-  AbortActiveTransactions();
+  return num_inserts;
+}
 
-  // After finishing recovery, set the next oid with maximum oid
-  // observed during the recovery
-  log_manager.UpdateCatalogAndTxnManagers(max_oid, max_cid);
+/**
+ * @brief Replay a batch of log records shipped by the leader. The batch holds
+ * what the leader has written to its log file between two delimiters, so it
+ * goes through the same code path as recovery. Transactions that are not
+ * committed at the end of the batch stay in the recovery txn table until a
+ * later batch commits them.
+ */
+bool WriteAheadFrontendLogger::ReplayLog(const char *data, size_t len) {
+  if (len == 0) {
+    return true;
+  }
 
-  LOG_TRACE("This thread did %d inserts", (int)num_inserts);
-  cur_file_handle = INVALID_FILE_HANDLE;
+  FILE *file = fmemopen(const_cast<char *>(data), len, "rb");
+  if (file == nullptr) {
+    LOG_ERROR("Could not open the log batch for replay");
+    return false;
+  }
+
+  // the file handle of the log file is not in use on a follower, but keep it
+  // anyway
+  FileHandle log_file_handle = cur_file_handle;
+  cur_file_handle = FileHandle(file, INVALID_FILE_DESCRIPTOR, len);
+  replaying_log_buffer_ = true;
+
+  ReplayLogRecords(INVALID_CID, MAX_CID);
+  bool replayed = (ftell(file) == (long)len);
+
+  replaying_log_buffer_ = false;
+  cur_file_handle = log_file_handle;
+  fclose(file);
+
+  ApplyCommittedRecords();
+
+  // make the replayed versions visible to new transactions
+  auto &manager = catalog::Manager::GetInstance();
+  if (max_oid > manager.GetCurrentTileGroupId()) {
+    manager.SetNextTileGroupId(max_oid);
+  }
+
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  if (max_cid + 1 > txn_manager.GetCurrentCommitId()) {
+    txn_manager.SetNextCid(max_cid + 1);
+  }
+
+  if (replayed == false) {
+    LOG_ERROR("Could not replay the whole log batch");
+  }
+  return replayed;
+}
+
+/**
+ * @brief Replay a tuple batch, or the tuple batches of a compressed block
+ */
+bool WriteAheadFrontendLogger::ReplayCompactRecords(
+    LogRecordType record_type, const std::vector<char> &frame,
+    cid_t start_cid, cid_t max_cid_for_recovery) {
+  if (record_type == LOGRECORD_TYPE_WAL_TUPLE_BATCH) {
+    return ReplayTupleBatch(frame.data(), frame.size(), start_cid,
+                            max_cid_for_recovery);
+  }
+
+  std::vector<char> data;
+  if (LoggingUtil::DecompressLogBlock(frame.data(), frame.size(), data) ==
+      false) {
+    return false;
+  }
+
+  CopySerializeInput input(data.data(), data.size());
+  while (input.RemainingBytes() > 0) {
+    auto batch_type = (LogRecordType)input.ReadEnumInSingleByte();
+    if (batch_type != LOGRECORD_TYPE_WAL_TUPLE_BATCH ||
+        input.RemainingBytes() < sizeof(int32_t)) {
+      LOG_ERROR("Unexpected record type %s in a compressed block",
+                LogRecordTypeToString(batch_type).c_str());
+      return false;
+    }
+
+    size_t batch_size = input.ReadInt();
+    if (batch_size > input.RemainingBytes()) {
+      return false;
+    }
+
+    auto batch_data =
+        reinterpret_cast<const char *>(input.getRawPointer(batch_size));
+    if (ReplayTupleBatch(batch_data, batch_size, start_cid,
+                         max_cid_for_recovery) == false) {
+      return false;
+    }
+  }
+
+  return true;
 }
 
+/**
+ * @brief Add the records of a tuple batch to its transaction, which the
+ * batch begins if it is the first one, and commit it if the batch says so
+ */
+bool WriteAheadFrontendLogger::ReplayTupleBatch(const char *data, size_t size,
+                                                cid_t start_cid,
+                                                cid_t max_cid_for_recovery) {
+  cid_t commit_id = INVALID_CID;
+  bool commit = false;
+  std::vector<TupleRecord *> records;
+
+  bool valid = TupleBatchRecord::Deserialize(data, size, commit_id, commit,
+                                             records, recovery_pool);
+
+  if (valid == false || commit_id <= start_cid ||
+      commit_id > max_cid_for_recovery) {
+    for (auto record : records) {
+      delete record->GetTuple();
+      delete record;
+    }
+    return valid;
+  }
+
+  if (recovery_txn_table.find(commit_id) == recovery_txn_table.end()) {
+    StartTransactionRecovery(commit_id);
+  }
+
+  auto &txn_records = recovery_txn_table[commit_id];
+  txn_records.insert(txn_records.end(), records.begin(), records.end());
+
+  if (commit) {
+    CommitTransactionRecovery(commit_id);
+  }
+
+  return true;
+}
+
+/**
+ * @brief rebuild the indexes of all tables
+ *
+ * The tile groups of all tables are handed out to the recovery threads one
+ * at a time, so that large tables are split among the threads as well.
+ * If the checkpoint loaded index images, only the tuples that were
+ * recovered from the WAL are inserted.
+ */
 void WriteAheadFrontendLogger::RecoverIndex() {
   auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
   LOG_TRACE("Recovering the indexes");
   cid_t cid = txn_manager.GetNextCommitId();
   LOG_TRACE("Index Recovery got Next commit id as %d", (int)cid);
+  cid_t image_cid = CheckpointManager::GetInstance().GetIndexRecoveredCid();
 
   auto catalog = catalog::Catalog::GetInstance();
   auto database_count = catalog->GetDatabaseCount();
 
+  std::vector<std::pair<storage::DataTable *, oid_t>> tile_groups;
+
   // loop all databases
   for (oid_t database_idx = 1; database_idx < database_count; database_idx++) {
     auto database = catalog->GetDatabaseWithOffset(database_idx);
@@ -402,29 +753,73 @@ void WriteAheadFrontendLogger::RecoverIndex() {
       LOG_TRACE("SeqScan: database oid %u table oid %u: %s", database_idx,
                 table_idx, target_table->GetName().c_str());
 
-      if (!RecoverTableIndexHelper(target_table, cid)) {
-        break;
+      auto table_tile_group_count = target_table->GetTileGroupCount();
+      LOG_TRACE("Recovering tile group count: %ld", table_tile_group_count);
+      for (oid_t tile_group_offset = START_OID;
+           tile_group_offset < table_tile_group_count; tile_group_offset++) {
+        tile_groups.emplace_back(target_table, tile_group_offset);
       }
     }
   }
+
+  // Every index is rebuilt by all the recovery threads
+  size_t thread_count =
+      std::min(GetRecoveryThreadCount(1), std::max<size_t>(1, tile_groups.size()));
+  std::atomic<size_t> next_tile_group(0);
+  std::mutex tuple_counts_mutex;
+  std::map<storage::DataTable *, size_t> tuple_counts;
+
+  auto rebuild = [&]() {
+    std::map<storage::DataTable *, size_t> local_tuple_counts;
+    size_t tile_group_itr;
+    while ((tile_group_itr = next_tile_group.fetch_add(1)) <
+           tile_groups.size()) {
+      auto target_table = tile_groups[tile_group_itr].first;
+      local_tuple_counts[target_table] += RecoverTileGroupIndex(
+          target_table, tile_groups[tile_group_itr].second, cid, image_cid);
+    }
+
+    std::lock_guard<std::mutex> lock(tuple_counts_mutex);
+    for (auto &tuple_count : local_tuple_counts) {
+      tuple_counts[tuple_count.first] += tuple_count.second;
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t thread_itr = 1; thread_itr < thread_count; thread_itr++) {
+    threads.emplace_back(rebuild);
+  }
+  rebuild();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Increase the indexes' number of tuples as well
+  for (auto &tuple_count : tuple_counts) {
+    auto target_table = tuple_count.first;
+    for (oid_t index_itr = 0; index_itr < target_table->GetIndexCount();
+         index_itr++) {
+      target_table->GetIndex(index_itr)
+          ->IncreaseNumberOfTuplesBy(tuple_count.second);
+    }
+  }
 }
 
-bool WriteAheadFrontendLogger::RecoverTableIndexHelper(
-    storage::DataTable *target_table, cid_t start_cid) {
+size_t WriteAheadFrontendLogger::RecoverTileGroupIndex(
+    storage::DataTable *target_table, oid_t tile_group_offset,
+    cid_t start_cid, cid_t image_cid) {
   auto schema = target_table->GetSchema();
   PL_ASSERT(schema);
   std::vector<oid_t> column_ids;
   column_ids.resize(schema->GetColumnCount());
   std::iota(column_ids.begin(), column_ids.end(), 0);
 
-  oid_t current_tile_group_offset = START_OID;
-  auto table_tile_group_count = target_table->GetTileGroupCount();
-  LOG_TRACE("Recovering tile group count: %ld", table_tile_group_count);
   CheckpointTileScanner scanner;
+  size_t tuple_count = 0;
 
-  while (current_tile_group_offset < table_tile_group_count) {
+  {
     // Retrieve a tile group
-    auto tile_group = target_table->GetTileGroup(current_tile_group_offset);
+    auto tile_group = target_table->GetTileGroup(tile_group_offset);
 
     // Retrieve a logical tile
     std::unique_ptr<executor::LogicalTile> logical_tile(
@@ -432,17 +827,23 @@ bool WriteAheadFrontendLogger::RecoverTableIndexHelper(
 
     // Empty result
     if (!logical_tile) {
-      current_tile_group_offset++;
-      continue;
+      return 0;
     }
 
     auto tile_group_id = logical_tile->GetColumnInfo(0)
                              .base_tile->GetTileGroup()
                              ->GetTileGroupId();
     LOG_TRACE("Retrieved tile group %u", tile_group_id);
+    auto tile_group_header = tile_group->GetHeader();
 
     // Go over the logical tile
     for (oid_t tuple_id : *logical_tile) {
+      // The index images hold the tuples of the checkpoint
+      if (image_cid != INVALID_CID &&
+          tile_group_header->GetBeginCommitId(tuple_id) <= image_cid) {
+        continue;
+      }
+
       expression::ContainerTuple<executor::LogicalTile> cur_tuple(
           logical_tile.get(), tuple_id);
 
@@ -458,34 +859,42 @@ bool WriteAheadFrontendLogger::RecoverTableIndexHelper(
 
         ItemPointer location(tile_group_id, tuple_id);
         InsertIndexEntry(tuple.get(), target_table, location);
+        tuple_count++;
       }
     }
-    current_tile_group_offset++;
   }
-  return true;
+  return tuple_count;
 }
 
 void WriteAheadFrontendLogger::InsertIndexEntry(storage::Tuple *tuple,
                                                 storage::DataTable *table,
-                                                ItemPointer target_location UNUSED_ATTRIBUTE) {
+                                                ItemPointer target_location) {
   PL_ASSERT(tuple);
   PL_ASSERT(table);
   auto index_count = table->GetIndexCount();
   LOG_TRACE("Insert tuple (%u, %u) into %u indexes", target_location.block,
             target_location.offset, index_count);
 
+  // The indexes of a table share the indirection of a tuple
+  auto tile_group_header = catalog::Manager::GetInstance()
+                               .GetTileGroup(target_location.block)
+                               ->GetHeader();
+  ItemPointer *indirection =
+      tile_group_header->GetIndirection(target_location.offset);
+  if (indirection == nullptr) {
+    indirection = table->AllocateIndirection(target_location);
+    tile_group_header->SetIndirection(target_location.offset, indirection);
+  }
+
   for (int index_itr = index_count - 1; index_itr >= 0; --index_itr) {
     auto index = table->GetIndex(index_itr);
-    auto index_schema = index->GetKeySchema();
+    auto index_schema = index->GetMetadata()->GetCoveringSchema();
     auto indexed_columns = index_schema->GetIndexedColumns();
     std::unique_ptr<storage::Tuple> key(new storage::Tuple(index_schema, true));
     key->SetFromTuple(tuple, indexed_columns, index->GetPool());
 
-    // TODO: workaround. this can cause memory leak.
-    // since currently logging does not work, we will handle this later.
-    // index->InsertEntry(key.get(), new ItemPointer(target_location));
-    // Increase the indexes' number of tuples by 1 as well
-    index->IncreaseNumberOfTuplesBy(1);
+    // RecoverIndex() increases the indexes' number of tuples
+    index->InsertEntry(key.get(), indirection);
   }
 }
 
@@ -512,39 +921,46 @@ void WriteAheadFrontendLogger::StartTransactionRecovery(cid_t commit_id) {
 }
 
 /**
- * @brief move tuples from current txn to recovery txn so that we can commit
- * them later
+ * @brief move tuples from current txn to the committed records, which are
+ * applied by ApplyCommittedRecords()
  * @param recovery txn
  */
 void WriteAheadFrontendLogger::CommitTransactionRecovery(cid_t commit_id) {
   std::vector<TupleRecord *> &tuple_records = recovery_txn_table[commit_id];
-  for (auto it = tuple_records.begin(); it != tuple_records.end(); it++) {
-    TupleRecord *curr = *it;
-    switch (curr->GetType()) {
-      case LOGRECORD_TYPE_WAL_TUPLE_INSERT:
-        InsertTuple(curr);
-        break;
-      case LOGRECORD_TYPE_WAL_TUPLE_UPDATE:
-        UpdateTuple(curr);
-        break;
-      case LOGRECORD_TYPE_WAL_TUPLE_DELETE:
-        DeleteTuple(curr);
-        break;
-      default:
-        continue;
-    }
-    delete curr;
-  }
+  committed_records_.insert(committed_records_.end(), tuple_records.begin(),
+                            tuple_records.end());
   max_cid = commit_id + 1;
   recovery_txn_table.erase(commit_id);
 }
 
+// Serializes the creation of tile groups by concurrent recovery threads
+static std::mutex recovery_tile_group_mutex;
+
+static std::shared_ptr<storage::TileGroup> GetTileGroupForRecovery(
+    storage::DataTable *table, oid_t tile_group_id, oid_t &max_tg) {
+  auto &manager = catalog::Manager::GetInstance();
+  auto tile_group = manager.GetTileGroup(tile_group_id);
+
+  if (tile_group == nullptr) {
+    std::lock_guard<std::mutex> lock(recovery_tile_group_mutex);
+    tile_group = manager.GetTileGroup(tile_group_id);
+    if (tile_group == nullptr) {
+      table->AddTileGroupWithOidForRecovery(tile_group_id);
+      tile_group = manager.GetTileGroup(tile_group_id);
+    }
+    if (max_tg < tile_group_id) {
+      max_tg = tile_group_id;
+    }
+  }
+
+  return tile_group;
+}
+
 void InsertTupleHelper(oid_t &max_tg, cid_t commit_id, oid_t db_id,
                        oid_t table_id, const ItemPointer &insert_loc,
                        storage::Tuple *tuple,
                        bool should_increase_tuple_count = true) {
   LOG_TRACE("Insert tuple helper.");
-  auto &manager = catalog::Manager::GetInstance();
   auto catalog = catalog::Catalog::GetInstance();
   storage::Database *db = catalog->GetDatabaseWithOid(db_id);
   PL_ASSERT(db);
@@ -556,19 +972,7 @@ void InsertTupleHelper(oid_t &max_tg, cid_t commit_id, oid_t db_id,
   }
   PL_ASSERT(table);
 
-  // FIXME Handle the case when tile_group is not created yet.
-  // table->GetTileGroupLock().WriteLock();
-  auto tile_group = manager.GetTileGroup(insert_loc.block);
-
-  if (tile_group == nullptr) {
-    table->AddTileGroupWithOidForRecovery(insert_loc.block);
-    tile_group = manager.GetTileGroup(insert_loc.block);
-    if (max_tg < insert_loc.block) {
-      max_tg = insert_loc.block;
-    }
-  }
-  // table->GetTileGroupLock().Unlock();
-  // unlock table here
+  auto tile_group = GetTileGroupForRecovery(table, insert_loc.block, max_tg);
 
   tile_group->InsertTupleFromRecovery(commit_id, insert_loc.offset, tuple);
   if (should_increase_tuple_count) {
@@ -579,7 +983,6 @@ void InsertTupleHelper(oid_t &max_tg, cid_t commit_id, oid_t db_id,
 
 void DeleteTupleHelper(oid_t &max_tg, cid_t commit_id, oid_t db_id,
                        oid_t table_id, const ItemPointer &delete_loc) {
-  auto &manager = catalog::Manager::GetInstance();
   auto catalog = catalog::Catalog::GetInstance();
   storage::Database *db = catalog->GetDatabaseWithOid(db_id);
   PL_ASSERT(db);
@@ -590,20 +993,10 @@ void DeleteTupleHelper(oid_t &max_tg, cid_t commit_id, oid_t db_id,
   }
   PL_ASSERT(table);
 
-  // FIXME Handle the case when tile_group is not created yet.
-  // acquiring the write lock will lead to deadlock
-  // table->GetTileGroupLock().WriteLock();
-  auto tile_group = manager.GetTileGroup(delete_loc.block);
-  if (tile_group == nullptr) {
-    table->AddTileGroupWithOidForRecovery(delete_loc.block);
-    tile_group = manager.GetTileGroup(delete_loc.block);
-    if (max_tg < delete_loc.block) {
-      max_tg = delete_loc.block;
-    }
-  }
+  auto tile_group = GetTileGroupForRecovery(table, delete_loc.block, max_tg);
+
   // FIXME we always decrease the number of tuples by one
   table->DecreaseTupleCount(1);
-  // table->GetTileGroupLock().Unlock();
 
   tile_group->DeleteTupleFromRecovery(commit_id, delete_loc.offset);
 }
@@ -611,7 +1004,6 @@ void DeleteTupleHelper(oid_t &max_tg, cid_t commit_id, oid_t db_id,
 void UpdateTupleHelper(oid_t &max_tg, cid_t commit_id, oid_t db_id,
                        oid_t table_id, const ItemPointer &remove_loc,
                        const ItemPointer &insert_loc, storage::Tuple *tuple) {
-  auto &manager = catalog::Manager::GetInstance();
   auto catalog = catalog::Catalog::GetInstance();
   storage::Database *db = catalog->GetDatabaseWithOid(db_id);
   PL_ASSERT(db);
@@ -623,17 +1015,8 @@ void UpdateTupleHelper(oid_t &max_tg, cid_t commit_id, oid_t db_id,
   }
   PL_ASSERT(table);
 
-  // FIXME Handle the case when tile_group is not created yet.
-  // table->GetTileGroupLock().WriteLock();
-  auto tile_group = manager.GetTileGroup(remove_loc.block);
-  if (tile_group == nullptr) {
-    table->AddTileGroupWithOidForRecovery(remove_loc.block);
-    tile_group = manager.GetTileGroup(remove_loc.block);
-    if (max_tg < remove_loc.block) {
-      max_tg = remove_loc.block;
-    }
-  }
-  // table->GetTileGroupLock().Unlock();
+  auto tile_group = GetTileGroupForRecovery(table, remove_loc.block, max_tg);
+
   InsertTupleHelper(max_tg, commit_id, db_id, table_id, insert_loc, tuple,
                     false);
 
@@ -672,6 +1055,156 @@ void WriteAheadFrontendLogger::UpdateTuple(TupleRecord *record) {
                     record->GetTuple());
 }
 
+// Take the columns that an update has not changed from the old version
+static void CompleteDeltaTuple(TupleRecord *record, type::AbstractPool *pool) {
+  auto &manager = catalog::Manager::GetInstance();
+  auto delete_location = record->GetDeleteLocation();
+  auto tile_group = manager.GetTileGroup(delete_location.block);
+  if (tile_group == nullptr) {
+    LOG_ERROR("Could not find the old version (%u, %u) of an update",
+              delete_location.block, delete_location.offset);
+    return;
+  }
+
+  auto tuple = record->GetTuple();
+  auto &changed_columns = record->GetChangedColumns();
+  for (oid_t column_itr = 0; column_itr < changed_columns.size();
+       column_itr++) {
+    if (changed_columns[column_itr] == false) {
+      tuple->SetValue(column_itr,
+                      tile_group->GetValue(delete_location.offset, column_itr),
+                      pool);
+    }
+  }
+}
+
+static void ApplyTupleRecord(TupleRecord *record, oid_t &max_tg,
+                             type::AbstractPool *pool) {
+  switch (record->GetType()) {
+    case LOGRECORD_TYPE_WAL_TUPLE_INSERT:
+      InsertTupleHelper(max_tg, record->GetTransactionId(),
+                        record->GetDatabaseOid(), record->GetTableId(),
+                        record->GetInsertLocation(), record->GetTuple());
+      break;
+    case LOGRECORD_TYPE_WAL_TUPLE_UPDATE:
+      if (record->IsDelta()) {
+        CompleteDeltaTuple(record, pool);
+      }
+      UpdateTupleHelper(max_tg, record->GetTransactionId(),
+                        record->GetDatabaseOid(), record->GetTableId(),
+                        record->GetDeleteLocation(),
+                        record->GetInsertLocation(), record->GetTuple());
+      break;
+    case LOGRECORD_TYPE_WAL_TUPLE_DELETE:
+      DeleteTupleHelper(max_tg, record->GetTransactionId(),
+                        record->GetDatabaseOid(), record->GetTableId(),
+                        record->GetDeleteLocation());
+      break;
+    default:
+      break;
+  }
+  delete record;
+}
+
+// Follow the links between tile groups to the one that stands for all of
+// the linked ones
+static oid_t FindLinkedTileGroup(
+    const std::unordered_map<oid_t, oid_t> &tile_group_links,
+    oid_t tile_group_id) {
+  auto itr = tile_group_links.find(tile_group_id);
+  while (itr != tile_group_links.end()) {
+    tile_group_id = itr->second;
+    itr = tile_group_links.find(tile_group_id);
+  }
+  return tile_group_id;
+}
+
+/**
+ * @brief apply the records of the committed transactions
+ *
+ * A tuple slot only takes a version whose commit id is higher than the one
+ * of the version it holds, so the committed records can be applied in any
+ * order. They are partitioned by tile group among the recovery threads, so
+ * that the threads do not contend on the same tile group headers. Updates
+ * go to the partition of the old version, and insert the new version from
+ * there.
+ *
+ * Updates in the compact format may only carry the changed columns, and
+ * read the others from the old version, so they must be applied in log
+ * order with the records that write its slot. Inserts into the slot (e.g.
+ * once it is reused) are in the same partition. An update that writes its
+ * new version there links its two tile groups, and linked tile groups are
+ * applied by the same thread.
+ */
+void WriteAheadFrontendLogger::ApplyCommittedRecords() {
+  size_t thread_count = std::min(
+      GetRecoveryThreadCount(LogManager::GetInstance().GetNumFrontendLoggers()),
+      committed_records_.size() / MIN_RECORDS_PER_RECOVERY_THREAD);
+
+  if (thread_count <= 1) {
+    for (auto record : committed_records_) {
+      ApplyTupleRecord(record, max_oid, recovery_pool);
+    }
+    committed_records_.clear();
+    return;
+  }
+
+  std::set<ItemPointer> delta_old_versions;
+  for (auto record : committed_records_) {
+    if (record->IsDelta()) {
+      delta_old_versions.insert(record->GetDeleteLocation());
+    }
+  }
+
+  std::unordered_map<oid_t, oid_t> tile_group_links;
+  if (delta_old_versions.empty() == false) {
+    for (auto record : committed_records_) {
+      if (record->GetType() != LOGRECORD_TYPE_WAL_TUPLE_UPDATE ||
+          delta_old_versions.count(record->GetInsertLocation()) == 0) {
+        continue;
+      }
+      auto old_tile_group = FindLinkedTileGroup(
+          tile_group_links, record->GetDeleteLocation().block);
+      auto new_tile_group = FindLinkedTileGroup(
+          tile_group_links, record->GetInsertLocation().block);
+      if (old_tile_group != new_tile_group) {
+        tile_group_links[std::max(old_tile_group, new_tile_group)] =
+            std::min(old_tile_group, new_tile_group);
+      }
+    }
+  }
+
+  std::vector<std::vector<TupleRecord *>> partitions(thread_count);
+  for (auto record : committed_records_) {
+    auto location = (record->GetType() == LOGRECORD_TYPE_WAL_TUPLE_INSERT)
+                        ? record->GetInsertLocation()
+                        : record->GetDeleteLocation();
+    auto tile_group_id = FindLinkedTileGroup(tile_group_links, location.block);
+    partitions[tile_group_id % thread_count].push_back(record);
+  }
+  committed_records_.clear();
+
+  std::vector<oid_t> max_tile_group_ids(thread_count, 0);
+  std::vector<std::thread> threads;
+  for (size_t thread_itr = 0; thread_itr < thread_count; thread_itr++) {
+    threads.emplace_back([this, &partitions, &max_tile_group_ids,
+                          thread_itr]() {
+      for (auto record : partitions[thread_itr]) {
+        ApplyTupleRecord(record, max_tile_group_ids[thread_itr],
+                         recovery_pool);
+      }
+    });
+  }
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (auto max_tile_group_id : max_tile_group_ids) {
+    max_oid = std::max(max_oid, max_tile_group_id);
+  }
+}
+
 //===--------------------------------------------------------------------===//
 // Utility functions
 //===--------------------------------------------------------------------===//
@@ -681,7 +1214,8 @@ LogRecordType WriteAheadFrontendLogger::GetNextLogRecordTypeForRecovery() {
   bool is_truncated = false;
   int ret;
 
-  if (cur_file_handle.file == nullptr || cur_file_handle.fd == -1)
+  if (cur_file_handle.file == nullptr ||
+      (cur_file_handle.fd == -1 && replaying_log_buffer_ == false))
     return LOGRECORD_TYPE_INVALID;
 
   LOG_TRACE("Inside GetNextLogRecordForRecovery");
@@ -699,9 +1233,16 @@ LogRecordType WriteAheadFrontendLogger::GetNextLogRecordTypeForRecovery() {
     ret = fread((void *)&buffer, 1, sizeof(char), cur_file_handle.file);
     if (ret <= 0) {
       LOG_TRACE("Failed an fread");
+    } else if (buffer == LOGRECORD_TYPE_INVALID) {
+      // The zeroed tail of a preallocated log file
+      LOG_TRACE("Reached the unused part of the log file");
+      is_truncated = true;
     }
   }
   if (is_truncated || ret <= 0) {
+    // a shipped log batch is not followed by another file
+    if (replaying_log_buffer_) return LOGRECORD_TYPE_INVALID;
+
     LOG_TRACE("Call OpenNextLogFile");
     OpenNextLogFile();
     if (cur_file_handle.fd == -1) return LOGRECORD_TYPE_INVALID;
@@ -883,19 +1424,26 @@ void WriteAheadFrontendLogger::CreateNewLogFile(bool close_old_file) {
     LogFile *cur_log_file_object = log_files_[file_list_size - 1];
 
     if (file_list_size != 0) {
-      // TODO check return values of all these operations!
-      fseek(cur_file_handle.file, 0, SEEK_SET);
-
-      fwrite((void *)&(max_log_id_file), sizeof(max_log_id_file), 1,
-             cur_file_handle.file);
+      if (log_device_ != nullptr) {
+        // waits for the batches in flight, and syncs the header
+        cid_t header[2] = {max_log_id_file, max_delimiter_file};
+        log_device_->Overwrite(0, reinterpret_cast<const char *>(header),
+                               sizeof(header));
+      } else {
+        // TODO check return values of all these operations!
+        fseek(cur_file_handle.file, 0, SEEK_SET);
+
+        fwrite((void *)&(max_log_id_file), sizeof(max_log_id_file), 1,
+               cur_file_handle.file);
+
+        fwrite((void *)&(max_delimiter_file), sizeof(max_delimiter_file), 1,
+               cur_file_handle.file);
+      }
 
       cur_log_file_object->SetMaxLogId(max_log_id_file);
 
       LOG_TRACE("MaxLogID of the last closed file is %d", (int)max_log_id_file);
 
-      fwrite((void *)&(max_delimiter_file), sizeof(max_delimiter_file), 1,
-             cur_file_handle.file);
-
       cur_log_file_object->SetMaxDelimiter(max_delimiter_file);
 
       LOG_TRACE("MaxDelimiter of the last closed file is %d",
@@ -904,16 +1452,25 @@ void WriteAheadFrontendLogger::CreateNewLogFile(bool close_old_file) {
       max_log_id_file = 0;     // reset
       max_delimiter_file = 0;  // reset
 
-      fstat(cur_file_handle.fd, &log_stats);
+      if (log_device_ != nullptr) {
+        // the file itself has been preallocated
+        cur_file_handle.size = log_device_->GetSize();
+      } else {
+        fstat(cur_file_handle.fd, &log_stats);
 
-      cur_file_handle.size = log_stats.st_size;
+        cur_file_handle.size = log_stats.st_size;
+      }
 
       LOG_TRACE("The log file to be closed has size %d",
                 (int)cur_file_handle.size);
 
       cur_log_file_object->SetLogFileSize(cur_file_handle.size);
 
-      fclose(cur_file_handle.file);
+      if (log_device_ != nullptr) {
+        log_device_->Close();
+      } else {
+        fclose(cur_file_handle.file);
+      }
 
       cur_log_file_object->SetFilePtr(nullptr);  // invalidate
       cur_log_file_object->SetLogFileFD(-1);     // invalidate
@@ -924,23 +1481,43 @@ void WriteAheadFrontendLogger::CreateNewLogFile(bool close_old_file) {
 
   new_file_name = this->GetFileNameFromVersion(new_file_num);
 
-  FILE *new_log_file = fopen(new_file_name.c_str(), "wb");
+  if (log_device_ != nullptr) {
+    // preallocate the whole file up to the switch limit
+    size_t file_size_limit =
+        LogManager::GetInstance().GetLogFileSizeLimit() * 1024;
+    if (log_device_->Open(new_file_name, file_size_limit) == false) {
+      LOG_ERROR("Could not open new log file");
+      return;
+    }
 
-  if (new_log_file == NULL) {
-    LOG_ERROR("new_log_file is NULL");
-    return;
-  }
+    // the max log id and max delimiter in this file are 0 for now
+    cid_t header[2] = {default_commit_id, default_delimiter};
+    log_device_->Append(reinterpret_cast<const char *>(header),
+                        sizeof(header));
+
+    cur_file_handle.file = nullptr;
+    cur_file_handle.fd = log_device_->GetFD();
+  } else {
+    FILE *new_log_file = fopen(new_file_name.c_str(), "wb");
 
-  // now set the first 8 bytes to 0 - this is for the max_log id in this file
-  fwrite((void *)&default_commit_id, sizeof(default_commit_id), 1,
-         new_log_file);
+    if (new_log_file == NULL) {
+      LOG_ERROR("new_log_file is NULL");
+      return;
+    }
 
-  // now set the next 8 bytes to 0 - this is for the max delimiter in this file
-  fwrite((void *)&default_delimiter, sizeof(default_delimiter), 1,
-         new_log_file);
+    // now set the first 8 bytes to 0 - this is for the max_log id in this
+    // file
+    fwrite((void *)&default_commit_id, sizeof(default_commit_id), 1,
+           new_log_file);
 
-  cur_file_handle.file = new_log_file;
-  cur_file_handle.fd = fileno(cur_file_handle.file);
+    // now set the next 8 bytes to 0 - this is for the max delimiter in this
+    // file
+    fwrite((void *)&default_delimiter, sizeof(default_delimiter), 1,
+           new_log_file);
+
+    cur_file_handle.file = new_log_file;
+    cur_file_handle.fd = fileno(cur_file_handle.file);
+  }
   cur_file_handle.size = 0;
 
   if (cur_file_handle.fd == -1) {
@@ -963,8 +1540,12 @@ bool WriteAheadFrontendLogger::FileSwitchCondIsTrue() {
   struct stat stat_buf;
   if (cur_file_handle.fd == -1) return false;
 
-  fstat(cur_file_handle.fd, &stat_buf);
-  cur_file_handle.size = stat_buf.st_size;
+  if (log_device_ != nullptr) {
+    cur_file_handle.size = log_device_->GetSize();
+  } else {
+    fstat(cur_file_handle.fd, &stat_buf);
+    cur_file_handle.size = stat_buf.st_size;
+  }
 
   return cur_file_handle.size >
          LogManager::GetInstance().GetLogFileSizeLimit() * 1024;
@@ -1171,6 +1752,50 @@ WriteAheadFrontendLogger::ExtractMaxLogIdAndMaxDelimFromLogFileRecords(
         delete tuple_record;
         break;
       }
+      case LOGRECORD_TYPE_COMPACT_ITERATION_DELIMITER: {
+        uint64_t cid;
+        if (LoggingUtil::ReadVarint(file_handle, cid) == false) {
+          return std::pair<cid_t, cid_t>(UINT64_MAX, UINT64_MAX);
+        }
+        if (cid > max_log_id_so_far) max_log_id_so_far = cid;
+        if (cid > max_delim_so_far) max_delim_so_far = cid;
+        break;
+      }
+      case LOGRECORD_TYPE_WAL_TUPLE_BATCH:
+      case LOGRECORD_TYPE_WAL_COMPRESSED_BLOCK: {
+        std::vector<char> frame;
+        if (LoggingUtil::ReadFrame(file_handle, frame) == false) {
+          return std::pair<cid_t, cid_t>(UINT64_MAX, UINT64_MAX);
+        }
+
+        // The commit id leads every batch
+        if (record_type == LOGRECORD_TYPE_WAL_TUPLE_BATCH) {
+          CopySerializeInput batch_input(frame.data(), frame.size());
+          cid_t cid = batch_input.ReadVarint();
+          if (cid > max_log_id_so_far) max_log_id_so_far = cid;
+          break;
+        }
+
+        std::vector<char> data;
+        if (LoggingUtil::DecompressLogBlock(frame.data(), frame.size(),
+                                            data) == false) {
+          return std::pair<cid_t, cid_t>(UINT64_MAX, UINT64_MAX);
+        }
+
+        CopySerializeInput input(data.data(), data.size());
+        while (input.RemainingBytes() > sizeof(int32_t)) {
+          input.ReadEnumInSingleByte();
+          size_t batch_size = input.ReadInt();
+          if (batch_size == 0 || batch_size > input.RemainingBytes()) {
+            return std::pair<cid_t, cid_t>(UINT64_MAX, UINT64_MAX);
+          }
+          CopySerializeInput batch_input(input.getRawPointer(batch_size),
+                                         batch_size);
+          cid_t cid = batch_input.ReadVarint();
+          if (cid > max_log_id_so_far) max_log_id_so_far = cid;
+        }
+        break;
+      }
       default:
         reached_end_of_file = true;
         break;
@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 
+#include <algorithm>
 #include <iostream>
 
 #include "logging/records/tuple_record.h"
@@ -20,6 +21,7 @@
 #include "logging/loggers/wbl_backend_logger.h"
 
 #include "catalog/manager.h"
+#include "storage/tile_group.h"
 
 namespace peloton {
 namespace logging {
@@ -32,12 +34,17 @@ void WriteBehindBackendLogger::Log(LogRecord *record) {
 
     if(no_write == false) {
       SyncDataForCommit();
+    } else {
+      dirty_ranges_.clear();
     }
+  } else if (record->GetType() == LOGRECORD_TYPE_TRANSACTION_ABORT) {
+    dirty_ranges_.clear();
   }
-  log_buffer_lock.Lock();
   switch (record->GetType()) {
     case LOGRECORD_TYPE_TRANSACTION_COMMIT:
-      highest_logged_commit_message = record->GetTransactionId();
+      highest_logged_commit_message =
+          std::max(record->GetTransactionId(), commit_id_floor);
+      commit_id_floor = INVALID_CID;
       // fallthrough
     case LOGRECORD_TYPE_TRANSACTION_ABORT:
     case LOGRECORD_TYPE_TRANSACTION_BEGIN:
@@ -50,22 +57,18 @@ void WriteBehindBackendLogger::Log(LogRecord *record) {
     }
     case LOGRECORD_TYPE_WBL_TUPLE_DELETE:
     case LOGRECORD_TYPE_WAL_TUPLE_DELETE: {
-      tile_groups_to_sync_.insert(
-          ((TupleRecord *)record)->GetDeleteLocation().block);
+      AddDirtyRanges(((TupleRecord *)record)->GetDeleteLocation());
       break;
     }
     case LOGRECORD_TYPE_WBL_TUPLE_INSERT:
     case LOGRECORD_TYPE_WAL_TUPLE_INSERT: {
-      tile_groups_to_sync_.insert(
-          ((TupleRecord *)record)->GetInsertLocation().block);
+      AddDirtyRanges(((TupleRecord *)record)->GetInsertLocation());
       break;
     }
     case LOGRECORD_TYPE_WBL_TUPLE_UPDATE:
     case LOGRECORD_TYPE_WAL_TUPLE_UPDATE: {
-      tile_groups_to_sync_.insert(
-          ((TupleRecord *)record)->GetDeleteLocation().block);
-      tile_groups_to_sync_.insert(
-          ((TupleRecord *)record)->GetInsertLocation().block);
+      AddDirtyRanges(((TupleRecord *)record)->GetDeleteLocation());
+      AddDirtyRanges(((TupleRecord *)record)->GetInsertLocation());
       break;
     }
     default:
@@ -73,10 +76,42 @@ void WriteBehindBackendLogger::Log(LogRecord *record) {
       break;
   }
 
-  log_buffer_lock.Unlock();
+  PublishCommitIds();
+}
+
+void WriteBehindBackendLogger::AddDirtyRanges(const ItemPointer &location) {
+  if (track_dirty_ranges_ == false) {
+    tile_groups_to_sync_.insert(location.block);
+    return;
+  }
+
+  auto tile_group =
+      catalog::Manager::GetInstance().GetTileGroup(location.block);
+  if (tile_group != nullptr) {
+    tile_group->CollectDirtyRanges(location.offset, dirty_ranges_);
+  }
+}
+
+void WriteBehindBackendLogger::CollectDirtyRanges(
+    std::vector<storage::DirtyRange> &ranges) {
+  dirty_ranges_lock_.Lock();
+  ranges.insert(ranges.end(), committed_dirty_ranges_.begin(),
+                committed_dirty_ranges_.end());
+  committed_dirty_ranges_.clear();
+  dirty_ranges_lock_.Unlock();
 }
 
 void WriteBehindBackendLogger::SyncDataForCommit() {
+  // The frontend logger syncs the ranges before it persists the commit
+  if (track_dirty_ranges_ == true) {
+    dirty_ranges_lock_.Lock();
+    committed_dirty_ranges_.insert(committed_dirty_ranges_.end(),
+                                   dirty_ranges_.begin(), dirty_ranges_.end());
+    dirty_ranges_lock_.Unlock();
+    dirty_ranges_.clear();
+    return;
+  }
+
   auto &manager = catalog::Manager::GetInstance();
 
   // Sync the tiles in the modified tile groups and their headers
@@ -81,6 +81,10 @@ WriteBehindFrontendLogger::~WriteBehindFrontendLogger() {
  * @brief flush all log records to the file
  */
 void WriteBehindFrontendLogger::FlushLogRecords(void) {
+  // The data of the collected commits must be durable before the log
+  // record says so
+  SyncDirtyRanges();
+
   struct WriteBehindLogRecord record;
   record.persistent_commit_id = max_collected_commit_id;
   auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
@@ -108,6 +112,31 @@ void WriteBehindFrontendLogger::FlushLogRecords(void) {
   txn_manager.SetMaxGrantCid(new_grant);
 }
 
+/**
+ * @brief sync the cache lines that the collected commits modified
+ */
+void WriteBehindFrontendLogger::SyncDirtyRanges(void) {
+  backend_loggers_lock.Lock();
+  for (auto backend_logger : backend_loggers) {
+    auto wbl_backend_logger =
+        static_cast<WriteBehindBackendLogger *>(backend_logger);
+    if (wbl_backend_logger->IsTrackingDirtyRanges()) {
+      wbl_backend_logger->CollectDirtyRanges(dirty_ranges_);
+    }
+  }
+  backend_loggers_lock.Unlock();
+
+  if (dirty_ranges_.empty() || no_write_) {
+    dirty_ranges_.clear();
+    return;
+  }
+
+  auto &storage_manager = storage::StorageManager::GetInstance();
+  storage_manager.SyncRanges(LoggingUtil::GetBackendType(logging_type),
+                             dirty_ranges_);
+  dirty_ranges_.clear();
+}
+
 //===--------------------------------------------------------------------===//
 // Recovery
 //===--------------------------------------------------------------------===//
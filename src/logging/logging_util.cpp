@@ -15,6 +15,10 @@
 #include <sys/stat.h>
 #include <cstring>
 
+#ifdef PELOTON_HAVE_LZ4
+#include <lz4.h>
+#endif
+
 #include "catalog/catalog.h"
 #include "storage/database.h"
 #include "type/types.h"
@@ -305,6 +309,110 @@ void LoggingUtil::SkipTupleRecordBody(FileHandle &file_handle) {
   CopySerializeInput tuple_body(body, body_size);
 }
 
+bool LoggingUtil::ReadVarint(FileHandle &file_handle, uint64_t &value) {
+  value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (IsFileTruncated(file_handle, 1)) {
+      return false;
+    }
+
+    uint8_t byte;
+    if (fread(&byte, 1, sizeof(byte), file_handle.file) != sizeof(byte)) {
+      LOG_ERROR("Error occured in fread ");
+      return false;
+    }
+
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool LoggingUtil::ReadFrame(FileHandle &file_handle, std::vector<char> &frame) {
+  // Check if the frame is broken
+  size_t frame_size = GetNextFrameSize(file_handle);
+  if (frame_size == 0) {
+    return false;
+  }
+
+  frame.resize(frame_size);
+  size_t ret = fread(frame.data(), 1, frame_size, file_handle.file);
+  if (ret != frame_size) {
+    LOG_ERROR("Error occured in fread ");
+    return false;
+  }
+
+  // Drop the frame length
+  frame.erase(frame.begin(), frame.begin() + sizeof(int32_t));
+  return true;
+}
+
+bool LoggingUtil::IsCompressionAvailable() {
+#ifdef PELOTON_HAVE_LZ4
+  return true;
+#else
+  return false;
+#endif
+}
+
+/**
+ * @brief Compress log records
+ *
+ * The block holds the uncompressed size and the LZ4 compressed records. It
+ * is framed like the other records, so that torn writes are detected.
+ */
+bool LoggingUtil::CompressLogBlock(UNUSED_ATTRIBUTE const char *data,
+                                   UNUSED_ATTRIBUTE size_t size,
+                                   UNUSED_ATTRIBUTE CopySerializeOutput &output) {
+#ifdef PELOTON_HAVE_LZ4
+  output.Reset();
+  output.WriteEnumInSingleByte(LOGRECORD_TYPE_WAL_COMPRESSED_BLOCK);
+  size_t start = output.Position();
+  output.WriteInt(0);
+  output.WriteVarint(size);
+
+  std::vector<char> compressed(LZ4_compressBound(static_cast<int>(size)));
+  int compressed_size =
+      LZ4_compress_default(data, compressed.data(), static_cast<int>(size),
+                           static_cast<int>(compressed.size()));
+  if (compressed_size <= 0) {
+    return false;
+  }
+
+  output.WriteBytes(compressed.data(), compressed_size);
+  output.WriteIntAt(
+      start, static_cast<int32_t>(output.Position() - start - sizeof(int32_t)));
+  return output.Size() < size;
+#else
+  return false;
+#endif
+}
+
+bool LoggingUtil::DecompressLogBlock(UNUSED_ATTRIBUTE const char *frame,
+                                     UNUSED_ATTRIBUTE size_t frame_size,
+                                     UNUSED_ATTRIBUTE std::vector<char> &data) {
+#ifdef PELOTON_HAVE_LZ4
+  CopySerializeInput input(frame, frame_size);
+  size_t size = input.ReadVarint();
+  size_t header_size = frame_size - input.RemainingBytes();
+
+  data.resize(size);
+  int ret = LZ4_decompress_safe(frame + header_size, data.data(),
+                                static_cast<int>(frame_size - header_size),
+                                static_cast<int>(size));
+  if (ret < 0 || static_cast<size_t>(ret) != size) {
+    LOG_ERROR("Could not decompress a log block");
+    return false;
+  }
+  return true;
+#else
+  LOG_ERROR("Found a compressed log block, but peloton is built without LZ4");
+  return false;
+#endif
+}
+
 // Wrappers
 storage::DataTable *LoggingUtil::GetTable(TupleRecord &tuple_record) {
   // Get db, table, schema to insert tuple
@@ -30,16 +30,22 @@ bool TransactionRecord::Serialize(CopySerializeOutput &output) {
   // First, write out the log record type
   output.WriteEnumInSingleByte(log_record_type);
 
-  // Then reserve 4 bytes for the header size to be written later
-  size_t start = output.Position();
-  output.WriteInt(0);
-  output.WriteLong(cid);
-
-  // Write out the header now
-  int32_t header_length =
-      static_cast<int32_t>(output.Position() - start - sizeof(int32_t));
-  output.WriteIntAt(start, header_length);
-
+  // A compact delimiter is just the commit id
+  if (log_record_type == LOGRECORD_TYPE_COMPACT_ITERATION_DELIMITER) {
+    output.WriteVarint(cid);
+  } else {
+    // Then reserve 4 bytes for the header size to be written later
+    size_t start = output.Position();
+    output.WriteInt(0);
+    output.WriteLong(cid);
+
+    // Write out the header now
+    int32_t header_length =
+        static_cast<int32_t>(output.Position() - start - sizeof(int32_t));
+    output.WriteIntAt(start, header_length);
+  }
+
+  delete[] message;
   message_length = output.Size();
   message = new char[message_length];
   PL_MEMCPY(message, output.Data(), message_length);
@@ -0,0 +1,234 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// tuple_batch_record.cpp
+//
+// Identification: src/logging/records/tuple_batch_record.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "logging/records/tuple_batch_record.h"
+#include "catalog/schema.h"
+#include "common/logger.h"
+#include "common/macros.h"
+#include "logging/logging_util.h"
+#include "storage/data_table.h"
+#include "storage/tuple.h"
+
+namespace peloton {
+namespace logging {
+
+void TupleBatchRecord::Reset(cid_t commit_id) {
+  cid = commit_id;
+  body.Reset();
+  record_count = 0;
+  commit = false;
+}
+
+/**
+ * @brief Encode a tuple record
+ * @param record with the tuple data of inserts and updates
+ */
+void TupleBatchRecord::AddTupleRecord(TupleRecord &record) {
+  PL_ASSERT(record.GetTransactionId() == cid);
+  auto record_type = record.GetType();
+  auto insert_location = record.GetInsertLocation();
+  auto delete_location = record.GetDeleteLocation();
+
+  record_buffer.Reset();
+  record_buffer.WriteVarint(record.GetDatabaseOid());
+  record_buffer.WriteVarint(record.GetTableId());
+
+  switch (record_type) {
+    case LOGRECORD_TYPE_WAL_TUPLE_INSERT:
+    case LOGRECORD_TYPE_WAL_TUPLE_UPDATE: {
+      record_buffer.WriteVarint(insert_location.block);
+      record_buffer.WriteVarint(insert_location.offset);
+
+      auto tuple = (storage::Tuple *)record.GetData();
+      PL_ASSERT(tuple);
+      oid_t column_count = tuple->GetSchema()->GetColumnCount();
+      std::vector<bool> changed_columns(column_count, true);
+
+      if (record_type == LOGRECORD_TYPE_WAL_TUPLE_UPDATE) {
+        record_buffer.WriteVarint(delete_location.block);
+        record_buffer.WriteVarint(delete_location.offset);
+
+        if (record.IsDelta()) {
+          changed_columns = record.GetChangedColumns();
+          PL_ASSERT(changed_columns.size() == column_count);
+        }
+
+        // bitmap of the changed columns
+        for (oid_t column_itr = 0; column_itr < column_count; column_itr += 8) {
+          uint8_t bits = 0;
+          for (oid_t bit = 0; bit < 8 && column_itr + bit < column_count;
+               bit++) {
+            if (changed_columns[column_itr + bit]) bits |= (1 << bit);
+          }
+          record_buffer.WriteByte(bits);
+        }
+      }
+
+      for (oid_t column_itr = 0; column_itr < column_count; column_itr++) {
+        if (changed_columns[column_itr]) {
+          tuple->GetValue(column_itr).SerializeTo(record_buffer);
+        }
+      }
+      break;
+    }
+
+    case LOGRECORD_TYPE_WAL_TUPLE_DELETE:
+      record_buffer.WriteVarint(delete_location.block);
+      record_buffer.WriteVarint(delete_location.offset);
+      break;
+
+    default:
+      LOG_ERROR("Unsupported tuple record type %s in a batch",
+                LogRecordTypeToString(record_type).c_str());
+      return;
+  }
+
+  body.WriteEnumInSingleByte(record_type);
+  body.WriteVarint(record_buffer.Size());
+  body.WriteBytes(record_buffer.Data(), record_buffer.Size());
+  record_count++;
+}
+
+/**
+ * @brief Serialize the batch
+ * @return true if we serialize data otherwise false
+ */
+bool TupleBatchRecord::Serialize(CopySerializeOutput &output) {
+  output.Reset();
+
+  output.WriteEnumInSingleByte(log_record_type);
+
+  // reserve 4 bytes for the frame length, so that torn writes are detected
+  // like for the other records
+  size_t start = output.Position();
+  output.WriteInt(0);
+
+  output.WriteVarint(cid);
+  output.WriteBool(commit);
+  output.WriteVarint(record_count);
+  output.WriteBytes(body.Data(), body.Size());
+
+  output.WriteIntAt(
+      start, static_cast<int32_t>(output.Position() - start - sizeof(int32_t)));
+
+  delete[] message;
+  message_length = output.Size();
+  message = new char[message_length];
+  PL_MEMCPY(message, output.Data(), message_length);
+
+  return true;
+}
+
+bool TupleBatchRecord::Deserialize(const char *data, size_t size,
+                                   cid_t &commit_id, bool &commit,
+                                   std::vector<TupleRecord *> &records,
+                                   type::AbstractPool *pool) {
+  CopySerializeInput input(data, size);
+
+  commit_id = input.ReadVarint();
+  commit = input.ReadBool();
+  size_t record_count = input.ReadVarint();
+
+  for (size_t record_itr = 0; record_itr < record_count; record_itr++) {
+    if (input.RemainingBytes() < 2) {
+      return false;
+    }
+
+    auto record_type = (LogRecordType)input.ReadEnumInSingleByte();
+    size_t record_length = input.ReadVarint();
+    if (record_length > input.RemainingBytes()) {
+      return false;
+    }
+
+    CopySerializeInput record_input(input.getRawPointer(record_length),
+                                    record_length);
+    oid_t db_oid = record_input.ReadVarint();
+    oid_t table_oid = record_input.ReadVarint();
+    ItemPointer insert_location = INVALID_ITEMPOINTER;
+    ItemPointer delete_location = INVALID_ITEMPOINTER;
+
+    if (record_type == LOGRECORD_TYPE_WAL_TUPLE_INSERT ||
+        record_type == LOGRECORD_TYPE_WAL_TUPLE_UPDATE) {
+      insert_location.block = record_input.ReadVarint();
+      insert_location.offset = record_input.ReadVarint();
+    }
+    if (record_type == LOGRECORD_TYPE_WAL_TUPLE_UPDATE ||
+        record_type == LOGRECORD_TYPE_WAL_TUPLE_DELETE) {
+      delete_location.block = record_input.ReadVarint();
+      delete_location.offset = record_input.ReadVarint();
+    }
+
+    std::unique_ptr<TupleRecord> record(
+        new TupleRecord(record_type, commit_id, table_oid, insert_location,
+                        delete_location, nullptr, db_oid));
+
+    if (record_type == LOGRECORD_TYPE_WAL_TUPLE_DELETE) {
+      records.push_back(record.release());
+      continue;
+    }
+
+    // Skip the records of tables that we do not know about
+    auto table = LoggingUtil::GetTable(*record);
+    if (table == nullptr) {
+      LOG_TRACE("Skip a tuple of table %u", table_oid);
+      continue;
+    }
+
+    auto schema = table->GetSchema();
+    oid_t column_count = schema->GetColumnCount();
+    std::vector<bool> changed_columns(column_count, true);
+
+    if (record_type == LOGRECORD_TYPE_WAL_TUPLE_UPDATE) {
+      bool is_delta = false;
+      for (oid_t column_itr = 0; column_itr < column_count; column_itr += 8) {
+        uint8_t bits = record_input.ReadByte();
+        for (oid_t bit = 0; bit < 8 && column_itr + bit < column_count;
+             bit++) {
+          changed_columns[column_itr + bit] = (bits & (1 << bit)) != 0;
+          is_delta |= !changed_columns[column_itr + bit];
+        }
+      }
+      if (is_delta) {
+        record->SetChangedColumns(changed_columns);
+      }
+    }
+
+    std::unique_ptr<storage::Tuple> tuple(new storage::Tuple(schema, true));
+    for (oid_t column_itr = 0; column_itr < column_count; column_itr++) {
+      if (changed_columns[column_itr]) {
+        auto value = type::Value::DeserializeFrom(
+            record_input, schema->GetType(column_itr), pool);
+        tuple->SetValue(column_itr, value, pool);
+      }
+    }
+
+    record->SetTuple(tuple.release());
+    records.push_back(record.release());
+  }
+
+  return true;
+}
+
+const std::string TupleBatchRecord::GetInfo() const {
+  std::ostringstream os;
+
+  os << "#LOG TYPE:" << LogRecordTypeToString(GetType()) << "\n";
+  os << " #Txn ID:" << GetTransactionId() << "\n";
+  os << " #Records:" << GetRecordCount() << "\n";
+  os << " #Commit:" << IsCommit() << "\n";
+  os << "\n";
+
+  return os.str();
+}
+
+}  // namespace logging
+}  // namespace peloton
@@ -37,6 +37,14 @@ extern int peloton_flush_mode;
 // PCOMMIT latency (for NVM WBL)
 extern int peloton_pcommit_latency;
 
+// Log format (for WAL)
+extern bool peloton_wal_compact_format;
+
+extern bool peloton_wal_compression;
+
+// NVM emulation (for NVM WBL)
+extern bool peloton_nvm_emulation;
+
 namespace peloton {
 namespace benchmark {
 
@@ -63,6 +71,21 @@ void RunBenchmark() {
   peloton_wait_timeout = state.wait_timeout;
   peloton_flush_mode = state.flush_mode;
   peloton_pcommit_latency = state.pcommit_latency;
+  peloton_wal_compact_format = state.compact_log;
+  peloton_wal_compression = state.compress_log;
+  peloton_nvm_emulation = state.nvm_emulation;
+
+  // Replay the log of a leader and serve read-only queries
+  if (state.replication_role == REPLICATION_ROLE_FOLLOWER) {
+    SetupLoggingOnFollower();
+    return;
+  }
+
+  // Measure the log buffer handoff with an increasing number of backends
+  if (state.experiment_type == EXPERIMENT_TYPE_BACKEND_SCALING) {
+    RunBackendScalingBenchmark();
+    return;
+  }
 
   //===--------------------------------------------------------------------===//
   // WAL
@@ -78,6 +101,13 @@ void RunBenchmark() {
   // WBL
   //===--------------------------------------------------------------------===//
   else if (logging::LoggingUtil::IsBasedOnWriteBehindLogging(peloton_logging_mode)) {
+    // The emulated data file is recreated on startup, so only the logging
+    // throughput can be measured
+    if (state.nvm_emulation) {
+      PrepareLogFile();
+      return;
+    }
+
     LOG_ERROR("currently, we do not support write behind logging.");
     PL_ASSERT(false);
     // Test a simple log process
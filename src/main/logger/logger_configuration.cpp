@@ -18,6 +18,7 @@
 #include "common/exception.h"
 #include "common/logger.h"
 #include "storage/storage_manager.h"
+#include "networking/peloton_endpoint.h"
 
 #include "benchmark/logger/logger_configuration.h"
 #include "benchmark/ycsb/ycsb_configuration.h"
@@ -42,6 +43,13 @@ void Usage(FILE* out) {
           "   -v --flush-mode        :  Flush mode \n"
           "   -r --commit-interval   :  Group commit interval \n"
           "   -j --log-dir           :  Log directory\n"
+          "   -C --compact-log       :  Compact WAL format \n"
+          "   -Z --compress-log      :  Compress the WAL (with -C) \n"
+          "   -R --replication-role  :  1 leader, 2 follower \n"
+          "   -P --replication-port  :  RPC port of this process \n"
+          "   -F --follower-address  :  Follower address (ip:port) \n"
+          "   -M --replication-mode  :  0 async, 1 sync, 2 semi-sync \n"
+          "   -N --nvm-emulation     :  Emulate NVM with a mapped file (WBL) \n"
           "   -y --benchmark-type    :  Benchmark type \n");
 }
 
@@ -56,6 +64,13 @@ static struct option opts[] = {
     {"commit-interval", optional_argument, NULL, 'r'},
     {"benchmark-type", optional_argument, NULL, 'y'},
     {"log-dir", optional_argument, NULL, 'j'},
+    {"compact-log", no_argument, NULL, 'C'},
+    {"compress-log", no_argument, NULL, 'Z'},
+    {"replication-role", optional_argument, NULL, 'R'},
+    {"replication-port", optional_argument, NULL, 'P'},
+    {"follower-address", optional_argument, NULL, 'F'},
+    {"replication-mode", optional_argument, NULL, 'M'},
+    {"nvm-emulation", no_argument, NULL, 'N'},
     {NULL, 0, NULL, 0}};
 
 static void ValidateLoggingType(const configuration& state) {
@@ -98,6 +113,8 @@ std::string ExperimentTypeToString(ExperimentType type) {
       return "STORAGE";
     case EXPERIMENT_TYPE_LATENCY:
       return "LATENCY";
+    case EXPERIMENT_TYPE_BACKEND_SCALING:
+      return "BACKEND_SCALING";
 
     default:
       LOG_ERROR("Invalid experiment_type :: %d", type);
@@ -149,7 +166,7 @@ static void ValidateDataFileSize(const configuration& state) {
 }
 
 static void ValidateExperimentType(const configuration& state) {
-  if (state.experiment_type < 0 || state.experiment_type > 4) {
+  if (state.experiment_type < 0 || state.experiment_type > 5) {
     LOG_ERROR("Invalid experiment_type :: %d", state.experiment_type);
     exit(EXIT_FAILURE);
   }
@@ -219,6 +236,71 @@ static void ValidateLogFileDir(configuration& state) {
   LOG_INFO("log_file_dir :: %s", state.log_file_dir.c_str());
 }
 
+static void ValidateLogFormat(const configuration& state) {
+  if (state.compress_log && !state.compact_log) {
+    LOG_ERROR("compress_log needs compact_log");
+    exit(EXIT_FAILURE);
+  }
+
+  LOG_INFO("compact_log :: %d", state.compact_log);
+  LOG_INFO("compress_log :: %d", state.compress_log);
+}
+
+static void ValidateReplication(const configuration& state) {
+  if (state.replication_role < REPLICATION_ROLE_NONE ||
+      state.replication_role > REPLICATION_ROLE_FOLLOWER) {
+    LOG_ERROR("Invalid replication_role :: %d", state.replication_role);
+    exit(EXIT_FAILURE);
+  }
+
+  if (state.replication_role == REPLICATION_ROLE_NONE) {
+    return;
+  }
+
+  if (state.logging_type != LOGGING_TYPE_NVM_WAL &&
+      state.logging_type != LOGGING_TYPE_SSD_WAL &&
+      state.logging_type != LOGGING_TYPE_HDD_WAL) {
+    LOG_ERROR("replication needs write ahead logging");
+    exit(EXIT_FAILURE);
+  }
+
+  if (state.benchmark_type != BENCHMARK_TYPE_YCSB) {
+    LOG_ERROR("replication only supports the ycsb benchmark");
+    exit(EXIT_FAILURE);
+  }
+
+  if (state.replication_port <= 0 || state.replication_port >= 65535) {
+    LOG_ERROR("Invalid replication_port :: %d", state.replication_port);
+    exit(EXIT_FAILURE);
+  }
+
+  if (state.replication_role == REPLICATION_ROLE_LEADER &&
+      state.follower_address.empty()) {
+    LOG_ERROR("the leader needs a follower_address");
+    exit(EXIT_FAILURE);
+  }
+
+  if (state.replication_mode < ASYNC_REPLICATION ||
+      state.replication_mode > SEMISYNC_REPLICATION) {
+    LOG_ERROR("Invalid replication_mode :: %d", state.replication_mode);
+    exit(EXIT_FAILURE);
+  }
+
+  LOG_INFO("replication_role :: %d", state.replication_role);
+  LOG_INFO("replication_port :: %d", state.replication_port);
+  LOG_INFO("follower_address :: %s", state.follower_address.c_str());
+  LOG_INFO("replication_mode :: %d", state.replication_mode);
+}
+
+static void ValidateNVMEmulation(const configuration& state) {
+  if (state.nvm_emulation && state.logging_type != LOGGING_TYPE_NVM_WBL) {
+    LOG_ERROR("nvm_emulation needs NVM write behind logging");
+    exit(EXIT_FAILURE);
+  }
+
+  LOG_INFO("nvm_emulation :: %d", state.nvm_emulation);
+}
+
 void ParseArguments(int argc, char* argv[], configuration& state) {
   // Default Logger Values
   state.logging_type = LOGGING_TYPE_SSD_WAL;
@@ -233,6 +315,13 @@ void ParseArguments(int argc, char* argv[], configuration& state) {
   state.pcommit_latency = 0;
   state.asynchronous_mode = ASYNCHRONOUS_TYPE_SYNC;
   state.checkpoint_type = CHECKPOINT_TYPE_INVALID;
+  state.compact_log = false;
+  state.compress_log = false;
+  state.replication_role = REPLICATION_ROLE_NONE;
+  state.replication_port = PELOTON_SERVER_PORT;
+  state.follower_address = "";
+  state.replication_mode = SYNC_REPLICATION;
+  state.nvm_emulation = false;
 
   // YCSB Default Values
   ycsb::state.index = INDEX_TYPE_BWTREE;
@@ -265,10 +354,11 @@ void ParseArguments(int argc, char* argv[], configuration& state) {
   // Parse args
   while (1) {
     int idx = 0;
-    // logger - hs:x:f:l:t:q:v:r:y:
+    // logger - hs:x:f:l:t:q:v:r:y:j:CZR:P:F:M:N
     // ycsb   - hemgi:k:d:p:b:c:o:u:z:n:
     // tpcc   - heagi:k:d:p:b:w:n:
-    int c = getopt_long(argc, argv, "hs:x:f:l:t:q:v:r:y:emgi:k:d:p:b:c:o:u:z:n:aw:j:",
+    int c = getopt_long(argc, argv,
+                        "hs:x:f:l:t:q:v:r:y:emgi:k:d:p:b:c:o:u:z:n:aw:j:CZR:P:F:M:N",
                         opts, &idx);
 
     if (c == -1) break;
@@ -304,6 +394,27 @@ void ParseArguments(int argc, char* argv[], configuration& state) {
       case 'y':
         state.benchmark_type = (BenchmarkType)atoi(optarg);
         break;
+      case 'C':
+        state.compact_log = true;
+        break;
+      case 'Z':
+        state.compress_log = true;
+        break;
+      case 'R':
+        state.replication_role = (ReplicationRole)atoi(optarg);
+        break;
+      case 'P':
+        state.replication_port = atoi(optarg);
+        break;
+      case 'F':
+        state.follower_address = optarg;
+        break;
+      case 'M':
+        state.replication_mode = (ReplicationType)atoi(optarg);
+        break;
+      case 'N':
+        state.nvm_emulation = true;
+        break;
 
       case 'i': {
         char *index = optarg;
@@ -386,11 +497,11 @@ void ParseArguments(int argc, char* argv[], configuration& state) {
     }
   }
 
-  if (state.checkpoint_type == CHECKPOINT_TYPE_NORMAL &&
+  if (state.checkpoint_type != CHECKPOINT_TYPE_INVALID &&
       (state.logging_type == LOGGING_TYPE_NVM_WAL ||
        state.logging_type == LOGGING_TYPE_SSD_WAL ||
        state.logging_type == LOGGING_TYPE_HDD_WAL)) {
-    peloton_checkpoint_mode = CHECKPOINT_TYPE_NORMAL;
+    peloton_checkpoint_mode = state.checkpoint_type;
   }
 
   // Print Logger configuration
@@ -404,6 +515,9 @@ void ParseArguments(int argc, char* argv[], configuration& state) {
   ValidateFlushMode(state);
   ValidateNVMLatency(state);
   ValidatePCOMMITLatency(state);
+  ValidateLogFormat(state);
+  ValidateReplication(state);
+  ValidateNVMEmulation(state);
 
   // Print YCSB configuration
   if (state.benchmark_type == BENCHMARK_TYPE_YCSB) {
@@ -11,11 +11,15 @@
 //===----------------------------------------------------------------------===//
 
 #include <fts.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <getopt.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "type/value_factory.h"
 #include "concurrency/transaction_manager_factory.h"
@@ -37,9 +41,18 @@
 #include "benchmark/tpcc/tpcc_workload.h"
 
 #include "logging/checkpoint_manager.h"
+#include "logging/log_shipper.h"
 #include "logging/loggers/wbl_frontend_logger.h"
 #include "logging/logging_util.h"
 
+#include "executor/executor_context.h"
+#include "executor/logical_tile.h"
+#include "executor/seq_scan_executor.h"
+#include "planner/seq_scan_plan.h"
+
+#include "networking/logging_service.h"
+#include "networking/rpc_server.h"
+
 //===--------------------------------------------------------------------===//
 // GUC Variables
 //===--------------------------------------------------------------------===//
@@ -240,6 +253,128 @@ void CleanUpLogDirectory() {
   RemoveDirectory(wal_directory_path.c_str());
 }
 
+//===--------------------------------------------------------------------===//
+// REPLICATION
+//===--------------------------------------------------------------------===//
+
+/**
+ * @brief start the RPC server of this process in its own thread. The
+ * follower receives the log batches through it, and the leader the
+ * acknowledgements. It runs until the process exits
+ */
+void StartReplicationServer() {
+  auto rpc_server = new networking::RpcServer(state.replication_port);
+  auto logging_service = new networking::LoggingService();
+  rpc_server->RegisterService(logging_service);
+
+  std::thread server_thread(&networking::RpcServer::Start, rpc_server);
+  server_thread.detach();
+}
+
+/**
+ * @brief report how fast the log was shipped and how far the follower was
+ * behind
+ */
+void ReportReplication(double duration) {
+  auto& log_shipper = logging::LogShipper::GetInstance();
+
+  // the follower may still be applying the last batches
+  log_shipper.WaitForFollower();
+
+  size_t shipped_bytes = log_shipper.GetShippedBytes();
+  LOG_INFO("replication: %lu batches %lu bytes (%lf MB/s)",
+           log_shipper.GetShippedBatches(), shipped_bytes,
+           shipped_bytes / (1024.0 * 1024.0) / std::max(duration, 1e-3));
+  LOG_INFO("replication lag: avg %lu us max %lu us (%lu acknowledged, %lu "
+           "timeouts)",
+           log_shipper.GetAverageLag(), log_shipper.GetMaxLag(),
+           log_shipper.GetAcknowledgedBatches(),
+           log_shipper.GetTimeoutCount());
+
+  log_shipper.Stop();
+}
+
+/**
+ * @brief count the tuples of the user table that are visible to a read-only
+ * transaction. Recovery does not maintain the indexes, so the follower scans
+ */
+static size_t ScanUserTable() {
+  auto& txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto txn = txn_manager.BeginReadonlyTransaction();
+
+  std::unique_ptr<executor::ExecutorContext> context(
+      new executor::ExecutorContext(txn));
+
+  std::vector<oid_t> column_ids = {0};
+  planner::SeqScanPlan seq_scan_node(ycsb::user_table, nullptr, column_ids);
+  executor::SeqScanExecutor seq_scan_executor(&seq_scan_node, context.get());
+
+  size_t tuple_count = 0;
+  if (seq_scan_executor.Init()) {
+    while (seq_scan_executor.Execute()) {
+      std::unique_ptr<executor::LogicalTile> result_tile(
+          seq_scan_executor.GetOutput());
+      tuple_count += result_tile->GetTupleCount();
+    }
+  }
+
+  txn_manager.EndReadonlyTransaction(txn);
+  return tuple_count;
+}
+
+/**
+ * @brief replay the log shipped by a leader, and serve read-only scans of the
+ * replicated table for the duration of the benchmark
+ */
+bool SetupLoggingOnFollower() {
+  // Clean up log directory
+  CleanUpLogDirectory();
+
+  auto& log_manager = logging::LogManager::GetInstance();
+  log_manager.SetLogDirectoryName(state.log_file_dir);
+  log_manager.SetLogFileName(
+      state.log_file_dir + "/" +
+      logging::WriteAheadFrontendLogger::wal_directory_path);
+
+  if (log_manager.ContainsFrontendLogger() == true) {
+    LOG_ERROR("another logging thread is running now");
+    return false;
+  }
+
+  // The follower starts with the same empty tables as the leader, so the
+  // replayed tile groups belong to the same table
+  ycsb::CreateYCSBDatabase();
+
+  // The frontend logger does not log on the follower, it only replays the
+  // shipped batches
+  log_manager.InitFrontendLoggers();
+  StartReplicationServer();
+
+  double duration = ycsb::state.duration;
+  size_t scan_count = 0;
+  size_t tuple_count = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  auto report = start;
+  while (true) {
+    tuple_count = ScanUserTable();
+    scan_count++;
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - report >= std::chrono::seconds(1)) {
+      LOG_INFO("follower: %lu replicated tuples", tuple_count);
+      report = now;
+    }
+    if (std::chrono::duration<double>(now - start).count() >= duration) {
+      break;
+    }
+  }
+
+  LOG_INFO("follower: %lu scans (%lf scans/s), %lu replicated tuples",
+           scan_count, scan_count / std::max(duration, 1e-3), tuple_count);
+  return true;
+}
+
 /**
  * @brief writing a simple log file
  */
@@ -255,6 +390,10 @@ bool PrepareLogFile() {
     log_manager.SetLogFileName(
         state.log_file_dir + "/" +
         logging::WriteAheadFrontendLogger::wal_directory_path);
+  } else if (state.nvm_emulation) {
+    log_manager.SetLogFileName(
+        state.log_file_dir + "/" +
+        logging::WriteBehindFrontendLogger::wbl_log_path);
   } else {
     LOG_ERROR("currently, we do not support write behind logging.");
     PL_ASSERT(false);
@@ -297,6 +436,16 @@ bool PrepareLogFile() {
                       std::to_string(state.asynchronous_mode));
   }
 
+  // Ship the log to the follower
+  if (state.replication_role == REPLICATION_ROLE_LEADER) {
+    StartReplicationServer();
+    auto& log_shipper = logging::LogShipper::GetInstance();
+    if (log_shipper.Start(state.follower_address, state.replication_mode) ==
+        false) {
+      return false;
+    }
+  }
+
   std::thread logging_thread;
   std::thread checkpoint_thread;
 
@@ -319,6 +468,27 @@ bool PrepareLogFile() {
     if (log_manager.EndLogging()) {
       logging_thread.join();
     }
+
+    // Log bandwidth over the run of the workload
+    double duration = (state.benchmark_type == BENCHMARK_TYPE_TPCC)
+                          ? tpcc::state.duration
+                          : ycsb::state.duration;
+    size_t log_bytes = log_manager.GetLogBytes();
+    LOG_INFO("log bytes: %lu", log_bytes);
+    LOG_INFO("log bandwidth: %lf MB/s",
+             log_bytes / (1024.0 * 1024.0) / std::max(duration, 1e-3));
+
+    if (state.replication_role == REPLICATION_ROLE_LEADER) {
+      ReportReplication(duration);
+    }
+
+    // Cost of making the dirty cache lines durable at group commit
+    if (state.nvm_emulation) {
+      LOG_INFO("nvm emulation: %lu msyncs %lu flushes %lu synced bytes",
+               storage_manager.GetMsyncCount(),
+               storage_manager.GetClflushCount(),
+               storage_manager.GetSyncedBytes());
+    }
   }
 
   if (state.benchmark_type == BENCHMARK_TYPE_YCSB) {
@@ -416,6 +586,89 @@ void BuildLog() {
   }
 }
 
+//===--------------------------------------------------------------------===//
+// BACKEND SCALING
+//===--------------------------------------------------------------------===//
+
+/**
+ * @brief log empty transactions from 1, 2, 4, ... backends, and report the
+ * commit throughput and how long the backends waited for log buffers
+ */
+void RunBackendScalingBenchmark() {
+  if (!logging::LoggingUtil::IsBasedOnWriteAheadLogging(peloton_logging_mode)) {
+    LOG_ERROR("backend scaling benchmark needs write ahead logging");
+    return;
+  }
+
+  auto& log_manager = logging::LogManager::GetInstance();
+  auto& txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  log_manager.SetLogDirectoryName(state.log_file_dir);
+  log_manager.SetLogFileName(
+      state.log_file_dir + "/" +
+      logging::WriteAheadFrontendLogger::wal_directory_path);
+  log_manager.SetSyncCommit(state.asynchronous_mode !=
+                            ASYNCHRONOUS_TYPE_ASYNC);
+
+  int max_backend_count = ycsb::state.backend_count;
+  double duration = ycsb::state.duration;
+
+  for (int backend_count = 1; backend_count <= max_backend_count;
+       backend_count *= 2) {
+    CleanUpLogDirectory();
+    log_manager.ResetLogStatus();
+    log_manager.ResetFrontendLoggers();
+
+    std::thread logging_thread;
+    std::thread checkpoint_thread;
+    StartLogging(logging_thread, checkpoint_thread);
+
+    std::atomic<bool> is_running(true);
+    std::atomic<size_t> commit_count(0);
+    std::vector<std::thread> backends;
+    for (int backend_itr = 0; backend_itr < backend_count; backend_itr++) {
+      backends.emplace_back([&]() {
+        size_t local_commit_count = 0;
+        while (is_running) {
+          log_manager.PrepareLogging();
+          auto commit_id = txn_manager.GetNextCommitId();
+          log_manager.LogBeginTransaction(commit_id);
+          log_manager.LogCommitTransaction(commit_id);
+          log_manager.DoneLogging();
+          local_commit_count++;
+        }
+        commit_count += local_commit_count;
+      });
+    }
+
+    std::this_thread::sleep_for(
+        std::chrono::milliseconds(static_cast<int64_t>(duration * 1000)));
+    is_running = false;
+    for (auto& backend : backends) {
+      backend.join();
+    }
+
+    // Read the stats before the backend loggers go away
+    size_t wait_count = log_manager.GetLogBufferWaitCount();
+    uint64_t wait_time = log_manager.GetLogBufferWaitTime();
+
+    if (peloton_checkpoint_mode != CHECKPOINT_TYPE_INVALID) {
+      auto& checkpoint_manager = logging::CheckpointManager::GetInstance();
+      checkpoint_manager.SetCheckpointStatus(CHECKPOINT_STATUS_INVALID);
+      checkpoint_manager.WaitForModeTransition(CHECKPOINT_STATUS_INVALID,
+                                               true);
+      checkpoint_thread.join();
+    }
+    if (log_manager.EndLogging()) {
+      logging_thread.join();
+    }
+
+    LOG_INFO("backends: %d throughput: %lf txn/s", backend_count,
+             commit_count / std::max(duration, 1e-3));
+    LOG_INFO("backends: %d buffer waits: %lu wait time: %lu us",
+             backend_count, wait_count, wait_time);
+  }
+}
+
 }  // namespace logger
 }  // namespace benchmark
 }  // namespace peloton
@@ -10,13 +10,124 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <chrono>
 #include <iostream>
+#include <thread>
 
 #include "configuration/configuration.h"
 #include "common/init.h"
 #include "common/logger.h"
+#include "logging/log_manager.h"
+#include "logging/log_shipper.h"
+#include "networking/connection_manager.h"
+#include "networking/logging_service.h"
+#include "networking/rpc_server.h"
 #include "wire/libevent_server.h"
 
+namespace peloton {
+
+// Start the RPC server that carries the shipped log. The follower receives
+// the log batches through it, and the leader the acknowledgements. It runs
+// until the process exits
+void StartReplicationServer() {
+  auto rpc_server = new networking::RpcServer(FLAGS_replication_port);
+  rpc_server->RegisterService(new networking::LoggingService());
+
+  std::thread server_thread(&networking::RpcServer::Start, rpc_server);
+  server_thread.detach();
+
+  // The leader can only ship once the server is listening
+  auto &connection_manager = networking::ConnectionManager::GetInstance();
+  for (int wait_itr = 0; wait_itr < 100; wait_itr++) {
+    if (connection_manager.GetEventBase() != NULL) break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+}
+
+// Write the log of the leader, and ship it to the follower. Commits are
+// acknowledged once the replication mode allows it
+bool StartLeader(std::thread &logging_thread) {
+  ReplicationType replication_type;
+  if (FLAGS_replication_mode == "sync") {
+    replication_type = SYNC_REPLICATION;
+  } else if (FLAGS_replication_mode == "semisync") {
+    replication_type = SEMISYNC_REPLICATION;
+  } else if (FLAGS_replication_mode == "async") {
+    replication_type = ASYNC_REPLICATION;
+  } else {
+    LOG_ERROR("Invalid replication_mode :: %s",
+              FLAGS_replication_mode.c_str());
+    return false;
+  }
+
+  if (FLAGS_follower_address.empty()) {
+    LOG_ERROR("the leader needs a follower_address");
+    return false;
+  }
+
+  StartReplicationServer();
+  auto &log_shipper = logging::LogShipper::GetInstance();
+  if (log_shipper.Start(FLAGS_follower_address, replication_type) == false) {
+    return false;
+  }
+
+  auto &log_manager = logging::LogManager::GetInstance();
+  log_manager.SetSyncCommit(true);
+
+  // Wait for standby mode
+  std::thread local_thread(&logging::LogManager::StartStandbyMode,
+                           &log_manager);
+  logging_thread.swap(local_thread);
+  log_manager.WaitForModeTransition(LOGGING_STATUS_TYPE_STANDBY, true);
+
+  // Recover the log this process has written before
+  log_manager.PrepareRecovery();
+  log_manager.StartRecoveryMode();
+  log_manager.WaitForModeTransition(LOGGING_STATUS_TYPE_LOGGING, true);
+  log_manager.DoneRecovery();
+  return true;
+}
+
+// Report how far the follower was behind, and stop writing the log
+void StopLeader(std::thread &logging_thread) {
+  auto &log_shipper = logging::LogShipper::GetInstance();
+
+  // the follower may still be applying the last batches
+  log_shipper.WaitForFollower();
+  LOG_INFO("replication: %lu batches %lu bytes",
+           log_shipper.GetShippedBatches(), log_shipper.GetShippedBytes());
+  LOG_INFO("replication lag: avg %lu us max %lu us (%lu acknowledged, %lu "
+           "timeouts)",
+           log_shipper.GetAverageLag(), log_shipper.GetMaxLag(),
+           log_shipper.GetAcknowledgedBatches(),
+           log_shipper.GetTimeoutCount());
+  log_shipper.Stop();
+
+  auto &log_manager = logging::LogManager::GetInstance();
+  if (log_manager.EndLogging()) {
+    logging_thread.join();
+  }
+}
+
+// Check the replication role of the server. Both sides of a replica pair use
+// the write ahead log, and the log manager picks up the logging mode when it
+// is first used
+bool ConfigureReplicationRole() {
+  if (FLAGS_replication_role == "none") {
+    return true;
+  }
+  if (FLAGS_replication_role != "leader" &&
+      FLAGS_replication_role != "follower") {
+    LOG_ERROR("Invalid replication_role :: %s",
+              FLAGS_replication_role.c_str());
+    return false;
+  }
+  peloton_logging_mode = LOGGING_TYPE_SSD_WAL;
+  return true;
+}
+
+}  // End peloton namespace
+
 // Peloton process begins execution here.
 int main(int argc, char *argv[]) {
 
@@ -35,13 +146,36 @@ int main(int argc, char *argv[]) {
     peloton::configuration::PrintConfiguration();
   }
 
+  if (peloton::ConfigureReplicationRole() == false) {
+    return 1;
+  }
+  bool leader = (FLAGS_replication_role == "leader");
+  bool follower = (FLAGS_replication_role == "follower");
+
   try {
     // Setup
     peloton::PelotonInit::Initialize();
 
+    std::thread logging_thread;
+    if (leader && peloton::StartLeader(logging_thread) == false) {
+      peloton::PelotonInit::Shutdown();
+      return 1;
+    }
+
+    // The frontend logger of the follower does not log, it only replays the
+    // shipped batches. The wire path rejects writes
+    if (follower) {
+      peloton::logging::LogManager::GetInstance().InitFrontendLoggers();
+      peloton::StartReplicationServer();
+    }
+
     // Launch server
     peloton::wire::LibeventServer libeventserver;
 
+    if (leader) {
+      peloton::StopLeader(logging_thread);
+    }
+
     // Teardown
     peloton::PelotonInit::Shutdown();
   }
@@ -27,7 +27,7 @@ void Usage(FILE *out) {
   fprintf(out,
           "Command line options : ycsb <options> \n"
           "   -h --help              :  print help message \n"
-          "   -i --index             :  index type: bwtree (default) or btree\n"
+          "   -i --index             :  index type: bwtree (default) or art\n"
           "   -k --scale_factor      :  # of K tuples \n"
           "   -d --duration          :  execution duration \n"
           "   -p --profile_duration  :  profile duration \n"
@@ -61,7 +61,7 @@ static struct option opts[] = {
 };
 
 void ValidateIndex(const configuration &state) {
-  if (state.index != INDEX_TYPE_BWTREE && state.index != INDEX_TYPE_BWTREE) {
+  if (state.index != INDEX_TYPE_BWTREE && state.index != INDEX_TYPE_ART) {
     LOG_ERROR("Invalid index");
     exit(EXIT_FAILURE);
   }
@@ -176,6 +176,8 @@ void ParseArguments(int argc, char *argv[], configuration &state) {
         char *index = optarg;
         if (strcmp(index, "bwtree") == 0) {
           state.index = INDEX_TYPE_BWTREE;
+        } else if (strcmp(index, "art") == 0) {
+          state.index = INDEX_TYPE_ART;
         } else {
           LOG_ERROR("Unknown index: %s", index);
           exit(EXIT_FAILURE);
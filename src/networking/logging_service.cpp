@@ -0,0 +1,57 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// logging_service.cpp
+//
+// Identification: src/networking/logging_service.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "networking/logging_service.h"
+#include "logging/log_manager.h"
+#include "logging/log_shipper.h"
+#include "common/logger.h"
+
+namespace peloton {
+namespace networking {
+
+void LoggingService::LogRecordReplay(
+    ::google::protobuf::RpcController* controller,
+    const LogRecordReplayRequest* request, LogRecordReplayResponse* response,
+    ::google::protobuf::Closure* done) {
+  if (controller->Failed()) {
+    std::string error = controller->ErrorText();
+    LOG_TRACE("LoggingService with controller failed:%s ", error.c_str());
+  }
+
+  // If request is not null, this is a rpc call on the follower, which should
+  // replay the log records
+  if (request != NULL) {
+    LOG_TRACE("Received log batch %ld (%lu bytes)",
+              (long)request->sequence_number(), request->log().size());
+
+    auto &log_manager = logging::LogManager::GetInstance();
+    if (log_manager.ReplayLog(request->log().data(), request->log().size()) ==
+        false) {
+      controller->SetFailed("Could not replay the log batch");
+    }
+
+    response->set_sequence_number(request->sequence_number());
+
+    // if callback exist, run it
+    if (done) {
+      done->Run();
+    }
+  }
+  // Here is for the leader callback for LogRecordReplay
+  else {
+    logging::LogShipper::GetInstance().Acknowledge(
+        response->sequence_number());
+  }
+}
+
+}  // namespace networking
+}  // namespace peloton
@@ -220,7 +220,8 @@ void *Connection::ProcessMessage(void *connection) {
         google::protobuf::Message *message = rpc_method->response_->New();
 
         // Deserialize the receiving message
-        message->ParseFromArray(buf + HEADERLEN + TYPELEN + OPCODELEN, msg_len);
+        message->ParseFromArray(buf + HEADERLEN + TYPELEN + OPCODELEN,
+                                msg_len - TYPELEN - OPCODELEN);
 
         // Invoke rpc call. request is null
         rpc_method->service_->CallMethod(method, &controller, NULL, message,
@@ -282,20 +283,10 @@ void Connection::ReadCb(UNUSED_ATTRIBUTE struct bufferevent *bev, void *ctx) {
 
   /*
    * Process the message will invoke rpc call.
-   * Note: this might take a long time. So we put this in a thread
-   */
-
-  /* prepaere workers_thread to send and recv data */
-  std::function<void()> worker_conn =
-      std::bind(&Connection::ProcessMessage, conn);
-
-  /*
-   * Add workers to thread pool to send and recv data
-   * Note: after AddTask, ReadCb will return and another
-   * request on this connection can be processed while
-   * the former is still being processed
+   * Note: the messages are processed on the event loop thread, so the
+   * messages of a connection are handled in the order they arrive
    */
-  //PthreadThreadPool::GetInstance().AddTask(worker_conn);
+  Connection::ProcessMessage(conn);
 }
 
 /*
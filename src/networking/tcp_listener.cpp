@@ -27,11 +27,21 @@
 namespace peloton {
 namespace networking {
 
-Listener::Listener(int port)
-    : port_(port), listen_base_(event_base_new()), listener_(NULL) {
-  // make libevent support multiple threads (pthread)
-  // TODO: put evthread_use_pthreads before event_base_new()?
+/*
+ * @breif NewEventBase makes libevent support multiple threads (pthread)
+ *        before the event base is created. This is required because the
+ *        connections are written by other threads than the event loop
+ */
+static struct event_base *NewEventBase() {
+  static int use_pthreads = evthread_use_pthreads();
+  if (use_pthreads != 0) {
+    LOG_ERROR("Couldn't make libevent thread-safe");
+  }
+  return event_base_new();
+}
 
+Listener::Listener(int port)
+    : port_(port), listen_base_(NewEventBase()), listener_(NULL) {
   PL_ASSERT(listen_base_ != NULL);
   PL_ASSERT(port_ > 0 && port_ < 65535);
 }
@@ -66,10 +76,6 @@ void Listener::Run(void *arg) {
   /* Listen on the given port. */
   sin.sin_port = htons(port_);
 
-  // TODO: Fix cmake to link in "-levent_pthreads"
-  /* We must specify this function if we use multiple threads*/
-  // evthread_use_pthreads();
-
   // TODO: LEV_OPT_THREADSAFE is necessary here?
   listener_ = evconnlistener_new_bind(
       listen_base_, AcceptConnCb, arg,
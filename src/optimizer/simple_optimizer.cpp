@@ -164,9 +164,26 @@ std::shared_ptr<planner::AbstractPlan> SimpleOptimizer::BuildPelotonPlanTree(
       // If there is no aggregate functions, just do a sequential scan
       if (!agg_flag && group_by_columns.size() == 0) {
         LOG_TRACE("No aggregate functions found.");
-        std::unique_ptr<planner::AbstractPlan> child_SelectPlan =
-            CreateScanPlan(target_table, column_ids, predicate,
-                           select_stmt->is_for_update);
+        std::unique_ptr<planner::AbstractPlan> child_SelectPlan;
+
+        // Without a predicate, ORDER BY + LIMIT can still be answered by
+        // walking the first (or last) keys of an index on the sort column
+        if (predicate == nullptr && select_stmt->order != NULL &&
+            select_stmt->limit != NULL &&
+            select_stmt->order->expr->GetExpressionType() ==
+                EXPRESSION_TYPE_VALUE_TUPLE) {
+          std::string sort_col_name(
+              ((expression::TupleValueExpression*)select_stmt->order->expr)
+                  ->GetColumnName());
+          child_SelectPlan = CreateOrderedIndexScanPlan(
+              target_table, column_ids, sort_col_name,
+              select_stmt->is_for_update);
+        }
+
+        if (child_SelectPlan == nullptr) {
+          child_SelectPlan = CreateScanPlan(target_table, column_ids, predicate,
+                                            select_stmt->is_for_update);
+        }
 
         // if we have expressions which are not just columns, we need to add a
         // projection plan node
@@ -255,7 +272,9 @@ std::shared_ptr<planner::AbstractPlan> SimpleOptimizer::BuildPelotonPlanTree(
           // limit operation speed. That is to say the limit flags are passed
           // to index, then index returns the tuples matched with the limit
           SetIndexScanFlag(child_SelectPlan.get(), select_stmt->limit->limit,
-                           offset, flags.front());
+                           offset, flags.front() ? SCAN_DIRECTION_TYPE_BACKWARD
+                                                 : SCAN_DIRECTION_TYPE_FORWARD,
+                           &sort_col_name);
 
           // Create order_by_plan
           std::unique_ptr<planner::OrderByPlan> order_by_plan(
@@ -654,6 +673,12 @@ std::shared_ptr<planner::AbstractPlan> SimpleOptimizer::BuildPelotonPlanTree(
 
 std::unique_ptr<planner::AbstractPlan> SimpleOptimizer::CreateCopyPlan(
     parser::CopyStatement* copy_stmt) {
+  // The rows of a COPY FROM STDIN come in CopyData messages
+  if (copy_stmt->file_path == nullptr) {
+    throw NotImplementedException(
+        "Error: COPY FROM STDIN is only supported by the wire protocol");
+  }
+
   std::string table_name(copy_stmt->cpy_table->GetTableName());
   bool deserialize_parameters = false;
 
@@ -783,6 +808,26 @@ bool SimpleOptimizer::CheckIndexSearchable(
   return true;
 }
 
+/**
+ * This function checks whether all the columns referenced by an expression
+ * are stored inside the (covering) index
+ */
+static bool IsExpressionCovered(const expression::AbstractExpression* expr,
+                                const index::IndexMetadata* index_metadata) {
+  if (expr->GetExpressionType() == EXPRESSION_TYPE_VALUE_TUPLE) {
+    auto tuple_expr =
+        static_cast<const expression::TupleValueExpression*>(expr);
+    if (tuple_expr->GetColumnId() < 0) return false;
+    return index_metadata->IsColumnCovered(tuple_expr->GetColumnId());
+  }
+
+  for (size_t child = 0; child < expr->GetChildrenSize(); child++) {
+    if (IsExpressionCovered(expr->GetChild(child), index_metadata) == false)
+      return false;
+  }
+  return true;
+}
+
 std::unique_ptr<planner::AbstractScan> SimpleOptimizer::CreateScanPlan(
     storage::DataTable* target_table, std::vector<oid_t>& column_ids,
     expression::AbstractExpression* predicate, bool for_update) {
@@ -827,11 +872,67 @@ std::unique_ptr<planner::AbstractScan> SimpleOptimizer::CreateScanPlan(
   // Create plan node.
   std::unique_ptr<planner::IndexScanPlan> node(new planner::IndexScanPlan(
       target_table, predicate, column_ids, index_scan_desc, for_update));
+
+  // A covering index can answer the scan by itself if it stores every output
+  // column as well as every column the residual predicate refers to
+  auto index_metadata = index->GetMetadata();
+  if (for_update == false && index_metadata->IsCovering() &&
+      column_ids.empty() == false) {
+    bool covered = true;
+    for (auto column_id : column_ids) {
+      if (index_metadata->IsColumnCovered(column_id) == false) {
+        covered = false;
+        break;
+      }
+    }
+    if (covered == true && predicate != nullptr) {
+      covered = IsExpressionCovered(predicate, index_metadata);
+    }
+    if (covered == true) {
+      LOG_TRACE("Index %s covers the scan", index->GetName().c_str());
+      node->SetIndexOnly(true);
+    }
+  }
   LOG_TRACE("Index scan plan created");
 
   return std::move(node);
 }
 
+std::unique_ptr<planner::AbstractScan>
+SimpleOptimizer::CreateOrderedIndexScanPlan(storage::DataTable* target_table,
+                                            std::vector<oid_t>& column_ids,
+                                            const std::string& sort_column,
+                                            bool for_update) {
+  oid_t sort_column_id = target_table->GetSchema()->GetColumnID(sort_column);
+
+  for (oid_t index_itr = 0; index_itr < target_table->GetIndexCount();
+       index_itr++) {
+    auto index = target_table->GetIndex(index_itr);
+    if (index == nullptr || index->GetMetadata()->GetVisibility() == false) {
+      continue;
+    }
+
+    if (index->GetMetadata()->GetKeyAttrs().front() != sort_column_id) {
+      continue;
+    }
+
+    // An index scan without key conditions covers the whole index
+    LOG_TRACE("Walking index %s in the order of %s", index->GetName().c_str(),
+              sort_column.c_str());
+    std::vector<oid_t> key_column_ids;
+    std::vector<ExpressionType> expr_types;
+    std::vector<type::Value> values;
+    std::vector<expression::AbstractExpression*> runtime_keys;
+    planner::IndexScanPlan::IndexScanDesc index_scan_desc(
+        index, key_column_ids, expr_types, values, runtime_keys);
+
+    return std::unique_ptr<planner::AbstractScan>(new planner::IndexScanPlan(
+        target_table, nullptr, column_ids, index_scan_desc, for_update));
+  }
+
+  return nullptr;
+}
+
 /**
  * This function replaces all COLUMN_REF expressions with TupleValue
  * expressions
@@ -1281,7 +1382,8 @@ std::unique_ptr<planner::AbstractPlan> SimpleOptimizer::CreateJoinPlan(
 
 void SimpleOptimizer::SetIndexScanFlag(planner::AbstractPlan* select_plan,
                                        uint64_t limit, uint64_t offset,
-                                       bool descent) {
+                                       ScanDirectionType scan_direction,
+                                       const std::string* sort_column) {
   // Set the flag for the underlying index scan plan
   planner::IndexScanPlan* index_scan_plan = nullptr;
 
@@ -1302,12 +1404,46 @@ void SimpleOptimizer::SetIndexScanFlag(planner::AbstractPlan* select_plan,
     }
   }
 
+  // The index scan stops after limit + offset tuples in key order, which are
+  // the right ones for ORDER BY only if the key order is the sort order
+  if (index_scan_plan != nullptr && sort_column != nullptr) {
+    auto index = index_scan_plan->GetIndex();
+    auto &key_attrs = index->GetMetadata()->GetKeyAttrs();
+    oid_t sort_column_id =
+        index_scan_plan->GetTable()->GetSchema()->GetColumnID(*sort_column);
+
+    auto &key_column_ids = index_scan_plan->GetKeyColumnIds();
+    auto &expr_types = index_scan_plan->GetExprTypes();
+    bool sorted = false;
+    for (auto key_attr : key_attrs) {
+      if (key_attr == sort_column_id) {
+        sorted = true;
+        break;
+      }
+
+      bool fixed = false;
+      for (size_t i = 0; i < key_column_ids.size(); i++) {
+        if (key_column_ids[i] == key_attr &&
+            expr_types[i] == EXPRESSION_TYPE_COMPARE_EQUAL) {
+          fixed = true;
+          break;
+        }
+      }
+      if (fixed == false) break;
+    }
+
+    if (sorted == false) {
+      LOG_TRACE("Index order does not match ORDER BY, limit is not pushed");
+      return;
+    }
+  }
+
   if (index_scan_plan != nullptr) {
     LOG_TRACE("Set index scan plan");
     index_scan_plan->SetLimit(true);
     index_scan_plan->SetLimitNumber(limit);
     index_scan_plan->SetLimitOffset(offset);
-    index_scan_plan->SetDescend(descent);
+    index_scan_plan->SetScanDirection(scan_direction);
   }
 }
 }  // namespace optimizer
@@ -182,6 +182,10 @@ void GetCreateStatementInfo(CreateStatement* stmt, uint num_indent) {
     printf("INDEX : table : %s unique : %d attrs : ",
            stmt->GetTableName().c_str(), stmt->unique);
     for (auto key : *(stmt->index_attrs)) printf("%s ", key);
+    if (stmt->include_attrs != nullptr) {
+      printf("include : ");
+      for (auto key : *(stmt->include_attrs)) printf("%s ", key);
+    }
     printf("\n");
   } else if (stmt->type == CreateStatement::CreateType::kTable) {
     inprint(stmt->GetTableName().c_str(), num_indent + 1);
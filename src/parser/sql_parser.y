@@ -194,7 +194,7 @@ struct PARSER_CUST_LTYPE {
 %token REFERENCES DEALLOCATE PARAMETERS INTERSECT TEMPORARY TIMESTAMP
 %token VARBINARY ROLLBACK DISTINCT NVARCHAR RESTRICT TRUNCATE ANALYZE BETWEEN BOOLEAN ADDRESS
 %token DATABASE SMALLINT VARCHAR FOREIGN TINYINT CASCADE COLUMNS CONTROL DEFAULT EXECUTE EXPLAIN EXTRACT
-%token INTEGER NATURAL PREPARE PRIMARY SCHEMAS DECIMAL
+%token INCLUDE INTEGER NATURAL PREPARE PRIMARY SCHEMAS DECIMAL
 %token SPATIAL VIRTUAL BEFORE COLUMN CREATE DELETE DIRECT 
 %token BIGINT DOUBLE ESCAPE EXCEPT EXISTS GLOBAL HAVING
 %token INSERT ISNULL OFFSET RENAME SCHEMA SELECT SORTED
@@ -205,7 +205,7 @@ struct PARSER_CUST_LTYPE {
 %token LOAD NULL PART PLAN SHOW TEXT TIME VIEW WITH ADD ALL
 %token AND ASC CSV FOR INT KEY NOT OFF SET TOP SUM MIN MAX AVG AS BY IF
 %token IN IS OF ON OR TO
-%token COPY DELIMITER
+%token COPY DELIMITER STDIN BINARY
 
 /*********************************
  ** Non-Terminal types (http://www.gnu.org/software/bison/manual/html_node/Type-Decl.html)
@@ -225,6 +225,8 @@ struct PARSER_CUST_LTYPE {
 %type <sval> 		opt_alias alias
 %type <bval> 		opt_not_exists opt_exists opt_distinct opt_notnull opt_primary opt_unique opt_update
 %type <uval>		opt_join_type column_type opt_column_width opt_index_type
+%type <uval>		opt_copy_format
+%type <sval>		opt_copy_delimiter
 %type <table> 		from_clause table_ref table_ref_atomic table_ref_name
 %type <table>		join_clause join_table table_ref_name_no_alias
 %type <expr> 		expr scalar_expr unary_expr binary_expr function_expr star_expr expr_alias parameter_expr opt_default
@@ -238,7 +240,7 @@ struct PARSER_CUST_LTYPE {
 %type <update_t>	update_clause
 %type <group_t>		opt_group
 
-%type <str_vec>				ident_commalist opt_column_list
+%type <str_vec>				ident_commalist opt_column_list opt_include
 %type <expr_vec>			expr_list select_list literal_list
 %type <table_vec>			table_ref_commalist
 %type <update_vec>			update_clause_commalist
@@ -344,6 +346,7 @@ execute_statement:
  * Create Statement
  * CREATE TABLE students (name TEXT, student_number INTEGER, city TEXT, grade DOUBLE)
  * CREATE INDEX i_security ON security (s_co_id, s_issue)
+ * CREATE INDEX i_security ON security (s_co_id) INCLUDE (s_issue)
  * CREATE DATABASE my_db
  ******************************/
 create_statement:
@@ -358,25 +361,32 @@ create_statement:
 			$$->if_not_exists = $3;
 			$$->database_name = $4;
 		}
-		|	CREATE opt_unique INDEX IDENTIFIER ON table_name '(' ident_commalist ')' {
+		|	CREATE opt_unique INDEX IDENTIFIER ON table_name '(' ident_commalist ')' opt_include {
 			$$ = new CreateStatement(CreateStatement::kIndex);
 			$$->unique = $2;
 			$$->index_name = $4;
 			$$->table_info_ = $6;
 			$$->index_attrs = $8;
+			$$->include_attrs = $10;
 			$$->index_type = peloton::INDEX_TYPE_BWTREE;
 		}
 
-		|	CREATE opt_unique INDEX IDENTIFIER ON table_name '(' ident_commalist ')' USING opt_index_type {
+		|	CREATE opt_unique INDEX IDENTIFIER ON table_name '(' ident_commalist ')' opt_include USING opt_index_type {
 			$$ = new CreateStatement(CreateStatement::kIndex);
 			$$->unique = $2;
 			$$->index_name = $4;
 			$$->table_info_ = $6;
 			$$->index_attrs = $8;
-			$$->index_type = $11;
+			$$->include_attrs = $10;
+			$$->index_type = $12;
 		}
 	;
 
+opt_include:
+		INCLUDE '(' ident_commalist ')' { $$ = $3; }
+	|	/* empty */ { $$ = nullptr; }
+	;
+
 opt_not_exists:
 		IF NOT EXISTS { $$ = true; }
 	|	/* empty */ { $$ = false; }
@@ -948,6 +958,7 @@ join_condition:
 /******************************
  * Copy Statement
  * COPY catalog_db.query_metric TO '/home/user/query_metric.csv' DELIMITER ','
+ * COPY foo FROM STDIN WITH CSV DELIMITER ';'
  * TODO: Nested query like below is not supported yet
  * COPY (SELECT id FROM A WHERE val = 1) TO '/path/file.csv' DELIMITER ';'
  ******************************/
@@ -962,6 +973,29 @@ copy_statement:
 			$$->delimiter = *($6);
 			delete $6;
 		}
+	|	COPY table_ref_name FROM STDIN opt_copy_format opt_copy_delimiter {
+			$$ = new CopyStatement((peloton::CopyType) $5);
+			$$->cpy_table = $2;
+			if ($6 != NULL) {
+				$$->delimiter = *($6);
+				delete $6;
+			} else if ($5 == peloton::COPY_TYPE_IMPORT_TSV) {
+				$$->delimiter = '\t';
+			}
+		}
+	;
+
+opt_copy_format:
+		WITH CSV { $$ = peloton::COPY_TYPE_IMPORT_CSV; }
+	|	CSV { $$ = peloton::COPY_TYPE_IMPORT_CSV; }
+	|	WITH BINARY { $$ = peloton::COPY_TYPE_IMPORT_BINARY; }
+	|	BINARY { $$ = peloton::COPY_TYPE_IMPORT_BINARY; }
+	|	/* empty */ { $$ = peloton::COPY_TYPE_IMPORT_TSV; }
+	;
+
+opt_copy_delimiter:
+		DELIMITER STRING { $$ = $2; }
+	|	/* empty */ { $$ = NULL; }
 	;
 
 
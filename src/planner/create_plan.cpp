@@ -88,6 +88,12 @@ CreatePlan::CreatePlan(parser::CreateStatement *parse_tree) {
 
     index_attrs = index_attrs_holder;
 
+    if (parse_tree->include_attrs != nullptr) {
+      for (auto attr : *parse_tree->include_attrs) {
+        include_attrs.push_back(attr);
+      }
+    }
+
     index_type = parse_tree->index_type;
 
     unique = parse_tree->unique;
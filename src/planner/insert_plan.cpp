@@ -164,6 +164,11 @@ type::AbstractPool *InsertPlan::GetPlanPool() {
   return pool_.get();
 }
 
+void InsertPlan::AddTuple(std::unique_ptr<storage::Tuple> &&tuple) {
+  tuples_.push_back(std::move(tuple));
+  bulk_insert_count = tuples_.size();
+}
+
 void InsertPlan::SetParameterValues(std::vector<type::Value> *values) {
   PL_ASSERT(values->size() == parameter_vector_->size());
   LOG_TRACE("Set Parameter Values in Insert");
@@ -190,5 +195,55 @@ void InsertPlan::SetParameterValues(std::vector<type::Value> *values) {
     }
   }
 }
+
+bool InsertPlan::IsBatchable() const {
+  return target_table_ != nullptr && project_info_.get() == nullptr &&
+         GetChildren().empty() && tuples_.size() == 1 &&
+         bulk_insert_count == 1 && parameter_vector_.get() != nullptr &&
+         parameter_vector_->empty() == false;
+}
+
+std::unique_ptr<InsertPlan> InsertPlan::BindBatch(
+    const std::vector<std::vector<type::Value>> &param_rows) const {
+  PL_ASSERT(IsBatchable());
+  std::unique_ptr<InsertPlan> batch_plan(
+      new InsertPlan(target_table_, param_rows.size()));
+
+  auto schema = target_table_->GetSchema();
+  auto column_count = schema->GetColumnCount();
+  auto &template_tuple = tuples_[0];
+
+  // The parameter columns of the template tuple are not set
+  std::vector<bool> is_param_column(column_count, false);
+  for (auto &put_loc : *parameter_vector_) {
+    is_param_column[std::get<1>(put_loc)] = true;
+  }
+
+  for (auto &params : param_rows) {
+    PL_ASSERT(params.size() == parameter_vector_->size());
+    std::unique_ptr<storage::Tuple> tuple(new storage::Tuple(schema, true));
+
+    // Constants of the statement
+    for (oid_t column_id = 0; column_id < column_count; column_id++) {
+      if (is_param_column[column_id] == false) {
+        tuple->SetValue(column_id, template_tuple->GetValue(column_id),
+                        batch_plan->GetPlanPool());
+      }
+    }
+
+    // Then its parameters
+    for (unsigned int i = 0; i < params.size(); ++i) {
+      auto &put_loc = parameter_vector_->at(i);
+      auto value = params.at(std::get<2>(put_loc))
+                       .CastAs(params_value_type_->at(i));
+      tuple->SetValue(std::get<1>(put_loc), value, batch_plan->GetPlanPool());
+    }
+
+    batch_plan->tuples_.push_back(std::move(tuple));
+  }
+
+  return batch_plan;
+}
+
 }
 }
@@ -47,7 +47,10 @@ BackendStatsContext* BackendStatsContext::GetInstance() {
 
 BackendStatsContext::BackendStatsContext(size_t max_latency_history,
                                          bool regiser_to_aggregator)
-    : txn_latencies_(LATENCY_METRIC, max_latency_history) {
+    : txn_latencies_(LATENCY_METRIC, max_latency_history),
+      commit_latency_histogram_(HISTOGRAM_METRIC, "COMMIT LATENCY", "us"),
+      group_commit_size_histogram_(HISTOGRAM_METRIC, "GROUP COMMIT SIZE",
+                                   "txns") {
   std::thread::id this_id = std::this_thread::get_id();
   thread_id_ = this_id;
 
@@ -233,6 +236,8 @@ void BackendStatsContext::Aggregate(BackendStatsContext& source) {
   // Aggregate all global metrics
   txn_latencies_.Aggregate(source.txn_latencies_);
   txn_latencies_.ComputeLatencies();
+  commit_latency_histogram_.Aggregate(source.commit_latency_histogram_);
+  group_commit_size_histogram_.Aggregate(source.group_commit_size_histogram_);
 
   // Aggregate all per-database metrics
   for (auto& database_item : source.database_metrics_) {
@@ -267,6 +272,8 @@ void BackendStatsContext::Aggregate(BackendStatsContext& source) {
 
 void BackendStatsContext::Reset() {
   txn_latencies_.Reset();
+  commit_latency_histogram_.Reset();
+  group_commit_size_histogram_.Reset();
 
   for (auto& database_item : database_metrics_) {
     database_item.second->Reset();
@@ -322,6 +329,8 @@ std::string BackendStatsContext::ToString() const {
   std::stringstream ss;
 
   ss << txn_latencies_.GetInfo() << std::endl;
+  ss << commit_latency_histogram_.GetInfo();
+  ss << group_commit_size_histogram_.GetInfo() << std::endl;
 
   for (auto& database_item : database_metrics_) {
     oid_t database_id = database_item.second->GetDatabaseId();
@@ -0,0 +1,91 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// histogram_metric.cpp
+//
+// Identification: src/statistics/histogram_metric.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "statistics/histogram_metric.h"
+#include "common/macros.h"
+
+namespace peloton {
+namespace stats {
+
+HistogramMetric::HistogramMetric(MetricType type, const std::string &name,
+                                 const std::string &unit)
+    : AbstractMetric(type), name_(name), unit_(unit) {
+  Reset();
+}
+
+void HistogramMetric::Reset() {
+  for (size_t i = 0; i < BUCKET_COUNT; i++) {
+    buckets_[i].store(0);
+  }
+  count_.store(0);
+  sum_.store(0);
+}
+
+void HistogramMetric::Aggregate(AbstractMetric &source) {
+  PL_ASSERT(source.GetType() == HISTOGRAM_METRIC);
+
+  auto &histogram = static_cast<HistogramMetric &>(source);
+  for (size_t i = 0; i < BUCKET_COUNT; i++) {
+    buckets_[i].fetch_add(histogram.GetBucketCount(i));
+  }
+  count_.fetch_add(histogram.GetCount());
+  sum_.fetch_add(histogram.GetSum());
+}
+
+uint64_t HistogramMetric::GetPercentile(double percentile) const {
+  uint64_t count = GetCount();
+  if (count == 0) {
+    return 0;
+  }
+
+  // Rank of the value we are looking for, starting at 1
+  uint64_t rank = static_cast<uint64_t>(percentile / 100 * count);
+  if (rank == 0) rank = 1;
+
+  uint64_t seen = 0;
+  for (size_t i = 0; i < BUCKET_COUNT; i++) {
+    seen += GetBucketCount(i);
+    if (seen >= rank) {
+      return 1ULL << i;
+    }
+  }
+  return 1ULL << (BUCKET_COUNT - 1);
+}
+
+const std::string HistogramMetric::GetInfo() const {
+  std::stringstream ss;
+  uint64_t count = GetCount();
+
+  ss << name_ << " (" << unit_ << "): [ ";
+  ss << "count=" << count;
+  if (count != 0) {
+    ss << ", average=" << static_cast<double>(GetSum()) / count;
+    ss << ", median<" << GetPercentile(50);
+    ss << ", 99th-%-tile<" << GetPercentile(99);
+    ss << ", buckets={";
+    bool first = true;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+      uint64_t bucket_count = GetBucketCount(i);
+      if (bucket_count == 0) continue;
+      if (first == false) ss << ", ";
+      // Lower bound of the bucket
+      ss << ((i == 0) ? 0 : (1ULL << (i - 1))) << ":" << bucket_count;
+      first = false;
+    }
+    ss << "}";
+  }
+  ss << " ]" << std::endl;
+  return ss.str();
+}
+
+}  // namespace stats
+}  // namespace peloton
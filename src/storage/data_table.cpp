@@ -327,24 +327,122 @@ ItemPointer DataTable::InsertTuple(const storage::Tuple *tuple) {
 }
 
 /**
- * @brief Insert a tuple into all indexes. If index is primary/unique,
- * check visibility of existing
- * index entries.
- * @warning This still doesn't guarantee serializability.
+ * @brief Insert a batch of tuples, e.g. a chunk of a bulk load.
  *
- * @returns True on success, false if a visible entry exists (in case of
- *primary/unique).
+ * Instead of one atomic add per tuple, consecutive slots are claimed in
+ * ranges that are as large as the active tile group allows. Index entries
+ * are inserted index by index so that the key tuple is reused and each
+ * index stays hot in the cache while the batch goes in.
+ *
+ * @returns True on success, false if an index or foreign key constraint is
+ * violated. The transaction must be aborted in that case.
  */
-bool DataTable::InsertInIndexes(const storage::Tuple *tuple,
-                                ItemPointer location,
-                                concurrency::Transaction *transaction,
-                                ItemPointer **index_entry_ptr) {
-  int index_count = GetIndexCount();
+bool DataTable::InsertTuples(const std::vector<const storage::Tuple *> &tuples,
+                             concurrency::Transaction *transaction,
+                             std::vector<ItemPointer> &locations) {
+  oid_t tuple_count = tuples.size();
+  locations.clear();
+  locations.reserve(tuple_count);
+
+  // Claim the slots. Recycled slots are left to the single tuple inserts
+  size_t active_tile_group_id = number_of_tuples_ % active_tilegroup_count_;
+  oid_t inserted_count = 0;
+  while (inserted_count < tuple_count) {
+    auto tile_group = active_tile_groups_[active_tile_group_id];
+
+    oid_t first_slot = INVALID_OID;
+    oid_t claimed = tile_group->InsertTuples(
+        tuples.data() + inserted_count, tuple_count - inserted_count,
+        first_slot);
+
+    // some other thread is allocating a new tile group
+    if (claimed == 0) {
+      continue;
+    }
+
+    auto tile_group_id = tile_group->GetTileGroupId();
+    for (oid_t tuple_itr = 0; tuple_itr < claimed; tuple_itr++) {
+      locations.emplace_back(tile_group_id, first_slot + tuple_itr);
+    }
+    inserted_count += claimed;
+
+    // we got the last tuple slot of the tile group
+    if (first_slot + claimed == tile_group->GetAllocatedTupleCount()) {
+      AddDefaultTileGroup(active_tile_group_id);
+    }
+  }
+
+  LOG_TRACE("Inserted %u tuples, tile group count: %lu", tuple_count,
+            tile_group_count_.load());
+
+  auto &transaction_manager =
+      concurrency::TransactionManagerFactory::GetInstance();
+  auto index_count = GetIndexCount();
+
+  // Own the tuples before any of them shows up in an index
+  std::vector<ItemPointer *> index_entry_ptrs(tuple_count, nullptr);
+  for (oid_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+    if (index_count != 0) {
+      index_entry_ptrs[tuple_itr] = AllocateIndirection(locations[tuple_itr]);
+    }
+    transaction_manager.PerformInsert(transaction, locations[tuple_itr],
+                                      index_entry_ptrs[tuple_itr]);
+  }
+  IncreaseTupleCount(tuple_count);
 
+  if (index_count == 0 && foreign_keys_.empty()) {
+    return true;
+  }
+
+  std::function<bool(const void *)> fn =
+      std::bind(&concurrency::TransactionManager::IsOccupied,
+                &transaction_manager, transaction, std::placeholders::_1);
+
+  for (int index_itr = index_count - 1; index_itr >= 0; --index_itr) {
+    auto index = GetIndex(index_itr);
+    auto index_schema = index->GetMetadata()->GetCoveringSchema();
+    auto indexed_columns = index_schema->GetIndexedColumns();
+    bool is_unique =
+        (index->GetIndexType() == INDEX_CONSTRAINT_TYPE_PRIMARY_KEY ||
+         index->GetIndexType() == INDEX_CONSTRAINT_TYPE_UNIQUE);
+    std::unique_ptr<storage::Tuple> key(new storage::Tuple(index_schema, true));
+
+    for (oid_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+      key->SetFromTuple(tuples[tuple_itr], indexed_columns, index->GetPool());
+
+      if (is_unique) {
+        if (index->CondInsertEntry(key.get(), index_entry_ptrs[tuple_itr],
+                                   fn) == false) {
+          LOG_TRACE("Index constraint violated on %s",
+                    index->GetName().c_str());
+          return false;
+        }
+      } else {
+        index->InsertEntry(key.get(), index_entry_ptrs[tuple_itr]);
+      }
+    }
+  }
+
+  for (auto tuple : tuples) {
+    if (CheckForeignKeyConstraints(tuple) == false) {
+      LOG_TRACE("ForeignKey constraint violated");
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * @brief Allocate the indirection that the index entries of a tuple point to
+ * and point it to the given location.
+ */
+ItemPointer *DataTable::AllocateIndirection(const ItemPointer &location) {
   size_t active_indirection_array_id =
       number_of_tuples_ % active_indirection_array_count_;
 
   size_t indirection_offset = INVALID_INDIRECTION_OFFSET;
+  ItemPointer *indirection = nullptr;
 
   while (true) {
     auto active_indirection_array =
@@ -352,19 +450,39 @@ bool DataTable::InsertInIndexes(const storage::Tuple *tuple,
     indirection_offset = active_indirection_array->AllocateIndirection();
 
     if (indirection_offset != INVALID_INDIRECTION_OFFSET) {
-      *index_entry_ptr =
+      indirection =
           active_indirection_array->GetIndirectionByOffset(indirection_offset);
       break;
     }
   }
 
-  (*index_entry_ptr)->block = location.block;
-  (*index_entry_ptr)->offset = location.offset;
+  indirection->block = location.block;
+  indirection->offset = location.offset;
 
   if (indirection_offset == INDIRECTION_ARRAY_MAX_SIZE - 1) {
     AddDefaultIndirectionArray(active_indirection_array_id);
   }
 
+  return indirection;
+}
+
+/**
+ * @brief Insert a tuple into all indexes. If index is primary/unique,
+ * check visibility of existing
+ * index entries.
+ * @warning This still doesn't guarantee serializability.
+ *
+ * @returns True on success, false if a visible entry exists (in case of
+ *primary/unique).
+ */
+bool DataTable::InsertInIndexes(const storage::Tuple *tuple,
+                                ItemPointer location,
+                                concurrency::Transaction *transaction,
+                                ItemPointer **index_entry_ptr) {
+  int index_count = GetIndexCount();
+
+  *index_entry_ptr = AllocateIndirection(location);
+
   auto &transaction_manager =
       concurrency::TransactionManagerFactory::GetInstance();
 
@@ -378,7 +496,8 @@ bool DataTable::InsertInIndexes(const storage::Tuple *tuple,
 
   for (int index_itr = index_count - 1; index_itr >= 0; --index_itr) {
     auto index = GetIndex(index_itr);
-    auto index_schema = index->GetKeySchema();
+    // Covering indexes also store their INCLUDE columns after the key
+    auto index_schema = index->GetMetadata()->GetCoveringSchema();
     auto indexed_columns = index_schema->GetIndexedColumns();
     std::unique_ptr<storage::Tuple> key(new storage::Tuple(index_schema, true));
     key->SetFromTuple(tuple, indexed_columns, index->GetPool());
@@ -463,9 +582,12 @@ bool DataTable::InsertInSecondaryIndexes(const AbstractTuple *tuple,
     }
 
     // Key attributes are updated, insert a new entry in all secondary index
-    std::unique_ptr<storage::Tuple> key(new storage::Tuple(index_schema, true));
+    auto covering_schema = index->GetMetadata()->GetCoveringSchema();
+    std::unique_ptr<storage::Tuple> key(
+        new storage::Tuple(covering_schema, true));
 
-    key->SetFromTuple(tuple, indexed_columns, index->GetPool());
+    key->SetFromTuple(tuple, covering_schema->GetIndexedColumns(),
+                      index->GetPool());
 
     switch (index->GetIndexType()) {
       case INDEX_CONSTRAINT_TYPE_PRIMARY_KEY:
@@ -21,6 +21,7 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 
@@ -44,6 +45,9 @@ extern int peloton_flush_mode;
 // PCOMMIT latency (for NVM WBL)
 extern int peloton_pcommit_latency;
 
+// Emulate NVM with the memory-mapped data file (for NVM WBL)
+extern bool peloton_nvm_emulation;
+
 // PMEM file size
 size_t peloton_data_file_size = 0;
 
@@ -333,6 +337,9 @@ StorageManager::StorageManager()
     Func_drain = drain_pcommit;
   }
 
+  nvm_emulation =
+      (peloton_logging_mode == LOGGING_TYPE_NVM_WBL && peloton_nvm_emulation);
+
   // Rest of this stuff is needed only for Write Behind Logging
   int data_fd;
   std::string data_file_name;
@@ -447,58 +454,76 @@ void *StorageManager::Allocate(BackendType type, size_t size) {
   allocation_count++;
 
   switch (type) {
-    case BACKEND_TYPE_MM:
+    case BACKEND_TYPE_MM: {
+      return ::operator new(size);
+    } break;
+
     case BACKEND_TYPE_NVM: {
+      if (nvm_emulation == true) {
+        return AllocateFromDataFile(size);
+      }
       return ::operator new(size);
     } break;
 
     case BACKEND_TYPE_SSD:
     case BACKEND_TYPE_HDD: {
-      {
-        size_t cache_data_file_offset = 0;
+      return AllocateFromDataFile(size);
+    } break;
 
-        // Lock the file
-        data_file_spinlock.Lock();
+    case BACKEND_TYPE_INVALID:
+    default: {
+      throw Exception("invalid backend: " + std::to_string(data_file_len));
+      return nullptr;
+    }
+  }
+}
 
-        // Check if within bounds
-        if (data_file_offset < data_file_len) {
-          cache_data_file_offset = data_file_offset;
+void *StorageManager::AllocateFromDataFile(size_t size) {
+  size_t cache_data_file_offset = 0;
 
-          // Offset by the requested size
-          data_file_offset += size;
+  // Start every allocation on a cache line, so that flushing the lines of
+  // one allocation never writes back another one
+  size = (size + FLUSH_ALIGN - 1) & ~(FLUSH_ALIGN - 1);
 
-          // Unlock the file
-          data_file_spinlock.Unlock();
+  // Lock the file
+  data_file_spinlock.Lock();
 
-          void *address = reinterpret_cast<char *>(data_file_address) +
-                          cache_data_file_offset;
-          return address;
-        }
+  // Check if within bounds
+  if (data_file_offset + size <= data_file_len) {
+    cache_data_file_offset = data_file_offset;
 
-        data_file_spinlock.Unlock();
-        throw Exception("no more memory available: offset : " +
-                        std::to_string(data_file_offset) + " length : " +
-                        std::to_string(data_file_len));
+    // Offset by the requested size
+    data_file_offset += size;
 
-        return nullptr;
-      }
-    } break;
+    // Unlock the file
+    data_file_spinlock.Unlock();
 
-    case BACKEND_TYPE_INVALID:
-    default: {
-      throw Exception("invalid backend: " + std::to_string(data_file_len));
-      return nullptr;
-    }
+    void *address =
+        reinterpret_cast<char *>(data_file_address) + cache_data_file_offset;
+    return address;
   }
+
+  data_file_spinlock.Unlock();
+  throw Exception("no more memory available: offset : " +
+                  std::to_string(data_file_offset) + " length : " +
+                  std::to_string(data_file_len));
+
+  return nullptr;
 }
 
 void StorageManager::Release(BackendType type, void *address) {
   switch (type) {
-    case BACKEND_TYPE_MM:
-    case BACKEND_TYPE_NVM: {
+    case BACKEND_TYPE_MM: {
       ::operator delete(address);
     } break;
 
+    case BACKEND_TYPE_NVM: {
+      // Emulated NVM is never reused, like the data file of SSD and HDD
+      if (nvm_emulation == false) {
+        ::operator delete(address);
+      }
+    } break;
+
     case BACKEND_TYPE_SSD:
     case BACKEND_TYPE_HDD: {
       // Nothing to do here
@@ -523,18 +548,18 @@ void StorageManager::Sync(BackendType type, void *address, size_t length) {
       Func_flush(address, length);
       Func_drain();
       clflush_count++;
+
+      if (nvm_emulation == true) {
+        SyncDataFile(reinterpret_cast<uintptr_t>(address),
+                     reinterpret_cast<uintptr_t>(address) + length);
+      }
     } break;
 
     case BACKEND_TYPE_SSD:
     case BACKEND_TYPE_HDD: {
-      // sync the mmap'ed file to SSD or HDD
-      int status = msync(data_file_address, data_file_len, MS_SYNC);
-      if (status != 0) {
-        perror("msync");
-        exit(EXIT_FAILURE);
-      }
-
-      msync_count++;
+      // sync the pages of the mmap'ed file to SSD or HDD
+      SyncDataFile(reinterpret_cast<uintptr_t>(address),
+                   reinterpret_cast<uintptr_t>(address) + length);
     } break;
 
     case BACKEND_TYPE_INVALID:
@@ -544,5 +569,80 @@ void StorageManager::Sync(BackendType type, void *address, size_t length) {
   }
 }
 
+void StorageManager::SyncRanges(BackendType type,
+                                std::vector<DirtyRange> &ranges) {
+  if (ranges.empty() || type == BACKEND_TYPE_MM) {
+    return;
+  }
+
+  // Merge the ranges at cache line granularity
+  std::sort(ranges.begin(), ranges.end());
+  size_t merged_count = 0;
+  for (auto &range : ranges) {
+    uintptr_t begin = range.first & ~(FLUSH_ALIGN - 1);
+    uintptr_t end = (range.second + FLUSH_ALIGN - 1) & ~(FLUSH_ALIGN - 1);
+    if (merged_count > 0 && begin <= ranges[merged_count - 1].second) {
+      auto &last = ranges[merged_count - 1];
+      last.second = std::max(last.second, end);
+    } else {
+      ranges[merged_count++] = DirtyRange(begin, end);
+    }
+  }
+  ranges.resize(merged_count);
+
+  for (auto &range : ranges) {
+    synced_bytes += range.second - range.first;
+  }
+
+  if (type == BACKEND_TYPE_NVM) {
+    // flush all the lines and drain once
+    for (auto &range : ranges) {
+      Func_flush(reinterpret_cast<const void *>(range.first),
+                 range.second - range.first);
+    }
+    Func_drain();
+    clflush_count++;
+
+    if (nvm_emulation == false) {
+      return;
+    }
+  }
+
+  // msync the pages of the file-backed ranges
+  static const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+  uintptr_t begin = ranges.front().first & ~(page_size - 1);
+  uintptr_t end = ranges.front().second;
+  for (auto &range : ranges) {
+    uintptr_t range_begin = range.first & ~(page_size - 1);
+    if (range_begin > end) {
+      SyncDataFile(begin, end);
+      begin = range_begin;
+    }
+    end = std::max(end, range.second);
+  }
+  SyncDataFile(begin, end);
+}
+
+void StorageManager::SyncDataFile(uintptr_t begin, uintptr_t end) {
+  static const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+  uintptr_t file_begin = reinterpret_cast<uintptr_t>(data_file_address);
+  uintptr_t file_end = file_begin + data_file_len;
+
+  // msync needs the range to start on a page
+  begin = std::max(begin & ~(page_size - 1), file_begin);
+  end = std::min(end, file_end);
+  if (data_file_address == nullptr || begin >= end) {
+    return;
+  }
+
+  int status = msync(reinterpret_cast<void *>(begin), end - begin, MS_SYNC);
+  if (status != 0) {
+    perror("msync");
+    exit(EXIT_FAILURE);
+  }
+
+  msync_count++;
+}
+
 }  // End storage namespace
 }  // End peloton namespace
@@ -159,6 +159,27 @@ oid_t TileGroup::InsertTuple(const Tuple *tuple) {
   return tuple_slot_id;
 }
 
+/**
+ * Grab a range of slots with a single atomic add and fill in the tuples.
+ * Returns the number of tuples inserted (0 if the tile group is full)
+ */
+oid_t TileGroup::InsertTuples(const Tuple *const *tuples, const oid_t count,
+                              oid_t &first_slot) {
+  oid_t claimed = tile_group_header->GetNextEmptyTupleSlots(count, first_slot);
+
+  LOG_TRACE("Tile Group Id :: %u claimed %u slots from %u out of %u slots",
+            tile_group_id, claimed, first_slot, num_tuple_slots);
+
+  for (oid_t tuple_itr = 0; tuple_itr < claimed; tuple_itr++) {
+    CopyTuple(tuples[tuple_itr], first_slot + tuple_itr);
+
+    PL_ASSERT(tile_group_header->GetTransactionId(first_slot + tuple_itr) ==
+              INVALID_TXN_ID);
+  }
+
+  return claimed;
+}
+
 /**
  * Grab specific slot and fill in the tuple
  * Used by recovery
@@ -375,6 +396,20 @@ void TileGroup::Sync() {
   }
 }
 
+void TileGroup::CollectDirtyRanges(oid_t tuple_slot,
+                                   std::vector<DirtyRange> &ranges) const {
+  for (auto tile : tiles) {
+    auto location =
+        reinterpret_cast<uintptr_t>(tile->GetTupleLocation(tuple_slot));
+    ranges.emplace_back(location, location + tile->GetSchema()->GetLength());
+  }
+
+  auto header_location = reinterpret_cast<uintptr_t>(
+      tile_group_header->GetHeaderEntryLocation(tuple_slot));
+  ranges.emplace_back(header_location,
+                      header_location + TileGroupHeader::header_entry_size);
+}
+
 //===--------------------------------------------------------------------===//
 // Utilities
 //===--------------------------------------------------------------------===//
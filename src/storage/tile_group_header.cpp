@@ -35,7 +35,12 @@ TileGroupHeader::TileGroupHeader(const BackendType &backend_type,
       data(nullptr),
       num_tuple_slots(tuple_count),
       next_tuple_slot(0),
-      tile_header_lock() {
+      tile_header_lock(),
+      all_visible_cid_(MAX_CID),
+      all_visible_generation_(0),
+      all_visible_checked_cid_(INVALID_CID),
+      in_place_updated_(false),
+      has_dead_versions_(false) {
   header_size = num_tuple_slots * header_entry_size;
 
   // allocate storage space for header
@@ -159,6 +164,71 @@ const std::string TileGroupHeader::GetInfo() const {
   return os.str();
 }
 
+/**
+ * @brief Check whether all the tuples in this tile group are visible.
+ *
+ * The summary is only computed for full tile groups, since new tuples can
+ * not show up in them any more (other than through recycled slots, which
+ * first have to be invalidated). A positive result is cached until the next
+ * ResetAllVisible(). Tile groups that contain deleted or superseded versions
+ * are remembered so that we do not rescan them over and over again.
+ */
+bool TileGroupHeader::IsAllVisible(const cid_t &read_cid) const {
+  if (in_place_updated_.load() == true || has_dead_versions_.load() == true) {
+    return false;
+  }
+
+  cid_t all_visible_cid = all_visible_cid_.load();
+  if (all_visible_cid != MAX_CID) {
+    return all_visible_cid <= read_cid;
+  }
+
+  if (next_tuple_slot.load() < num_tuple_slots) {
+    return false;
+  }
+
+  // Somebody else failed at this (or a newer) snapshot already
+  if (read_cid <= all_visible_checked_cid_.load()) {
+    return false;
+  }
+
+  auto generation = all_visible_generation_.load();
+
+  cid_t max_begin_cid = INVALID_CID;
+  for (oid_t tuple_slot_id = START_OID; tuple_slot_id < num_tuple_slots;
+       tuple_slot_id++) {
+    cid_t end_cid = GetEndCommitId(tuple_slot_id);
+    if (end_cid != MAX_CID ||
+        GetNextItemPointer(tuple_slot_id).IsNull() == false) {
+      // deleted or updated versions can only go away by recycling the slot
+      has_dead_versions_.store(true);
+      return false;
+    }
+
+    cid_t begin_cid = GetBeginCommitId(tuple_slot_id);
+    if (GetTransactionId(tuple_slot_id) != INITIAL_TXN_ID ||
+        begin_cid == MAX_CID) {
+      // in-flight insertion or modification
+      all_visible_checked_cid_.store(read_cid);
+      return false;
+    }
+
+    if (begin_cid > max_begin_cid) {
+      max_begin_cid = begin_cid;
+    }
+  }
+
+  all_visible_cid_.store(max_begin_cid);
+
+  // A slot was acquired while we were scanning
+  if (all_visible_generation_.load() != generation) {
+    all_visible_cid_.store(MAX_CID);
+    return false;
+  }
+
+  return max_begin_cid <= read_cid;
+}
+
 void TileGroupHeader::Sync() {
   // Sync the tile group data
   auto &storage_manager = storage::StorageManager::GetInstance();
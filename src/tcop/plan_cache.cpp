@@ -0,0 +1,375 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// plan_cache.cpp
+//
+// Identification: src/tcop/plan_cache.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <limits>
+
+#include <boost/algorithm/string.hpp>
+
+#include "tcop/plan_cache.h"
+#include "common/logger.h"
+#include "type/value_factory.h"
+
+// Number of normalized queries kept in the plan cache
+extern size_t peloton_plan_cache_size;
+
+namespace peloton {
+namespace tcop {
+
+namespace {
+
+//===--------------------------------------------------------------------===//
+// Query Tokens
+//===--------------------------------------------------------------------===//
+
+enum class TokenType { WORD, NUMBER, STRING, SYMBOL };
+
+struct Token {
+  TokenType type;
+  size_t begin;
+  size_t end;
+};
+
+// Split the query the way the SQL scanner does. Returns false for queries
+// that we do not want to normalize (comments, placeholders, odd literals)
+bool TokenizeQuery(const std::string &query, std::vector<Token> &tokens) {
+  size_t size = query.size();
+  size_t pos = 0;
+
+  while (pos < size) {
+    char c = query[pos];
+    char next = (pos + 1 < size) ? query[pos + 1] : '\0';
+    size_t begin = pos;
+
+    if (isspace(c)) {
+      pos++;
+      continue;
+    }
+
+    if (c == '\'' || c == '"') {
+      // The scanner has no escapes, a literal ends at the next quote
+      pos = query.find(c, pos + 1);
+      if (pos == std::string::npos ||
+          query.find('\n', begin) < pos) {
+        return false;
+      }
+      pos++;
+      tokens.push_back({c == '\'' ? TokenType::STRING : TokenType::WORD,
+                        begin, pos});
+    } else if (isdigit(c) || (c == '.' && isdigit(next))) {
+      while (pos < size && isdigit(query[pos])) pos++;
+      if (pos < size && query[pos] == '.') {
+        pos++;
+        while (pos < size && isdigit(query[pos])) pos++;
+      }
+      if (pos < size && (isalpha(query[pos]) || query[pos] == '_' ||
+                         query[pos] == '.')) {
+        return false;
+      }
+      tokens.push_back({TokenType::NUMBER, begin, pos});
+    } else if (isalpha(c)) {
+      while (pos < size && (isalnum(query[pos]) || query[pos] == '_')) pos++;
+      tokens.push_back({TokenType::WORD, begin, pos});
+    } else if (c == '$' || c == '?' || (c == '-' && next == '-') ||
+               (c == '/' && next == '*')) {
+      return false;
+    } else if ((c == '<' && (next == '>' || next == '=')) ||
+               ((c == '>' || c == '!') && next == '=')) {
+      pos += 2;
+      tokens.push_back({TokenType::SYMBOL, begin, pos});
+    } else {
+      pos++;
+      tokens.push_back({TokenType::SYMBOL, begin, pos});
+    }
+  }
+
+  return true;
+}
+
+std::string GetTokenText(const std::string &query, const Token &token) {
+  return query.substr(token.begin, token.end - token.begin);
+}
+
+bool IsComparison(const std::string &text) {
+  return text == "=" || text == "<" || text == ">" || text == "<=" ||
+         text == ">=" || text == "<>" || text == "!=";
+}
+
+bool IsArithmetic(const std::string &text) {
+  return text.size() == 1 && std::string("+-*/%^.(|").find(text) !=
+                                 std::string::npos;
+}
+
+// Build the value the parser would give the literal. Returns false for
+// integers that do not fit in an INTEGER
+bool GetLiteralValue(const std::string &query, const Token &token,
+                     type::Value &value) {
+  auto text = GetTokenText(query, token);
+  if (token.type == TokenType::STRING) {
+    value = type::ValueFactory::GetVarcharValue(
+        text.substr(1, text.size() - 2));
+  } else if (text.find('.') != std::string::npos) {
+    value = type::ValueFactory::GetDoubleValue(atof(text.c_str()));
+  } else {
+    auto integer = strtoll(text.c_str(), nullptr, 10);
+    if (integer > std::numeric_limits<int32_t>::max()) {
+      return false;
+    }
+    value = type::ValueFactory::GetIntegerValue((int32_t)integer);
+  }
+  return true;
+}
+
+bool IsLiteral(const Token &token) {
+  return token.type == TokenType::NUMBER || token.type == TokenType::STRING;
+}
+
+}  // namespace
+
+//===--------------------------------------------------------------------===//
+// Plan Cache
+//===--------------------------------------------------------------------===//
+
+PlanCache::PlanCache()
+    : cache_(peloton_plan_cache_size),
+      catalog_version_(0),
+      hit_count_(0),
+      miss_count_(0) {}
+
+PlanCache &PlanCache::GetInstance() {
+  static PlanCache plan_cache;
+  return plan_cache;
+}
+
+bool PlanCache::NormalizeQuery(const std::string &query,
+                               std::string &normalized_query,
+                               std::vector<type::Value> &params) {
+  std::vector<Token> tokens;
+  if (TokenizeQuery(query, tokens) == false || tokens.empty()) {
+    return false;
+  }
+
+  auto token_count = tokens.size();
+  auto is_word = [&](size_t idx, const char *word) {
+    return idx < token_count && tokens[idx].type == TokenType::WORD &&
+           boost::iequals(GetTokenText(query, tokens[idx]), word);
+  };
+  auto is_symbol = [&](size_t idx, const char *symbol) {
+    return idx < token_count && tokens[idx].type == TokenType::SYMBOL &&
+           GetTokenText(query, tokens[idx]) == symbol;
+  };
+
+  std::vector<size_t> literals;
+
+  if (is_word(0, "SELECT") || is_word(0, "UPDATE") || is_word(0, "DELETE")) {
+    // Only the right side of comparisons in the WHERE clause. The planner
+    // turns those into index keys or predicates that read the parameters
+    bool in_where = false;
+    for (size_t idx = 1; idx < token_count; idx++) {
+      if (is_word(idx, "WHERE")) {
+        in_where = true;
+      } else if (is_word(idx, "GROUP") || is_word(idx, "HAVING") ||
+                 is_word(idx, "ORDER") || is_word(idx, "LIMIT") ||
+                 is_word(idx, "OFFSET")) {
+        in_where = false;
+      }
+
+      if (in_where == false || IsLiteral(tokens[idx]) == false ||
+          IsComparison(GetTokenText(query, tokens[idx - 1])) == false) {
+        continue;
+      }
+      if (idx + 1 < token_count &&
+          IsArithmetic(GetTokenText(query, tokens[idx + 1]))) {
+        continue;
+      }
+      literals.push_back(idx);
+    }
+  } else if (is_word(0, "INSERT")) {
+    // A single tuple of plain literals, so that the parameter of a value is
+    // its position in the tuple
+    size_t idx = 1;
+    while (idx < token_count && is_word(idx, "VALUES") == false) idx++;
+    if (is_symbol(++idx, "(") == false) {
+      return false;
+    }
+    while (true) {
+      idx++;
+      if (idx >= token_count || IsLiteral(tokens[idx]) == false) {
+        return false;
+      }
+      literals.push_back(idx);
+      if (is_symbol(++idx, ")")) break;
+      if (is_symbol(idx, ",") == false) {
+        return false;
+      }
+    }
+    idx++;
+    if (is_symbol(idx, ";")) idx++;
+    if (idx != token_count) {
+      return false;
+    }
+  } else {
+    return false;
+  }
+
+  // Replace the literals by $1, $2, ...
+  normalized_query.clear();
+  params.clear();
+  size_t copied = 0;
+  for (auto idx : literals) {
+    type::Value value;
+    if (GetLiteralValue(query, tokens[idx], value) == false) {
+      if (is_word(0, "INSERT")) return false;
+      continue;
+    }
+    params.push_back(value);
+    normalized_query.append(query, copied, tokens[idx].begin - copied);
+    normalized_query.append("$" + std::to_string(params.size()));
+    copied = tokens[idx].end;
+  }
+  normalized_query.append(query, copied, std::string::npos);
+
+  return true;
+}
+
+bool PlanCache::Acquire(const std::string &normalized_query,
+                        uint64_t catalog_version,
+                        std::shared_ptr<Statement> &statement) {
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  statement.reset();
+
+  auto itr = cache_.find(normalized_query);
+  if (itr == cache_.end()) {
+    miss_count_++;
+    return true;
+  }
+
+  auto entry = *itr;
+  if (entry->catalog_version != catalog_version) {
+    // planned before the last DDL
+    cache_.delete_key(normalized_query);
+    miss_count_++;
+    return true;
+  }
+  if (entry->cacheable == false) {
+    return false;
+  }
+
+  if (entry->idle_statements.empty()) {
+    // every statement is executing, plan another one
+    miss_count_++;
+    return true;
+  }
+
+  statement = entry->idle_statements.back();
+  entry->idle_statements.pop_back();
+  hit_count_++;
+  return true;
+}
+
+void PlanCache::Release(const std::string &normalized_query,
+                        uint64_t catalog_version,
+                        const std::shared_ptr<Statement> &statement) {
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+
+  // invalidated while it was executing
+  if (statement->GetNeedsPlan() ||
+      catalog_version != catalog_version_.load()) {
+    return;
+  }
+
+  std::shared_ptr<PlanCacheEntry> entry;
+  auto itr = cache_.find(normalized_query);
+  if (itr != cache_.end() && (*itr)->catalog_version == catalog_version) {
+    entry = *itr;
+  } else {
+    entry.reset(new PlanCacheEntry());
+    entry->query = normalized_query;
+    entry->catalog_version = catalog_version;
+    entry->table_ids = statement->GetReferencedTables();
+    cache_.insert(std::make_pair(normalized_query, entry));
+  }
+
+  if (std::find(entry->statements.begin(), entry->statements.end(),
+                statement) == entry->statements.end()) {
+    if (entry->statements.size() >= MAX_STATEMENTS) {
+      return;
+    }
+    entry->statements.push_back(statement);
+  }
+  entry->idle_statements.push_back(statement);
+}
+
+void PlanCache::MarkUncacheable(const std::string &normalized_query,
+                                uint64_t catalog_version) {
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  LOG_TRACE("Query can not be planned after normalization: %s",
+            normalized_query.c_str());
+
+  std::shared_ptr<PlanCacheEntry> entry(new PlanCacheEntry());
+  entry->query = normalized_query;
+  entry->catalog_version = catalog_version;
+  entry->cacheable = false;
+  cache_.insert(std::make_pair(normalized_query, entry));
+}
+
+void PlanCache::InvalidateTable(oid_t table_id) {
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+
+  std::vector<std::string> invalid_queries;
+  for (auto itr = cache_.begin(); itr != cache_.end(); itr++) {
+    auto entry = *itr;
+    if (entry->table_ids.count(table_id) == 0) {
+      continue;
+    }
+    // statements that are executing are dropped when they are released
+    for (auto &statement : entry->statements) {
+      statement->SetNeedsPlan(true);
+    }
+    invalid_queries.push_back(entry->query);
+  }
+
+  for (auto &query : invalid_queries) {
+    LOG_DEBUG("Dropping cached plan of '%s'", query.c_str());
+    cache_.delete_key(query);
+  }
+}
+
+void PlanCache::Clear() {
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+
+  // Cache::clear also resets the capacity, so delete the keys instead
+  std::vector<std::string> queries;
+  for (auto itr = cache_.begin(); itr != cache_.end(); itr++) {
+    auto entry = *itr;
+    for (auto &statement : entry->statements) {
+      statement->SetNeedsPlan(true);
+    }
+    queries.push_back(entry->query);
+  }
+  for (auto &query : queries) {
+    cache_.delete_key(query);
+  }
+
+  hit_count_ = 0;
+  miss_count_ = 0;
+}
+
+size_t PlanCache::GetSize() {
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  return cache_.size();
+}
+
+}  // End tcop namespace
+}  // End peloton namespace
@@ -33,9 +33,13 @@
 #include "optimizer/simple_optimizer.h"
 
 #include "planner/plan_util.h"
+#include "tcop/plan_cache.h"
 
 #include <boost/algorithm/string.hpp>
 
+// Cache the plans of simple-protocol queries across connections
+extern bool peloton_plan_cache;
+
 namespace peloton {
 namespace tcop {
 
@@ -129,27 +133,67 @@ Result TrafficCop::AbortQueryHelper() {
   }
 }
 
+Result TrafficCop::BeginTransaction() { return BeginQueryHelper(); }
+
+Result TrafficCop::CommitTransaction() { return CommitQueryHelper(); }
+
+Result TrafficCop::AbortTransaction() { return AbortQueryHelper(); }
+
 Result TrafficCop::ExecuteStatement(
     const std::string &query, std::vector<ResultType> &result,
     std::vector<FieldInfoType> &tuple_descriptor, int &rows_changed,
     std::string &error_message) {
   LOG_TRACE("Received %s", query.c_str());
 
-  // Prepare the statement
   std::string unnamed_statement = "unnamed";
-  auto statement = PrepareStatement(unnamed_statement, query, error_message);
+  std::shared_ptr<Statement> statement;
+  std::vector<type::Value> params;
+
+  // Look up the plan of the query with its literals replaced by parameters
+  auto &plan_cache = PlanCache::GetInstance();
+  std::string normalized_query;
+  uint64_t catalog_version = plan_cache.GetCatalogVersion();
+  bool cached = peloton_plan_cache &&
+                PlanCache::NormalizeQuery(query, normalized_query, params) &&
+                plan_cache.Acquire(normalized_query, catalog_version,
+                                   statement);
+
+  if (cached && statement.get() == nullptr) {
+    std::string normalize_error;
+    statement = PrepareStatement(unnamed_statement, normalized_query,
+                                 normalize_error);
+    if (statement.get() == nullptr ||
+        statement->GetPlanTree().get() == nullptr) {
+      // plan the original query from now on
+      plan_cache.MarkUncacheable(normalized_query, catalog_version);
+      statement.reset();
+      cached = false;
+    }
+  }
+
+  if (cached == false) {
+    params.clear();
+    statement = PrepareStatement(unnamed_statement, query, error_message);
+  }
 
   if (statement.get() == nullptr) {
     return Result::RESULT_FAILURE;
   }
 
-  // Then, execute the statement
+  // Then, bind the literals and execute the statement
   bool unnamed = true;
   std::vector<int> result_format(statement->GetTupleDescriptor().size(), 0);
-  std::vector<type::Value> params;
-  auto status =
-      ExecuteStatement(statement, params, unnamed, nullptr, result_format,
-                       result, rows_changed, error_message);
+  auto status = Result::RESULT_FAILURE;
+  try {
+    if (params.size() > 0) {
+      statement->GetPlanTree()->SetParameterValues(&params);
+    }
+    status = ExecuteStatement(statement, params, unnamed, nullptr,
+                              result_format, result, rows_changed,
+                              error_message);
+  } catch (Exception &e) {
+    error_message = e.what();
+  }
 
   if (status == Result::RESULT_SUCCESS) {
     LOG_TRACE("Execution succeeded!");
@@ -158,6 +202,14 @@ Result TrafficCop::ExecuteStatement(
     LOG_TRACE("Execution failed!");
   }
 
+  if (cached) {
+    plan_cache.Release(normalized_query, catalog_version, statement);
+  } else if (boost::iequals(statement->GetQueryType(), "CREATE") ||
+             boost::iequals(statement->GetQueryType(), "DROP") ||
+             boost::iequals(statement->GetQueryType(), "ALTER")) {
+    plan_cache.BumpCatalogVersion();
+  }
+
   return status;
 }
 
@@ -187,7 +239,8 @@ Result TrafficCop::ExecuteStatement(
       return AbortQueryHelper();
     else {
       auto status = ExecuteStatementPlan(statement->GetPlanTree().get(), params,
-                                         result, result_format);
+                                         result, result_format,
+                                         statement.get());
       LOG_TRACE("Statement executed. Result: %d", status.m_result);
       rows_changed = status.m_processed;
       return status.m_result;
@@ -200,7 +253,8 @@ Result TrafficCop::ExecuteStatement(
 
 bridge::peloton_status TrafficCop::ExecuteStatementPlan(
     const planner::AbstractPlan *plan, const std::vector<type::Value> &params,
-    std::vector<ResultType> &result, const std::vector<int> &result_format) {
+    std::vector<ResultType> &result, const std::vector<int> &result_format,
+    Statement *statement) {
   concurrency::Transaction *txn;
   bool single_statement_txn = false, init_failure = false;
   bridge::peloton_status p_status;
@@ -221,8 +275,13 @@ bridge::peloton_status TrafficCop::ExecuteStatementPlan(
   // skip if already aborted
   if (curr_state.second != Result::RESULT_ABORTED) {
     PL_ASSERT(txn);
-    p_status = bridge::PlanExecutor::ExecutePlan(plan, txn, params, result,
-                                                 result_format);
+    if (statement != nullptr && statement->GetPlanTree().get() == plan) {
+      p_status = bridge::PlanExecutor::ExecutePlan(statement, txn, params,
+                                                   result, result_format);
+    } else {
+      p_status = bridge::PlanExecutor::ExecutePlan(plan, txn, params, result,
+                                                   result_format);
+    }
 
     if (p_status.m_result == Result::RESULT_FAILURE) {
       // only possible if init failed
@@ -273,23 +332,7 @@ std::shared_ptr<Statement> TrafficCop::PrepareStatement(
     if (sql_stmt->is_valid == false) {
       throw ParserException("Error parsing SQL statement");
     }
-    auto plan = optimizer_->BuildPelotonPlanTree(sql_stmt);
-    statement->SetPlanTree(plan);
-
-    // Get the tables that our plan references so that we know how to
-    // invalidate it at a later point when the catalog changes
-    const std::set<oid_t> table_oids =
-        planner::PlanUtil::GetTablesReferenced(plan.get());
-    statement->SetReferencedTables(table_oids);
-
-    for (auto stmt : sql_stmt->GetStatements()) {
-      LOG_TRACE("SQLStatement: %s", stmt->GetInfo().c_str());
-      if (stmt->GetType() == STATEMENT_TYPE_SELECT) {
-        auto tuple_descriptor = GenerateTupleDescriptor(stmt);
-        statement->SetTupleDescriptor(tuple_descriptor);
-      }
-      break;
-    }
+    PlanStatement(sql_stmt, statement.get());
 
 #ifdef LOG_DEBUG_ENABLED
     if (statement->GetPlanTree().get() != nullptr) {
@@ -304,6 +347,109 @@ std::shared_ptr<Statement> TrafficCop::PrepareStatement(
   }
 }
 
+bool TrafficCop::PrepareStatementList(
+    const std::string &query_string,
+    const std::vector<std::string> &statement_queries,
+    std::vector<std::shared_ptr<Statement>> &statements,
+    std::string &error_message) {
+  LOG_DEBUG("Prepare %lu statements", statement_queries.size());
+
+  try {
+    auto &peloton_parser = parser::Parser::GetInstance();
+    auto sql_stmt_list = peloton_parser.BuildParseTree(query_string);
+    if (sql_stmt_list->is_valid == false) {
+      throw ParserException("Error parsing SQL statement");
+    }
+    if (sql_stmt_list->GetNumStatements() != statement_queries.size()) {
+      error_message = "Statements do not match the query texts";
+      return false;
+    }
+
+    for (size_t stmt_itr = 0; stmt_itr < statement_queries.size();
+         stmt_itr++) {
+      // Move the parsed statement into a list of its own for the optimizer
+      std::unique_ptr<parser::SQLStatementList> sql_stmt(
+          new parser::SQLStatementList(sql_stmt_list->statements[stmt_itr]));
+      sql_stmt_list->statements[stmt_itr] = nullptr;
+
+      std::shared_ptr<Statement> statement(
+          new Statement("unnamed", statement_queries[stmt_itr]));
+      PlanStatement(sql_stmt, statement.get());
+      statements.push_back(std::move(statement));
+    }
+    return true;
+  } catch (Exception &e) {
+    error_message = e.what();
+    statements.clear();
+    return false;
+  }
+}
+
+void TrafficCop::PlanStatement(
+    const std::unique_ptr<parser::SQLStatementList> &sql_stmt,
+    Statement *statement) {
+  auto plan = optimizer_->BuildPelotonPlanTree(sql_stmt);
+  statement->SetPlanTree(plan);
+
+  // Get the tables that our plan references so that we know how to
+  // invalidate it at a later point when the catalog changes
+  const std::set<oid_t> table_oids =
+      planner::PlanUtil::GetTablesReferenced(plan.get());
+  statement->SetReferencedTables(table_oids);
+
+  for (auto stmt : sql_stmt->GetStatements()) {
+    LOG_TRACE("SQLStatement: %s", stmt->GetInfo().c_str());
+    if (stmt->GetType() == STATEMENT_TYPE_SELECT) {
+      auto tuple_descriptor = GenerateTupleDescriptor(stmt);
+      statement->SetTupleDescriptor(tuple_descriptor);
+    }
+    break;
+  }
+}
+
+Result TrafficCop::ExecuteStatementList(
+    const std::vector<std::shared_ptr<Statement>> &statements,
+    std::vector<std::vector<ResultType>> &results,
+    std::vector<int> &rows_changed, std::string &error_message) {
+  auto status = BeginQueryHelper();
+  if (status != Result::RESULT_SUCCESS) {
+    error_message = "Failed to begin the transaction";
+    return status;
+  }
+
+  std::vector<type::Value> params;
+  for (auto &statement : statements) {
+    std::vector<int> result_format(statement->GetTupleDescriptor().size(), 0);
+    std::vector<ResultType> result;
+    int rows = 0;
+    try {
+      status = ExecuteStatement(statement, params, true, nullptr,
+                                result_format, result, rows, error_message);
+    } catch (Exception &e) {
+      error_message = e.what();
+      status = Result::RESULT_FAILURE;
+    }
+
+    if (status != Result::RESULT_SUCCESS) {
+      // The statements before it are rolled back with it
+      AbortQueryHelper();
+      if (error_message.empty()) {
+        error_message = "Transaction aborted";
+      }
+      return Result::RESULT_FAILURE;
+    }
+    results.push_back(std::move(result));
+    rows_changed.push_back(rows);
+  }
+
+  status = CommitQueryHelper();
+  if (status != Result::RESULT_SUCCESS) {
+    error_message = "Failed to commit the transaction";
+    return Result::RESULT_FAILURE;
+  }
+  return status;
+}
+
 std::vector<FieldInfoType> TrafficCop::GenerateTupleDescriptor(
     parser::SQLStatement *sql_stmt) {
   std::vector<FieldInfoType> tuple_descriptor;
@@ -395,8 +541,15 @@ std::vector<FieldInfoType> TrafficCop::GenerateTupleDescriptor(
 FieldInfoType TrafficCop::GetColumnFieldForValueType(
     std::string column_name, type::Type::TypeId column_type) {
   switch (column_type) {
+    case type::Type::BOOLEAN:
+      return std::make_tuple(column_name, POSTGRES_VALUE_TYPE_BOOLEAN, 1);
+    case type::Type::TINYINT:
+    case type::Type::SMALLINT:
+      return std::make_tuple(column_name, POSTGRES_VALUE_TYPE_SMALLINT, 2);
     case type::Type::INTEGER:
       return std::make_tuple(column_name, POSTGRES_VALUE_TYPE_INTEGER, 4);
+    case type::Type::BIGINT:
+      return std::make_tuple(column_name, POSTGRES_VALUE_TYPE_BIGINT, 8);
     case type::Type::DECIMAL:
       return std::make_tuple(column_name, POSTGRES_VALUE_TYPE_DOUBLE, 8);
     case type::Type::VARCHAR:
@@ -786,6 +786,9 @@ std::string IndexTypeToString(IndexType type) {
     case INDEX_TYPE_HASH: {
       return "HASH";
     }
+    case INDEX_TYPE_ART: {
+      return "ART";
+    }
     default: {
       throw ConversionException(
           StringUtil::Format("No string conversion for IndexType value '%d'",
@@ -802,6 +805,8 @@ IndexType StringToIndexType(const std::string& str) {
     return INDEX_TYPE_BWTREE;
   } else if (str == "HASH") {
     return INDEX_TYPE_HASH;
+  } else if (str == "ART") {
+    return INDEX_TYPE_ART;
   } else {
     throw ConversionException(StringUtil::Format(
         "No IndexType conversion from string '%s'", str.c_str()));
@@ -1357,6 +1362,12 @@ std::string LogRecordTypeToString(LogRecordType type) {
     case LOGRECORD_TYPE_WAL_TUPLE_UPDATE: {
       return "WAL_TUPLE_UPDATE";
     }
+    case LOGRECORD_TYPE_WAL_TUPLE_BATCH: {
+      return "WAL_TUPLE_BATCH";
+    }
+    case LOGRECORD_TYPE_WAL_COMPRESSED_BLOCK: {
+      return "WAL_COMPRESSED_BLOCK";
+    }
     case LOGRECORD_TYPE_WBL_TUPLE_INSERT: {
       return "WBL_TUPLE_INSERT";
     }
@@ -1369,6 +1380,9 @@ std::string LogRecordTypeToString(LogRecordType type) {
     case LOGRECORD_TYPE_ITERATION_DELIMITER: {
       return "ITERATION_DELIMITER";
     }
+    case LOGRECORD_TYPE_COMPACT_ITERATION_DELIMITER: {
+      return "COMPACT_ITERATION_DELIMITER";
+    }
     default: {
       throw ConversionException(StringUtil::Format(
           "No string conversion for LogRecordType value '%d'",
@@ -1403,6 +1417,10 @@ LogRecordType StringToLogRecordType(const std::string& str) {
     return LOGRECORD_TYPE_WAL_TUPLE_DELETE;
   } else if (str == "WAL_TUPLE_UPDATE") {
     return LOGRECORD_TYPE_WAL_TUPLE_UPDATE;
+  } else if (str == "WAL_TUPLE_BATCH") {
+    return LOGRECORD_TYPE_WAL_TUPLE_BATCH;
+  } else if (str == "WAL_COMPRESSED_BLOCK") {
+    return LOGRECORD_TYPE_WAL_COMPRESSED_BLOCK;
   } else if (str == "WBL_TUPLE_INSERT") {
     return LOGRECORD_TYPE_WBL_TUPLE_INSERT;
   } else if (str == "WBL_TUPLE_DELETE") {
@@ -1411,6 +1429,8 @@ LogRecordType StringToLogRecordType(const std::string& str) {
     return LOGRECORD_TYPE_WBL_TUPLE_UPDATE;
   } else if (str == "ITERATION_DELIMITER") {
     return LOGRECORD_TYPE_ITERATION_DELIMITER;
+  } else if (str == "COMPACT_ITERATION_DELIMITER") {
+    return LOGRECORD_TYPE_COMPACT_ITERATION_DELIMITER;
   } else {
     throw ConversionException(StringUtil::Format(
         "No LogRecordType conversion from string '%s'", str.c_str()));
@@ -1509,6 +1529,8 @@ std::string SqlStateErrorCodeToString(SqlStateErrorCode code) {
   switch (code) {
     case SERIALIZATION_ERROR:
       return "40001";
+    case READ_ONLY_SQL_TRANSACTION:
+      return "25006";
     default:
       return "INVALID";
   }
@@ -0,0 +1,706 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// copy_loader.cpp
+//
+// Identification: src/wire/copy_loader.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#include "wire/copy_loader.h"
+
+#include "catalog/schema.h"
+#include "common/exception.h"
+#include "common/logger.h"
+#include "common/macros.h"
+#include "planner/insert_plan.h"
+#include "storage/data_table.h"
+#include "storage/tuple.h"
+#include "tcop/tcop.h"
+#include "type/value_factory.h"
+
+// Commit every tile group chunk of a COPY outside a transaction block on its
+// own, instead of loading the whole COPY in one transaction
+extern bool peloton_copy_chunk_commit;
+
+namespace peloton {
+namespace wire {
+
+namespace {
+
+// Signature at the start of the binary COPY format
+const char BINARY_SIGNATURE[] = "PGCOPY\n\377\r\n";
+const size_t BINARY_SIGNATURE_SIZE = 11;
+
+// Signature, flags and the length of the header extension
+const size_t BINARY_HEADER_SIZE = BINARY_SIGNATURE_SIZE + 8;
+
+template <typename T>
+T ReadBigEndian(const char *data) {
+  unsigned char bytes[sizeof(T)];
+  for (size_t i = 0; i < sizeof(T); i++) {
+    bytes[i] = data[sizeof(T) - 1 - i];
+  }
+  T value;
+  PL_MEMCPY(&value, bytes, sizeof(T));
+  return value;
+}
+
+// Date of the Gregorian calendar that is the given number of days after
+// 1970-01-01
+void CivilFromDays(int64_t days, int64_t &year, int64_t &month,
+                   int64_t &day) {
+  days += 719468;
+  int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+  int64_t day_of_era = days - era * 146097;
+  int64_t year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 -
+                         day_of_era / 146096) / 365;
+  int64_t day_of_year =
+      day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+  int64_t month_index = (5 * day_of_year + 2) / 153;
+  day = day_of_year - (153 * month_index + 2) / 5 + 1;
+  month = month_index < 10 ? month_index + 3 : month_index - 9;
+  year = year_of_era + era * 400 + (month <= 2);
+}
+
+// Timestamp of the microseconds since 2000-01-01 that Postgres sends in
+// binary format. See TimestampType::ToString for the layout
+bool GetPelotonTimestamp(int64_t timestamp, uint64_t &peloton_timestamp) {
+  const int64_t micros_per_day = 86400LL * 1000000;
+  // days between 1970-01-01 and 2000-01-01
+  const int64_t epoch_offset = 10957;
+
+  int64_t days = timestamp / micros_per_day;
+  int64_t micros_of_day = timestamp % micros_per_day;
+  if (micros_of_day < 0) {
+    micros_of_day += micros_per_day;
+    days--;
+  }
+
+  int64_t year, month, day;
+  CivilFromDays(days + epoch_offset, year, month, day);
+  if (year < 0 || year > 9999) {
+    return false;
+  }
+
+  // in UTC, the time zone is stored shifted by 12
+  peloton_timestamp = ((month * 32 + day) * 27 + 12) * 10000 + year;
+  peloton_timestamp = peloton_timestamp * 100000 + micros_of_day / 1000000;
+  peloton_timestamp = peloton_timestamp * 1000000 + micros_of_day % 1000000;
+  return true;
+}
+
+// Build an integer of the column type. Returns false if it does not fit
+bool GetIntegerValue(int64_t integer, type::Type::TypeId type_id,
+                     type::Value &value) {
+  switch (type_id) {
+    case type::Type::TINYINT:
+      if (integer < std::numeric_limits<int8_t>::min() ||
+          integer > std::numeric_limits<int8_t>::max()) {
+        return false;
+      }
+      value = type::ValueFactory::GetTinyIntValue((int8_t)integer);
+      return true;
+    case type::Type::SMALLINT:
+      if (integer < std::numeric_limits<int16_t>::min() ||
+          integer > std::numeric_limits<int16_t>::max()) {
+        return false;
+      }
+      value = type::ValueFactory::GetSmallIntValue((int16_t)integer);
+      return true;
+    case type::Type::INTEGER:
+      if (integer < std::numeric_limits<int32_t>::min() ||
+          integer > std::numeric_limits<int32_t>::max()) {
+        return false;
+      }
+      value = type::ValueFactory::GetIntegerValue((int32_t)integer);
+      return true;
+    default:
+      value = type::ValueFactory::GetBigIntValue(integer);
+      return true;
+  }
+}
+
+int GetHexDigit(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+}  // namespace
+
+//===--------------------------------------------------------------------===//
+// Copy Loader
+//===--------------------------------------------------------------------===//
+
+CopyLoader::CopyLoader(storage::DataTable *table, CopyType copy_type,
+                       char delimiter, tcop::TrafficCop *traffic_cop)
+    : table_(table),
+      copy_type_(copy_type),
+      delimiter_(delimiter),
+      traffic_cop_(traffic_cop),
+      chunk_size_(table->GetTuplesPerTileGroup()),
+      chunk_plan_(new planner::InsertPlan(table, 0)) {
+  auto schema = table->GetSchema();
+  for (oid_t column_itr = 0; column_itr < schema->GetColumnCount();
+       column_itr++) {
+    column_types_.push_back(schema->GetType(column_itr));
+  }
+
+  if (chunk_size_ == 0) {
+    chunk_size_ = DEFAULT_TUPLES_PER_TILEGROUP;
+  }
+}
+
+CopyLoader::~CopyLoader() {
+  // The COPY was cancelled before its end
+  if (owns_txn_) {
+    traffic_cop_->AbortTransaction();
+  }
+}
+
+bool CopyLoader::SetError(const std::string &error_message) {
+  LOG_TRACE("COPY failed: %s", error_message.c_str());
+  error_message_ = error_message;
+  if (owns_txn_) {
+    owns_txn_ = false;
+    traffic_cop_->AbortTransaction();
+  }
+  return false;
+}
+
+bool CopyLoader::Consume(const char *data, size_t len) {
+  if (error_message_.empty() == false) {
+    return false;
+  }
+  // the rest of the data after the end marker is ignored
+  if (data_done_) {
+    return true;
+  }
+
+  // Continue the row that the last message did not finish
+  if (pending_.empty() == false) {
+    pending_.append(data, len);
+    data = pending_.data();
+    len = pending_.size();
+  }
+
+  size_t consumed = 0;
+  bool status;
+  try {
+    switch (copy_type_) {
+      case COPY_TYPE_IMPORT_BINARY:
+        status = ParseBinary(data, len, consumed);
+        break;
+      case COPY_TYPE_IMPORT_CSV:
+        status = ParseCSV(data, len, consumed);
+        break;
+      default:
+        status = ParseText(data, len, consumed);
+        break;
+    }
+  } catch (Exception &e) {
+    return SetError(e.what());
+  }
+
+  if (status == false) {
+    return false;
+  }
+
+  if (data_done_) {
+    consumed = len;
+  }
+
+  // data may point into pending_
+  std::string rest(data + consumed, len - consumed);
+  pending_.swap(rest);
+  return true;
+}
+
+bool CopyLoader::Finish() {
+  if (error_message_.empty() == false) {
+    return false;
+  }
+  if (pending_.empty() == false) {
+    // a text row may miss its last newline
+    if (copy_type_ != COPY_TYPE_IMPORT_BINARY && data_done_ == false) {
+      std::string last_row("\n");
+      if (Consume(last_row.data(), last_row.size()) == false) {
+        return false;
+      }
+    }
+    if (pending_.empty() == false) {
+      return SetError("COPY data ends in the middle of a row");
+    }
+  }
+
+  try {
+    if (LoadChunk() == false) {
+      return false;
+    }
+  } catch (Exception &e) {
+    return SetError(e.what());
+  }
+
+  if (owns_txn_) {
+    owns_txn_ = false;
+    if (traffic_cop_->CommitTransaction() != Result::RESULT_SUCCESS) {
+      row_count_ = 0;
+      return SetError("COPY failed to commit");
+    }
+  }
+  return true;
+}
+
+bool CopyLoader::ParseText(const char *data, size_t len, size_t &consumed) {
+  size_t pos = 0;
+  while (data_done_ == false) {
+    auto line_end =
+        static_cast<const char *>(std::memchr(data + pos, '\n', len - pos));
+    if (line_end == nullptr) {
+      break;
+    }
+    size_t end = line_end - data;
+    // a carriage return in the data is escaped
+    size_t line_len = end - pos;
+    if (line_len > 0 && data[end - 1] == '\r') {
+      line_len--;
+    }
+
+    if (line_len == 2 && data[pos] == '\\' && data[pos + 1] == '.') {
+      data_done_ = true;
+      break;
+    }
+
+    fields_.clear();
+    null_fields_.clear();
+    std::string field;
+    size_t field_begin = pos;
+    size_t line_end_pos = pos + line_len;
+    for (size_t i = pos; i <= line_end_pos; i++) {
+      if (i == line_end_pos || data[i] == delimiter_) {
+        // an unescaped \N is a NULL
+        bool is_null = (i - field_begin == 2 && data[field_begin] == '\\' &&
+                        data[field_begin + 1] == 'N');
+        fields_.push_back(std::move(field));
+        null_fields_.push_back(is_null);
+        field.clear();
+        field_begin = i + 1;
+        continue;
+      }
+
+      char c = data[i];
+      if (c != '\\' || i + 1 == line_end_pos) {
+        field.push_back(c);
+        continue;
+      }
+
+      c = data[++i];
+      switch (c) {
+        case 'b':
+          field.push_back('\b');
+          break;
+        case 'f':
+          field.push_back('\f');
+          break;
+        case 'n':
+          field.push_back('\n');
+          break;
+        case 'r':
+          field.push_back('\r');
+          break;
+        case 't':
+          field.push_back('\t');
+          break;
+        case 'v':
+          field.push_back('\v');
+          break;
+        case 'x': {
+          // one or two hex digits
+          int byte = 0, digits = 0;
+          while (digits < 2 && i + 1 < line_end_pos &&
+                 GetHexDigit(data[i + 1]) >= 0) {
+            byte = byte * 16 + GetHexDigit(data[++i]);
+            digits++;
+          }
+          field.push_back(digits == 0 ? 'x' : (char)byte);
+        } break;
+        default:
+          if (c >= '0' && c <= '7') {
+            // up to three octal digits
+            int byte = c - '0', digits = 1;
+            while (digits < 3 && i + 1 < line_end_pos && data[i + 1] >= '0' &&
+                   data[i + 1] <= '7') {
+              byte = byte * 8 + (data[++i] - '0');
+              digits++;
+            }
+            field.push_back((char)byte);
+          } else {
+            field.push_back(c);
+          }
+          break;
+      }
+    }
+
+    if (AddTextRow() == false) {
+      return false;
+    }
+    pos = end + 1;
+    consumed = pos;
+  }
+  return true;
+}
+
+bool CopyLoader::ParseCSV(const char *data, size_t len, size_t &consumed) {
+  size_t pos = 0;
+  while (data_done_ == false && pos < len) {
+    // end of data marker
+    if (len - pos >= 3 && data[pos] == '\\' && data[pos + 1] == '.' &&
+        (data[pos + 2] == '\n' ||
+         (data[pos + 2] == '\r' && len - pos >= 4 && data[pos + 3] == '\n'))) {
+      data_done_ = true;
+      break;
+    }
+
+    // A row that is not complete is parsed again with the next message
+    fields_.clear();
+    null_fields_.clear();
+    std::string field;
+    bool quoted = false, in_quotes = false, row_done = false;
+    size_t i = pos;
+    for (; i < len; i++) {
+      char c = data[i];
+      if (in_quotes) {
+        if (c != '"') {
+          field.push_back(c);
+        } else if (i + 1 < len && data[i + 1] == '"') {
+          field.push_back('"');
+          i++;
+        } else {
+          in_quotes = false;
+        }
+      } else if (c == '"') {
+        in_quotes = true;
+        quoted = true;
+      } else if (c == '\r' && i + 1 < len && data[i + 1] == '\n') {
+        continue;
+      } else if (c == delimiter_ || c == '\n') {
+        // only an unquoted empty field is NULL
+        null_fields_.push_back(quoted == false && field.empty());
+        fields_.push_back(std::move(field));
+        field.clear();
+        quoted = false;
+        if (c == '\n') {
+          row_done = true;
+          break;
+        }
+      } else {
+        field.push_back(c);
+      }
+    }
+
+    if (row_done == false) {
+      break;
+    }
+    if (AddTextRow() == false) {
+      return false;
+    }
+    pos = i + 1;
+    consumed = pos;
+  }
+  return true;
+}
+
+bool CopyLoader::ParseBinary(const char *data, size_t len, size_t &consumed) {
+  size_t pos = 0;
+  if (header_done_ == false) {
+    if (len < BINARY_HEADER_SIZE) {
+      return true;
+    }
+    if (std::memcmp(data, BINARY_SIGNATURE, BINARY_SIGNATURE_SIZE) != 0) {
+      return SetError("COPY file signature not recognized");
+    }
+    auto extension_len =
+        ReadBigEndian<int32_t>(data + BINARY_SIGNATURE_SIZE + 4);
+    if (extension_len < 0) {
+      return SetError("Invalid COPY file header");
+    }
+    if (len < BINARY_HEADER_SIZE + extension_len) {
+      return true;
+    }
+    pos = BINARY_HEADER_SIZE + extension_len;
+    header_done_ = true;
+    consumed = pos;
+  }
+
+  auto column_count = column_types_.size();
+  while (data_done_ == false && len - pos >= 2) {
+    auto field_count = ReadBigEndian<int16_t>(data + pos);
+    if (field_count == -1) {
+      // file trailer
+      data_done_ = true;
+      break;
+    }
+    if (field_count != (int16_t)column_count) {
+      return SetError("Row has " + std::to_string(field_count) +
+                      " fields, expected " + std::to_string(column_count));
+    }
+
+    // Wait for the rest of the row
+    size_t row_end = pos + 2;
+    bool row_done = true;
+    for (size_t field_itr = 0; field_itr < column_count; field_itr++) {
+      if (len - row_end < 4) {
+        row_done = false;
+        break;
+      }
+      auto field_len = ReadBigEndian<int32_t>(data + row_end);
+      row_end += 4;
+      if (field_len < -1) {
+        return SetError("Invalid field length in COPY data");
+      }
+      if (field_len > 0 && len - row_end < (size_t)field_len) {
+        row_done = false;
+        break;
+      }
+      row_end += std::max(field_len, 0);
+    }
+    if (row_done == false) {
+      break;
+    }
+
+    std::unique_ptr<storage::Tuple> tuple(
+        new storage::Tuple(table_->GetSchema(), true));
+    auto pool = chunk_plan_->GetPlanPool();
+    size_t field_pos = pos + 2;
+    for (size_t field_itr = 0; field_itr < column_count; field_itr++) {
+      auto field_len = ReadBigEndian<int32_t>(data + field_pos);
+      auto type_id = column_types_[field_itr];
+      field_pos += 4;
+
+      type::Value value;
+      if (field_len == -1) {
+        value = type::ValueFactory::GetNullValueByType(type_id);
+      } else if (GetBinaryValue(data + field_pos, field_len, type_id, value) ==
+                 false) {
+        return false;
+      }
+      tuple->SetValue(field_itr, value, pool);
+      field_pos += std::max(field_len, 0);
+    }
+
+    chunk_plan_->AddTuple(std::move(tuple));
+    if (chunk_plan_->GetBulkInsertCount() >= chunk_size_ &&
+        LoadChunk() == false) {
+      return false;
+    }
+    pos = row_end;
+    consumed = pos;
+  }
+  return true;
+}
+
+bool CopyLoader::AddTextRow() {
+  auto column_count = column_types_.size();
+  if (fields_.size() != column_count) {
+    return SetError("Row has " + std::to_string(fields_.size()) +
+                    " fields, expected " + std::to_string(column_count));
+  }
+
+  std::unique_ptr<storage::Tuple> tuple(
+      new storage::Tuple(table_->GetSchema(), true));
+  auto pool = chunk_plan_->GetPlanPool();
+  for (size_t field_itr = 0; field_itr < column_count; field_itr++) {
+    type::Value value;
+    if (null_fields_[field_itr]) {
+      value = type::ValueFactory::GetNullValueByType(column_types_[field_itr]);
+    } else if (GetTextValue(fields_[field_itr], column_types_[field_itr],
+                            value) == false) {
+      return false;
+    }
+    tuple->SetValue(field_itr, value, pool);
+  }
+
+  chunk_plan_->AddTuple(std::move(tuple));
+  if (chunk_plan_->GetBulkInsertCount() >= chunk_size_) {
+    return LoadChunk();
+  }
+  return true;
+}
+
+bool CopyLoader::GetTextValue(const std::string &field,
+                              type::Type::TypeId type_id, type::Value &value) {
+  switch (type_id) {
+    case type::Type::BOOLEAN: {
+      std::string str(field);
+      std::transform(str.begin(), str.end(), str.begin(), ::tolower);
+      if (str == "t" || str == "true" || str == "y" || str == "yes" ||
+          str == "on" || str == "1") {
+        value = type::ValueFactory::GetBooleanValue(true);
+      } else if (str == "f" || str == "false" || str == "n" || str == "no" ||
+                 str == "off" || str == "0") {
+        value = type::ValueFactory::GetBooleanValue(false);
+      } else {
+        return SetError("Invalid boolean: " + field);
+      }
+    } break;
+    case type::Type::TINYINT:
+    case type::Type::SMALLINT:
+    case type::Type::INTEGER:
+    case type::Type::BIGINT: {
+      char *end = nullptr;
+      errno = 0;
+      long long integer = strtoll(field.c_str(), &end, 10);
+      if (field.empty() || *end != '\0' || errno == ERANGE ||
+          GetIntegerValue(integer, type_id, value) == false) {
+        return SetError("Invalid integer: " + field);
+      }
+    } break;
+    case type::Type::DECIMAL: {
+      char *end = nullptr;
+      double decimal = strtod(field.c_str(), &end);
+      if (field.empty() || *end != '\0') {
+        return SetError("Invalid decimal: " + field);
+      }
+      value = type::ValueFactory::GetDoubleValue(decimal);
+    } break;
+    case type::Type::TIMESTAMP:
+      value = type::ValueFactory::CastAsTimestamp(
+          type::ValueFactory::GetVarcharValue(field));
+      break;
+    case type::Type::VARCHAR:
+      value = type::ValueFactory::GetVarcharValue(field);
+      break;
+    case type::Type::VARBINARY: {
+      if (field.size() < 2 || field[0] != '\\' || field[1] != 'x') {
+        value = type::ValueFactory::GetVarbinaryValue(field);
+        break;
+      }
+      // hex format of bytea
+      std::string bytes;
+      for (size_t i = 2; i + 1 < field.size(); i += 2) {
+        int high = GetHexDigit(field[i]), low = GetHexDigit(field[i + 1]);
+        if (high < 0 || low < 0) {
+          return SetError("Invalid hex data: " + field);
+        }
+        bytes.push_back((char)(high * 16 + low));
+      }
+      value = type::ValueFactory::GetVarbinaryValue(bytes);
+    } break;
+    default:
+      return SetError("COPY does not support columns of type " +
+                      type::Type::GetInstance(type_id)->ToString());
+  }
+  return true;
+}
+
+bool CopyLoader::GetBinaryValue(const char *data, int32_t len,
+                                type::Type::TypeId type_id,
+                                type::Value &value) {
+  switch (type_id) {
+    case type::Type::BOOLEAN:
+      if (len != 1) break;
+      value = type::ValueFactory::GetBooleanValue(data[0] != 0);
+      return true;
+    case type::Type::TINYINT:
+    case type::Type::SMALLINT:
+    case type::Type::INTEGER:
+    case type::Type::BIGINT: {
+      // whatever integer type the client has
+      int64_t integer;
+      if (len == 1) {
+        integer = (int8_t)data[0];
+      } else if (len == 2) {
+        integer = ReadBigEndian<int16_t>(data);
+      } else if (len == 4) {
+        integer = ReadBigEndian<int32_t>(data);
+      } else if (len == 8) {
+        integer = ReadBigEndian<int64_t>(data);
+      } else {
+        break;
+      }
+      if (GetIntegerValue(integer, type_id, value) == false) {
+        return SetError("Integer out of range: " + std::to_string(integer));
+      }
+      return true;
+    }
+    case type::Type::DECIMAL:
+      if (len == 8) {
+        value = type::ValueFactory::GetDoubleValue(ReadBigEndian<double>(data));
+      } else if (len == 4) {
+        value = type::ValueFactory::GetDoubleValue(ReadBigEndian<float>(data));
+      } else {
+        break;
+      }
+      return true;
+    case type::Type::TIMESTAMP: {
+      uint64_t timestamp;
+      if (len != 8) break;
+      if (GetPelotonTimestamp(ReadBigEndian<int64_t>(data), timestamp) ==
+          false) {
+        return SetError("Timestamp out of range");
+      }
+      value = type::ValueFactory::GetTimestampValue(timestamp);
+      return true;
+    }
+    case type::Type::VARCHAR:
+      value = type::ValueFactory::GetVarcharValue(std::string(data, len));
+      return true;
+    case type::Type::VARBINARY:
+      value = type::ValueFactory::GetVarbinaryValue(
+          reinterpret_cast<const unsigned char *>(data), len, true);
+      return true;
+    default:
+      return SetError("COPY does not support columns of type " +
+                      type::Type::GetInstance(type_id)->ToString());
+  }
+
+  return SetError("Invalid length " + std::to_string(len) + " of a " +
+                  type::Type::GetInstance(type_id)->ToString() + " field");
+}
+
+bool CopyLoader::LoadChunk() {
+  auto tuple_count = chunk_plan_->GetBulkInsertCount();
+  if (tuple_count == 0) {
+    return true;
+  }
+
+  // The chunks share the transaction of the COPY, unless each one is asked
+  // to be a transaction of its own. Within a block they use the block's
+  if (peloton_copy_chunk_commit == false && owns_txn_ == false &&
+      traffic_cop_->HasActiveTransaction() == false) {
+    if (traffic_cop_->BeginTransaction() != Result::RESULT_SUCCESS) {
+      return SetError("COPY failed to begin a transaction");
+    }
+    owns_txn_ = true;
+  }
+
+  std::vector<type::Value> params;
+  std::vector<ResultType> result;
+  std::vector<int> result_format;
+  auto status = traffic_cop_->ExecuteStatementPlan(chunk_plan_.get(), params,
+                                                   result, result_format);
+  if (status.m_result != Result::RESULT_SUCCESS) {
+    return SetError("COPY failed to insert rows " +
+                    std::to_string(row_count_ + 1) + " to " +
+                    std::to_string(row_count_ + tuple_count));
+  }
+  LOG_TRACE("COPY loaded %u rows", tuple_count);
+
+  row_count_ += tuple_count;
+  chunk_plan_.reset(new planner::InsertPlan(table_, 0));
+  return true;
+}
+
+}  // End wire namespace
+}  // End peloton namespace
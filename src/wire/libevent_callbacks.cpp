@@ -12,9 +12,15 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <errno.h>
 #include <unistd.h>
 #include "wire/libevent_server.h"
+#include "wire/transaction_worker_pool.h"
 #include "common/macros.h"
+#include "logging/log_manager.h"
+
+// Suspend connections instead of their thread while their commit is flushed
+extern bool peloton_async_commit_ack;
 
 namespace peloton {
 namespace wire {
@@ -39,22 +45,31 @@ void WorkerHandleNewConn(evutil_socket_t new_conn_recv_fd,
   switch (m_buf[0]) {
     /* new connection case */
     case 'c': {
-      // fetch the new connection fd from the queue
+      // fetch the new connection fd from the queue, this may also be a
+      // listening socket of the worker
       thread->new_conn_queue.Dequeue(item);
-      conn = LibeventServer::GetConn(item->new_conn_fd);
-      if (conn == nullptr) {
-        LOG_DEBUG("Creating new socket fd:%d", item->new_conn_fd);
-        /* create a new connection object */
-        LibeventServer::CreateNewConn(item->new_conn_fd, item->event_flags,
-                                      static_cast<LibeventThread *>(thread),
-                                      CONN_READ);
+      SetupConnection(item->new_conn_fd, item->event_flags,
+                      static_cast<LibeventThread *>(thread),
+                      item->init_state);
+      break;
+    }
+
+    /* the worker pool has run the packet of a connection, or its commit is
+     * durable */
+    case 'e': {
+      if (thread->exec_done_queue.Dequeue(conn) == false) {
+        LOG_ERROR("No connection in the executed queue");
+        break;
+      }
+      PL_ASSERT(conn->state == CONN_EXECUTING);
+      if (conn->exec_status == false) {
+        // packet processing can't proceed further
+        conn->TransitState(CONN_CLOSING);
       } else {
-        LOG_DEBUG("Reusing socket fd:%d", item->new_conn_fd);
-        /* otherwise reset and reuse the existing conn object */
-        conn->Reset();
-        conn->Init(item->event_flags, static_cast<LibeventThread *>(thread),
-                    CONN_READ);
+        // We should have responses ready to send
+        conn->TransitState(CONN_WRITE);
       }
+      StateMachine(conn);
       break;
     }
 
@@ -63,6 +78,21 @@ void WorkerHandleNewConn(evutil_socket_t new_conn_recv_fd,
   }
 }
 
+void SetupConnection(int conn_fd, short event_flags, LibeventThread *thread,
+                     ConnState init_state) {
+  auto conn = LibeventServer::GetConn(conn_fd);
+  if (conn == nullptr) {
+    LOG_DEBUG("Creating new socket fd:%d", conn_fd);
+    /* create a new connection object */
+    LibeventServer::CreateNewConn(conn_fd, event_flags, thread, init_state);
+  } else {
+    LOG_DEBUG("Reusing socket fd:%d", conn_fd);
+    /* otherwise reset and reuse the existing conn object */
+    conn->Reset();
+    conn->Init(event_flags, thread, init_state);
+  }
+}
+
 void EventHandler(UNUSED_ATTRIBUTE evutil_socket_t connfd, short ev_flags, void *arg) {
   LOG_TRACE("Event callback fired for connfd: %d", connfd);
   LibeventSocket *conn = static_cast<LibeventSocket *>(arg);
@@ -72,21 +102,145 @@ void EventHandler(UNUSED_ATTRIBUTE evutil_socket_t connfd, short ev_flags, void
   StateMachine(conn);
 }
 
+/* Does the packet run a statement that should go to the worker pool? */
+static bool IsPoolPacket(uchar msg_type) {
+  if (TransactionWorkerPool::GetInstance().IsRunning() == false) {
+    return false;
+  }
+  switch (msg_type) {
+    case SIMPLE_QUERY_COMMAND:
+    case PARSE_COMMAND:
+    case EXECUTE_COMMAND:
+    case SYNC_COMMAND:
+    case COPY_DATA_COMMAND:
+    case COPY_DONE_COMMAND:
+    case COPY_FAIL_COMMAND:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/* Hands the connection back to its worker thread */
+static void ResumeConnection(LibeventSocket *conn) {
+  auto thread = static_cast<LibeventWorkerThread *>(conn->thread);
+  thread->exec_done_queue.Enqueue(conn);
+  char buf[1];
+  buf[0] = 'e';
+  if (write(thread->new_conn_send_fd, buf, 1) != 1) {
+    LOG_ERROR("Failed to write to thread notify pipe");
+  }
+}
+
+/* Runs the packet of the connection. Its commits do not wait for their log
+ * flush, commit_id is set to the one the reply has to wait for */
+static bool RunPacket(LibeventSocket *conn, cid_t &commit_id) {
+  auto &log_manager = logging::LogManager::GetInstance();
+  log_manager.SetDeferFlushWait(peloton_async_commit_ack);
+  bool status = conn->pkt_manager.ProcessPacket(&conn->rpkt);
+  commit_id = log_manager.TakeDeferredCommitId();
+  return status;
+}
+
+/* Resumes the connection once the commit is durable. Returns false if it
+ * already is */
+static bool WaitForCommit(LibeventSocket *conn, cid_t commit_id) {
+  if (commit_id == INVALID_CID) {
+    return false;
+  }
+  return logging::LogManager::GetInstance().NotifyOnFlush(
+      commit_id, [conn]() { ResumeConnection(conn); });
+}
+
+void SubmitPacket(LibeventSocket *conn) {
+  auto work_class = conn->pkt_manager.GetWorkClass(&conn->rpkt);
+
+  // Nothing else happens on the connection until the packet has run
+  if (event_del(conn->event) == -1) {
+    LOG_ERROR("Failed to delete event");
+  }
+  conn->TransitState(CONN_EXECUTING);
+
+  TransactionWorkerPool::GetInstance().Submit(work_class, [conn]() {
+    cid_t commit_id;
+    conn->exec_status = RunPacket(conn, commit_id);
+
+    // The reply of a commit goes out once its log is flushed, the worker
+    // moves on meanwhile
+    if (conn->exec_status && WaitForCommit(conn, commit_id)) {
+      return;
+    }
+    ResumeConnection(conn);
+  });
+}
+
+/* Aborts the open transactions of the connection on the worker pool, so a
+ * long rollback does not hold up the network thread. The connection comes
+ * back to it to be closed */
+static void AbortOnPool(LibeventSocket *conn) {
+  if (event_del(conn->event) == -1) {
+    LOG_ERROR("Failed to delete event");
+  }
+  conn->TransitState(CONN_EXECUTING);
+
+  TransactionWorkerPool::GetInstance().Submit(WorkClass::OLTP, [conn]() {
+    conn->pkt_manager.AbortOpenTransactions();
+    conn->exec_status = false;
+    ResumeConnection(conn);
+  });
+}
+
+void RejectConnection(int new_conn_fd) {
+  // ErrorResponse with the fields of a Postgres server that is full
+  std::string fields;
+  fields.append("SFATAL", 7);
+  fields.append("C53300", 7);
+  fields.append("Msorry, too many clients already", 33);
+  fields.push_back('\0');
+
+  std::string packet(1, ERROR_RESPONSE);
+  uint32_t len = htonl(fields.size() + sizeof(uint32_t));
+  packet.append(reinterpret_cast<char *>(&len), sizeof(uint32_t));
+  packet.append(fields);
+  if (write(new_conn_fd, packet.data(), packet.size()) < 0) {
+    LOG_DEBUG("Failed to send the error to fd:%d", new_conn_fd);
+  }
+  close(new_conn_fd);
+}
+
 void StateMachine(LibeventSocket *conn) {
   bool done = false;
 
   while (done == false) {
     switch (conn->state) {
       case CONN_LISTENING: {
-        struct sockaddr_storage addr;
-        socklen_t addrlen = sizeof(addr);
-        int new_conn_fd =
-            accept(conn->sock_fd, (struct sockaddr *)&addr, &addrlen);
-        if (new_conn_fd == -1) {
-          LOG_ERROR("Failed to accept");
+        // Drain the backlog, so that a burst of connections does not take
+        // one event per connection
+        while (true) {
+          struct sockaddr_storage addr;
+          socklen_t addrlen = sizeof(addr);
+          int new_conn_fd =
+              accept(conn->sock_fd, (struct sockaddr *)&addr, &addrlen);
+          if (new_conn_fd == -1) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+              LOG_ERROR("Failed to accept");
+            }
+            break;
+          }
+          if (LibeventServer::AdmitConnection() == false) {
+            LOG_ERROR("Too many connections, rejecting fd:%d", new_conn_fd);
+            RejectConnection(new_conn_fd);
+            continue;
+          }
+          if (conn->thread->GetThreadID() == MASTER_THREAD_ID) {
+            (static_cast<LibeventMasterThread *>(conn->thread))
+                ->DispatchConnection(new_conn_fd, EV_READ | EV_PERSIST);
+          } else {
+            // A worker with its own listening socket keeps the connection
+            SetupConnection(new_conn_fd, EV_READ | EV_PERSIST, conn->thread,
+                            CONN_READ);
+          }
         }
-        (static_cast<LibeventMasterThread *>(conn->thread))
-            ->DispatchConnection(new_conn_fd, EV_READ | EV_PERSIST);
         done = true;
         break;
       }
@@ -150,9 +304,25 @@ void StateMachine(LibeventSocket *conn) {
           // We need to handle startup packet first
           status = conn->pkt_manager.ProcessStartupPacket(&conn->rpkt);
           conn->pkt_manager.is_started = true;
+        } else if (IsPoolPacket(conn->rpkt.msg_type)) {
+          // Statements run on the worker pool, not on this thread
+          SubmitPacket(conn);
+          done = true;
+          break;
         } else {
           // Process all other packets
-          status = conn->pkt_manager.ProcessPacket(&conn->rpkt);
+          cid_t commit_id;
+          status = RunPacket(conn, commit_id);
+          if (status && WaitForCommit(conn, commit_id)) {
+            // The reply is written once the commit is durable. The flush
+            // callback resumes the connection on this thread, so it can
+            // only run after we return
+            event_del(conn->event);
+            conn->exec_status = true;
+            conn->TransitState(CONN_EXECUTING);
+            done = true;
+            break;
+          }
         }
 
         if (status == false) {
@@ -192,7 +362,23 @@ void StateMachine(LibeventSocket *conn) {
         break;
       }
 
+      case CONN_EXECUTING: {
+        // wait for the worker pool to finish the packet
+        done = true;
+        break;
+      }
+
       case CONN_CLOSING: {
+        // A client that went away inside a transaction has it aborted before
+        // the connection is closed
+        if (conn->pkt_manager.HasOpenTransaction()) {
+          if (TransactionWorkerPool::GetInstance().IsRunning()) {
+            AbortOnPool(conn);
+            done = true;
+            break;
+          }
+          conn->pkt_manager.AbortOpenTransactions();
+        }
         conn->CloseSocket();
         done = true;
         break;
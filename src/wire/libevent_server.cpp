@@ -14,21 +14,52 @@
 
 #include <fcntl.h>
 #include <inttypes.h>
+#include <sys/resource.h>
 #include <sys/socket.h>
 #include <fstream>
 
 #include "common/init.h"
 #include "common/macros.h"
 #include "common/thread_pool.h"
+#include "wire/transaction_worker_pool.h"
+
+// Run statements on the transaction worker pool instead of the network threads
+extern bool peloton_worker_pool;
+
+// Threads of the transaction worker pool (0: one per core)
+extern size_t peloton_worker_thread_count;
+
+// Workers of the pool that run analytic statements (0: a quarter of them)
+extern size_t peloton_analytic_worker_thread_count;
+
+// Give every network thread its own SO_REUSEPORT listening socket
+extern bool peloton_reuseport_listeners;
+
+// Connections a listening socket queues until they are accepted
+// (0: SOMAXCONN)
+extern int peloton_listen_backlog;
 
 namespace peloton {
 namespace wire {
 
+// Sockets are found by their fd, which can be any number below the limit of
+// open files, and not only below the count of fds the server needs
+static size_t GetSocketListSize() {
+  // 2 fd's per thread for pipe, 1 listening socket per thread with
+  // SO_REUSEPORT and 1 for the master
+  size_t list_size = FLAGS_max_connections + QUERY_THREAD_COUNT * 3 + 1;
+  struct rlimit fd_limit;
+  if (getrlimit(RLIMIT_NOFILE, &fd_limit) == 0 &&
+      fd_limit.rlim_cur != RLIM_INFINITY && fd_limit.rlim_cur > list_size) {
+    list_size = fd_limit.rlim_cur;
+  }
+  return list_size;
+}
+
 std::vector<std::unique_ptr<LibeventSocket>>
     &LibeventServer::GetGlobalSocketList() {
-  static std::vector<std::unique_ptr<LibeventSocket>>
-      // 2 fd's per thread for pipe and 1 listening socket
-      global_socket_list(FLAGS_max_connections + QUERY_THREAD_COUNT * 2 + 1);
+  static std::vector<std::unique_ptr<LibeventSocket>> global_socket_list(
+      GetSocketListSize());
   return global_socket_list;
 }
 
@@ -45,6 +76,63 @@ void LibeventServer::CreateNewConn(const int &connfd, short ev_flags,
       new LibeventSocket(connfd, ev_flags, thread, init_state));
 }
 
+std::atomic<size_t> &LibeventServer::GetConnectionCount() {
+  static std::atomic<size_t> connection_count(0);
+  return connection_count;
+}
+
+bool LibeventServer::AdmitConnection() {
+  auto &connection_count = GetConnectionCount();
+  if (connection_count.fetch_add(1) >= (size_t)FLAGS_max_connections) {
+    connection_count--;
+    return false;
+  }
+  return true;
+}
+
+void LibeventServer::ReleaseConnection() { GetConnectionCount()--; }
+
+int LibeventServer::OpenListenSocket(bool reuse_port) {
+  struct sockaddr_in sin;
+  PL_MEMSET(&sin, 0, sizeof(sin));
+  sin.sin_family = AF_INET;
+  sin.sin_addr.s_addr = INADDR_ANY;
+  sin.sin_port = htons(port_);
+
+  int listen_fd;
+
+  listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+
+  if (listen_fd < 0) {
+    throw ConnectionException("Failed to create listen socket");
+  }
+
+  int reuse = 1;
+  setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+  // The kernel spreads the connections over the sockets bound to the port
+  if (reuse_port &&
+      setsockopt(listen_fd, SOL_SOCKET, SO_REUSEPORT, &reuse,
+                 sizeof(reuse)) < 0) {
+    throw ConnectionException("Failed to set SO_REUSEPORT");
+  }
+
+  if (bind(listen_fd, (struct sockaddr *)&sin, sizeof(sin)) < 0) {
+    throw ConnectionException("Failed to bind socket to port: " + std::to_string(port_));
+  }
+
+  // A storm of connections overflows a short accept queue, and the dropped
+  // ones only get in once their SYN is sent again
+  int conn_backlog = peloton_listen_backlog;
+  if (conn_backlog <= 0) {
+    conn_backlog = SOMAXCONN;
+  }
+  if (listen(listen_fd, conn_backlog) < 0) {
+    throw ConnectionException("Failed to listen to socket");
+  }
+  return listen_fd;
+}
+
 /**
  * Stop signal handling
  */
@@ -75,6 +163,21 @@ LibeventServer::LibeventServer() {
   port_ = FLAGS_port;
   max_connections_ = FLAGS_max_connections;
 
+  // Statements run on their own threads so that a long one does not hold up
+  // the other connections of its network thread
+  if (peloton_worker_pool) {
+    size_t worker_count = peloton_worker_thread_count;
+    if (worker_count == 0) {
+      worker_count = std::thread::hardware_concurrency();
+    }
+    size_t analytic_worker_count = peloton_analytic_worker_thread_count;
+    if (analytic_worker_count == 0) {
+      analytic_worker_count = worker_count / 4;
+    }
+    TransactionWorkerPool::GetInstance().Start(worker_count,
+                                               analytic_worker_count);
+  }
+
   // For logging purposes
   //  event_enable_debug_mode();
   //  event_set_log_callback(LogCallback);
@@ -88,37 +191,24 @@ LibeventServer::LibeventServer() {
   signal(SIGPIPE, SIG_IGN);
 
   if (FLAGS_socket_family == "AF_INET") {
-    struct sockaddr_in sin;
-    PL_MEMSET(&sin, 0, sizeof(sin));
-    sin.sin_family = AF_INET;
-    sin.sin_addr.s_addr = INADDR_ANY;
-    sin.sin_port = htons(port_);
-
-    int listen_fd;
-
-    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
-
-    if (listen_fd < 0) {
-      throw ConnectionException("Failed to create listen socket");
-    }
-
-    int reuse = 1;
-    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
-
-    if (bind(listen_fd, (struct sockaddr *)&sin, sizeof(sin)) < 0) {
-      throw ConnectionException("Failed to bind socket to port: " + std::to_string(port_));
+    if (peloton_reuseport_listeners) {
+      // Every worker accepts on its own socket, so a storm of connections
+      // is not funneled through the master thread
+      auto master = static_cast<LibeventMasterThread *>(master_thread.get());
+      for (auto &worker_thread : master->GetWorkerThreads()) {
+        int listen_fd = OpenListenSocket(true);
+        master->DispatchListenSocket(listen_fd, EV_READ | EV_PERSIST,
+                                     worker_thread.get());
+      }
+    } else {
+      int listen_fd = OpenListenSocket(false);
+      LibeventServer::CreateNewConn(listen_fd, EV_READ | EV_PERSIST,
+                                    master_thread.get(), CONN_LISTENING);
     }
 
-    int conn_backlog = 12;
-    if (listen(listen_fd, conn_backlog) < 0) {
-      throw ConnectionException("Failed to listen to socket");
-    }
-
-    LibeventServer::CreateNewConn(listen_fd, EV_READ | EV_PERSIST,
-                                  master_thread.get(), CONN_LISTENING);
-
     LOG_INFO("Listening on port %" PRIu64, port_);
     event_base_dispatch(base);
+    TransactionWorkerPool::GetInstance().Stop();
     event_free(evstop);
     event_base_free(base);
   }
@@ -13,6 +13,9 @@
 #include <unistd.h>
 #include "wire/libevent_server.h"
 
+// Largest size the read buffer of a connection grows to (in bytes)
+extern size_t peloton_max_socket_buffer_size;
+
 namespace peloton {
 namespace wire {
 
@@ -118,6 +121,14 @@ bool LibeventSocket::ReadPacketHeader() {
     GetSizeFromPktHeader(rbuf_.buf_ptr);
   }
 
+  // Large packets are read in place into a grown read buffer. Only those
+  // that do not fit even then are copied into the extended buffer
+  if (rpkt.len > rbuf_.GetMaxSize() &&
+      rpkt.len <= peloton_max_socket_buffer_size) {
+    LOG_DEBUG("Growing read buffer for pkt size:%ld", rpkt.len);
+    rbuf_.Grow(rpkt.len);
+  }
+
   // do we need to use the extended buffer for this packet?
   rpkt.is_extended = (rpkt.len > rbuf_.GetMaxSize());
 
@@ -172,6 +183,12 @@ bool LibeventSocket::ReadPacket() {
  */
 
 WriteState LibeventSocket::WritePackets() {
+  // the replies of batched EXECUTE messages are not known until the batch
+  // runs, so hold back everything until then
+  if (pkt_manager.HasPendingBatch()) {
+    return WRITE_COMPLETE;
+  }
+
   // iterate through all the packets
   for (; next_response_ < pkt_manager.responses.size(); next_response_++) {
     auto pkt = pkt_manager.responses[next_response_].get();
@@ -483,6 +500,7 @@ void LibeventSocket::CloseSocket() {
   event_del(event);
 
   TransitState(CONN_CLOSED);
+  LibeventServer::ReleaseConnection();
   Reset();
   for (;;) {
     int status = close(sock_fd);
@@ -499,6 +517,7 @@ void LibeventSocket::CloseSocket() {
 
 void LibeventSocket::Reset() {
   rbuf_.Reset();
+  rbuf_.Shrink();
   wbuf_.Reset();
   pkt_manager.Reset();
   state = CONN_INVALID;
@@ -10,7 +10,10 @@
 //
 //===----------------------------------------------------------------------===//
 #include "wire/libevent_thread.h"
+#include <pthread.h>
+#include <sched.h>
 #include <sys/file.h>
+#include <thread>
 #include <fstream>
 #include <vector>
 #include "boost/thread/future.hpp"
@@ -18,6 +21,9 @@
 #include "common/thread_pool.h"
 #include "wire/libevent_server.h"
 
+// Pin every network thread to a core, so its memory stays on the local node
+extern bool peloton_pin_network_threads;
+
 namespace peloton {
 namespace wire {
 
@@ -50,10 +56,31 @@ LibeventMasterThread::LibeventMasterThread(const int num_threads,
   sleep(1);
 }
 
+/*
+ * Pin the calling thread to a core. The memory it touches first, like the
+ * buffers of the connections it sets up, is then allocated on its NUMA node
+ */
+static void PinThread(int thread_id) {
+  auto cpu_count = std::thread::hardware_concurrency();
+  if (cpu_count == 0) {
+    return;
+  }
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(thread_id % cpu_count, &cpu_set);
+  if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set) !=
+      0) {
+    LOG_ERROR("Failed to pin worker %d", thread_id);
+  }
+}
+
 /*
  * Start with worker event loop
  */
 void LibeventMasterThread::StartWorker(LibeventWorkerThread *worker_thread) {
+  if (peloton_pin_network_threads) {
+    PinThread(worker_thread->GetThreadID());
+  }
   event_base_loop(worker_thread->GetEventBase(), 0);
 }
 
@@ -62,7 +89,9 @@ void LibeventMasterThread::StartWorker(LibeventWorkerThread *worker_thread) {
 * constructor.
 */
 LibeventWorkerThread::LibeventWorkerThread(const int thread_id)
-    : LibeventThread(thread_id, event_base_new()), new_conn_queue(QUEUE_SIZE) {
+    : LibeventThread(thread_id, event_base_new()),
+      new_conn_queue(QUEUE_SIZE),
+      exec_done_queue(QUEUE_SIZE) {
   int fds[2];
   if (pipe(fds)) {
     LOG_ERROR("Can't create notify pipe to accept connections");
@@ -109,5 +138,25 @@ void LibeventMasterThread::DispatchConnection(int new_conn_fd,
     LOG_ERROR("Failed to write to thread notify pipe");
   }
 }
+
+/*
+* The listening socket is set up by the worker itself, since its event base
+* is only used from its own thread
+*/
+void LibeventMasterThread::DispatchListenSocket(
+    int listen_fd, short event_flags, LibeventWorkerThread *worker_thread) {
+  char buf[1];
+  buf[0] = 'c';
+
+  LOG_DEBUG("Dispatching listening socket to worker %d",
+            worker_thread->GetThreadID());
+  std::shared_ptr<NewConnQueueItem> item(
+      new NewConnQueueItem(listen_fd, event_flags, CONN_LISTENING));
+  worker_thread->new_conn_queue.Enqueue(item);
+
+  if (write(worker_thread->new_conn_send_fd, buf, 1) != 1) {
+    LOG_ERROR("Failed to write to thread notify pipe");
+  }
+}
 }
 }
@@ -89,6 +89,16 @@ void PacketGetString(InputPacket *rpkt, size_t len, std::string &result) {
   rpkt->ptr += len;
 }
 
+boost::string_ref PacketGetStringRef(InputPacket *rpkt, size_t len) {
+  // return empty string
+  if (len == 0) return boost::string_ref();
+
+  // exclude null char
+  auto data = reinterpret_cast<const char *>(&(*(rpkt->Begin() + rpkt->ptr)));
+  rpkt->ptr += len;
+  return boost::string_ref(data, len - 1);
+}
+
 void GetStringToken(InputPacket *rpkt, std::string &result) {
   // save start itr position of string
   auto start = rpkt->Begin() + rpkt->ptr;
@@ -121,6 +131,20 @@ uchar *PacketCopyBytes(ByteBuf::const_iterator begin, int len) {
   return result;
 }
 
+std::shared_ptr<ByteBuf> InputPacket::DetachBuffer() {
+  if (detached_buffer_.get() == nullptr) {
+    if (is_extended) {
+      detached_buffer_.reset(new ByteBuf(std::move(extended_buffer_)));
+      extended_buffer_.clear();
+    } else {
+      detached_buffer_.reset(new ByteBuf(begin, end));
+    }
+    begin = detached_buffer_->begin();
+    end = detached_buffer_->end();
+  }
+  return detached_buffer_;
+}
+
 void PacketPutByte(OutputPacket *pkt, const uchar c) {
   pkt->buf.push_back(c);
   pkt->len++;
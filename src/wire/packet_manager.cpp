@@ -11,17 +11,24 @@
 //===----------------------------------------------------------------------===//
 #include "wire/packet_manager.h"
 
+#include <algorithm>
+#include <cctype>
 #include <cstdio>
 #include <unordered_map>
 
 #include "common/cache.h"
 #include "common/macros.h"
 #include "common/portal.h"
+#include "catalog/catalog.h"
 #include "optimizer/simple_optimizer.h"
+#include "parser/copy_statement.h"
+#include "parser/parser.h"
 #include "planner/abstract_plan.h"
+#include "planner/abstract_scan_plan.h"
 #include "planner/delete_plan.h"
 #include "planner/insert_plan.h"
 #include "planner/update_plan.h"
+#include "tcop/plan_cache.h"
 #include "tcop/tcop.h"
 #include "type/types.h"
 #include "type/value.h"
@@ -33,6 +40,12 @@
 
 #define PROTO_MAJOR_VERSION(x) x >> 16
 
+// EXECUTE messages of a prepared INSERT batched before a Sync (<= 1: off)
+extern size_t peloton_execute_batch_size;
+
+// Run the statements of a multi-statement simple query in one transaction
+extern bool peloton_query_batch;
+
 namespace peloton {
 namespace wire {
 
@@ -50,7 +63,10 @@ const std::unordered_map<std::string, std::string>
 std::vector<PacketManager *> PacketManager::packet_managers_;
 std::mutex PacketManager::packet_managers_mutex_;
 
-PacketManager::PacketManager() : txn_state_(TXN_IDLE), pkt_cntr_(0) {
+PacketManager::PacketManager()
+    : txn_state_(TXN_IDLE),
+      read_only_(FLAGS_replication_role == "follower"),
+      pkt_cntr_(0) {
   traffic_cop_.reset(new tcop::TrafficCop());
   {
     std::lock_guard<std::mutex> lock(PacketManager::packet_managers_mutex_);
@@ -73,6 +89,9 @@ PacketManager::~PacketManager() {
 }
 
 void PacketManager::InvalidatePreparedStatements(oid_t table_id) {
+  // The shared plans of simple queries
+  tcop::PlanCache::GetInstance().InvalidateTable(table_id);
+
   if (table_statement_cache_.find(table_id) == table_statement_cache_.end()) {
     return;
   }
@@ -177,14 +196,16 @@ bool PacketManager::ProcessStartupPacket(InputPacket *pkt) {
 }
 
 void PacketManager::PutTupleDescriptor(
-    const std::vector<FieldInfoType> &tuple_descriptor) {
+    const std::vector<FieldInfoType> &tuple_descriptor,
+    const std::vector<int> &result_format) {
   if (tuple_descriptor.empty()) return;
 
   std::unique_ptr<OutputPacket> pkt(new OutputPacket());
   pkt->msg_type = ROW_DESCRIPTION;
   PacketPutInt(pkt.get(), tuple_descriptor.size(), 2);
 
-  for (auto col : tuple_descriptor) {
+  for (size_t col_idx = 0; col_idx < tuple_descriptor.size(); col_idx++) {
+    auto &col = tuple_descriptor[col_idx];
     PacketPutString(pkt.get(), std::get<0>(col));
     // TODO: Table Oid (int32)
     PacketPutInt(pkt.get(), 0, 4);
@@ -196,8 +217,12 @@ void PacketManager::PutTupleDescriptor(
     PacketPutInt(pkt.get(), std::get<2>(col), 2);
     // Type modifier (int32)
     PacketPutInt(pkt.get(), -1, 4);
-    // Format code for text
-    PacketPutInt(pkt.get(), 0, 2);
+    // Format code (0 for text, 1 for binary)
+    int format = 0;
+    if (col_idx < result_format.size() && result_format[col_idx] != 0) {
+      format = 1;
+    }
+    PacketPutInt(pkt.get(), format, 2);
   }
   responses.push_back(std::move(pkt));
 }
@@ -214,7 +239,7 @@ void PacketManager::SendDataRows(std::vector<ResultType> &results, int colcount,
     pkt->msg_type = DATA_ROW;
     PacketPutInt(pkt.get(), colcount, 2);
     for (int j = 0; j < colcount; j++) {
-      auto content = results[i * colcount + j].second;
+      const auto &content = results[i * colcount + j].second;
       if (content.size() == 0) {
         // content is NULL
         PacketPutInt(pkt.get(), NULL_CONTENT_SIZE, 4);
@@ -277,11 +302,17 @@ bool PacketManager::HardcodedExecuteFilter(std::string query_type) {
 
 // The Simple Query Protocol
 void PacketManager::ExecQueryMessage(InputPacket *pkt) {
-  std::string q_str;
-  PacketGetString(pkt, pkt->len, q_str);
-
-  std::vector<std::string> queries;
-  boost::split(queries, q_str, boost::is_any_of(";"));
+  auto q_str = PacketGetStringRef(pkt, pkt->len);
+  auto full_query = q_str;
+
+  // Split the queries without copying them out of the packet
+  std::vector<boost::string_ref> queries;
+  while (true) {
+    auto pos = q_str.find(';');
+    queries.push_back(q_str.substr(0, pos));
+    if (pos == boost::string_ref::npos) break;
+    q_str.remove_prefix(pos + 1);
+  }
 
   if (queries.size() == 1) {
     SendEmptyQueryResponse();
@@ -289,15 +320,33 @@ void PacketManager::ExecQueryMessage(InputPacket *pkt) {
     return;
   }
 
-  for (auto query : queries) {
+  if (queries.size() > 2 && ExecQueryBatch(full_query, queries)) {
+    SendReadyForQuery(txn_state_);
+    return;
+  }
+
+  for (size_t query_idx = 0; query_idx < queries.size(); query_idx++) {
     // iterate till before the empty string after the last ';'
-    if (query != queries.back()) {
+    if (query_idx + 1 < queries.size()) {
+      auto query = queries[query_idx].to_string();
       if (query.empty()) {
         SendEmptyQueryResponse();
         SendReadyForQuery(TXN_IDLE);
         return;
       }
 
+      // The rows follow in COPY DATA messages, the rest of the queries are
+      // dropped
+      std::string query_type;
+      Statement::ParseQueryType(query, query_type);
+      if (RejectWrite(query_type)) {
+        break;
+      }
+      if (boost::iequals(query_type, "COPY") && StartCopyIn(query)) {
+        if (copy_loader_.get() != nullptr) return;
+        break;
+      }
+
       std::vector<ResultType> result;
       std::vector<FieldInfoType> tuple_descriptor;
       std::string error_message;
@@ -330,6 +379,68 @@ void PacketManager::ExecQueryMessage(InputPacket *pkt) {
   SendReadyForQuery(READ_FOR_QUERY);
 }
 
+bool PacketManager::ExecQueryBatch(
+    const boost::string_ref &query_string,
+    const std::vector<boost::string_ref> &queries) {
+  if (peloton_query_batch == false || txn_state_ != TXN_IDLE) {
+    return false;
+  }
+
+  // Every statement must be planned up front and be able to run inside one
+  // transaction, otherwise they run one by one
+  std::vector<std::string> statement_queries;
+  for (size_t query_idx = 0; query_idx + 1 < queries.size(); query_idx++) {
+    auto query = queries[query_idx].to_string();
+    std::string query_type;
+    Statement::ParseQueryType(query, query_type);
+    if (query_type.empty() || (read_only_ && IsWriteQuery(query_type)) ||
+        boost::iequals(query_type, "BEGIN") ||
+        boost::iequals(query_type, "COMMIT") ||
+        boost::iequals(query_type, "ROLLBACK") ||
+        boost::iequals(query_type, "COPY") ||
+        boost::iequals(query_type, "SET") ||
+        boost::iequals(query_type, "SHOW") ||
+        boost::iequals(query_type, "CREATE") ||
+        boost::iequals(query_type, "DROP") ||
+        boost::iequals(query_type, "ALTER") ||
+        boost::iequals(query_type, "PREPARE") ||
+        boost::iequals(query_type, "EXECUTE")) {
+      return false;
+    }
+    statement_queries.push_back(std::move(query));
+  }
+
+  std::vector<std::shared_ptr<Statement>> statements;
+  std::string error_message;
+  if (traffic_cop_->PrepareStatementList(query_string.to_string(),
+                                         statement_queries, statements,
+                                         error_message) == false) {
+    // Let the statements report their own errors
+    return false;
+  }
+
+  std::vector<std::vector<ResultType>> results;
+  std::vector<int> rows_changed;
+  auto status = traffic_cop_->ExecuteStatementList(statements, results,
+                                                   rows_changed, error_message);
+
+  // The replies of all the statements are buffered and go out together
+  for (size_t stmt_idx = 0; stmt_idx < results.size(); stmt_idx++) {
+    auto tuple_descriptor = statements[stmt_idx]->GetTupleDescriptor();
+    int rows_affected = rows_changed[stmt_idx];
+    PutTupleDescriptor(tuple_descriptor);
+    SendDataRows(results[stmt_idx], tuple_descriptor.size(), rows_affected);
+    CompleteCommand(
+        boost::to_upper_copy(statements[stmt_idx]->GetQueryType()),
+        rows_affected);
+  }
+
+  if (status != Result::RESULT_SUCCESS) {
+    SendErrorResponse({{HUMAN_READABLE_ERROR, error_message}});
+  }
+  return true;
+}
+
 /*
  * exec_parse_message - handle PARSE message
  */
@@ -357,6 +468,11 @@ void PacketManager::ExecParseMessage(InputPacket *pkt) {
     return;
   }
 
+  if (RejectWrite(query_type)) {
+    skipped_stmt_ = true;
+    return;
+  }
+
   // Prepare statement
   std::shared_ptr<Statement> statement(nullptr);
 
@@ -498,15 +614,20 @@ void PacketManager::ExecBindMessage(InputPacket *pkt) {
     ReplanPreparedStatement(statement.get());
   }
 
-  // Group the parameter types and the parameters in this vector
-  std::vector<std::pair<int, std::string>> bind_parameters(num_params);
   std::vector<type::Value> param_values(num_params);
 
   auto param_types = statement->GetParamTypes();
 
+  // Varlen parameters point into the packet, which the portal keeps. Not when
+  // the raw parameters are copied for the statistics
+  std::shared_ptr<ByteBuf> param_buffer;
+  if (FLAGS_stats_mode == STATS_TYPE_INVALID) {
+    param_buffer = pkt->DetachBuffer();
+  }
+
   auto val_buf_begin = pkt->Begin() + pkt->ptr;
-  auto val_buf_len = ReadParamValue(pkt, num_params, param_types,
-                                    bind_parameters, param_values, formats);
+  auto val_buf_len =
+      ReadParamValue(pkt, num_params, param_types, param_values, formats);
 
   int format_codes_number = PacketGetInt(pkt, 2);
   LOG_TRACE("format_codes_number: %d", format_codes_number);
@@ -558,6 +679,7 @@ void PacketManager::ExecBindMessage(InputPacket *pkt) {
   // Notice that this will move param_values so no value will be left there.
   auto portal =
       new Portal(portal_name, statement, std::move(param_values), param_stat);
+  portal->SetParameterBuffer(param_buffer);
   std::shared_ptr<Portal> portal_reference(portal);
 
   auto itr = portals_.find(portal_name);
@@ -599,92 +721,87 @@ size_t PacketManager::ReadParamFormat(InputPacket *pkt, int num_params_format,
 }
 
 // For consistency, this function assumes the input vectors has the correct size
-size_t PacketManager::ReadParamValue(
-    InputPacket *pkt, int num_params, std::vector<int32_t> &param_types,
-    std::vector<std::pair<int, std::string>> &bind_parameters,
-    std::vector<type::Value> &param_values, std::vector<int16_t> &formats) {
+size_t PacketManager::ReadParamValue(InputPacket *pkt, int num_params,
+                                     std::vector<int32_t> &param_types,
+                                     std::vector<type::Value> &param_values,
+                                     std::vector<int16_t> &formats) {
   auto begin = pkt->ptr;
-  ByteBuf param;
+  // Values of a detached packet point into it instead of holding a copy
+  bool borrow = pkt->IsDetached();
   for (int param_idx = 0; param_idx < num_params; param_idx++) {
     int param_len = PacketGetInt(pkt, 4);
+    auto peloton_type = PostgresValueTypeToPelotonValueType(
+        static_cast<PostgresValueType>(param_types[param_idx]));
     // BIND packet NULL parameter case
     if (param_len == -1) {
       // NULL mode
-      auto peloton_type = PostgresValueTypeToPelotonValueType(
-          static_cast<PostgresValueType>(param_types[param_idx]));
-      bind_parameters[param_idx] =
-          std::make_pair(peloton_type, std::string(""));
       param_values[param_idx] =
           type::ValueFactory::GetNullValueByType(peloton_type);
+      continue;
+    }
+
+    PL_ASSERT(pkt->ptr + param_len <= pkt->len);
+    auto param = &(*pkt->Begin()) + pkt->ptr;
+    pkt->ptr += param_len;
+
+    if (formats[param_idx] == 0) {
+      // TEXT mode
+      type::Value text_value;
+      if (borrow) {
+        // A varchar ends with '\0'. Move the text over the last byte of its
+        // length, which was read already, so that the terminator fits
+        auto text = reinterpret_cast<char *>(pkt->GetDetachedData()) +
+                    pkt->ptr - param_len - 1;
+        std::memmove(text, text + 1, param_len);
+        text[param_len] = '\0';
+        text_value = type::ValueFactory::GetVarcharValue(text, false);
+      } else {
+        text_value = type::ValueFactory::GetVarcharValue(
+            std::string(reinterpret_cast<const char *>(param), param_len));
+      }
+      if (peloton_type == type::Type::VARCHAR) {
+        param_values[param_idx] = std::move(text_value);
+      } else {
+        param_values[param_idx] = text_value.CastAs(peloton_type);
+      }
+      PL_ASSERT(param_values[param_idx].GetTypeId() != type::Type::INVALID);
     } else {
-      PacketGetBytes(pkt, param_len, param);
-
-      if (formats[param_idx] == 0) {
-        // TEXT mode
-        std::string param_str = std::string(std::begin(param), std::end(param));
-        bind_parameters[param_idx] =
-            std::make_pair(type::Type::VARCHAR, param_str);
-        if (PostgresValueTypeToPelotonValueType(
-                (PostgresValueType)param_types[param_idx]) ==
-            type::Type::VARCHAR) {
+      // BINARY mode
+      switch (param_types[param_idx]) {
+        case POSTGRES_VALUE_TYPE_INTEGER: {
+          int int_val = 0;
+          for (size_t i = 0; i < sizeof(int); ++i) {
+            int_val = (int_val << 8) | param[i];
+          }
           param_values[param_idx] =
-              type::ValueFactory::GetVarcharValue(param_str);
-        } else {
+              type::ValueFactory::GetIntegerValue(int_val);
+        } break;
+        case POSTGRES_VALUE_TYPE_BIGINT: {
+          int64_t int_val = 0;
+          for (size_t i = 0; i < sizeof(int64_t); ++i) {
+            int_val = (int_val << 8) | param[i];
+          }
+          param_values[param_idx] = type::ValueFactory::GetBigIntValue(int_val);
+        } break;
+        case POSTGRES_VALUE_TYPE_DOUBLE: {
+          double float_val = 0;
+          unsigned long buf = 0;
+          for (size_t i = 0; i < sizeof(double); ++i) {
+            buf = (buf << 8) | param[i];
+          }
+          PL_MEMCPY(&float_val, &buf, sizeof(double));
           param_values[param_idx] =
-              (type::ValueFactory::GetVarcharValue(param_str))
-                  .CastAs(PostgresValueTypeToPelotonValueType(
-                      (PostgresValueType)param_types[param_idx]));
-        }
-        PL_ASSERT(param_values[param_idx].GetTypeId() != type::Type::INVALID);
-      } else {
-        // BINARY mode
-        switch (param_types[param_idx]) {
-          case POSTGRES_VALUE_TYPE_INTEGER: {
-            int int_val = 0;
-            for (size_t i = 0; i < sizeof(int); ++i) {
-              int_val = (int_val << 8) | param[i];
-            }
-            bind_parameters[param_idx] =
-                std::make_pair(type::Type::INTEGER, std::to_string(int_val));
-            param_values[param_idx] =
-                type::ValueFactory::GetIntegerValue(int_val).Copy();
-          } break;
-          case POSTGRES_VALUE_TYPE_BIGINT: {
-            int64_t int_val = 0;
-            for (size_t i = 0; i < sizeof(int64_t); ++i) {
-              int_val = (int_val << 8) | param[i];
-            }
-            bind_parameters[param_idx] =
-                std::make_pair(type::Type::BIGINT, std::to_string(int_val));
-            param_values[param_idx] =
-                type::ValueFactory::GetBigIntValue(int_val).Copy();
-          } break;
-          case POSTGRES_VALUE_TYPE_DOUBLE: {
-            double float_val = 0;
-            unsigned long buf = 0;
-            for (size_t i = 0; i < sizeof(double); ++i) {
-              buf = (buf << 8) | param[i];
-            }
-            PL_MEMCPY(&float_val, &buf, sizeof(double));
-            bind_parameters[param_idx] =
-                std::make_pair(type::Type::DECIMAL, std::to_string(float_val));
-            param_values[param_idx] =
-                type::ValueFactory::GetDoubleValue(float_val).Copy();
-          } break;
-          case POSTGRES_VALUE_TYPE_VARBINARY: {
-            bind_parameters[param_idx] = std::make_pair(
-                type::Type::VARBINARY,
-                std::string(reinterpret_cast<char *>(&param[0]), param_len));
-            param_values[param_idx] = type::ValueFactory::GetVarbinaryValue(
-                &param[0], param_len, true);
-
-          } break;
-          default: {
-            LOG_ERROR("Do not support data type: %d", param_types[param_idx]);
-          } break;
-        }
-        PL_ASSERT(param_values[param_idx].GetTypeId() != type::Type::INVALID);
+              type::ValueFactory::GetDoubleValue(float_val);
+        } break;
+        case POSTGRES_VALUE_TYPE_VARBINARY: {
+          param_values[param_idx] = type::ValueFactory::GetVarbinaryValue(
+              param, param_len, borrow == false);
+        } break;
+        default: {
+          LOG_ERROR("Do not support data type: %d", param_types[param_idx]);
+        } break;
       }
+      PL_ASSERT(param_values[param_idx].GetTypeId() != type::Type::INVALID);
     }
   }
   auto end = pkt->ptr;
@@ -727,8 +844,9 @@ bool PacketManager::ExecDescribeMessage(InputPacket *pkt) {
       return false;
     }
 
+    // The rows of the portal are sent in the formats given at Bind
     auto statement = portal->GetStatement();
-    PutTupleDescriptor(statement->GetTupleDescriptor());
+    PutTupleDescriptor(statement->GetTupleDescriptor(), result_format_);
   } else {
     LOG_TRACE("Describe a prepared statement");
   }
@@ -775,7 +893,12 @@ void PacketManager::ExecExecuteMessage(InputPacket *pkt) {
 
   auto statement_name = statement->GetStatementName();
   bool unnamed = statement_name.empty();
-  auto param_values = portal->GetParameters();
+  const auto &param_values = portal->GetParameters();
+
+  // Consecutive EXECUTE messages of a prepared INSERT run as one batch
+  if (BatchExecuteMessage(portal)) {
+    return;
+  }
 
   auto status = traffic_cop_->ExecuteStatement(
       statement, param_values, unnamed, param_stat, result_format_, results,
@@ -804,6 +927,103 @@ void PacketManager::ExecExecuteMessage(InputPacket *pkt) {
   }
 }
 
+bool PacketManager::BatchExecuteMessage(
+    const std::shared_ptr<Portal> &portal) {
+  auto statement = portal->GetStatement();
+  auto &plan = statement->GetPlanTree();
+
+  // Any other statement ends the batch
+  if (batch_plan_.get() != nullptr && batch_plan_ != plan) {
+    FlushExecuteBatch();
+  }
+
+  // The statistics are collected per statement execution
+  if (peloton_execute_batch_size <= 1 ||
+      FLAGS_stats_mode != STATS_TYPE_INVALID ||
+      statement->GetQueryType() != "INSERT" || plan.get() == nullptr ||
+      plan->GetPlanNodeType() != PLAN_NODE_TYPE_INSERT ||
+      static_cast<const planner::InsertPlan *>(plan.get())->IsBatchable() ==
+          false) {
+    return false;
+  }
+
+  batch_plan_ = plan;
+  // The portal keeps the packet that the parameters point into
+  batch_portals_.push_back(portal);
+  batch_params_.push_back(portal->GetParameters());
+
+  // Keep a place for the reply in between the other responses
+  batch_reply_slots_.push_back(responses.size());
+  responses.emplace_back(nullptr);
+
+  if (batch_params_.size() >= peloton_execute_batch_size) {
+    FlushExecuteBatch();
+  }
+  return true;
+}
+
+void PacketManager::FlushExecuteBatch() {
+  if (batch_plan_.get() == nullptr) {
+    return;
+  }
+
+  LOG_TRACE("Executing a batch of %lu inserts", batch_params_.size());
+  std::vector<ResultType> results;
+  std::vector<type::Value> params;
+  std::string error_message;
+  bridge::peloton_status status;
+  try {
+    auto insert_plan =
+        static_cast<const planner::InsertPlan *>(batch_plan_.get());
+    auto batch_plan = insert_plan->BindBatch(batch_params_);
+    status = traffic_cop_->ExecuteStatementPlan(batch_plan.get(), params,
+                                                results, result_format_);
+  } catch (Exception &e) {
+    error_message = e.what();
+    status.m_result = Result::RESULT_FAILURE;
+  }
+
+  if (status.m_result == Result::RESULT_SUCCESS) {
+    for (auto slot : batch_reply_slots_) {
+      CompleteCommand("INSERT", 1);
+      responses[slot] = std::move(responses.back());
+      responses.pop_back();
+    }
+  } else {
+    // The messages after the failed EXECUTE are skipped until Sync
+    responses.resize(batch_reply_slots_.front());
+    if (status.m_result == Result::RESULT_ABORTED) {
+      LOG_DEBUG("Failed to execute batch: Conflicting txn aborted");
+      SendErrorResponse(
+          {{SQLSTATE_CODE_ERROR, SqlStateErrorCodeToString(
+                                     SqlStateErrorCode::SERIALIZATION_ERROR)}});
+    } else {
+      LOG_ERROR("Failed to execute batch: %s", error_message.c_str());
+      SendErrorResponse({{HUMAN_READABLE_ERROR, error_message}});
+    }
+  }
+
+  batch_plan_.reset();
+  batch_portals_.clear();
+  batch_params_.clear();
+  batch_reply_slots_.clear();
+}
+
+void PacketManager::DiscardExecuteBatch() {
+  if (batch_plan_.get() == nullptr) {
+    return;
+  }
+
+  LOG_DEBUG("Discarding a batch of %lu inserts", batch_params_.size());
+  responses.erase(std::remove(responses.begin(), responses.end(), nullptr),
+                  responses.end());
+
+  batch_plan_.reset();
+  batch_portals_.clear();
+  batch_params_.clear();
+  batch_reply_slots_.clear();
+}
+
 void PacketManager::ExecCloseMessage(InputPacket *pkt) {
   uchar close_type = 0;
   std::string name;
@@ -839,6 +1059,208 @@ void PacketManager::ExecCloseMessage(InputPacket *pkt) {
   responses.push_back(std::move(response));
 }
 
+bool PacketManager::StartCopyIn(const std::string &query) {
+  auto &peloton_parser = parser::Parser::GetInstance();
+  std::unique_ptr<parser::SQLStatementList> sql_stmt;
+  try {
+    sql_stmt = peloton_parser.BuildParseTree(query);
+  } catch (Exception &e) {
+    return false;
+  }
+  if (sql_stmt->is_valid == false || sql_stmt->GetStatements().size() != 1 ||
+      sql_stmt->GetStatement(0)->GetType() != STATEMENT_TYPE_COPY) {
+    return false;
+  }
+  auto copy_stmt =
+      static_cast<parser::CopyStatement *>(sql_stmt->GetStatement(0));
+  if (copy_stmt->file_path != nullptr) {
+    // COPY ... TO a file
+    return false;
+  }
+
+  std::string table_name(copy_stmt->cpy_table->GetTableName());
+  storage::DataTable *table = nullptr;
+  try {
+    table = catalog::Catalog::GetInstance()->GetTableWithName(
+        copy_stmt->cpy_table->GetDatabaseName(), table_name);
+  } catch (CatalogException &e) {
+    table = nullptr;
+  }
+  if (table == nullptr) {
+    SendErrorResponse({{HUMAN_READABLE_ERROR,
+                        "Table '" + table_name + "' does not exist"}});
+    return true;
+  }
+
+  copy_loader_.reset(new CopyLoader(table, copy_stmt->type,
+                                    copy_stmt->delimiter, traffic_cop_.get()));
+
+  // Every column in the format of the data
+  uchar format = copy_loader_->IsBinary() ? 1 : 0;
+  std::unique_ptr<OutputPacket> response(new OutputPacket());
+  response->msg_type = COPY_IN_RESPONSE;
+  PacketPutByte(response.get(), format);
+  PacketPutInt(response.get(), copy_loader_->GetColumnCount(), 2);
+  for (size_t column_itr = 0; column_itr < copy_loader_->GetColumnCount();
+       column_itr++) {
+    PacketPutInt(response.get(), format, 2);
+  }
+  responses.push_back(std::move(response));
+  return true;
+}
+
+void PacketManager::ExecCopyDataMessage(InputPacket *pkt) {
+  // After an error the rest of the data is dropped
+  if (copy_loader_.get() == nullptr) {
+    return;
+  }
+
+  auto data = reinterpret_cast<const char *>(&(*pkt->Begin()));
+  if (copy_loader_->Consume(data, pkt->len) == false) {
+    ExecCopyDoneMessage(true, "");
+  }
+}
+
+void PacketManager::ExecCopyDoneMessage(bool copy_failed,
+                                        const std::string &fail_message) {
+  if (copy_loader_.get() == nullptr) {
+    return;
+  }
+
+  if (copy_failed == false && copy_loader_->Finish()) {
+    CompleteCommand("COPY", copy_loader_->GetRowCount());
+  } else if (copy_failed && fail_message.empty() == false) {
+    SendErrorResponse(
+        {{HUMAN_READABLE_ERROR, "COPY from stdin failed: " + fail_message}});
+  } else {
+    SendErrorResponse(
+        {{HUMAN_READABLE_ERROR, copy_loader_->GetErrorMessage()}});
+  }
+  copy_loader_.reset();
+
+  SendReadyForQuery(txn_state_);
+  force_flush = true;
+}
+
+bool PacketManager::IsAnalyticPlan(const planner::AbstractPlan *plan) {
+  if (plan == nullptr) {
+    return false;
+  }
+  switch (plan->GetPlanNodeType()) {
+    case PLAN_NODE_TYPE_NESTLOOP:
+    case PLAN_NODE_TYPE_NESTLOOPINDEX:
+    case PLAN_NODE_TYPE_MERGEJOIN:
+    case PLAN_NODE_TYPE_HASHJOIN:
+    case PLAN_NODE_TYPE_AGGREGATE:
+    case PLAN_NODE_TYPE_AGGREGATE_V2:
+    case PLAN_NODE_TYPE_HASH:
+    case PLAN_NODE_TYPE_COPY:
+      return true;
+    case PLAN_NODE_TYPE_SEQSCAN: {
+      // A sequential scan without a predicate reads the whole table
+      auto scan = static_cast<const planner::AbstractScan *>(plan);
+      if (scan->GetPredicate() == nullptr) {
+        return true;
+      }
+    } break;
+    default:
+      break;
+  }
+  for (auto &child : plan->GetChildren()) {
+    if (IsAnalyticPlan(child.get())) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Case insensitive search for an upper case keyword in the query text
+static bool ContainsKeyword(boost::string_ref query,
+                            boost::string_ref keyword) {
+  return std::search(query.begin(), query.end(), keyword.begin(),
+                     keyword.end(), [](char query_char, char keyword_char) {
+                       return std::toupper(static_cast<unsigned char>(
+                                  query_char)) == keyword_char;
+                     }) != query.end();
+}
+
+bool PacketManager::IsAnalyticQuery(boost::string_ref query) {
+  static const boost::string_ref analytic_keywords[] = {
+      "COPY", " JOIN ", "GROUP BY", "COUNT(", "SUM(", "AVG(", "MIN(", "MAX("};
+  for (auto &keyword : analytic_keywords) {
+    if (ContainsKeyword(query, keyword)) {
+      return true;
+    }
+  }
+  // A select without a predicate reads the whole table
+  while (query.empty() == false &&
+         std::isspace(static_cast<unsigned char>(query.front()))) {
+    query.remove_prefix(1);
+  }
+  return ContainsKeyword(query.substr(0, 6), "SELECT") &&
+         ContainsKeyword(query, " FROM ") &&
+         ContainsKeyword(query, " WHERE ") == false;
+}
+
+bool PacketManager::IsWriteQuery(const std::string &query_type) {
+  return boost::iequals(query_type, "INSERT") ||
+         boost::iequals(query_type, "UPDATE") ||
+         boost::iequals(query_type, "DELETE") ||
+         boost::iequals(query_type, "COPY");
+}
+
+bool PacketManager::RejectWrite(const std::string &query_type) {
+  if (read_only_ == false || IsWriteQuery(query_type) == false) {
+    return false;
+  }
+  SendErrorResponse(
+      {{SQLSTATE_CODE_ERROR, SqlStateErrorCodeToString(
+                                 SqlStateErrorCode::READ_ONLY_SQL_TRANSACTION)},
+       {HUMAN_READABLE_ERROR, "cannot execute " +
+                                  boost::to_upper_copy(query_type) +
+                                  " on a follower"}});
+  return true;
+}
+
+WorkClass PacketManager::GetWorkClass(InputPacket *pkt) {
+  // A COPY in progress loads a whole stream of rows
+  if (copy_loader_ != nullptr) {
+    return WorkClass::ANALYTIC;
+  }
+
+  auto start = pkt->ptr;
+  WorkClass work_class = WorkClass::OLTP;
+  switch (pkt->msg_type) {
+    case SIMPLE_QUERY_COMMAND: {
+      // Classify the query in place, on the network thread
+      auto query = PacketGetStringRef(pkt, pkt->len - pkt->ptr);
+      if (IsAnalyticQuery(query)) {
+        work_class = WorkClass::ANALYTIC;
+      }
+    } break;
+    case EXECUTE_COMMAND: {
+      std::string portal_name;
+      GetStringToken(pkt, portal_name);
+      auto portal_itr = portals_.find(portal_name);
+      if (portal_itr != portals_.end() && portal_itr->second != nullptr) {
+        auto statement = portal_itr->second->GetStatement();
+        if (IsAnalyticPlan(statement->GetPlanTree().get())) {
+          work_class = WorkClass::ANALYTIC;
+        }
+      }
+    } break;
+    case COPY_DATA_COMMAND:
+    case COPY_DONE_COMMAND:
+    case COPY_FAIL_COMMAND:
+      work_class = WorkClass::ANALYTIC;
+      break;
+    default:
+      break;
+  }
+  pkt->ptr = start;
+  return work_class;
+}
+
 /*
  * process_packet - Main switch block; process incoming packets,
  *  Returns false if the session needs to be closed.
@@ -851,6 +1273,7 @@ bool PacketManager::ProcessPacket(InputPacket *pkt) {
   switch (pkt->msg_type) {
     case SIMPLE_QUERY_COMMAND: {
       LOG_TRACE("SIMPLE_QUERY_COMMAND");
+      FlushExecuteBatch();
       ExecQueryMessage(pkt);
       force_flush = true;
     } break;
@@ -872,6 +1295,8 @@ bool PacketManager::ProcessPacket(InputPacket *pkt) {
     } break;
     case SYNC_COMMAND: {
       LOG_TRACE("SYNC_COMMAND");
+      // Run what is batched so that all replies go out with one flush
+      FlushExecuteBatch();
       SendReadyForQuery(txn_state_);
       force_flush = true;
     } break;
@@ -879,13 +1304,30 @@ bool PacketManager::ProcessPacket(InputPacket *pkt) {
       LOG_TRACE("CLOSE_COMMAND");
       ExecCloseMessage(pkt);
     } break;
+    case COPY_DATA_COMMAND: {
+      LOG_TRACE("COPY_DATA_COMMAND");
+      ExecCopyDataMessage(pkt);
+    } break;
+    case COPY_DONE_COMMAND: {
+      LOG_TRACE("COPY_DONE_COMMAND");
+      ExecCopyDoneMessage(false, "");
+    } break;
+    case COPY_FAIL_COMMAND: {
+      LOG_TRACE("COPY_FAIL_COMMAND");
+      std::string fail_message;
+      GetStringToken(pkt, fail_message);
+      ExecCopyDoneMessage(true, fail_message);
+    } break;
     case TERMINATE_COMMAND: {
       LOG_TRACE("TERMINATE_COMMAND");
+      // Without a Sync, the batch is not committed
+      DiscardExecuteBatch();
       force_flush = true;
       return false;
     } break;
     case NULL: {
       LOG_TRACE("NULL");
+      DiscardExecuteBatch();
       force_flush = true;
       return false;
     } break;
@@ -927,11 +1369,22 @@ void PacketManager::SendReadyForQuery(uchar txn_status) {
   responses.push_back(std::move(pkt));
 }
 
+void PacketManager::AbortOpenTransactions() {
+  // The COPY aborts the transaction it began
+  copy_loader_.reset();
+  while (traffic_cop_->HasActiveTransaction()) {
+    traffic_cop_->AbortTransaction();
+  }
+  txn_state_ = TXN_IDLE;
+}
+
 void PacketManager::Reset() {
   client_.Reset();
   is_started = false;
   force_flush = false;
 
+  DiscardExecuteBatch();
+  copy_loader_.reset();
   responses.clear();
   unnamed_statement_.reset();
   result_format_.clear();
@@ -0,0 +1,160 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// transaction_worker_pool.cpp
+//
+// Identification: src/wire/transaction_worker_pool.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "wire/transaction_worker_pool.h"
+
+#include "common/logger.h"
+
+namespace peloton {
+namespace wire {
+
+TransactionWorkerPool::TransactionWorkerPool() : running_(false) {
+  ResetStats();
+}
+
+TransactionWorkerPool &TransactionWorkerPool::GetInstance() {
+  static TransactionWorkerPool worker_pool;
+  return worker_pool;
+}
+
+void TransactionWorkerPool::Start(size_t worker_count,
+                                  size_t analytic_worker_count) {
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  if (running_.load()) {
+    return;
+  }
+
+  // Keep at least one worker of each class
+  if (worker_count < 2) worker_count = 2;
+  if (analytic_worker_count == 0) analytic_worker_count = 1;
+  if (analytic_worker_count >= worker_count) {
+    analytic_worker_count = worker_count - 1;
+  }
+
+  LOG_INFO("Starting %lu transaction workers, %lu of them analytic",
+           worker_count, analytic_worker_count);
+  running_ = true;
+  for (size_t worker_itr = 0; worker_itr < worker_count; worker_itr++) {
+    bool analytic_worker = worker_itr < analytic_worker_count;
+    workers_.emplace_back(&TransactionWorkerPool::RunWorker, this,
+                          analytic_worker);
+  }
+}
+
+void TransactionWorkerPool::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    if (running_.load() == false) {
+      return;
+    }
+    running_ = false;
+  }
+  queue_cv_.notify_all();
+
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+
+  const char *class_names[] = {"OLTP", "analytic"};
+  for (int class_itr = 0; class_itr < 2; class_itr++) {
+    size_t executed_count = executed_count_[class_itr].load();
+    uint64_t average_micros =
+        executed_count ? total_queue_micros_[class_itr] / executed_count : 0;
+    LOG_INFO("%s work: %lu runs, queue time avg %lu us, max %lu us",
+             class_names[class_itr], executed_count, average_micros,
+             max_queue_micros_[class_itr].load());
+  }
+}
+
+void TransactionWorkerPool::Submit(WorkClass work_class,
+                                   std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    queues_[(int)work_class].push_back(
+        {std::move(task), std::chrono::steady_clock::now()});
+  }
+  // OLTP workers ignore analytic work, so wake everybody up for it
+  if (work_class == WorkClass::ANALYTIC) {
+    queue_cv_.notify_all();
+  } else {
+    queue_cv_.notify_one();
+  }
+}
+
+size_t TransactionWorkerPool::GetQueueLength(WorkClass work_class) {
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  return queues_[(int)work_class].size();
+}
+
+void TransactionWorkerPool::ResetStats() {
+  for (int class_itr = 0; class_itr < 2; class_itr++) {
+    executed_count_[class_itr] = 0;
+    total_queue_micros_[class_itr] = 0;
+    max_queue_micros_[class_itr] = 0;
+  }
+}
+
+bool TransactionWorkerPool::GetWork(bool analytic_worker, WorkItem &item,
+                                    WorkClass &work_class) {
+  std::unique_lock<std::mutex> lock(queue_mutex_);
+  auto &oltp_queue = queues_[(int)WorkClass::OLTP];
+  auto &analytic_queue = queues_[(int)WorkClass::ANALYTIC];
+
+  while (true) {
+    // Analytic workers take analytic work first
+    if (analytic_worker && analytic_queue.empty() == false) {
+      work_class = WorkClass::ANALYTIC;
+      break;
+    }
+    if (oltp_queue.empty() == false) {
+      work_class = WorkClass::OLTP;
+      break;
+    }
+    // The queued work is finished before the workers exit
+    if (running_.load() == false &&
+        (analytic_queue.empty() || analytic_worker == false)) {
+      return false;
+    }
+    queue_cv_.wait(lock);
+  }
+
+  auto &queue = queues_[(int)work_class];
+  item = std::move(queue.front());
+  queue.pop_front();
+  return true;
+}
+
+void TransactionWorkerPool::RunWorker(bool analytic_worker) {
+  WorkItem item;
+  WorkClass work_class;
+  while (GetWork(analytic_worker, item, work_class)) {
+    uint64_t queue_micros =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - item.queued_at).count();
+
+    int class_id = (int)work_class;
+    executed_count_[class_id]++;
+    total_queue_micros_[class_id] += queue_micros;
+    auto max_micros = max_queue_micros_[class_id].load();
+    while (queue_micros > max_micros &&
+           max_queue_micros_[class_id].compare_exchange_weak(
+               max_micros, queue_micros) == false) {
+    }
+
+    item.task();
+    item.task = nullptr;
+  }
+}
+
+}  // End wire namespace
+}  // End peloton namespace
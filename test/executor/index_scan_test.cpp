@@ -27,6 +27,7 @@
 #include "executor/logical_tile.h"
 #include "executor/logical_tile_factory.h"
 #include "executor/plan_executor.h"
+#include "index/index_factory.h"
 #include "optimizer/simple_optimizer.h"
 #include "parser/parser.h"
 #include "planner/create_plan.h"
@@ -173,5 +174,106 @@ TEST_F(IndexScanTests, MultiColumnPredicateTest) {
   txn_manager.CommitTransaction(txn);
 }
 
+// Index-only scan on a covering index. The committed tuples are answered
+// from the INCLUDE columns, the tuple inserted by the scanning transaction
+// itself has to go through the table.
+TEST_F(IndexScanTests, CoveringIndexOnlyTest) {
+  const int tuple_count = TESTS_TUPLES_PER_TILEGROUP;
+  std::unique_ptr<storage::DataTable> data_table(
+      ExecutorTestsUtil::CreateTable(tuple_count, false));
+  auto tuple_schema = data_table->GetSchema();
+
+  // Index on column 1 that also stores columns 0 and 2
+  std::vector<oid_t> key_attrs = {1};
+  std::vector<oid_t> include_attrs = {0, 2};
+  auto key_schema = catalog::Schema::CopySchema(tuple_schema, key_attrs);
+  key_schema->SetIndexedColumns(key_attrs);
+  auto index_metadata = new index::IndexMetadata(
+      "covering_btree_index", 125, INVALID_OID, INVALID_OID, INDEX_TYPE_BWTREE,
+      INDEX_CONSTRAINT_TYPE_DEFAULT, tuple_schema, key_schema, key_attrs, false,
+      include_attrs);
+  std::shared_ptr<index::Index> covering_index(
+      index::IndexFactory::GetIndex(index_metadata));
+  data_table->AddIndex(covering_index);
+
+  EXPECT_TRUE(index_metadata->IsCovering());
+  EXPECT_TRUE(index_metadata->IsColumnCovered(0));
+  EXPECT_TRUE(index_metadata->IsColumnCovered(1));
+  EXPECT_TRUE(index_metadata->IsColumnCovered(2));
+  EXPECT_FALSE(index_metadata->IsColumnCovered(3));
+
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto txn = txn_manager.BeginTransaction();
+  ExecutorTestsUtil::PopulateTable(data_table.get(),
+                                   tuple_count * DEFAULT_TILEGROUP_COUNT, false,
+                                   false, false, txn);
+  txn_manager.CommitTransaction(txn);
+
+  txn = txn_manager.BeginTransaction();
+
+  // Uncommitted insert of the scanning transaction
+  auto testing_pool = TestingHarness::GetInstance().GetTestingPool();
+  storage::Tuple tuple(tuple_schema, true);
+  tuple.SetValue(0, type::ValueFactory::GetIntegerValue(1000), testing_pool);
+  tuple.SetValue(1, type::ValueFactory::GetIntegerValue(5), testing_pool);
+  tuple.SetValue(2, type::ValueFactory::GetDoubleValue(1002), testing_pool);
+  tuple.SetValue(3, type::ValueFactory::GetVarcharValue("1003"),
+                 testing_pool);
+  ItemPointer *index_entry_ptr = nullptr;
+  ItemPointer tuple_slot_id =
+      data_table->InsertTuple(&tuple, txn, &index_entry_ptr);
+  txn_manager.PerformInsert(txn, tuple_slot_id, index_entry_ptr);
+
+  //===--------------------------------------------------------------------===//
+  // ATTR 1 <= 51
+  //===--------------------------------------------------------------------===//
+
+  std::vector<oid_t> column_ids({0, 2});
+  std::vector<oid_t> key_column_ids({1});
+  std::vector<ExpressionType> expr_types(
+      {ExpressionType::EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO});
+  std::vector<type::Value> values(
+      {type::ValueFactory::GetIntegerValue(51).Copy()});
+  std::vector<expression::AbstractExpression *> runtime_keys;
+
+  planner::IndexScanPlan::IndexScanDesc index_scan_desc(
+      covering_index, key_column_ids, expr_types, values, runtime_keys);
+
+  planner::IndexScanPlan node(data_table.get(), nullptr, column_ids,
+                              index_scan_desc);
+  node.SetIndexOnly(true);
+
+  std::unique_ptr<executor::ExecutorContext> context(
+      new executor::ExecutorContext(txn));
+
+  executor::IndexScanExecutor executor(&node, context.get());
+  EXPECT_TRUE(executor.Init());
+
+  // The first tile is built from the index, the second one from the table
+  EXPECT_TRUE(executor.Execute());
+  std::unique_ptr<executor::LogicalTile> index_tile(executor.GetOutput());
+  EXPECT_THAT(index_tile, NotNull());
+  EXPECT_EQ(6, index_tile->GetTupleCount());
+  EXPECT_EQ(2, index_tile->GetColumnCount());
+
+  oid_t tuple_id = 0;
+  for (auto row : *index_tile) {
+    EXPECT_EQ(ExecutorTestsUtil::PopulatedValue(tuple_id, 0),
+              index_tile->GetValue(row, 0).GetAs<int32_t>());
+    EXPECT_EQ(ExecutorTestsUtil::PopulatedValue(tuple_id, 2),
+              index_tile->GetValue(row, 1).GetAs<double>());
+    tuple_id++;
+  }
+
+  EXPECT_TRUE(executor.Execute());
+  std::unique_ptr<executor::LogicalTile> table_tile(executor.GetOutput());
+  EXPECT_THAT(table_tile, NotNull());
+  EXPECT_EQ(1, table_tile->GetTupleCount());
+
+  EXPECT_FALSE(executor.Execute());
+
+  txn_manager.CommitTransaction(txn);
+}
+
 }  // namespace test
 }  // namespace peloton
@@ -20,6 +20,7 @@
 #include "common/harness.h"
 #include "common/logger.h"
 #include "executor/insert_executor.h"
+#include "expression/parameter_value_expression.h"
 #include "expression/tuple_value_expression.h"
 #include "parser/select_statement.h"
 #include "planner/insert_plan.h"
@@ -144,5 +145,65 @@ TEST_F(InsertTests, InsertRecord) {
   txn_manager.CommitTransaction(txn);
 }
 
+TEST_F(InsertTests, InsertBatch) {
+  catalog::Catalog::GetInstance();
+
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto txn = txn_manager.BeginTransaction();
+  auto id_column = catalog::Column(
+      type::Type::INTEGER, type::Type::GetTypeSize(type::Type::INTEGER),
+      "dept_id", true);
+  auto name_column =
+      catalog::Column(type::Type::VARCHAR, 32, "dept_name", false);
+
+  std::unique_ptr<catalog::Schema> table_schema(
+      new catalog::Schema({id_column, name_column}));
+
+  catalog::Catalog::GetInstance()->CreateDatabase(DEFAULT_DB_NAME, txn);
+  catalog::Catalog::GetInstance()->CreateTable(DEFAULT_DB_NAME, "TEST_TABLE",
+                                               std::move(table_schema), txn);
+  txn_manager.CommitTransaction(txn);
+
+  auto table = catalog::Catalog::GetInstance()->GetTableWithName(
+      DEFAULT_DB_NAME, "TEST_TABLE");
+
+  // INSERT INTO TEST_TABLE VALUES ($1, 'Hello')
+  std::vector<std::vector<expression::AbstractExpression *> *> insert_values;
+  std::vector<expression::AbstractExpression *> values;
+  values.push_back(new expression::ParameterValueExpression(0));
+  values.push_back(new expression::ConstantValueExpression(
+      type::ValueFactory::GetVarcharValue("Hello")));
+  insert_values.push_back(&values);
+
+  planner::InsertPlan node(table, nullptr, &insert_values);
+  EXPECT_TRUE(node.IsBatchable());
+
+  std::vector<std::vector<type::Value>> param_rows;
+  for (int i = 0; i < 5; i++) {
+    param_rows.push_back({type::ValueFactory::GetIntegerValue(10 * i)});
+  }
+  auto batch_node = node.BindBatch(param_rows);
+  EXPECT_EQ(5, batch_node->GetBulkInsertCount());
+  EXPECT_EQ(30, batch_node->GetTuple(3)->GetValue(0).GetAs<int32_t>());
+  EXPECT_EQ("Hello", batch_node->GetTuple(3)->GetValue(1).ToString());
+
+  // The batch is inserted by a single executor
+  txn = txn_manager.BeginTransaction();
+  std::unique_ptr<executor::ExecutorContext> context(
+      new executor::ExecutorContext(txn));
+  executor::InsertExecutor executor(batch_node.get(), context.get());
+  EXPECT_TRUE(executor.Init());
+  EXPECT_TRUE(executor.Execute());
+  EXPECT_EQ(5, table->GetTupleCount());
+  txn_manager.CommitTransaction(txn);
+
+  for (auto expr : values) delete expr;
+
+  // free the database just created
+  txn = txn_manager.BeginTransaction();
+  catalog::Catalog::GetInstance()->DropDatabaseWithName(DEFAULT_DB_NAME, txn);
+  txn_manager.CommitTransaction(txn);
+}
+
 }  // End test namespace
 }  // End peloton namespace
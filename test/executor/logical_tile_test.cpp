@@ -99,6 +99,44 @@ TEST_F(LogicalTileTests, TempTableTest) {
   }
 }
 
+TEST_F(LogicalTileTests, SerializeResultsTest) {
+  auto pool = TestingHarness::GetInstance().GetTestingPool();
+
+  catalog::Schema *schema = new catalog::Schema(
+      {ExecutorTestsUtil::GetColumnInfo(0), ExecutorTestsUtil::GetColumnInfo(2),
+       ExecutorTestsUtil::GetColumnInfo(3)});
+  storage::TempTable table(INVALID_OID, schema, true);
+
+  storage::Tuple tuple(table.GetSchema(), true);
+  tuple.SetValue(0, type::ValueFactory::GetIntegerValue(258), pool);
+  tuple.SetValue(1, type::ValueFactory::GetDoubleValue(1.5), pool);
+  tuple.SetValue(2, type::ValueFactory::GetVarcharValue("abc"), pool);
+  table.InsertTuple(&tuple);
+
+  std::unique_ptr<executor::LogicalTile> logical_tile(
+      executor::LogicalTileFactory::WrapTileGroup(table.GetTileGroup(0)));
+
+  // Text format
+  std::vector<ResultType> results;
+  logical_tile->SerializeResults({0, 0, 0}, results);
+  ASSERT_EQ(3, results.size());
+  EXPECT_EQ("258", std::string(results[0].second.begin(),
+                               results[0].second.end()));
+  EXPECT_EQ("abc", std::string(results[2].second.begin(),
+                               results[2].second.end()));
+
+  // Binary format is big endian
+  results.clear();
+  logical_tile->SerializeResults({1, 1, 1}, results);
+  ASSERT_EQ(3, results.size());
+  std::vector<unsigned char> integer_bytes = {0, 0, 1, 2};
+  EXPECT_EQ(integer_bytes, results[0].second);
+  std::vector<unsigned char> double_bytes = {0x3f, 0xf8, 0, 0, 0, 0, 0, 0};
+  EXPECT_EQ(double_bytes, results[1].second);
+  EXPECT_EQ("abc", std::string(results[2].second.begin(),
+                               results[2].second.end()));
+}
+
 TEST_F(LogicalTileTests, TileMaterializationTest) {
   const int tuple_count = 4;
   std::shared_ptr<storage::TileGroup> tile_group(
@@ -205,5 +243,19 @@ TEST_F(LogicalTileTests, TileMaterializationTest) {
   LOG_TRACE("%s", logical_tile->GetInfo().c_str());
 }
 
+TEST_F(LogicalTileTests, TilePoolTest) {
+  // A released logical tile is handed out again on the same thread
+  auto reused_count = executor::LogicalTileFactory::GetReusedTileCount();
+  std::unique_ptr<executor::LogicalTile> logical_tile(
+      executor::LogicalTileFactory::GetTile());
+  logical_tile.reset();
+
+  std::unique_ptr<executor::LogicalTile> logical_tile2(
+      executor::LogicalTileFactory::GetTile());
+  EXPECT_EQ(reused_count + 1,
+            executor::LogicalTileFactory::GetReusedTileCount());
+  EXPECT_EQ(0, logical_tile2->GetColumnCount());
+}
+
 }  // End test namespace
 }  // End peloton namespace
@@ -0,0 +1,308 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// art_index_test.cpp
+//
+// Identification: test/index/art_index_test.cpp
+//
+// Copyright (c) 2015-17, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/harness.h"
+#include "gtest/gtest.h"
+
+#include "common/logger.h"
+#include "common/platform.h"
+#include "index/index_factory.h"
+#include "index/scan_optimizer.h"
+#include "storage/tuple.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// ART Index Tests
+//===--------------------------------------------------------------------===//
+
+class ArtIndexTests : public PelotonTest {};
+
+catalog::Schema *key_schema = nullptr;
+catalog::Schema *tuple_schema = nullptr;
+
+const int NUM_KEYS = 1000;
+
+/*
+ * BuildIndex() - Builds an ART index on (INTEGER, VARCHAR)
+ */
+index::Index *BuildIndex(const bool unique_keys) {
+  std::vector<catalog::Column> column_list;
+
+  catalog::Column column1(type::Type::INTEGER,
+                          type::Type::GetTypeSize(type::Type::INTEGER), "A",
+                          true);
+  catalog::Column column2(type::Type::VARCHAR, 1024, "B", false);
+
+  column_list.push_back(column1);
+  column_list.push_back(column2);
+
+  std::vector<oid_t> key_attrs = {0, 1};
+
+  key_schema = new catalog::Schema(column_list);
+  key_schema->SetIndexedColumns(key_attrs);
+  tuple_schema = new catalog::Schema(column_list);
+
+  index::IndexMetadata *index_metadata = new index::IndexMetadata(
+      "art_test_index", 125,  // Index oid
+      INVALID_OID, INVALID_OID, INDEX_TYPE_ART, INDEX_CONSTRAINT_TYPE_DEFAULT,
+      tuple_schema, key_schema, key_attrs, unique_keys);
+
+  index::Index *index = index::IndexFactory::GetIndex(index_metadata);
+  EXPECT_TRUE(index != NULL);
+  EXPECT_EQ("ART", index->GetTypeName());
+
+  return index;
+}
+
+std::unique_ptr<storage::Tuple> MakeKey(int a, const std::string &b) {
+  auto pool = TestingHarness::GetInstance().GetTestingPool();
+  std::unique_ptr<storage::Tuple> key(new storage::Tuple(key_schema, true));
+  key->SetValue(0, type::ValueFactory::GetIntegerValue(a), pool);
+  key->SetValue(1, type::ValueFactory::GetVarcharValue(b), pool);
+  return key;
+}
+
+TEST_F(ArtIndexTests, BasicTest) {
+  std::vector<ItemPointer *> location_ptrs;
+  std::unique_ptr<index::Index> index(BuildIndex(false));
+  ItemPointer item0(120, 5);
+  ItemPointer item1(120, 7);
+
+  auto key0 = MakeKey(100, "a");
+  auto key1 = MakeKey(100, "ab");
+  auto key2 = MakeKey(100, "");
+
+  EXPECT_TRUE(index->InsertEntry(key0.get(), &item0));
+  EXPECT_TRUE(index->InsertEntry(key0.get(), &item1));
+  // Same key-value pair twice
+  EXPECT_FALSE(index->InsertEntry(key0.get(), &item1));
+  EXPECT_TRUE(index->InsertEntry(key1.get(), &item1));
+  EXPECT_TRUE(index->InsertEntry(key2.get(), &item1));
+
+  index->ScanKey(key0.get(), location_ptrs);
+  EXPECT_EQ(2, location_ptrs.size());
+  location_ptrs.clear();
+
+  index->ScanKey(key2.get(), location_ptrs);
+  EXPECT_EQ(1, location_ptrs.size());
+  location_ptrs.clear();
+
+  EXPECT_TRUE(index->DeleteEntry(key0.get(), &item0));
+  EXPECT_FALSE(index->DeleteEntry(key0.get(), &item0));
+
+  index->ScanKey(key0.get(), location_ptrs);
+  EXPECT_EQ(1, location_ptrs.size());
+  EXPECT_EQ(item1.offset, location_ptrs[0]->offset);
+  location_ptrs.clear();
+
+  index->ScanAllKeys(location_ptrs);
+  EXPECT_EQ(3, location_ptrs.size());
+  location_ptrs.clear();
+
+  // A covering ART index is rejected by the factory
+  std::vector<oid_t> key_attrs = {0};
+  index::IndexMetadata *covering_metadata = new index::IndexMetadata(
+      "art_covering_index", 126, INVALID_OID, INVALID_OID, INDEX_TYPE_ART,
+      INDEX_CONSTRAINT_TYPE_DEFAULT, tuple_schema,
+      new catalog::Schema({tuple_schema->GetColumn(0)}), key_attrs, false,
+      {1});
+  EXPECT_THROW(index::IndexFactory::GetIndex(covering_metadata),
+               IndexException);
+  delete covering_metadata;
+
+  delete tuple_schema;
+}
+
+TEST_F(ArtIndexTests, RangeScanTest) {
+  std::vector<ItemPointer *> location_ptrs;
+  std::unique_ptr<index::Index> index(BuildIndex(false));
+  std::vector<std::unique_ptr<ItemPointer>> items;
+
+  // Negative and positive integers, each with two strings
+  for (int i = -NUM_KEYS / 2; i < NUM_KEYS / 2; i++) {
+    items.emplace_back(new ItemPointer(i + NUM_KEYS, 0));
+    index->InsertEntry(MakeKey(i, "x").get(), items.back().get());
+    items.emplace_back(new ItemPointer(i + NUM_KEYS, 1));
+    index->InsertEntry(MakeKey(i, "x\x01y").get(), items.back().get());
+  }
+
+  // -10 <= A <= 9
+  index->ScanTest({type::ValueFactory::GetIntegerValue(-10),
+                   type::ValueFactory::GetIntegerValue(9)},
+                  {0, 0}, {EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO,
+                           EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO},
+                  SCAN_DIRECTION_TYPE_FORWARD, location_ptrs);
+  EXPECT_EQ(40, location_ptrs.size());
+  for (size_t i = 1; i < location_ptrs.size(); i++) {
+    auto prev = location_ptrs[i - 1];
+    auto curr = location_ptrs[i];
+    EXPECT_TRUE(prev->block < curr->block ||
+                (prev->block == curr->block && prev->offset < curr->offset));
+  }
+  location_ptrs.clear();
+
+  // Same range walked backwards
+  index->ScanTest({type::ValueFactory::GetIntegerValue(-10),
+                   type::ValueFactory::GetIntegerValue(9)},
+                  {0, 0}, {EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO,
+                           EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO},
+                  SCAN_DIRECTION_TYPE_BACKWARD, location_ptrs);
+  EXPECT_EQ(40, location_ptrs.size());
+  EXPECT_EQ(9 + NUM_KEYS, location_ptrs.front()->block);
+  EXPECT_EQ(-10 + NUM_KEYS, location_ptrs.back()->block);
+  location_ptrs.clear();
+
+  // A = 3 AND B > "x"
+  index->ScanTest({type::ValueFactory::GetIntegerValue(3),
+                   type::ValueFactory::GetVarcharValue("x")},
+                  {0, 1}, {EXPRESSION_TYPE_COMPARE_EQUAL,
+                           EXPRESSION_TYPE_COMPARE_GREATERTHAN},
+                  SCAN_DIRECTION_TYPE_FORWARD, location_ptrs);
+  EXPECT_EQ(2, location_ptrs.size());
+  location_ptrs.clear();
+
+  // Point query
+  index->ScanTest({type::ValueFactory::GetIntegerValue(-1),
+                   type::ValueFactory::GetVarcharValue("x")},
+                  {0, 1}, {EXPRESSION_TYPE_COMPARE_EQUAL,
+                           EXPRESSION_TYPE_COMPARE_EQUAL},
+                  SCAN_DIRECTION_TYPE_FORWARD, location_ptrs);
+  EXPECT_EQ(1, location_ptrs.size());
+  EXPECT_EQ(-1 + NUM_KEYS, location_ptrs[0]->block);
+  location_ptrs.clear();
+
+  index->ScanAllKeys(location_ptrs);
+  EXPECT_EQ(2 * NUM_KEYS, location_ptrs.size());
+  location_ptrs.clear();
+
+  delete tuple_schema;
+}
+
+TEST_F(ArtIndexTests, ScanIteratorTest) {
+  std::unique_ptr<index::Index> index(BuildIndex(false));
+  std::vector<std::unique_ptr<ItemPointer>> items;
+
+  // Two values per key, so that batches end on whole leaves
+  for (int i = 0; i < NUM_KEYS; i++) {
+    items.emplace_back(new ItemPointer(i, 0));
+    index->InsertEntry(MakeKey(i, "x").get(), items.back().get());
+    items.emplace_back(new ItemPointer(i, 1));
+    index->InsertEntry(MakeKey(i, "x").get(), items.back().get());
+  }
+
+  // 100 <= A <= 199
+  std::vector<type::Value> values = {type::ValueFactory::GetIntegerValue(100),
+                                     type::ValueFactory::GetIntegerValue(199)};
+  std::vector<oid_t> column_ids = {0, 0};
+  std::vector<ExpressionType> expr_types = {
+      EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO,
+      EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO};
+  index::IndexScanPredicate isp{};
+  isp.AddConjunctionScanPredicate(index.get(), values, column_ids, expr_types);
+  auto csp = &isp.GetConjunctionList()[0];
+
+  for (auto direction :
+       {SCAN_DIRECTION_TYPE_FORWARD, SCAN_DIRECTION_TYPE_BACKWARD}) {
+    auto scan_itr = index->GetScanIterator(values, column_ids, expr_types,
+                                           direction, csp);
+    std::vector<ItemPointer *> location_ptrs;
+    size_t batch_count = 0;
+    while (scan_itr->Next(location_ptrs, 5) != 0) {
+      batch_count++;
+    }
+    EXPECT_EQ(0, scan_itr->Next(location_ptrs, 5));
+
+    // Each batch of 5 is rounded up to 3 leaves
+    EXPECT_EQ(200, location_ptrs.size());
+    EXPECT_EQ(34, batch_count);
+    for (size_t i = 0; i < location_ptrs.size(); i++) {
+      oid_t expected = (direction == SCAN_DIRECTION_TYPE_FORWARD)
+                           ? 100 + i / 2
+                           : 199 - i / 2;
+      EXPECT_EQ(expected, location_ptrs[i]->block);
+    }
+  }
+
+  // A key deleted ahead of the iterator is not returned
+  auto scan_itr = index->GetScanIterator(values, column_ids, expr_types,
+                                         SCAN_DIRECTION_TYPE_FORWARD, csp);
+  std::vector<ItemPointer *> location_ptrs;
+  EXPECT_EQ(2, scan_itr->Next(location_ptrs, 1));
+  EXPECT_TRUE(index->DeleteEntry(MakeKey(101, "x").get(), items[202].get()));
+  EXPECT_TRUE(index->DeleteEntry(MakeKey(101, "x").get(), items[203].get()));
+  EXPECT_EQ(2, scan_itr->Next(location_ptrs, 1));
+  EXPECT_EQ(102, location_ptrs.back()->block);
+
+  delete tuple_schema;
+}
+
+TEST_F(ArtIndexTests, CondInsertTest) {
+  std::vector<ItemPointer *> location_ptrs;
+  std::unique_ptr<index::Index> index(BuildIndex(true));
+  ItemPointer item0(1, 1);
+  ItemPointer item1(2, 2);
+
+  auto key0 = MakeKey(7, "unique");
+  auto always = [](const void *) { return true; };
+  auto never = [](const void *) { return false; };
+
+  EXPECT_TRUE(index->CondInsertEntry(key0.get(), &item0, always));
+  EXPECT_FALSE(index->CondInsertEntry(key0.get(), &item1, always));
+  EXPECT_TRUE(index->CondInsertEntry(key0.get(), &item1, never));
+
+  index->ScanKey(key0.get(), location_ptrs);
+  EXPECT_EQ(2, location_ptrs.size());
+  location_ptrs.clear();
+
+  delete tuple_schema;
+}
+
+// INSERT/DELETE HELPER FUNCTION
+void InsertDeleteTest(index::Index *index,
+                      std::vector<std::unique_ptr<ItemPointer>> *items,
+                      size_t num_threads, uint64_t thread_itr) {
+  for (int i = thread_itr; i < NUM_KEYS; i += num_threads) {
+    auto key = MakeKey(i, std::string(i % 20, 'k'));
+    EXPECT_TRUE(index->InsertEntry(key.get(), (*items)[i].get()));
+  }
+  for (int i = thread_itr; i < NUM_KEYS; i += 2 * num_threads) {
+    auto key = MakeKey(i, std::string(i % 20, 'k'));
+    EXPECT_TRUE(index->DeleteEntry(key.get(), (*items)[i].get()));
+  }
+}
+
+TEST_F(ArtIndexTests, MultiThreadedInsertDeleteTest) {
+  std::vector<ItemPointer *> location_ptrs;
+  std::unique_ptr<index::Index> index(BuildIndex(false));
+  std::vector<std::unique_ptr<ItemPointer>> items;
+  for (int i = 0; i < NUM_KEYS; i++) {
+    items.emplace_back(new ItemPointer(i, i));
+  }
+
+  size_t num_threads = 4;
+  LaunchParallelTest(num_threads, InsertDeleteTest, index.get(), &items,
+                     num_threads);
+
+  index->ScanAllKeys(location_ptrs);
+  EXPECT_EQ(NUM_KEYS / 2, location_ptrs.size());
+  location_ptrs.clear();
+
+  index->PerformGC();
+  EXPECT_GT(index->GetMemoryFootprint(), 0);
+
+  delete tuple_schema;
+}
+
+}  // End test namespace
+}  // End peloton namespace
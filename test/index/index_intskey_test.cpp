@@ -189,7 +189,11 @@ void IndexIntsKeyTestHelper(IndexType index_type,
 //  IndexIntsKeyTestHelper(INDEX_TYPE_BWTREE, col_types);
 //}
 
-TEST_F(IndexIntsKeyTests, BwTreeTest) {
+/*
+ * IndexIntsKeyCombinationsHelper() - Runs the helper on every combination of
+ *                                    one to four integer key columns
+ */
+void IndexIntsKeyCombinationsHelper(IndexType index_type) {
   std::vector<type::Type::TypeId> types = {
       type::Type::BIGINT, type::Type::INTEGER, type::Type::SMALLINT,
       type::Type::TINYINT};
@@ -197,13 +201,13 @@ TEST_F(IndexIntsKeyTests, BwTreeTest) {
   // ONE COLUMN
   for (type::Type::TypeId type0 : types) {
     std::vector<type::Type::TypeId> col_types = {type0};
-    IndexIntsKeyTestHelper(INDEX_TYPE_BWTREE, col_types);
+    IndexIntsKeyTestHelper(index_type, col_types);
   }
   // TWO COLUMNS
   for (type::Type::TypeId type0 : types) {
     for (type::Type::TypeId type1 : types) {
       std::vector<type::Type::TypeId> col_types = {type0, type1};
-      IndexIntsKeyTestHelper(INDEX_TYPE_BWTREE, col_types);
+      IndexIntsKeyTestHelper(index_type, col_types);
     }
   }
   // THREE COLUMNS
@@ -211,7 +215,7 @@ TEST_F(IndexIntsKeyTests, BwTreeTest) {
     for (type::Type::TypeId type1 : types) {
       for (type::Type::TypeId type2 : types) {
         std::vector<type::Type::TypeId> col_types = {type0, type1, type2};
-        IndexIntsKeyTestHelper(INDEX_TYPE_BWTREE, col_types);
+        IndexIntsKeyTestHelper(index_type, col_types);
       }
     }
   }
@@ -222,13 +226,21 @@ TEST_F(IndexIntsKeyTests, BwTreeTest) {
         for (type::Type::TypeId type3 : types) {
           std::vector<type::Type::TypeId> col_types = {type0, type1, type2,
                                                        type3};
-          IndexIntsKeyTestHelper(INDEX_TYPE_BWTREE, col_types);
+          IndexIntsKeyTestHelper(index_type, col_types);
         }
       }
     }
   }
 }
 
+TEST_F(IndexIntsKeyTests, BwTreeTest) {
+  IndexIntsKeyCombinationsHelper(INDEX_TYPE_BWTREE);
+}
+
+TEST_F(IndexIntsKeyTests, ArtTest) {
+  IndexIntsKeyCombinationsHelper(INDEX_TYPE_ART);
+}
+
 // FIXME: The B-Tree core dumps. If we're not going to support then we should
 // probably drop it.
 // TEST_F(IndexIntsKeyTests, BTreeTest) {
@@ -16,6 +16,7 @@
 #include "common/logger.h"
 #include "common/platform.h"
 #include "index/index_factory.h"
+#include "index/scan_optimizer.h"
 #include "storage/tuple.h"
 
 namespace peloton {
@@ -312,6 +313,175 @@ TEST_F(IndexTests, MultiMapInsertTest) {
 }
 
 #ifdef ALLOW_UNIQUE_KEY
+TEST_F(IndexTests, ScanIteratorTest) {
+  auto pool = TestingHarness::GetInstance().GetTestingPool();
+  std::unique_ptr<index::Index> index(BuildIndex(false));
+  std::vector<std::unique_ptr<ItemPointer>> items;
+
+  for (int i = 0; i < 100; i++) {
+    std::unique_ptr<storage::Tuple> key(new storage::Tuple(key_schema, true));
+    key->SetValue(0, type::ValueFactory::GetIntegerValue(i), pool);
+    key->SetValue(1, type::ValueFactory::GetVarcharValue("a"), pool);
+    items.emplace_back(new ItemPointer(i, 0));
+    index->InsertEntry(key.get(), items.back().get());
+  }
+
+  // 10 < A <= 60; the strict bound makes the scan range inexact
+  std::vector<type::Value> values = {type::ValueFactory::GetIntegerValue(10),
+                                     type::ValueFactory::GetIntegerValue(60)};
+  std::vector<oid_t> column_ids = {0, 0};
+  std::vector<ExpressionType> expr_types = {
+      EXPRESSION_TYPE_COMPARE_GREATERTHAN,
+      EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO};
+  EXPECT_FALSE(index->IsExactScanRange(column_ids, expr_types));
+  EXPECT_TRUE(index->IsExactScanRange(
+      {0, 0}, {EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO,
+               EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO}));
+  EXPECT_TRUE(index->IsExactScanRange(
+      {0, 1}, {EXPRESSION_TYPE_COMPARE_EQUAL,
+               EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO}));
+  EXPECT_FALSE(index->IsExactScanRange({1}, {EXPRESSION_TYPE_COMPARE_EQUAL}));
+
+  index::IndexScanPredicate isp{};
+  isp.AddConjunctionScanPredicate(index.get(), values, column_ids, expr_types);
+  auto csp = &isp.GetConjunctionList()[0];
+
+  for (auto direction :
+       {SCAN_DIRECTION_TYPE_FORWARD, SCAN_DIRECTION_TYPE_BACKWARD}) {
+    auto scan_itr = index->GetScanIterator(values, column_ids, expr_types,
+                                           direction, csp);
+    std::vector<ItemPointer *> location_ptrs;
+    while (scan_itr->Next(location_ptrs, 7) != 0) {
+    }
+    EXPECT_EQ(0, scan_itr->Next(location_ptrs, 7));
+
+    EXPECT_EQ(50, location_ptrs.size());
+    for (size_t i = 0; i < location_ptrs.size(); i++) {
+      oid_t expected = (direction == SCAN_DIRECTION_TYPE_FORWARD) ? 11 + i
+                                                                  : 60 - i;
+      EXPECT_EQ(expected, location_ptrs[i]->block);
+    }
+  }
+
+  // Stopping early only touches the first entries
+  auto scan_itr = index->GetScanIterator(values, column_ids, expr_types,
+                                         SCAN_DIRECTION_TYPE_FORWARD, csp);
+  std::vector<ItemPointer *> location_ptrs;
+  EXPECT_EQ(3, scan_itr->Next(location_ptrs, 3));
+  EXPECT_EQ(11, location_ptrs.front()->block);
+  EXPECT_EQ(13, location_ptrs.back()->block);
+
+  delete tuple_schema;
+}
+
+TEST_F(IndexTests, BackwardFullScanTest) {
+  auto pool = TestingHarness::GetInstance().GetTestingPool();
+  std::unique_ptr<index::Index> index(BuildIndex(false));
+  std::vector<std::unique_ptr<storage::Tuple>> keys;
+  std::vector<std::unique_ptr<ItemPointer>> items;
+
+  // Enough keys to fill several leaf pages
+  for (int i = 0; i < 1000; i++) {
+    keys.emplace_back(new storage::Tuple(key_schema, true));
+    keys.back()->SetValue(0, type::ValueFactory::GetIntegerValue(i), pool);
+    keys.back()->SetValue(1, type::ValueFactory::GetVarcharValue("a"), pool);
+    items.emplace_back(new ItemPointer(i, 0));
+    index->InsertEntry(keys.back().get(), items.back().get());
+  }
+
+  // A <> predicate can not bound the scan, so it scans the whole index
+  std::vector<type::Value> values = {type::ValueFactory::GetIntegerValue(-1)};
+  std::vector<oid_t> column_ids = {0};
+  std::vector<ExpressionType> expr_types = {
+      EXPRESSION_TYPE_COMPARE_NOTEQUAL};
+  index::IndexScanPredicate isp{};
+  isp.AddConjunctionScanPredicate(index.get(), values, column_ids, expr_types);
+  auto csp = &isp.GetConjunctionList()[0];
+  EXPECT_TRUE(csp->IsFullIndexScan());
+
+  std::vector<ItemPointer *> location_ptrs;
+  index->ScanTest(values, column_ids, expr_types, SCAN_DIRECTION_TYPE_BACKWARD,
+                  location_ptrs);
+  EXPECT_EQ(1000, location_ptrs.size());
+  EXPECT_EQ(999, location_ptrs.front()->block);
+  EXPECT_EQ(0, location_ptrs.back()->block);
+
+  // The iterator starts at the last leaf page. Entries are read as it walks
+  // back, so it never sees the ones deleted after the first few
+  auto scan_itr = index->GetScanIterator(values, column_ids, expr_types,
+                                         SCAN_DIRECTION_TYPE_BACKWARD, csp);
+  location_ptrs.clear();
+  EXPECT_EQ(3, scan_itr->Next(location_ptrs, 3));
+  EXPECT_EQ(999, location_ptrs.front()->block);
+  EXPECT_EQ(997, location_ptrs.back()->block);
+
+  for (int i = 0; i < 500; i++) {
+    index->DeleteEntry(keys[i].get(), items[i].get());
+  }
+  location_ptrs.clear();
+  while (scan_itr->Next(location_ptrs, 100) != 0) {
+  }
+  EXPECT_EQ(497, location_ptrs.size());
+  EXPECT_EQ(500, location_ptrs.back()->block);
+
+  delete tuple_schema;
+}
+
+TEST_F(IndexTests, KeyFilterTest) {
+  auto pool = TestingHarness::GetInstance().GetTestingPool();
+  std::unique_ptr<index::Index> index(BuildIndex(false));
+  std::vector<std::unique_ptr<ItemPointer>> items;
+
+  auto make_key = [&](int i) {
+    std::unique_ptr<storage::Tuple> key(new storage::Tuple(key_schema, true));
+    key->SetValue(0, type::ValueFactory::GetIntegerValue(i), pool);
+    key->SetValue(1, type::ValueFactory::GetVarcharValue("a"), pool);
+    return key;
+  };
+
+  auto count_matches = [&](int begin, int end) {
+    size_t match_count = 0;
+    for (int i = begin; i < end; i++) {
+      std::vector<ItemPointer *> location_ptrs;
+      index->ScanKey(make_key(i).get(), location_ptrs);
+      match_count += location_ptrs.size();
+    }
+    return match_count;
+  };
+
+  // Keys inserted before the filter is enabled are added to it
+  for (int i = 0; i < 100; i++) {
+    items.emplace_back(new ItemPointer(i, 0));
+    index->InsertEntry(make_key(i).get(), items.back().get());
+  }
+  EXPECT_EQ(nullptr, index->GetKeyFilter());
+  index->EnableKeyFilter();
+  ASSERT_NE(nullptr, index->GetKeyFilter());
+
+  EXPECT_EQ(100, count_matches(0, 100));
+  EXPECT_EQ(0, count_matches(100, 200));
+
+  // Growing past the capacity of the filter rebuilds it
+  for (int i = 100; i < 10000; i++) {
+    items.emplace_back(new ItemPointer(i, 0));
+    index->InsertEntry(make_key(i).get(), items.back().get());
+  }
+  EXPECT_FALSE(index->GetKeyFilter()->NeedRebuild());
+  EXPECT_EQ(10000, count_matches(0, 10000));
+  EXPECT_EQ(0, count_matches(10000, 11000));
+
+  // Deleted keys are dropped by a rebuild
+  for (int i = 0; i < 9000; i++) {
+    index->DeleteEntry(make_key(i).get(), items[i].get());
+  }
+  index->RebuildKeyFilter();
+  EXPECT_FALSE(index->GetKeyFilter()->NeedRebuild());
+  EXPECT_EQ(0, count_matches(0, 9000));
+  EXPECT_EQ(1000, count_matches(9000, 10000));
+
+  delete tuple_schema;
+}
+
 TEST_F(IndexTests, UniqueKeyDeleteTest) {
   auto pool = TestingHarness::GetInstance().GetTestingPool();
   std::vector<ItemPointer *> location_ptrs;
@@ -13,6 +13,7 @@
 
 #include "common/harness.h"
 #include "logging/circular_buffer_pool.h"
+#include "logging/log_buffer_ring.h"
 #include "logging/logging_tests_util.h"
 #include "executor/executor_tests_util.h"
 #include <stdlib.h>
@@ -89,6 +90,47 @@ TEST_F(BufferPoolTests, BufferPoolBasicTest) {
   }
 }
 
+void RingEnqueueTest(logging::LogBufferRing *ring, unsigned int count) {
+  for (unsigned int i = 0; i < count; i++) {
+    std::unique_ptr<logging::LogBuffer> buf(new logging::LogBuffer(nullptr));
+    buf->SetSize(i);
+    ring->Put(std::move(buf));
+  }
+}
+
+void RingDequeueTest(logging::LogBufferRing *ring, unsigned int count) {
+  for (unsigned int i = 0; i < count; i++) {
+    auto buf = ring->Get();
+    PL_ASSERT(buf);
+    EXPECT_EQ(buf->GetSize(), i);
+  }
+}
+
+TEST_F(BufferPoolTests, LogBufferRingTest) {
+  logging::LogBufferRing ring0;
+  EXPECT_TRUE(ring0.TryGet() == nullptr);
+
+  RingEnqueueTest(&ring0, 5);
+  EXPECT_EQ(ring0.GetSize(), 5);
+
+  RingDequeueTest(&ring0, 5);
+  EXPECT_EQ(ring0.GetSize(), 0);
+  EXPECT_TRUE(ring0.TryGet() == nullptr);
+
+  RingEnqueueTest(&ring0, BUFFER_POOL_SIZE);
+  EXPECT_EQ(ring0.GetSize(), BUFFER_POOL_SIZE);
+  EXPECT_EQ(ring0.GetFullWaitCount(), 0);
+
+  // More buffers than slots, so both sides have to wait for each other
+  unsigned int count = BUFFER_POOL_SIZE * 64;
+  logging::LogBufferRing ring1;
+  std::thread enqueue_thread(RingEnqueueTest, &ring1, count);
+  std::thread dequeue_thread(RingDequeueTest, &ring1, count);
+  enqueue_thread.join();
+  dequeue_thread.join();
+  EXPECT_EQ(ring1.GetSize(), 0);
+}
+
 TEST_F(BufferPoolTests, LogBufferBasicTest) {
   size_t tile_group_size = TESTS_TUPLES_PER_TILEGROUP;
   size_t table_tile_group_count = 3;
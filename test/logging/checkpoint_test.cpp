@@ -18,8 +18,11 @@
 #include "logging/logging_util.h"
 #include "logging/loggers/wal_backend_logger.h"
 #include "logging/checkpoint/simple_checkpoint.h"
+#include "logging/checkpoint/parallel_checkpoint.h"
+#include "logging/checkpoint/image_checkpoint.h"
 #include "logging/checkpoint_manager.h"
 #include "storage/database.h"
+#include "storage/tile_group_header.h"
 
 #include "concurrency/transaction_manager_factory.h"
 #include "executor/logical_tile_factory.h"
@@ -115,6 +118,252 @@ TEST_F(CheckpointTests, CheckpointIntegrationTest) {
   logging::LoggingUtil::RemoveDirectory("pl_checkpoint", false);
 }
 
+TEST_F(CheckpointTests, ParallelCheckpointTest) {
+  logging::LoggingUtil::RemoveDirectory("pl_checkpoint", false);
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto txn = txn_manager.BeginTransaction();
+
+  size_t tile_group_size = TESTS_TUPLES_PER_TILEGROUP;
+  size_t table_tile_group_count = 5;
+
+  oid_t default_table_oid = 13;
+  storage::DataTable *target_table =
+      ExecutorTestsUtil::CreateTable(tile_group_size, true, default_table_oid);
+  ExecutorTestsUtil::PopulateTable(target_table,
+                                   tile_group_size * table_tile_group_count,
+                                   false, false, false, txn);
+  txn_manager.CommitTransaction(txn);
+
+  // add table to catalog
+  auto catalog = catalog::Catalog::GetInstance();
+  storage::Database *db(new storage::Database(DEFAULT_DB_ID));
+  db->AddTable(target_table);
+  catalog->AddDatabase(db);
+
+  // Remember the tuples to compare them after recovery
+  std::vector<oid_t> tile_group_ids;
+  std::vector<std::vector<type::Value>> expected_values;
+  auto tile_group_count = target_table->GetTileGroupCount();
+  for (oid_t tile_group_itr = 0; tile_group_itr < tile_group_count;
+       tile_group_itr++) {
+    auto tile_group = target_table->GetTileGroup(tile_group_itr);
+    if (tile_group->GetNextTupleSlot() == 0) continue;
+    tile_group_ids.push_back(tile_group->GetTileGroupId());
+    for (oid_t tuple_itr = 0; tuple_itr < tile_group->GetNextTupleSlot();
+         tuple_itr++) {
+      std::vector<type::Value> values;
+      for (oid_t column_itr = 0; column_itr < 4; column_itr++) {
+        values.push_back(tile_group->GetValue(tuple_itr, column_itr).Copy());
+      }
+      expected_values.push_back(values);
+    }
+  }
+
+  // create a checkpoint with a couple of threads
+  auto &log_manager = logging::LogManager::GetInstance();
+  log_manager.SetGlobalMaxFlushedCommitId(txn_manager.GetNextCommitId());
+  {
+    logging::ParallelCheckpoint checkpointer(false);
+    checkpointer.SetThreadCount(3);
+    checkpointer.DoCheckpoint();
+    EXPECT_NE(INVALID_CID, checkpointer.GetMostRecentCheckpointCid());
+  }
+
+  // restart with an empty table and recover from the checkpoint
+  catalog->DropDatabaseWithOid(DEFAULT_DB_ID);
+  target_table =
+      ExecutorTestsUtil::CreateTable(tile_group_size, true, default_table_oid);
+  db = new storage::Database(DEFAULT_DB_ID);
+  db->AddTable(target_table);
+  catalog->AddDatabase(db);
+  {
+    logging::ParallelCheckpoint checkpointer(false);
+    checkpointer.SetThreadCount(3);
+    EXPECT_NE(0, checkpointer.DoRecovery());
+  }
+
+  EXPECT_EQ(db->GetTableCount(), 1);
+  EXPECT_EQ(db->GetTable(0)->GetTupleCount(),
+            tile_group_size * table_tile_group_count);
+
+  // The tile groups are recovered in parallel, so look them up by id
+  auto &catalog_manager = catalog::Manager::GetInstance();
+  size_t tuple_count = 0;
+  for (auto tile_group_id : tile_group_ids) {
+    auto tile_group = catalog_manager.GetTileGroup(tile_group_id);
+    ASSERT_TRUE(tile_group != nullptr);
+    for (oid_t tuple_itr = 0; tuple_itr < tile_group->GetNextTupleSlot();
+         tuple_itr++) {
+      auto &values = expected_values[tuple_count++];
+      for (oid_t column_itr = 0; column_itr < 4; column_itr++) {
+        EXPECT_TRUE(tile_group->GetValue(tuple_itr, column_itr)
+                        .CompareEquals(values[column_itr]) == type::CMP_TRUE);
+      }
+    }
+  }
+  EXPECT_EQ(expected_values.size(), tuple_count);
+
+  catalog->DropDatabaseWithOid(db->GetOid());
+  logging::LoggingUtil::RemoveDirectory("pl_checkpoint", false);
+}
+
+TEST_F(CheckpointTests, ImageCheckpointTest) {
+  logging::LoggingUtil::RemoveDirectory("pl_checkpoint", false);
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto txn = txn_manager.BeginTransaction();
+
+  size_t tile_group_size = TESTS_TUPLES_PER_TILEGROUP;
+  size_t table_tile_group_count = 3;
+
+  // The last column is a varchar that is not inlined
+  oid_t default_table_oid = 13;
+  storage::DataTable *target_table =
+      ExecutorTestsUtil::CreateTable(tile_group_size, true, default_table_oid);
+  ExecutorTestsUtil::PopulateTable(target_table,
+                                   tile_group_size * table_tile_group_count,
+                                   false, false, false, txn);
+  txn_manager.CommitTransaction(txn);
+
+  // add table to catalog
+  auto catalog = catalog::Catalog::GetInstance();
+  storage::Database *db(new storage::Database(DEFAULT_DB_ID));
+  db->AddTable(target_table);
+  catalog->AddDatabase(db);
+
+  // Remember the tuples to compare them after recovery
+  std::vector<oid_t> tile_group_ids;
+  std::vector<std::vector<type::Value>> expected_values;
+  auto tile_group_count = target_table->GetTileGroupCount();
+  for (oid_t tile_group_itr = 0; tile_group_itr < tile_group_count;
+       tile_group_itr++) {
+    auto tile_group = target_table->GetTileGroup(tile_group_itr);
+    if (tile_group->GetNextTupleSlot() == 0) continue;
+    tile_group_ids.push_back(tile_group->GetTileGroupId());
+    for (oid_t tuple_itr = 0; tuple_itr < tile_group->GetNextTupleSlot();
+         tuple_itr++) {
+      std::vector<type::Value> values;
+      for (oid_t column_itr = 0; column_itr < 4; column_itr++) {
+        values.push_back(tile_group->GetValue(tuple_itr, column_itr).Copy());
+      }
+      expected_values.push_back(values);
+    }
+  }
+
+  auto &log_manager = logging::LogManager::GetInstance();
+  log_manager.SetGlobalMaxFlushedCommitId(txn_manager.GetNextCommitId());
+  {
+    logging::ImageCheckpoint checkpointer(false);
+    checkpointer.DoCheckpoint();
+    EXPECT_NE(INVALID_CID, checkpointer.GetMostRecentCheckpointCid());
+  }
+
+  // restart with an empty table and map the image
+  catalog->DropDatabaseWithOid(DEFAULT_DB_ID);
+  target_table =
+      ExecutorTestsUtil::CreateTable(tile_group_size, true, default_table_oid);
+  db = new storage::Database(DEFAULT_DB_ID);
+  db->AddTable(target_table);
+  catalog->AddDatabase(db);
+  {
+    logging::ImageCheckpoint checkpointer(false);
+    checkpointer.SetThreadCount(2);
+    EXPECT_NE(0, checkpointer.DoRecovery());
+  }
+
+  EXPECT_EQ(db->GetTable(0)->GetTupleCount(),
+            tile_group_size * table_tile_group_count);
+
+  auto &catalog_manager = catalog::Manager::GetInstance();
+  size_t tuple_count = 0;
+  for (auto tile_group_id : tile_group_ids) {
+    auto tile_group = catalog_manager.GetTileGroup(tile_group_id);
+    ASSERT_TRUE(tile_group != nullptr);
+    for (oid_t tuple_itr = 0; tuple_itr < tile_group->GetNextTupleSlot();
+         tuple_itr++) {
+      auto &values = expected_values[tuple_count++];
+      for (oid_t column_itr = 0; column_itr < 4; column_itr++) {
+        EXPECT_TRUE(tile_group->GetValue(tuple_itr, column_itr)
+                        .CompareEquals(values[column_itr]) == type::CMP_TRUE);
+      }
+    }
+  }
+  EXPECT_EQ(expected_values.size(), tuple_count);
+
+  catalog->DropDatabaseWithOid(db->GetOid());
+  logging::LoggingUtil::RemoveDirectory("pl_checkpoint", false);
+}
+
+TEST_F(CheckpointTests, IndexImageTest) {
+  logging::LoggingUtil::RemoveDirectory("pl_checkpoint", false);
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto txn = txn_manager.BeginTransaction();
+
+  size_t tile_group_size = TESTS_TUPLES_PER_TILEGROUP;
+  size_t table_tile_group_count = 3;
+  size_t table_tuple_count = tile_group_size * table_tile_group_count;
+
+  oid_t default_table_oid = 13;
+  storage::DataTable *target_table =
+      ExecutorTestsUtil::CreateTable(tile_group_size, true, default_table_oid);
+  ExecutorTestsUtil::PopulateTable(target_table, table_tuple_count, false,
+                                   false, false, txn);
+  txn_manager.CommitTransaction(txn);
+
+  auto catalog = catalog::Catalog::GetInstance();
+  storage::Database *db(new storage::Database(DEFAULT_DB_ID));
+  db->AddTable(target_table);
+  catalog->AddDatabase(db);
+
+  auto &log_manager = logging::LogManager::GetInstance();
+  log_manager.SetGlobalMaxFlushedCommitId(txn_manager.GetNextCommitId());
+  {
+    logging::ImageCheckpoint checkpointer(false);
+    checkpointer.SetIndexImages(true);
+    checkpointer.DoCheckpoint();
+    EXPECT_NE(INVALID_CID, checkpointer.GetMostRecentCheckpointCid());
+  }
+
+  // restart with an empty table and load the indexes from their images
+  catalog->DropDatabaseWithOid(DEFAULT_DB_ID);
+  target_table =
+      ExecutorTestsUtil::CreateTable(tile_group_size, true, default_table_oid);
+  db = new storage::Database(DEFAULT_DB_ID);
+  db->AddTable(target_table);
+  catalog->AddDatabase(db);
+  cid_t recovered_cid;
+  {
+    logging::ImageCheckpoint checkpointer(false);
+    checkpointer.SetIndexImages(true);
+    checkpointer.SetThreadCount(2);
+    recovered_cid = checkpointer.DoRecovery();
+    EXPECT_NE(0, recovered_cid);
+  }
+  EXPECT_EQ(recovered_cid,
+            logging::CheckpointManager::GetInstance().GetIndexRecoveredCid());
+
+  // Every entry points to the indirection of its restored tuple
+  auto &catalog_manager = catalog::Manager::GetInstance();
+  EXPECT_NE(0, target_table->GetIndexCount());
+  for (oid_t index_itr = 0; index_itr < target_table->GetIndexCount();
+       index_itr++) {
+    auto index = target_table->GetIndex(index_itr);
+    EXPECT_EQ(table_tuple_count, index->GetNumberOfTuples());
+
+    std::vector<ItemPointer *> entries;
+    index->ScanAllKeys(entries);
+    EXPECT_EQ(table_tuple_count, entries.size());
+    for (auto entry : entries) {
+      auto tile_group = catalog_manager.GetTileGroup(entry->block);
+      ASSERT_TRUE(tile_group != nullptr);
+      EXPECT_EQ(entry, tile_group->GetHeader()->GetIndirection(entry->offset));
+    }
+  }
+
+  logging::CheckpointManager::GetInstance().SetIndexRecoveredCid(INVALID_CID);
+  catalog->DropDatabaseWithOid(db->GetOid());
+  logging::LoggingUtil::RemoveDirectory("pl_checkpoint", false);
+}
+
 TEST_F(CheckpointTests, CheckpointScanTest) {
   logging::LoggingUtil::RemoveDirectory("pl_checkpoint", false);
 
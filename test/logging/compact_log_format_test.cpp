@@ -0,0 +1,175 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// compact_log_format_test.cpp
+//
+// Identification: test/logging/compact_log_format_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/harness.h"
+
+#include "catalog/catalog.h"
+#include "logging/logging_util.h"
+#include "logging/records/tuple_batch_record.h"
+#include "storage/data_table.h"
+#include "storage/database.h"
+#include "storage/tuple.h"
+
+#include "executor/executor_tests_util.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Compact Log Format Tests
+//===--------------------------------------------------------------------===//
+
+class CompactLogFormatTests : public PelotonTest {};
+
+TEST_F(CompactLogFormatTests, VarintTest) {
+  std::vector<uint64_t> values = {0,          1,          127,
+                                  128,        300,        16383,
+                                  16384,      UINT32_MAX, UINT64_MAX - 1,
+                                  UINT64_MAX};
+
+  CopySerializeOutput output;
+  for (auto value : values) {
+    output.WriteVarint(value);
+  }
+
+  // Small values take a single byte
+  EXPECT_LT(output.Size(), values.size() * sizeof(uint64_t));
+
+  CopySerializeInput input(output.Data(), output.Size());
+  for (auto value : values) {
+    EXPECT_EQ(value, input.ReadVarint());
+  }
+  EXPECT_EQ(0, input.RemainingBytes());
+}
+
+TEST_F(CompactLogFormatTests, TupleBatchTest) {
+  auto table = ExecutorTestsUtil::CreateTable(1024);
+  auto catalog = catalog::Catalog::GetInstance();
+  storage::Database *db = new storage::Database(DEFAULT_DB_ID);
+  catalog->AddDatabase(db);
+  db->AddTable(table);
+
+  auto pool = TestingHarness::GetInstance().GetTestingPool();
+  auto insert_tuple = ExecutorTestsUtil::GetTuple(table, 1, pool);
+  auto update_tuple = ExecutorTestsUtil::GetTuple(table, 2, pool);
+  cid_t commit_id = 42;
+
+  logging::TupleRecord insert_record(
+      LOGRECORD_TYPE_WAL_TUPLE_INSERT, commit_id, table->GetOid(),
+      ItemPointer(100, 5), INVALID_ITEMPOINTER, insert_tuple.get(),
+      DEFAULT_DB_ID);
+
+  // Only the second column has changed
+  logging::TupleRecord update_record(
+      LOGRECORD_TYPE_WAL_TUPLE_UPDATE, commit_id, table->GetOid(),
+      ItemPointer(100, 6), ItemPointer(100, 5), update_tuple.get(),
+      DEFAULT_DB_ID);
+  update_record.SetChangedColumns({false, true, false, false});
+
+  logging::TupleRecord delete_record(
+      LOGRECORD_TYPE_WAL_TUPLE_DELETE, commit_id, table->GetOid(),
+      INVALID_ITEMPOINTER, ItemPointer(100, 6), nullptr, DEFAULT_DB_ID);
+
+  logging::TupleBatchRecord batch_record;
+  batch_record.Reset(commit_id);
+  batch_record.AddTupleRecord(insert_record);
+  batch_record.AddTupleRecord(update_record);
+  batch_record.AddTupleRecord(delete_record);
+  batch_record.SetCommit();
+  EXPECT_EQ(3, batch_record.GetRecordCount());
+
+  CopySerializeOutput output;
+  EXPECT_TRUE(batch_record.Serialize(output));
+
+  // Skip the record type and the frame length
+  size_t header_size = sizeof(char) + sizeof(int32_t);
+  cid_t read_commit_id = INVALID_CID;
+  bool read_commit = false;
+  std::vector<logging::TupleRecord *> records;
+  EXPECT_TRUE(logging::TupleBatchRecord::Deserialize(
+      batch_record.GetMessage() + header_size,
+      batch_record.GetMessageLength() - header_size, read_commit_id,
+      read_commit, records, pool));
+
+  EXPECT_EQ(commit_id, read_commit_id);
+  EXPECT_TRUE(read_commit);
+  EXPECT_EQ(3, records.size());
+
+  // The insert carries all columns
+  EXPECT_EQ(LOGRECORD_TYPE_WAL_TUPLE_INSERT, records[0]->GetType());
+  EXPECT_EQ(5, records[0]->GetInsertLocation().offset);
+  EXPECT_FALSE(records[0]->IsDelta());
+  for (oid_t column_itr = 0; column_itr < 4; column_itr++) {
+    EXPECT_TRUE(records[0]->GetTuple()->GetValue(column_itr).CompareEquals(
+                    insert_tuple->GetValue(column_itr)) == type::CMP_TRUE);
+  }
+
+  // The update only the changed column
+  EXPECT_EQ(LOGRECORD_TYPE_WAL_TUPLE_UPDATE, records[1]->GetType());
+  EXPECT_EQ(5, records[1]->GetDeleteLocation().offset);
+  EXPECT_EQ(6, records[1]->GetInsertLocation().offset);
+  EXPECT_TRUE(records[1]->IsDelta());
+  std::vector<bool> changed_columns = {false, true, false, false};
+  EXPECT_EQ(changed_columns, records[1]->GetChangedColumns());
+  EXPECT_TRUE(records[1]->GetTuple()->GetValue(1).CompareEquals(
+                  update_tuple->GetValue(1)) == type::CMP_TRUE);
+
+  EXPECT_EQ(LOGRECORD_TYPE_WAL_TUPLE_DELETE, records[2]->GetType());
+  EXPECT_EQ(6, records[2]->GetDeleteLocation().offset);
+
+  for (auto record : records) {
+    delete record->GetTuple();
+    delete record;
+  }
+
+  // The batch is smaller than the legacy records of the transaction
+  CopySerializeOutput legacy_output;
+  size_t legacy_size = 0;
+  for (auto record : {&insert_record, &update_record, &delete_record}) {
+    record->Serialize(legacy_output);
+    legacy_size += record->GetMessageLength();
+  }
+  EXPECT_LT(batch_record.GetMessageLength(), legacy_size);
+
+  catalog->DropDatabaseWithOid(DEFAULT_DB_ID);
+}
+
+TEST_F(CompactLogFormatTests, CompressionTest) {
+  // Log records are repetitive, so they compress well
+  std::vector<char> data;
+  for (int record_itr = 0; record_itr < 1000; record_itr++) {
+    std::string record = "record " + std::to_string(record_itr % 10);
+    data.insert(data.end(), record.begin(), record.end());
+  }
+
+  CopySerializeOutput output;
+  if (logging::LoggingUtil::IsCompressionAvailable() == false) {
+    EXPECT_FALSE(logging::LoggingUtil::CompressLogBlock(data.data(),
+                                                        data.size(), output));
+    return;
+  }
+
+  EXPECT_TRUE(
+      logging::LoggingUtil::CompressLogBlock(data.data(), data.size(), output));
+  EXPECT_LT(output.Size(), data.size());
+  EXPECT_EQ(LOGRECORD_TYPE_WAL_COMPRESSED_BLOCK, (LogRecordType)output.Data()[0]);
+
+  // Skip the record type and the frame length
+  size_t header_size = sizeof(char) + sizeof(int32_t);
+  std::vector<char> decompressed;
+  EXPECT_TRUE(logging::LoggingUtil::DecompressLogBlock(
+      output.Data() + header_size, output.Size() - header_size, decompressed));
+  EXPECT_EQ(data, decompressed);
+}
+
+}  // End test namespace
+}  // End peloton namespace
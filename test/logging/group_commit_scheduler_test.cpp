@@ -0,0 +1,117 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// group_commit_scheduler_test.cpp
+//
+// Identification: test/logging/group_commit_scheduler_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <thread>
+
+#include "common/harness.h"
+
+#include "logging/group_commit_scheduler.h"
+#include "statistics/histogram_metric.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Group Commit Scheduler Tests
+//===--------------------------------------------------------------------===//
+
+class GroupCommitSchedulerTests : public PelotonTest {};
+
+TEST_F(GroupCommitSchedulerTests, FlushPolicyTest) {
+  // A latency target that the test never reaches
+  logging::GroupCommitScheduler scheduler(std::chrono::seconds(3600), 1024);
+
+  // Nothing to flush, even if backends are waiting
+  EXPECT_FALSE(scheduler.HasPending());
+  EXPECT_FALSE(scheduler.ShouldFlush(0));
+  EXPECT_FALSE(scheduler.ShouldFlush(4));
+
+  // Keep batching while nobody waits and the budget is not exhausted
+  scheduler.AddPending(100, 2);
+  scheduler.AddPending(200, 3);
+  EXPECT_TRUE(scheduler.HasPending());
+  EXPECT_EQ(300, scheduler.GetPendingBytes());
+  EXPECT_EQ(5, scheduler.GetPendingCommits());
+  EXPECT_FALSE(scheduler.ShouldFlush(0));
+
+  // Waiting backends force the flush
+  EXPECT_TRUE(scheduler.ShouldFlush(1));
+
+  // So does the byte budget
+  scheduler.AddPending(724, 1);
+  EXPECT_TRUE(scheduler.ShouldFlush(0));
+
+  EXPECT_EQ(6, scheduler.Flushed());
+  EXPECT_FALSE(scheduler.HasPending());
+  EXPECT_EQ(0, scheduler.GetPendingBytes());
+  EXPECT_FALSE(scheduler.ShouldFlush(1));
+
+  // Without a budget, a zero latency target flushes on every iteration
+  logging::GroupCommitScheduler eager(std::chrono::microseconds(0), 0);
+  eager.AddPending(1UL << 30, 1);
+  EXPECT_TRUE(eager.ShouldFlush(0));
+  EXPECT_EQ(1, eager.Flushed());
+
+  // And a short one flushes once the oldest record has waited long enough
+  logging::GroupCommitScheduler timed(std::chrono::microseconds(1000), 0);
+  timed.AddPending(10, 1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  timed.AddPending(10, 1);
+  EXPECT_TRUE(timed.ShouldFlush(0));
+  EXPECT_EQ(2, timed.Flushed());
+}
+
+TEST_F(GroupCommitSchedulerTests, HistogramTest) {
+  stats::HistogramMetric histogram{MetricType::HISTOGRAM_METRIC,
+                                   "GROUP COMMIT SIZE", "txns"};
+
+  EXPECT_EQ(0, histogram.GetCount());
+  EXPECT_EQ(0, histogram.GetPercentile(50));
+
+  EXPECT_EQ(0, stats::HistogramMetric::GetBucket(0));
+  EXPECT_EQ(1, stats::HistogramMetric::GetBucket(1));
+  EXPECT_EQ(2, stats::HistogramMetric::GetBucket(2));
+  EXPECT_EQ(2, stats::HistogramMetric::GetBucket(3));
+  EXPECT_EQ(11, stats::HistogramMetric::GetBucket(1024));
+  EXPECT_EQ(stats::HistogramMetric::BUCKET_COUNT - 1,
+            stats::HistogramMetric::GetBucket(UINT64_MAX));
+
+  // 99 small batches and a single large one
+  for (int i = 0; i < 99; i++) {
+    histogram.Record(3);
+  }
+  histogram.Record(1000);
+
+  EXPECT_EQ(100, histogram.GetCount());
+  EXPECT_EQ(99 * 3 + 1000, histogram.GetSum());
+  EXPECT_EQ(99, histogram.GetBucketCount(2));
+  EXPECT_EQ(1, histogram.GetBucketCount(10));
+  EXPECT_EQ(4, histogram.GetPercentile(50));
+  EXPECT_EQ(4, histogram.GetPercentile(99));
+  EXPECT_EQ(1024, histogram.GetPercentile(100));
+
+  // Aggregating adds up the buckets
+  stats::HistogramMetric total{MetricType::HISTOGRAM_METRIC,
+                               "GROUP COMMIT SIZE", "txns"};
+  total.Aggregate(histogram);
+  total.Aggregate(histogram);
+  EXPECT_EQ(200, total.GetCount());
+  EXPECT_EQ(198, total.GetBucketCount(2));
+  LOG_INFO("%s", total.GetInfo().c_str());
+
+  total.Reset();
+  EXPECT_EQ(0, total.GetCount());
+  EXPECT_EQ(0, total.GetBucketCount(2));
+}
+
+}  // End test namespace
+}  // End peloton namespace
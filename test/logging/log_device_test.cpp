@@ -0,0 +1,99 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// log_device_test.cpp
+//
+// Identification: test/logging/log_device_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <random>
+
+#include "common/harness.h"
+
+#include "logging/log_device.h"
+#include "logging/logging_util.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Log Device Tests
+//===--------------------------------------------------------------------===//
+
+class LogDeviceTests : public PelotonTest {};
+
+static std::vector<char> ReadLogFile(const std::string &file_name) {
+  std::ifstream file(file_name, std::ios::binary);
+  return std::vector<char>(std::istreambuf_iterator<char>(file),
+                           std::istreambuf_iterator<char>());
+}
+
+TEST_F(LogDeviceTests, AppendFlushTest) {
+  std::string dir_name = "log_device_test_dir";
+  std::string file_name = dir_name + "/segment.log";
+  EXPECT_TRUE(logging::LoggingUtil::CreateDirectory(dir_name.c_str(), 0700));
+
+  auto device = logging::LogDevice::Create();
+  LOG_INFO("Using the %s log device", device->GetName());
+
+  std::mt19937 rng(0);
+
+  // Reuse the device for a couple of segments
+  for (int segment = 0; segment < 2; segment++) {
+    std::vector<char> expected;
+    EXPECT_TRUE(device->Open(file_name, 1024 * 1024));
+
+    char header[16] = {0};
+    device->Append(header, sizeof(header));
+    expected.insert(expected.end(), header, header + sizeof(header));
+
+    uint64_t last_ticket = 0;
+    for (int record = 0; record < 2000; record++) {
+      // Mostly small records, and a few that span many blocks
+      size_t size = 1 + rng() % ((record % 100 == 0) ? 100000 : 500);
+      std::vector<char> data(size);
+      for (auto &byte : data) byte = 1 + rng() % 255;
+
+      device->Append(data.data(), size);
+      expected.insert(expected.end(), data.begin(), data.end());
+
+      if (rng() % 3 == 0) {
+        auto ticket = device->Flush();
+        EXPECT_GT(ticket, last_ticket);
+        last_ticket = ticket;
+      }
+      if (rng() % 100 == 0) {
+        device->WaitForDurable(last_ticket);
+        EXPECT_GE(device->GetDurableTicket(), last_ticket);
+      }
+    }
+    EXPECT_EQ(expected.size(), device->GetSize());
+
+    // Patch the header of the segment
+    memset(header, 0x11, sizeof(header));
+    device->Overwrite(0, header, sizeof(header));
+    memcpy(expected.data(), header, sizeof(header));
+
+    device->Close();
+    EXPECT_FALSE(device->IsOpen());
+
+    // The file holds the appended bytes, followed by zeros only
+    auto contents = ReadLogFile(file_name);
+    EXPECT_GE(contents.size(), expected.size());
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), contents.begin()));
+    EXPECT_TRUE(std::all_of(contents.begin() + expected.size(), contents.end(),
+                            [](char byte) { return byte == 0; }));
+  }
+
+  EXPECT_TRUE(logging::LoggingUtil::RemoveDirectory(dir_name.c_str(), false));
+}
+
+}  // End test namespace
+}  // End peloton namespace
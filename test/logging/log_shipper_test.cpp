@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// log_shipper_test.cpp
+//
+// Identification: test/logging/log_shipper_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>
+#include <thread>
+
+#include "common/harness.h"
+
+#include "logging/log_shipper.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Log Shipper Tests
+//===--------------------------------------------------------------------===//
+
+class LogShipperTests : public PelotonTest {};
+
+// Ship a batch while the follower acknowledges it a little later
+static void ShipAcknowledged(logging::LogShipper &log_shipper,
+                             uint64_t sequence_number) {
+  std::thread follower([&log_shipper, sequence_number] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    log_shipper.Acknowledge(sequence_number);
+  });
+  log_shipper.ShipLogBatch("batch", 5);
+  follower.join();
+}
+
+TEST_F(LogShipperTests, AckTimeoutTest) {
+  auto &log_shipper = logging::LogShipper::GetInstance();
+  log_shipper.SetTestMode(true);
+  log_shipper.ResetStatistics();
+  EXPECT_TRUE(log_shipper.Start("127.0.0.1:9001", SYNC_REPLICATION));
+
+  ShipAcknowledged(log_shipper, 1);
+  EXPECT_FALSE(log_shipper.IsDegraded());
+  EXPECT_EQ(0, log_shipper.GetTimeoutCount());
+
+  // The follower hangs. The leader waits for it once, then moves on
+  log_shipper.ShipLogBatch("batch", 5);
+  EXPECT_TRUE(log_shipper.IsDegraded());
+  EXPECT_EQ(1, log_shipper.GetTimeoutCount());
+
+  auto start = std::chrono::steady_clock::now();
+  for (int batch_itr = 0; batch_itr < 10; batch_itr++) {
+    log_shipper.ShipLogBatch("batch", 5);
+  }
+  EXPECT_LT(std::chrono::steady_clock::now() - start,
+            std::chrono::milliseconds(500));
+  EXPECT_EQ(1, log_shipper.GetTimeoutCount());
+
+  // It is waited for again once it has caught up with every batch
+  log_shipper.Acknowledge(2);
+  EXPECT_TRUE(log_shipper.IsDegraded());
+  log_shipper.Acknowledge(12);
+  EXPECT_FALSE(log_shipper.IsDegraded());
+
+  ShipAcknowledged(log_shipper, 13);
+  EXPECT_FALSE(log_shipper.IsDegraded());
+  EXPECT_EQ(1, log_shipper.GetTimeoutCount());
+  EXPECT_EQ(13, log_shipper.GetShippedBatches());
+  EXPECT_EQ(13, log_shipper.GetAcknowledgedBatches());
+
+  log_shipper.Stop();
+  log_shipper.SetTestMode(false);
+}
+
+}  // End test namespace
+}  // End peloton namespace
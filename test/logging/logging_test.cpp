@@ -10,6 +10,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 #include "catalog/catalog.h"
 #include "common/harness.h"
 
@@ -371,5 +375,78 @@ TEST_F(LoggingTests, BasicLogManagerTest) {
   log_manager.EndLogging();
 }
 
+TEST_F(LoggingTests, DeferredCommitTest) {
+  peloton_logging_mode = LOGGING_TYPE_INVALID;
+  auto &log_manager = logging::LogManager::GetInstance();
+  log_manager.DropFrontendLoggers();
+  log_manager.SetLoggingStatus(LOGGING_STATUS_TYPE_INVALID);
+  peloton_logging_mode = LOGGING_TYPE_NVM_WAL;
+
+  log_manager.SetSyncCommit(true);
+  log_manager.StartStandbyMode();
+  log_manager.GetFrontendLogger(0)->SetTestMode(true);
+  log_manager.StartRecoveryMode();
+  log_manager.WaitForModeTransition(LOGGING_STATUS_TYPE_LOGGING, true);
+  log_manager.SetGlobalMaxFlushedCommitId(4);
+  cid_t commit_id = 5;
+  log_manager.PrepareLogging();
+
+  // The commit returns without waiting for the flush
+  log_manager.SetDeferFlushWait(true);
+  log_manager.LogBeginTransaction(commit_id);
+  log_manager.LogCommitTransaction(commit_id);
+  EXPECT_EQ(commit_id, log_manager.TakeDeferredCommitId());
+  EXPECT_EQ(INVALID_CID, log_manager.TakeDeferredCommitId());
+
+  // The callback runs once the commit is durable
+  std::atomic<bool> flushed(false);
+  if (log_manager.NotifyOnFlush(commit_id, [&flushed]() { flushed = true; })) {
+    while (flushed.load() == false) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  EXPECT_EQ(commit_id, log_manager.GetPersistentFlushedCommitId());
+  EXPECT_FALSE(log_manager.NotifyOnFlush(commit_id, []() {}));
+  log_manager.EndLogging();
+}
+
+TEST_F(LoggingTests, CrossThreadCommitTest) {
+  peloton_logging_mode = LOGGING_TYPE_INVALID;
+  auto &log_manager = logging::LogManager::GetInstance();
+  log_manager.DropFrontendLoggers();
+  log_manager.SetLoggingStatus(LOGGING_STATUS_TYPE_INVALID);
+  peloton_logging_mode = LOGGING_TYPE_NVM_WAL;
+
+  log_manager.SetSyncCommit(true);
+  log_manager.StartStandbyMode();
+  log_manager.GetFrontendLogger(0)->SetTestMode(true);
+  log_manager.StartRecoveryMode();
+  log_manager.WaitForModeTransition(LOGGING_STATUS_TYPE_LOGGING, true);
+
+  // The transactions begin on one thread and end on others, in reverse
+  // commit id order. The ones committed after a higher commit id still wait
+  // for their own flush, and the open one does not hold the others back
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  std::vector<concurrency::Transaction *> txns(4);
+  std::thread begin_thread([&]() {
+    for (auto &txn : txns) {
+      txn = txn_manager.BeginTransaction();
+    }
+  });
+  begin_thread.join();
+
+  cid_t commit_id = INVALID_CID;
+  for (size_t txn_itr = txns.size() - 1; txn_itr > 0; txn_itr--) {
+    commit_id = std::max(commit_id, txns[txn_itr]->GetBeginCommitId());
+    std::thread commit_thread(
+        [&]() { txn_manager.CommitTransaction(txns[txn_itr]); });
+    commit_thread.join();
+    EXPECT_GE(log_manager.GetPersistentFlushedCommitId(), commit_id);
+  }
+  std::thread abort_thread([&]() { txn_manager.AbortTransaction(txns[0]); });
+  abort_thread.join();
+  log_manager.EndLogging();
+}
+
 }  // End test namespace
 }  // End peloton namespace
@@ -17,14 +17,17 @@
 
 #include "common/harness.h"
 #include "catalog/catalog.h"
+#include "catalog/manager.h"
 
 #include "concurrency/transaction_manager_factory.h"
 #include "executor/logical_tile_factory.h"
 #include "storage/data_table.h"
 #include "storage/tile.h"
+#include "storage/tile_group.h"
 #include "logging/loggers/wal_frontend_logger.h"
 #include "logging/log_manager.h"
 #include "logging/logging_util.h"
+#include "logging/records/tuple_batch_record.h"
 #include "index/index.h"
 #include "storage/database.h"
 #include "storage/table_factory.h"
@@ -277,6 +280,319 @@ TEST_F(RecoveryTests, RestartTest) {
   catalog->DropDatabaseWithOid(DEFAULT_DB_ID);
 }
 
+TEST_F(RecoveryTests, ParallelReplayTest) {
+  auto catalog = catalog::Catalog::GetInstance();
+  auto recovery_table = ExecutorTestsUtil::CreateTable(1024);
+
+  // Enough committed records to replay them with several threads
+  size_t tile_group_size = 64;
+  size_t table_tile_group_count = 64;
+  size_t num_rows = tile_group_size * table_tile_group_count;
+  cid_t default_commit_id = INVALID_CID;
+  cid_t default_delimiter = INVALID_CID;
+  auto recovery_thread_count = peloton_recovery_thread_count;
+  peloton_recovery_thread_count = 4;
+
+  std::string dir_name = logging::WriteAheadFrontendLogger::wal_directory_path;
+
+  storage::Database *db = new storage::Database(DEFAULT_DB_ID);
+  catalog->AddDatabase(db);
+  db->AddTable(recovery_table);
+
+  std::vector<std::shared_ptr<storage::Tuple>> tuples =
+      LoggingTestsUtil::BuildTuples(recovery_table, num_rows, false, false);
+
+  // Transaction (block + 1) inserts the tuples of tile group block
+  std::vector<logging::TupleRecord> records =
+      LoggingTestsUtil::BuildTupleRecordsForRestartTest(
+          tuples, tile_group_size, table_tile_group_count, 0, 0);
+
+  logging::LoggingUtil::RemoveDirectory(dir_name.c_str(), false);
+
+  auto status = logging::LoggingUtil::CreateDirectory(dir_name.c_str(), 0700);
+  EXPECT_EQ(status, true);
+  logging::LogManager::GetInstance().SetLogDirectoryName("./");
+
+  std::string file_name = dir_name + "/" + std::string("peloton_log_0.log");
+  FILE *fp = fopen(file_name.c_str(), "wb");
+  fwrite((void *)&default_commit_id, sizeof(default_commit_id), 1, fp);
+  fwrite((void *)&default_delimiter, sizeof(default_delimiter), 1, fp);
+
+  for (size_t block = 1; block <= table_tile_group_count; block++) {
+    CopySerializeOutput output_buffer_begin;
+    logging::TransactionRecord record_begin(LOGRECORD_TYPE_TRANSACTION_BEGIN,
+                                            block + 1);
+    record_begin.Serialize(output_buffer_begin);
+    fwrite(record_begin.GetMessage(), sizeof(char),
+           record_begin.GetMessageLength(), fp);
+
+    for (size_t offset = 0; offset < tile_group_size; offset++) {
+      auto &record = records[(block - 1) * tile_group_size + offset];
+      CopySerializeOutput output_buffer;
+      record.Serialize(output_buffer);
+      fwrite(record.GetMessage(), sizeof(char), record.GetMessageLength(),
+             fp);
+    }
+
+    CopySerializeOutput output_buffer_commit;
+    logging::TransactionRecord record_commit(LOGRECORD_TYPE_TRANSACTION_COMMIT,
+                                             block + 1);
+    record_commit.Serialize(output_buffer_commit);
+    fwrite(record_commit.GetMessage(), sizeof(char),
+           record_commit.GetMessageLength(), fp);
+  }
+
+  CopySerializeOutput output_buffer_delim;
+  logging::TransactionRecord record_delim(LOGRECORD_TYPE_ITERATION_DELIMITER,
+                                          table_tile_group_count + 1);
+  record_delim.Serialize(output_buffer_delim);
+  fwrite(record_delim.GetMessage(), sizeof(char),
+         record_delim.GetMessageLength(), fp);
+  fclose(fp);
+
+  logging::WriteAheadFrontendLogger wal_fel;
+  auto &log_manager = logging::LogManager::GetInstance();
+  log_manager.SetGlobalMaxFlushedIdForRecovery(table_tile_group_count + 1);
+
+  wal_fel.DoRecovery();
+
+  EXPECT_EQ(num_rows, recovery_table->GetTupleCount());
+  EXPECT_EQ(table_tile_group_count + 1, recovery_table->GetTileGroupCount());
+
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  txn_manager.SetNextCid(table_tile_group_count + 2);
+  wal_fel.RecoverIndex();
+  for (oid_t index_itr = 0; index_itr < recovery_table->GetIndexCount();
+       index_itr++) {
+    auto index = recovery_table->GetIndex(index_itr);
+    EXPECT_EQ(num_rows, index->GetNumberOfTuples());
+  }
+
+  peloton_recovery_thread_count = recovery_thread_count;
+  status = logging::LoggingUtil::RemoveDirectory(dir_name.c_str(), false);
+  EXPECT_EQ(status, true);
+
+  catalog->DropDatabaseWithOid(DEFAULT_DB_ID);
+}
+
+TEST_F(RecoveryTests, ReplayShippedLogTest) {
+  auto catalog = catalog::Catalog::GetInstance();
+  auto recovery_table = ExecutorTestsUtil::CreateTable(1024);
+
+  size_t tile_group_size = 16;
+  size_t table_tile_group_count = 4;
+  size_t num_rows = tile_group_size * table_tile_group_count;
+
+  storage::Database *db = new storage::Database(DEFAULT_DB_ID);
+  catalog->AddDatabase(db);
+  db->AddTable(recovery_table);
+
+  std::vector<std::shared_ptr<storage::Tuple>> tuples =
+      LoggingTestsUtil::BuildTuples(recovery_table, num_rows, false, false);
+
+  // Transaction (block + 1) inserts the tuples of tile group block
+  std::vector<logging::TupleRecord> records =
+      LoggingTestsUtil::BuildTupleRecordsForRestartTest(
+          tuples, tile_group_size, table_tile_group_count, 0, 0);
+
+  auto append_transaction_record = [](std::vector<char> &batch,
+                                      LogRecordType type, cid_t commit_id) {
+    CopySerializeOutput output_buffer;
+    logging::TransactionRecord record(type, commit_id);
+    record.Serialize(output_buffer);
+    batch.insert(batch.end(), record.GetMessage(),
+                 record.GetMessage() + record.GetMessageLength());
+  };
+
+  // The leader ships what it has written between two delimiters. The first
+  // batch ends in the middle of the last transaction
+  std::vector<std::vector<char>> batches(2);
+  for (size_t block = 1; block <= table_tile_group_count; block++) {
+    append_transaction_record(batches[0], LOGRECORD_TYPE_TRANSACTION_BEGIN,
+                              block + 1);
+
+    for (size_t offset = 0; offset < tile_group_size; offset++) {
+      auto &batch = (block == table_tile_group_count &&
+                     offset >= tile_group_size / 2)
+                        ? batches[1]
+                        : batches[0];
+      auto &record = records[(block - 1) * tile_group_size + offset];
+      CopySerializeOutput output_buffer;
+      record.Serialize(output_buffer);
+      batch.insert(batch.end(), record.GetMessage(),
+                   record.GetMessage() + record.GetMessageLength());
+    }
+
+    if (block < table_tile_group_count) {
+      append_transaction_record(batches[0], LOGRECORD_TYPE_TRANSACTION_COMMIT,
+                                block + 1);
+    }
+  }
+  append_transaction_record(batches[0], LOGRECORD_TYPE_ITERATION_DELIMITER,
+                            table_tile_group_count);
+  append_transaction_record(batches[1], LOGRECORD_TYPE_TRANSACTION_COMMIT,
+                            table_tile_group_count + 1);
+  append_transaction_record(batches[1], LOGRECORD_TYPE_ITERATION_DELIMITER,
+                            table_tile_group_count + 1);
+
+  logging::WriteAheadFrontendLogger wal_fel(true);
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+
+  // Only the committed transactions are applied
+  EXPECT_TRUE(wal_fel.ReplayLog(batches[0].data(), batches[0].size()));
+  EXPECT_EQ(num_rows - tile_group_size, recovery_table->GetTupleCount());
+  EXPECT_GT(txn_manager.GetCurrentCommitId(), table_tile_group_count);
+
+  // The open transaction is committed by the next batch
+  EXPECT_TRUE(wal_fel.ReplayLog(batches[1].data(), batches[1].size()));
+  EXPECT_EQ(num_rows, recovery_table->GetTupleCount());
+  EXPECT_GT(txn_manager.GetCurrentCommitId(), table_tile_group_count + 1);
+
+  // Records of a transaction that has not begun on the follower are reported
+  EXPECT_FALSE(wal_fel.ReplayLog(batches[1].data(), batches[1].size()));
+  EXPECT_EQ(num_rows, recovery_table->GetTupleCount());
+
+  catalog->DropDatabaseWithOid(DEFAULT_DB_ID);
+}
+
+TEST_F(RecoveryTests, RecycledSlotReplayTest) {
+  auto catalog = catalog::Catalog::GetInstance();
+  auto recovery_table = ExecutorTestsUtil::CreateTable(1024);
+  auto recovery_thread_count = peloton_recovery_thread_count;
+  peloton_recovery_thread_count = 4;
+
+  storage::Database *db = new storage::Database(DEFAULT_DB_ID);
+  catalog->AddDatabase(db);
+  db->AddTable(recovery_table);
+
+  auto pool = TestingHarness::GetInstance().GetTestingPool();
+  auto old_tuple = ExecutorTestsUtil::GetTuple(recovery_table, 1, pool);
+  auto update_tuple = ExecutorTestsUtil::GetTuple(recovery_table, 2, pool);
+  auto recycled_tuple = ExecutorTestsUtil::GetTuple(recovery_table, 3, pool);
+  auto moved_tuple = ExecutorTestsUtil::GetTuple(recovery_table, 4, pool);
+  auto chained_tuple = ExecutorTestsUtil::GetTuple(recovery_table, 5, pool);
+
+  auto &manager = catalog::Manager::GetInstance();
+  oid_t block = manager.GetCurrentTileGroupId() + 1;
+  oid_t table_id = recovery_table->GetOid();
+  std::vector<char> batch;
+  auto append_batch = [&batch](logging::TupleBatchRecord &batch_record) {
+    CopySerializeOutput output;
+    EXPECT_TRUE(batch_record.Serialize(output));
+    batch.insert(batch.end(), batch_record.GetMessage(),
+                 batch_record.GetMessage() + batch_record.GetMessageLength());
+  };
+
+  // Transaction 10 inserts the old version, and enough other tuples to
+  // replay the batch with several threads
+  size_t tile_group_size = 64;
+  size_t filler_tile_group_count = 40;
+  std::vector<std::shared_ptr<storage::Tuple>> tuples =
+      LoggingTestsUtil::BuildTuples(recovery_table,
+                                    tile_group_size * filler_tile_group_count,
+                                    false, false);
+  logging::TupleBatchRecord insert_batch;
+  insert_batch.Reset(10);
+  logging::TupleRecord old_record(LOGRECORD_TYPE_WAL_TUPLE_INSERT, 10,
+                                  table_id, ItemPointer(block, 0),
+                                  INVALID_ITEMPOINTER, old_tuple.get(),
+                                  DEFAULT_DB_ID);
+  insert_batch.AddTupleRecord(old_record);
+  for (size_t tuple_itr = 0; tuple_itr < tuples.size(); tuple_itr++) {
+    logging::TupleRecord record(
+        LOGRECORD_TYPE_WAL_TUPLE_INSERT, 10, table_id,
+        ItemPointer(block + 1 + tuple_itr / tile_group_size,
+                    tuple_itr % tile_group_size),
+        INVALID_ITEMPOINTER, tuples[tuple_itr].get(), DEFAULT_DB_ID);
+    insert_batch.AddTupleRecord(record);
+  }
+  insert_batch.SetCommit();
+  append_batch(insert_batch);
+
+  // Transaction 11 only changes the second column
+  logging::TupleBatchRecord update_batch;
+  update_batch.Reset(11);
+  logging::TupleRecord update_record(
+      LOGRECORD_TYPE_WAL_TUPLE_UPDATE, 11, table_id, ItemPointer(block, 1),
+      ItemPointer(block, 0), update_tuple.get(), DEFAULT_DB_ID);
+  update_record.SetChangedColumns({false, true, false, false});
+  update_batch.AddTupleRecord(update_record);
+  update_batch.SetCommit();
+  append_batch(update_batch);
+
+  // Transaction 12 reuses the slot of the old version once it is collected
+  logging::TupleBatchRecord recycle_batch;
+  recycle_batch.Reset(12);
+  logging::TupleRecord recycled_record(
+      LOGRECORD_TYPE_WAL_TUPLE_INSERT, 12, table_id, ItemPointer(block, 0),
+      INVALID_ITEMPOINTER, recycled_tuple.get(), DEFAULT_DB_ID);
+  recycle_batch.AddTupleRecord(recycled_record);
+  recycle_batch.SetCommit();
+  append_batch(recycle_batch);
+
+  // Transaction 13 moves a filler tuple into the first tile group, changing
+  // the third column, and transaction 14 updates the moved version again
+  logging::TupleBatchRecord move_batch;
+  move_batch.Reset(13);
+  logging::TupleRecord move_record(
+      LOGRECORD_TYPE_WAL_TUPLE_UPDATE, 13, table_id, ItemPointer(block, 2),
+      ItemPointer(block + 1, 0), moved_tuple.get(), DEFAULT_DB_ID);
+  move_record.SetChangedColumns({false, false, true, false});
+  move_batch.AddTupleRecord(move_record);
+  move_batch.SetCommit();
+  append_batch(move_batch);
+
+  logging::TupleBatchRecord chain_batch;
+  chain_batch.Reset(14);
+  logging::TupleRecord chain_record(
+      LOGRECORD_TYPE_WAL_TUPLE_UPDATE, 14, table_id, ItemPointer(block, 3),
+      ItemPointer(block, 2), chained_tuple.get(), DEFAULT_DB_ID);
+  chain_record.SetChangedColumns({false, true, false, false});
+  chain_batch.AddTupleRecord(chain_record);
+  chain_batch.SetCommit();
+  append_batch(chain_batch);
+
+  CopySerializeOutput output_buffer_delim;
+  logging::TransactionRecord record_delim(LOGRECORD_TYPE_ITERATION_DELIMITER,
+                                          14);
+  record_delim.Serialize(output_buffer_delim);
+  batch.insert(batch.end(), record_delim.GetMessage(),
+               record_delim.GetMessage() + record_delim.GetMessageLength());
+
+  logging::WriteAheadFrontendLogger wal_fel(true);
+  EXPECT_TRUE(wal_fel.ReplayLog(batch.data(), batch.size()));
+
+  // The new version takes the unchanged columns from the old version, not
+  // from the tuple that reused its slot
+  auto tile_group = manager.GetTileGroup(block);
+  ASSERT_NE(nullptr, tile_group.get());
+  for (oid_t column_itr = 0; column_itr < 4; column_itr++) {
+    auto &expected = (column_itr == 1) ? update_tuple : old_tuple;
+    EXPECT_TRUE(tile_group->GetValue(1, column_itr)
+                    .CompareEquals(expected->GetValue(column_itr)) ==
+                type::CMP_TRUE);
+    EXPECT_TRUE(tile_group->GetValue(0, column_itr)
+                    .CompareEquals(recycled_tuple->GetValue(column_itr)) ==
+                type::CMP_TRUE);
+  }
+
+  // The second update of the moved tuple sees the first one, although the
+  // first one started in another tile group
+  for (oid_t column_itr = 0; column_itr < 4; column_itr++) {
+    type::Value expected = tuples[0]->GetValue(column_itr);
+    if (column_itr == 1) {
+      expected = chained_tuple->GetValue(column_itr);
+    } else if (column_itr == 2) {
+      expected = moved_tuple->GetValue(column_itr);
+    }
+    EXPECT_TRUE(tile_group->GetValue(3, column_itr).CompareEquals(expected) ==
+                type::CMP_TRUE);
+  }
+
+  peloton_recovery_thread_count = recovery_thread_count;
+  catalog->DropDatabaseWithOid(DEFAULT_DB_ID);
+}
+
 TEST_F(RecoveryTests, BasicInsertTest) {
   auto recovery_table = ExecutorTestsUtil::CreateTable(1024);
   auto catalog = catalog::Catalog::GetInstance();
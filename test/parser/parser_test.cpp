@@ -105,6 +105,9 @@ TEST_F(ParserTest, BasicTest) {
 
   queries.push_back(
       "COPY catalog_db.query_metric TO '/home/user/output.csv' DELIMITER ',';");
+  queries.push_back("COPY foo FROM STDIN;");
+  queries.push_back("COPY foo FROM STDIN WITH CSV DELIMITER ';';");
+  queries.push_back("COPY foo FROM STDIN BINARY;");
 
   // Parsing
   UNUSED_ATTRIBUTE int ii = 0;
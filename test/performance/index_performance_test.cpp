@@ -246,6 +246,32 @@ static void DeleteTest2(index::Index *index, size_t num_thread, size_t num_key,
   return;
 }
 
+/*
+ * ScanKeyTest() - Tests ScanKey() performance for each index type
+ *
+ * This function looks up the keys inserted by InsertTest2() with the same
+ * interleaved pattern, so that every thread reads keys all over the index
+ */
+static void ScanKeyTest(index::Index *index, size_t num_thread, size_t num_key,
+                        uint64_t thread_id) {
+  std::unique_ptr<storage::Tuple> key(new storage::Tuple(key_schema, true));
+  std::vector<ItemPointer *> location_ptrs;
+
+  size_t j = 0;
+  for (size_t i = thread_id; j < num_key; (i += num_thread), j++) {
+    auto key_value = type::ValueFactory::GetIntegerValue(i);
+
+    key->SetValue(0, key_value, nullptr);
+    key->SetValue(1, key_value, nullptr);
+
+    location_ptrs.clear();
+    index->ScanKey(key.get(), location_ptrs);
+    EXPECT_EQ(1, location_ptrs.size());
+  }
+
+  return;
+}
+
 /*
  * TestIndexPerformance() - Test driver for indices of a given type
  *
@@ -333,6 +359,22 @@ static void TestIndexPerformance(const IndexType &index_type) {
   timer.Stop();
   LOG_INFO("InsertTest2 :: Type=%s; Duration=%.2lf",
            IndexTypeToString(index_type).c_str(), timer.GetDuration());
+  LOG_INFO("Memory footprint :: Type=%s; Bytes=%lu",
+           IndexTypeToString(index_type).c_str(),
+           index->GetMemoryFootprint());
+
+  ///////////////////////////////////////////////////////////////////
+  // Start ScanKeyTest
+  ///////////////////////////////////////////////////////////////////
+
+  timer.Start();
+
+  LaunchParallelTest(num_thread, ScanKeyTest, index.get(), num_thread,
+                     num_key);
+
+  timer.Stop();
+  LOG_INFO("ScanKeyTest :: Type=%s; Duration=%.2lf",
+           IndexTypeToString(index_type).c_str(), timer.GetDuration());
 
   ///////////////////////////////////////////////////////////////////
   // Start DeleteTest2
@@ -368,6 +410,10 @@ TEST_F(IndexPerformanceTests, BwTreeMultiThreadedTest) {
   TestIndexPerformance(INDEX_TYPE_BWTREE);
 }
 
+TEST_F(IndexPerformanceTests, ArtMultiThreadedTest) {
+  TestIndexPerformance(INDEX_TYPE_ART);
+}
+
 // TEST_F(IndexPerformanceTests, BTreeMultiThreadedTest) {
 //  TestIndexPerformance(INDEX_TYPE_BTREE);
 //}
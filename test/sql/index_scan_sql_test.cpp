@@ -15,7 +15,9 @@
 #include "catalog/catalog.h"
 #include "common/harness.h"
 #include "executor/create_executor.h"
+#include "optimizer/simple_optimizer.h"
 #include "planner/create_plan.h"
+#include "planner/index_scan_plan.h"
 
 #include "sql/sql_tests_util.h"
 
@@ -155,5 +157,72 @@ TEST_F(IndexScanSQLTests, SQLTest) {
   txn_manager.CommitTransaction(txn);
 }
 
+TEST_F(IndexScanSQLTests, OrderByLimitTest) {
+  catalog::Catalog::GetInstance()->CreateDatabase(DEFAULT_DB_NAME, nullptr);
+
+  SQLTestsUtil::ExecuteSQLQuery(
+      "CREATE TABLE department_table(dept_id INT PRIMARY KEY, dept_name "
+      "VARCHAR);");
+  for (int i = 1; i <= 10; i++) {
+    SQLTestsUtil::ExecuteSQLQuery(
+        "INSERT INTO department_table(dept_id,dept_name) VALUES (" +
+        std::to_string(i) + ",'hello_" + std::to_string(i) + "');");
+  }
+
+  std::vector<ResultType> result;
+
+  // "Latest N" walks the primary key backward
+  std::unique_ptr<optimizer::AbstractOptimizer> optimizer(
+      new optimizer::SimpleOptimizer());
+  std::string query(
+      "SELECT dept_id, dept_name FROM department_table ORDER BY dept_id DESC "
+      "LIMIT 3;");
+  auto limit_plan = SQLTestsUtil::GeneratePlanWithOptimizer(optimizer, query);
+  EXPECT_EQ(PLAN_NODE_TYPE_LIMIT, limit_plan->GetPlanNodeType());
+  auto scan_plan = limit_plan->GetChildren()[0]->GetChildren()[0].get();
+  EXPECT_EQ(PLAN_NODE_TYPE_INDEXSCAN, scan_plan->GetPlanNodeType());
+  auto index_scan_plan = static_cast<planner::IndexScanPlan *>(scan_plan);
+  EXPECT_TRUE(index_scan_plan->GetLimit());
+  EXPECT_EQ(SCAN_DIRECTION_TYPE_BACKWARD, index_scan_plan->GetScanDirection());
+
+  SQLTestsUtil::ExecuteSQLQuery(query, result);
+  EXPECT_EQ(6, result.size());
+  EXPECT_EQ("10", SQLTestsUtil::GetResultValueAsString(result, 0));
+  EXPECT_EQ("hello_10", SQLTestsUtil::GetResultValueAsString(result, 1));
+  EXPECT_EQ("9", SQLTestsUtil::GetResultValueAsString(result, 2));
+  EXPECT_EQ("8", SQLTestsUtil::GetResultValueAsString(result, 4));
+
+  // With a range predicate
+  SQLTestsUtil::ExecuteSQLQuery(
+      "SELECT dept_id FROM department_table WHERE dept_id < 8 ORDER BY "
+      "dept_id DESC LIMIT 2;",
+      result);
+  EXPECT_EQ(2, result.size());
+  EXPECT_EQ("7", SQLTestsUtil::GetResultValueAsString(result, 0));
+  EXPECT_EQ("6", SQLTestsUtil::GetResultValueAsString(result, 1));
+
+  // Ascending with an offset
+  SQLTestsUtil::ExecuteSQLQuery(
+      "SELECT dept_id FROM department_table WHERE dept_id > 2 ORDER BY "
+      "dept_id LIMIT 2 OFFSET 1;",
+      result);
+  EXPECT_EQ(2, result.size());
+  EXPECT_EQ("4", SQLTestsUtil::GetResultValueAsString(result, 0));
+  EXPECT_EQ("5", SQLTestsUtil::GetResultValueAsString(result, 1));
+
+  // The index is not ordered on dept_name, so the limit is not pushed down
+  SQLTestsUtil::ExecuteSQLQuery(
+      "SELECT dept_id, dept_name FROM department_table WHERE dept_id > 0 "
+      "ORDER BY dept_name DESC LIMIT 1;",
+      result);
+  EXPECT_EQ(2, result.size());
+  EXPECT_EQ("hello_9", SQLTestsUtil::GetResultValueAsString(result, 1));
+
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto txn = txn_manager.BeginTransaction();
+  catalog::Catalog::GetInstance()->DropDatabaseWithName(DEFAULT_DB_NAME, txn);
+  txn_manager.CommitTransaction(txn);
+}
+
 }  // namespace test
 }  // namespace peloton
@@ -0,0 +1,146 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// plan_cache_sql_test.cpp
+//
+// Identification: test/sql/plan_cache_sql_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+
+#include "catalog/catalog.h"
+#include "common/harness.h"
+#include "tcop/plan_cache.h"
+#include "type/value_factory.h"
+
+#include "sql/sql_tests_util.h"
+
+extern bool peloton_plan_cache;
+
+namespace peloton {
+namespace test {
+
+class PlanCacheSQLTests : public PelotonTest {};
+
+TEST_F(PlanCacheSQLTests, NormalizeQueryTest) {
+  std::string normalized_query;
+  std::vector<type::Value> params;
+
+  EXPECT_TRUE(tcop::PlanCache::NormalizeQuery(
+      "SELECT a FROM t WHERE id = 5 AND name = 'x';", normalized_query,
+      params));
+  EXPECT_EQ("SELECT a FROM t WHERE id = $1 AND name = $2;", normalized_query);
+  EXPECT_EQ(2, params.size());
+  EXPECT_EQ(type::Type::INTEGER, params[0].GetTypeId());
+  EXPECT_EQ(5, params[0].GetAs<int32_t>());
+  EXPECT_EQ(type::Type::VARCHAR, params[1].GetTypeId());
+
+  std::string other_query;
+  EXPECT_TRUE(tcop::PlanCache::NormalizeQuery(
+      "SELECT a FROM t WHERE id = 7 AND name = 'y';", other_query, params));
+  EXPECT_EQ(normalized_query, other_query);
+
+  // Only the comparisons of the WHERE clause
+  EXPECT_TRUE(tcop::PlanCache::NormalizeQuery(
+      "UPDATE t SET a = 1 WHERE id = 2 + 3 ORDER BY a LIMIT 4;",
+      normalized_query, params));
+  EXPECT_EQ("UPDATE t SET a = 1 WHERE id = 2 + 3 ORDER BY a LIMIT 4;",
+            normalized_query);
+  EXPECT_EQ(0, params.size());
+
+  EXPECT_TRUE(tcop::PlanCache::NormalizeQuery(
+      "INSERT INTO t(id, a) VALUES (1, 2.5);", normalized_query, params));
+  EXPECT_EQ("INSERT INTO t(id, a) VALUES ($1, $2);", normalized_query);
+  EXPECT_EQ(type::Type::DECIMAL, params[1].GetTypeId());
+
+  // Not cached
+  EXPECT_FALSE(tcop::PlanCache::NormalizeQuery(
+      "INSERT INTO t VALUES (1, 2), (3, 4);", normalized_query, params));
+  EXPECT_FALSE(tcop::PlanCache::NormalizeQuery(
+      "SELECT a FROM t WHERE id = $1;", normalized_query, params));
+  EXPECT_FALSE(tcop::PlanCache::NormalizeQuery("CREATE TABLE t(id INT);",
+                                               normalized_query, params));
+}
+
+TEST_F(PlanCacheSQLTests, SQLTest) {
+  catalog::Catalog::GetInstance()->CreateDatabase(DEFAULT_DB_NAME, nullptr);
+  auto &plan_cache = tcop::PlanCache::GetInstance();
+  plan_cache.Clear();
+  peloton_plan_cache = true;
+
+  SQLTestsUtil::ExecuteSQLQuery(
+      "CREATE TABLE department_table(dept_id INT PRIMARY KEY, dept_name "
+      "VARCHAR);");
+  for (int i = 1; i <= 10; i++) {
+    SQLTestsUtil::ExecuteSQLQuery(
+        "INSERT INTO department_table(dept_id,dept_name) VALUES (" +
+        std::to_string(i) + ",'hello_" + std::to_string(i) + "');");
+  }
+  // The inserts share one plan
+  EXPECT_EQ(1, plan_cache.GetSize());
+  EXPECT_EQ(9, plan_cache.GetHitCount());
+
+  std::vector<ResultType> result;
+  for (int i = 1; i <= 10; i++) {
+    SQLTestsUtil::ExecuteSQLQuery(
+        "SELECT dept_name FROM department_table WHERE dept_id = " +
+            std::to_string(i) + ";",
+        result);
+    EXPECT_EQ(1, result.size());
+    EXPECT_EQ("hello_" + std::to_string(i),
+              SQLTestsUtil::GetResultValueAsString(result, 0));
+  }
+  EXPECT_EQ(2, plan_cache.GetSize());
+  EXPECT_EQ(18, plan_cache.GetHitCount());
+
+  SQLTestsUtil::ExecuteSQLQuery(
+      "SELECT COUNT(*) FROM department_table WHERE dept_id < 4;", result);
+  EXPECT_EQ("3", SQLTestsUtil::GetResultValueAsString(result, 0));
+  SQLTestsUtil::ExecuteSQLQuery(
+      "SELECT COUNT(*) FROM department_table WHERE dept_id < 8;", result);
+  EXPECT_EQ("7", SQLTestsUtil::GetResultValueAsString(result, 0));
+
+  SQLTestsUtil::ExecuteSQLQuery(
+      "UPDATE department_table SET dept_name = 'updated' WHERE dept_id = 3;");
+  SQLTestsUtil::ExecuteSQLQuery(
+      "SELECT dept_name FROM department_table WHERE dept_id = 3;", result);
+  EXPECT_EQ("updated", SQLTestsUtil::GetResultValueAsString(result, 0));
+
+  SQLTestsUtil::ExecuteSQLQuery(
+      "DELETE FROM department_table WHERE dept_id = 4;");
+  SQLTestsUtil::ExecuteSQLQuery(
+      "SELECT dept_name FROM department_table WHERE dept_id = 4;", result);
+  EXPECT_EQ(0, result.size());
+
+  // Invalidating the table drops its plans
+  auto table = catalog::Catalog::GetInstance()->GetTableWithName(
+      DEFAULT_DB_NAME, "department_table");
+  plan_cache.InvalidateTable(table->GetOid());
+  EXPECT_EQ(0, plan_cache.GetSize());
+
+  SQLTestsUtil::ExecuteSQLQuery(
+      "SELECT dept_name FROM department_table WHERE dept_id = 5;", result);
+  EXPECT_EQ("hello_5", SQLTestsUtil::GetResultValueAsString(result, 0));
+  EXPECT_EQ(1, plan_cache.GetSize());
+
+  // DDL moves to a new catalog version
+  auto catalog_version = plan_cache.GetCatalogVersion();
+  SQLTestsUtil::ExecuteSQLQuery("CREATE TABLE other_table(id INT);");
+  EXPECT_EQ(catalog_version + 1, plan_cache.GetCatalogVersion());
+
+  peloton_plan_cache = false;
+  plan_cache.Clear();
+
+  // free the database just created
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto txn = txn_manager.BeginTransaction();
+  catalog::Catalog::GetInstance()->DropDatabaseWithName(DEFAULT_DB_NAME, txn);
+  txn_manager.CommitTransaction(txn);
+}
+
+}  // namespace test
+}  // namespace peloton
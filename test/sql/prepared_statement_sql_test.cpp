@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// prepared_statement_sql_test.cpp
+//
+// Identification: test/sql/prepared_statement_sql_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+
+#include "catalog/catalog.h"
+#include "common/harness.h"
+#include "executor/plan_executor.h"
+#include "planner/abstract_plan.h"
+#include "type/value_factory.h"
+
+#include "sql/sql_tests_util.h"
+
+namespace peloton {
+namespace test {
+
+class PreparedStatementSQLTests : public PelotonTest {};
+
+TEST_F(PreparedStatementSQLTests, ExecutorTreeTest) {
+  catalog::Catalog::GetInstance()->CreateDatabase(DEFAULT_DB_NAME, nullptr);
+
+  SQLTestsUtil::ExecuteSQLQuery(
+      "CREATE TABLE department_table(dept_id INT PRIMARY KEY, dept_name "
+      "VARCHAR);");
+  for (int i = 1; i <= 10; i++) {
+    SQLTestsUtil::ExecuteSQLQuery(
+        "INSERT INTO department_table(dept_id,dept_name) VALUES (" +
+        std::to_string(i) + ",'hello_" + std::to_string(i) + "');");
+  }
+
+  auto &traffic_cop = SQLTestsUtil::traffic_cop_;
+  std::string error_message;
+  auto statement = traffic_cop.PrepareStatement(
+      "select_dept",
+      "SELECT dept_name FROM department_table WHERE dept_id = $1;",
+      error_message);
+  ASSERT_NE(nullptr, statement.get());
+  EXPECT_TRUE(bridge::ExecutorTree::IsReusable(statement->GetPlanTree().get()));
+
+  // Every execution rebinds the same executor tree
+  std::vector<ResultType> result;
+  std::vector<int> result_format(1, 0);
+  int rows_changed;
+  for (int i = 1; i <= 10; i++) {
+    std::vector<type::Value> params = {type::ValueFactory::GetIntegerValue(i)};
+    statement->GetPlanTree()->SetParameterValues(&params);
+    auto status = traffic_cop.ExecuteStatement(
+        statement, params, false, nullptr, result_format, result, rows_changed,
+        error_message);
+    EXPECT_EQ(Result::RESULT_SUCCESS, status);
+    EXPECT_EQ(1, result.size());
+    EXPECT_EQ("hello_" + std::to_string(i),
+              SQLTestsUtil::GetResultValueAsString(result, 0));
+  }
+  ASSERT_NE(nullptr, statement->GetExecutorTree());
+  EXPECT_EQ(10, statement->GetExecutorTree()->GetExecutionCount());
+
+  // So does an update
+  auto update_statement = traffic_cop.PrepareStatement(
+      "update_dept",
+      "UPDATE department_table SET dept_name = 'updated' WHERE dept_id = $1;",
+      error_message);
+  ASSERT_NE(nullptr, update_statement.get());
+  for (int i = 1; i <= 3; i++) {
+    std::vector<type::Value> params = {type::ValueFactory::GetIntegerValue(i)};
+    update_statement->GetPlanTree()->SetParameterValues(&params);
+    auto status = traffic_cop.ExecuteStatement(
+        update_statement, params, false, nullptr, std::vector<int>(), result,
+        rows_changed, error_message);
+    EXPECT_EQ(Result::RESULT_SUCCESS, status);
+    EXPECT_EQ(1, rows_changed);
+  }
+  EXPECT_EQ(3, update_statement->GetExecutorTree()->GetExecutionCount());
+
+  SQLTestsUtil::ExecuteSQLQuery(
+      "SELECT COUNT(*) FROM department_table WHERE dept_name = 'updated';",
+      result);
+  EXPECT_EQ("3", SQLTestsUtil::GetResultValueAsString(result, 0));
+
+  // A new plan gets a new executor tree
+  statement->SetPlanTree(statement->GetPlanTree());
+  EXPECT_EQ(nullptr, statement->GetExecutorTree());
+
+  // free the database just created
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto txn = txn_manager.BeginTransaction();
+  catalog::Catalog::GetInstance()->DropDatabaseWithName(DEFAULT_DB_NAME, txn);
+  txn_manager.CommitTransaction(txn);
+}
+
+}  // namespace test
+}  // namespace peloton
@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// statement_list_sql_test.cpp
+//
+// Identification: test/sql/statement_list_sql_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+
+#include "catalog/catalog.h"
+#include "common/harness.h"
+
+#include "sql/sql_tests_util.h"
+
+namespace peloton {
+namespace test {
+
+class StatementListSQLTests : public PelotonTest {};
+
+TEST_F(StatementListSQLTests, OneTransactionTest) {
+  catalog::Catalog::GetInstance()->CreateDatabase(DEFAULT_DB_NAME, nullptr);
+
+  SQLTestsUtil::ExecuteSQLQuery(
+      "CREATE TABLE list_table(id INT PRIMARY KEY, name VARCHAR);");
+
+  auto &traffic_cop = SQLTestsUtil::traffic_cop_;
+  std::string error_message;
+
+  // The query string is parsed once and every statement is planned
+  std::vector<std::string> queries = {
+      "INSERT INTO list_table VALUES (1, 'one')",
+      " INSERT INTO list_table VALUES (2, 'two')",
+      " SELECT name FROM list_table WHERE id = 2"};
+  std::vector<std::shared_ptr<Statement>> statements;
+  EXPECT_TRUE(traffic_cop.PrepareStatementList(
+      queries[0] + ";" + queries[1] + ";" + queries[2] + ";", queries,
+      statements, error_message));
+  ASSERT_EQ(3, statements.size());
+  EXPECT_EQ("INSERT", statements[0]->GetQueryType());
+  EXPECT_EQ(1, statements[2]->GetTupleDescriptor().size());
+
+  std::vector<std::vector<ResultType>> results;
+  std::vector<int> rows_changed;
+  EXPECT_EQ(Result::RESULT_SUCCESS,
+            traffic_cop.ExecuteStatementList(statements, results, rows_changed,
+                                             error_message));
+  ASSERT_EQ(3, results.size());
+  EXPECT_EQ(1, rows_changed[0]);
+  EXPECT_EQ(1, rows_changed[1]);
+  EXPECT_EQ("two", SQLTestsUtil::GetResultValueAsString(results[2], 0));
+
+  // A failure rolls back the statements before it
+  queries = {"INSERT INTO list_table VALUES (3, 'three')",
+             "INSERT INTO list_table VALUES (1, 'again')"};
+  statements.clear();
+  EXPECT_TRUE(traffic_cop.PrepareStatementList(
+      queries[0] + ";" + queries[1] + ";", queries, statements,
+      error_message));
+  results.clear();
+  rows_changed.clear();
+  EXPECT_NE(Result::RESULT_SUCCESS,
+            traffic_cop.ExecuteStatementList(statements, results, rows_changed,
+                                             error_message));
+  EXPECT_EQ(1, results.size());
+
+  std::vector<ResultType> result;
+  SQLTestsUtil::ExecuteSQLQuery("SELECT COUNT(*) FROM list_table;", result);
+  EXPECT_EQ("2", SQLTestsUtil::GetResultValueAsString(result, 0));
+
+  // The statements must match the query texts
+  statements.clear();
+  EXPECT_FALSE(traffic_cop.PrepareStatementList(
+      "DELETE FROM list_table WHERE id = 1; DELETE FROM list_table;",
+      {"DELETE FROM list_table WHERE id = 1"}, statements, error_message));
+  EXPECT_TRUE(statements.empty());
+
+  // free the database just created
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto txn = txn_manager.BeginTransaction();
+  catalog::Catalog::GetInstance()->DropDatabaseWithName(DEFAULT_DB_NAME, txn);
+  txn_manager.CommitTransaction(txn);
+}
+
+}  // namespace test
+}  // namespace peloton
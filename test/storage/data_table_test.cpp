@@ -71,6 +71,61 @@ TEST_F(DataTableTests, TransformTileGroupTest) {
   data_table->TransformTileGroup(0, theta);
 }
 
+TEST_F(DataTableTests, InsertTuplesTest) {
+  // A batch spans several tile groups
+  const int tuple_count = 3 * TESTS_TUPLES_PER_TILEGROUP + 2;
+
+  std::unique_ptr<storage::DataTable> data_table(
+      ExecutorTestsUtil::CreateTable(TESTS_TUPLES_PER_TILEGROUP, true));
+  auto tile_group_count = data_table->GetTileGroupCount();
+  auto testing_pool = TestingHarness::GetInstance().GetTestingPool();
+
+  std::vector<std::unique_ptr<storage::Tuple>> tuples;
+  std::vector<const storage::Tuple *> tuple_ptrs;
+  for (int tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+    tuples.push_back(ExecutorTestsUtil::GetTuple(data_table.get(), tuple_itr,
+                                                 testing_pool));
+    tuple_ptrs.push_back(tuples.back().get());
+  }
+
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto txn = txn_manager.BeginTransaction();
+  std::vector<ItemPointer> locations;
+  EXPECT_TRUE(data_table->InsertTuples(tuple_ptrs, txn, locations));
+  EXPECT_EQ(Result::RESULT_SUCCESS, txn_manager.CommitTransaction(txn));
+
+  EXPECT_EQ(tuple_count, locations.size());
+  EXPECT_EQ(tuple_count, data_table->GetTupleCount());
+  EXPECT_LT(tile_group_count, data_table->GetTileGroupCount());
+  for (int tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+    auto tile_group = data_table->GetTileGroupById(locations[tuple_itr].block);
+    EXPECT_EQ(ExecutorTestsUtil::PopulatedValue(tuple_itr, 0),
+              tile_group->GetValue(locations[tuple_itr].offset, 0)
+                  .GetAs<int32_t>());
+  }
+
+  // Every index got every tuple
+  for (oid_t index_itr = 0; index_itr < data_table->GetIndexCount();
+       index_itr++) {
+    std::vector<ItemPointer *> index_entries;
+    data_table->GetIndex(index_itr)->ScanAllKeys(index_entries);
+    EXPECT_EQ(tuple_count, index_entries.size());
+  }
+
+  // A key that shows up twice within the batch violates the primary key
+  std::vector<std::unique_ptr<storage::Tuple>> duplicates;
+  duplicates.push_back(
+      ExecutorTestsUtil::GetTuple(data_table.get(), tuple_count, testing_pool));
+  duplicates.push_back(
+      ExecutorTestsUtil::GetTuple(data_table.get(), tuple_count, testing_pool));
+  tuple_ptrs = {duplicates[0].get(), duplicates[1].get()};
+
+  txn = txn_manager.BeginTransaction();
+  EXPECT_FALSE(data_table->InsertTuples(tuple_ptrs, txn, locations));
+  txn_manager.SetTransactionResult(txn, Result::RESULT_FAILURE);
+  EXPECT_EQ(Result::RESULT_ABORTED, txn_manager.AbortTransaction(txn));
+}
+
 std::unique_ptr<storage::DataTable> data_table_test_table;
 
 TEST_F(DataTableTests, GlobalTableTest) {
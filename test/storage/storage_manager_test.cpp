@@ -15,6 +15,12 @@
 
 #include "storage/storage_manager.h"
 
+extern peloton::LoggingType peloton_logging_mode;
+
+extern size_t peloton_data_file_size;
+
+extern bool peloton_nvm_emulation;
+
 namespace peloton {
 namespace test {
 
@@ -55,5 +61,54 @@ TEST_F(StorageManagerTests, BasicTest) {
   }
 }
 
+/**
+ * Emulated NVM lives in the data file and only the dirty cache lines are
+ * synced
+ */
+TEST_F(StorageManagerTests, EmulatedNVMTest) {
+  auto logging_mode = peloton_logging_mode;
+  peloton_logging_mode = LOGGING_TYPE_NVM_WBL;
+  peloton_data_file_size = 4;
+  peloton_nvm_emulation = true;
+
+  {
+    peloton::storage::StorageManager storage_manager;
+    EXPECT_TRUE(storage_manager.IsEmulatingNVM());
+
+    // Allocations start on a cache line
+    size_t length = 200;
+    auto first = reinterpret_cast<char *>(
+        storage_manager.Allocate(BACKEND_TYPE_NVM, length));
+    auto second = reinterpret_cast<char *>(
+        storage_manager.Allocate(BACKEND_TYPE_NVM, length));
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(first) % 64);
+    EXPECT_EQ(256, second - first);
+    PL_MEMSET(first, '-', length);
+    PL_MEMSET(second, '-', length);
+
+    // Overlapping ranges are merged into whole cache lines
+    auto address = reinterpret_cast<uintptr_t>(first);
+    std::vector<storage::DirtyRange> ranges = {
+        {address + 5, address + 70},
+        {address, address + 10},
+        {address + 256 + 100, address + 256 + 101}};
+    storage_manager.SyncRanges(BACKEND_TYPE_NVM, ranges);
+
+    EXPECT_EQ(2, ranges.size());
+    EXPECT_EQ(192, storage_manager.GetSyncedBytes());
+    EXPECT_EQ(1, storage_manager.GetClflushCount());
+
+    // Both lines are on the first page of the file
+    EXPECT_EQ(1, storage_manager.GetMsyncCount());
+
+    storage_manager.Release(BACKEND_TYPE_NVM, first);
+    storage_manager.Release(BACKEND_TYPE_NVM, second);
+  }
+
+  peloton_nvm_emulation = false;
+  peloton_data_file_size = 0;
+  peloton_logging_mode = logging_mode;
+}
+
 }  // End test namespace
 }  // End peloton namespace
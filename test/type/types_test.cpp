@@ -215,7 +215,8 @@ TEST_F(TypesTests, ExpressionTypeTest) {
 
 TEST_F(TypesTests, IndexTypeTest) {
   std::vector<IndexType> list = {INDEX_TYPE_INVALID,
-                                 INDEX_TYPE_BWTREE, INDEX_TYPE_HASH};
+                                 INDEX_TYPE_BWTREE, INDEX_TYPE_HASH,
+                                 INDEX_TYPE_ART};
 
   // Make sure that ToString and FromString work
   for (auto val : list) {
@@ -422,10 +423,13 @@ TEST_F(TypesTests, LogRecordTypeTest) {
       LOGRECORD_TYPE_WAL_TUPLE_INSERT,
       LOGRECORD_TYPE_WAL_TUPLE_DELETE,
       LOGRECORD_TYPE_WAL_TUPLE_UPDATE,
+      LOGRECORD_TYPE_WAL_TUPLE_BATCH,
+      LOGRECORD_TYPE_WAL_COMPRESSED_BLOCK,
       LOGRECORD_TYPE_WBL_TUPLE_INSERT,
       LOGRECORD_TYPE_WBL_TUPLE_DELETE,
       LOGRECORD_TYPE_WBL_TUPLE_UPDATE,
       LOGRECORD_TYPE_ITERATION_DELIMITER,
+      LOGRECORD_TYPE_COMPACT_ITERATION_DELIMITER,
   };
 
   // Make sure that ToString and FromString work
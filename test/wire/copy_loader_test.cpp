@@ -0,0 +1,182 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// copy_loader_test.cpp
+//
+// Identification: test/wire/copy_loader_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <arpa/inet.h>
+
+#include "catalog/catalog.h"
+#include "common/harness.h"
+#include "concurrency/transaction_manager_factory.h"
+#include "tcop/tcop.h"
+#include "wire/copy_loader.h"
+
+#include "sql/sql_tests_util.h"
+
+// Commit every tile group chunk of a COPY on its own (not all-or-nothing)
+extern bool peloton_copy_chunk_commit;
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Copy Loader Tests
+//===--------------------------------------------------------------------===//
+
+class CopyLoaderTests : public PelotonTest {};
+
+static void AppendShort(std::string &buf, int16_t value) {
+  value = htons(value);
+  buf.append(reinterpret_cast<char *>(&value), sizeof(int16_t));
+}
+
+static void AppendInt(std::string &buf, int32_t value) {
+  value = htonl(value);
+  buf.append(reinterpret_cast<char *>(&value), sizeof(int32_t));
+}
+
+static std::string GetName(int id) {
+  std::vector<ResultType> result;
+  SQLTestsUtil::ExecuteSQLQuery(
+      "SELECT name FROM copy_table WHERE id = " + std::to_string(id) + ";",
+      result);
+  if (result.empty()) return "<none>";
+  return SQLTestsUtil::GetResultValueAsString(result, 0);
+}
+
+TEST_F(CopyLoaderTests, LoadTest) {
+  catalog::Catalog::GetInstance()->CreateDatabase(DEFAULT_DB_NAME, nullptr);
+  SQLTestsUtil::ExecuteSQLQuery(
+      "CREATE TABLE copy_table(id INT PRIMARY KEY, name VARCHAR);");
+  auto table = catalog::Catalog::GetInstance()->GetTableWithName(
+      DEFAULT_DB_NAME, "copy_table");
+  tcop::TrafficCop traffic_cop;
+
+  // Text rows that are split across messages
+  wire::CopyLoader text_loader(table, COPY_TYPE_IMPORT_TSV, '\t',
+                               &traffic_cop);
+  std::string text("1\tone\n2\ttw");
+  EXPECT_TRUE(text_loader.Consume(text.data(), text.size()));
+  text = "o\\ttab\n3\t\\N\n\\.\n";
+  EXPECT_TRUE(text_loader.Consume(text.data(), text.size()));
+  EXPECT_TRUE(text_loader.Finish());
+  EXPECT_EQ(3, text_loader.GetRowCount());
+  EXPECT_EQ("one", GetName(1));
+  EXPECT_EQ("two\ttab", GetName(2));
+
+  // Quoted CSV fields, the last row has no newline
+  wire::CopyLoader csv_loader(table, COPY_TYPE_IMPORT_CSV, ',', &traffic_cop);
+  std::string csv("4,\"a, \"\"quoted\"\"\nvalue\"\r\n5,");
+  EXPECT_TRUE(csv_loader.Consume(csv.data(), csv.size()));
+  csv = "\"\"";
+  EXPECT_TRUE(csv_loader.Consume(csv.data(), csv.size()));
+  EXPECT_TRUE(csv_loader.Finish());
+  EXPECT_EQ(2, csv_loader.GetRowCount());
+  EXPECT_EQ("a, \"quoted\"\nvalue", GetName(4));
+  EXPECT_EQ("", GetName(5));
+
+  // Binary rows
+  std::string binary("PGCOPY\n\377\r\n", 11);
+  AppendInt(binary, 0);
+  AppendInt(binary, 0);
+  AppendShort(binary, 2);
+  AppendInt(binary, 4);
+  AppendInt(binary, 6);
+  AppendInt(binary, 3);
+  binary.append("six");
+  AppendShort(binary, -1);
+  wire::CopyLoader binary_loader(table, COPY_TYPE_IMPORT_BINARY, ',',
+                                 &traffic_cop);
+  for (size_t pos = 0; pos < binary.size(); pos += 5) {
+    auto len = std::min<size_t>(5, binary.size() - pos);
+    EXPECT_TRUE(binary_loader.Consume(binary.data() + pos, len));
+  }
+  EXPECT_TRUE(binary_loader.Finish());
+  EXPECT_EQ(1, binary_loader.GetRowCount());
+  EXPECT_EQ("six", GetName(6));
+
+  // A row with a missing field
+  wire::CopyLoader bad_loader(table, COPY_TYPE_IMPORT_TSV, '\t',
+                              &traffic_cop);
+  text = "7\n";
+  EXPECT_FALSE(bad_loader.Consume(text.data(), text.size()));
+  EXPECT_FALSE(bad_loader.GetErrorMessage().empty());
+
+  // A duplicate key fails the chunk
+  wire::CopyLoader duplicate_loader(table, COPY_TYPE_IMPORT_TSV, '\t',
+                                    &traffic_cop);
+  text = "8\teight\n1\tagain\n";
+  EXPECT_TRUE(duplicate_loader.Consume(text.data(), text.size()));
+  EXPECT_FALSE(duplicate_loader.Finish());
+  EXPECT_EQ("<none>", GetName(8));
+  EXPECT_EQ("one", GetName(1));
+
+  // free the database just created
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto txn = txn_manager.BeginTransaction();
+  catalog::Catalog::GetInstance()->DropDatabaseWithName(DEFAULT_DB_NAME, txn);
+  txn_manager.CommitTransaction(txn);
+}
+
+TEST_F(CopyLoaderTests, AllOrNothingTest) {
+  catalog::Catalog::GetInstance()->CreateDatabase(DEFAULT_DB_NAME, nullptr);
+  SQLTestsUtil::ExecuteSQLQuery(
+      "CREATE TABLE copy_table(id INT PRIMARY KEY, name VARCHAR);");
+  SQLTestsUtil::ExecuteSQLQuery("INSERT INTO copy_table VALUES (1, 'one');");
+  auto table = catalog::Catalog::GetInstance()->GetTableWithName(
+      DEFAULT_DB_NAME, "copy_table");
+  tcop::TrafficCop traffic_cop;
+
+  // The rows fill a few chunks, the last one fails on a duplicate key
+  std::string text;
+  size_t row_count = table->GetTuplesPerTileGroup() * 2 + 10;
+  for (size_t row_itr = 0; row_itr < row_count; row_itr++) {
+    text += std::to_string(row_itr + 100) + "\trow\n";
+  }
+  text += "1\tagain\n";
+
+  // None of the rows is loaded
+  {
+    wire::CopyLoader loader(table, COPY_TYPE_IMPORT_TSV, '\t', &traffic_cop);
+    EXPECT_TRUE(loader.Consume(text.data(), text.size()));
+    EXPECT_FALSE(loader.Finish());
+  }
+  EXPECT_FALSE(traffic_cop.HasActiveTransaction());
+  EXPECT_EQ("<none>", GetName(100));
+  EXPECT_EQ("<none>", GetName(100 + row_count - 1));
+
+  // A COPY that is cancelled half way is rolled back
+  {
+    wire::CopyLoader loader(table, COPY_TYPE_IMPORT_TSV, '\t', &traffic_cop);
+    EXPECT_TRUE(loader.Consume(text.data(), text.size() / 2));
+  }
+  EXPECT_FALSE(traffic_cop.HasActiveTransaction());
+  EXPECT_EQ("<none>", GetName(100));
+
+  // The chunks before the failure stay when each chunk commits on its own
+  peloton_copy_chunk_commit = true;
+  {
+    wire::CopyLoader loader(table, COPY_TYPE_IMPORT_TSV, '\t', &traffic_cop);
+    EXPECT_TRUE(loader.Consume(text.data(), text.size()));
+    EXPECT_FALSE(loader.Finish());
+  }
+  peloton_copy_chunk_commit = false;
+  EXPECT_EQ("row", GetName(100));
+  EXPECT_EQ("<none>", GetName(100 + row_count - 1));
+
+  // free the database just created
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto txn = txn_manager.BeginTransaction();
+  catalog::Catalog::GetInstance()->DropDatabaseWithName(DEFAULT_DB_NAME, txn);
+  txn_manager.CommitTransaction(txn);
+}
+
+}  // End test namespace
+}  // End peloton namespace
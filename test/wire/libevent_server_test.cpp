@@ -0,0 +1,409 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// libevent_server_test.cpp
+//
+// Identification: test/wire/libevent_server_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <arpa/inet.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include "catalog/catalog.h"
+#include "common/harness.h"
+#include "common/macros.h"
+#include "logging/log_manager.h"
+#include "wire/libevent_server.h"
+#include "wire/transaction_worker_pool.h"
+
+// Run statements on the transaction worker pool instead of the network threads
+extern bool peloton_worker_pool;
+
+// Threads of the transaction worker pool (0: one per core)
+extern size_t peloton_worker_thread_count;
+
+// Workers of the pool that run analytic statements (0: a quarter of them)
+extern size_t peloton_analytic_worker_thread_count;
+
+// Give every network thread its own SO_REUSEPORT listening socket
+extern bool peloton_reuseport_listeners;
+
+// Suspend connections instead of their thread while their commit is flushed
+extern bool peloton_async_commit_ack;
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Libevent Server Tests
+//===--------------------------------------------------------------------===//
+
+class LibeventServerTests : public PelotonTest {};
+
+// A blocking client that speaks the simple query protocol
+class TestClient {
+ public:
+  ~TestClient() { Close(); }
+
+  // Connect and send the startup packet. Returns true once the server is
+  // ready for queries
+  bool Connect(int port) {
+    fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    struct timeval timeout = {10, 0};
+    setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    struct sockaddr_in sin;
+    PL_MEMSET(&sin, 0, sizeof(sin));
+    sin.sin_family = AF_INET;
+    sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    sin.sin_port = htons(port);
+    if (connect(fd_, (struct sockaddr *)&sin, sizeof(sin)) < 0) {
+      Close();
+      return false;
+    }
+
+    std::string body;
+    AppendInt(body, 3 << 16);
+    body.append("user\0postgres\0database\0" DEFAULT_DB_NAME "\0\0",
+                23 + sizeof(DEFAULT_DB_NAME) + 1);
+    std::string packet;
+    AppendInt(packet, body.size() + sizeof(int32_t));
+    packet.append(body);
+    if (Send(packet) == false) return false;
+    auto types = ReadMessages();
+    return types.empty() == false && types.back() == 'Z';
+  }
+
+  // Run the query. Returns the types of the reply messages, ending with 'Z'
+  // unless the server went away
+  std::string Query(const std::string &query) {
+    std::string packet(1, 'Q');
+    AppendInt(packet, query.size() + 1 + sizeof(int32_t));
+    packet.append(query.c_str(), query.size() + 1);
+    if (Send(packet) == false) return "";
+    return ReadMessages();
+  }
+
+  void Close() {
+    if (fd_ >= 0) close(fd_);
+    fd_ = -1;
+  }
+
+  // SQLSTATE of the last error reply
+  std::string error_code;
+
+ private:
+  static void AppendInt(std::string &buf, int32_t value) {
+    value = htonl(value);
+    buf.append(reinterpret_cast<char *>(&value), sizeof(int32_t));
+  }
+
+  bool Send(const std::string &packet) {
+    return write(fd_, packet.data(), packet.size()) == (ssize_t)packet.size();
+  }
+
+  bool Receive(char *buf, size_t len) {
+    while (len > 0) {
+      auto bytes = read(fd_, buf, len);
+      if (bytes <= 0) return false;
+      buf += bytes;
+      len -= bytes;
+    }
+    return true;
+  }
+
+  std::string ReadMessages() {
+    std::string types;
+    char type;
+    int32_t len;
+    while (Receive(&type, 1) && Receive((char *)&len, sizeof(int32_t))) {
+      std::string body(ntohl(len) - sizeof(int32_t), '\0');
+      if (Receive(&body[0], body.size()) == false) break;
+      types.push_back(type);
+      if (type == 'E') {
+        // fields are a type byte and a string each
+        for (size_t pos = 0; pos < body.size() && body[pos] != '\0';
+             pos += strlen(&body[pos]) + 1) {
+          if (body[pos] == 'C') error_code = &body[pos + 1];
+        }
+      }
+      if (type == 'Z') break;
+    }
+    return types;
+  }
+
+  int fd_ = -1;
+};
+
+// Run a server in a thread until StopServer
+static void StartServer(std::thread &server_thread, int port) {
+  FLAGS_port = port;
+  server_thread = std::thread([]() { wire::LibeventServer server; });
+
+  // Wait until it serves connections
+  TestClient client;
+  for (int wait_itr = 0; wait_itr < 100; wait_itr++) {
+    if (client.Connect(port)) break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+}
+
+// The server closes the connections of gone clients in the background
+static void WaitForClosedConnections() {
+  for (int wait_itr = 0; wait_itr < 100; wait_itr++) {
+    if (wire::LibeventServer::GetOpenConnectionCount() == 0) break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+}
+
+static void StopServer(std::thread &server_thread) {
+  kill(getpid(), SIGHUP);
+  server_thread.join();
+}
+
+// Log the commits of the test, with the commits waiting for their flush
+static void StartLogging() {
+  peloton_logging_mode = LOGGING_TYPE_INVALID;
+  auto &log_manager = logging::LogManager::GetInstance();
+  log_manager.DropFrontendLoggers();
+  log_manager.SetLoggingStatus(LOGGING_STATUS_TYPE_INVALID);
+  peloton_logging_mode = LOGGING_TYPE_NVM_WAL;
+
+  log_manager.SetSyncCommit(true);
+  log_manager.StartStandbyMode();
+  log_manager.GetFrontendLogger(0)->SetTestMode(true);
+  log_manager.StartRecoveryMode();
+  log_manager.WaitForModeTransition(LOGGING_STATUS_TYPE_LOGGING, true);
+}
+
+static void StopLogging() {
+  logging::LogManager::GetInstance().EndLogging();
+  peloton_logging_mode = LOGGING_TYPE_INVALID;
+}
+
+static int CountRows(int port, const std::string &table) {
+  TestClient client;
+  if (client.Connect(port) == false) return 0;
+  auto types = client.Query("SELECT id FROM " + table + ";");
+  return (int)std::count(types.begin(), types.end(), 'D');
+}
+
+TEST_F(LibeventServerTests, PoolTransactionBlockTest) {
+  const int port = 15741;
+  const int client_count = 4;
+  const int txn_count = 10;
+  catalog::Catalog::GetInstance()->CreateDatabase(DEFAULT_DB_NAME, nullptr);
+  StartLogging();
+
+  peloton_worker_pool = true;
+  peloton_worker_thread_count = 4;
+  peloton_analytic_worker_thread_count = 1;
+  std::thread server_thread;
+  StartServer(server_thread, port);
+  EXPECT_TRUE(wire::TransactionWorkerPool::GetInstance().IsRunning());
+
+  TestClient ddl_client;
+  ASSERT_TRUE(ddl_client.Connect(port));
+  EXPECT_EQ("CZ", ddl_client.Query("CREATE TABLE pool_table(id INT);"));
+
+  // Clients idle inside a block, more of them than there are workers. They
+  // do not hold a worker
+  std::vector<std::unique_ptr<TestClient>> idle_clients;
+  for (int client_itr = 0; client_itr < 8; client_itr++) {
+    idle_clients.emplace_back(new TestClient());
+    ASSERT_TRUE(idle_clients.back()->Connect(port));
+    EXPECT_EQ("CZ", idle_clients.back()->Query("BEGIN;"));
+  }
+
+  // Every statement of a block is a packet of its own, and the packets of
+  // the clients interleave on the workers. The commits wait for their log
+  // flush, whichever worker began the transaction
+  std::vector<std::thread> client_threads;
+  std::atomic<int> committed(0);
+  for (int client_itr = 0; client_itr < client_count; client_itr++) {
+    client_threads.emplace_back([&, client_itr]() {
+      TestClient client;
+      if (client.Connect(port) == false) return;
+      for (int txn_itr = 0; txn_itr < txn_count; txn_itr++) {
+        int id = client_itr * txn_count + txn_itr;
+        if (client.Query("BEGIN;") != "CZ") return;
+        if (client.Query("INSERT INTO pool_table VALUES (" +
+                         std::to_string(id) + ");") != "CZ") {
+          return;
+        }
+        if (client.Query("COMMIT;") != "CZ") return;
+        committed++;
+      }
+    });
+  }
+  for (auto &client_thread : client_threads) {
+    client_thread.join();
+  }
+  EXPECT_EQ(client_count * txn_count, committed.load());
+
+  // The idle blocks end on other workers than they began on
+  for (auto &idle_client : idle_clients) {
+    EXPECT_EQ("CZ", idle_client->Query("INSERT INTO pool_table VALUES (-3);"));
+    EXPECT_EQ("CZ", idle_client->Query("ROLLBACK;"));
+  }
+  idle_clients.clear();
+
+  // A client that goes away inside a block has it aborted
+  TestClient gone_client;
+  ASSERT_TRUE(gone_client.Connect(port));
+  EXPECT_EQ("CZ", gone_client.Query("BEGIN;"));
+  EXPECT_EQ("CZ", gone_client.Query("INSERT INTO pool_table VALUES (-1);"));
+  gone_client.Close();
+
+  EXPECT_EQ(client_count * txn_count, CountRows(port, "pool_table"));
+  EXPECT_EQ("CZ", ddl_client.Query("BEGIN;"));
+  EXPECT_EQ("CZ", ddl_client.Query("INSERT INTO pool_table VALUES (-2);"));
+  EXPECT_EQ("CZ", ddl_client.Query("COMMIT;"));
+  EXPECT_EQ(client_count * txn_count + 1, CountRows(port, "pool_table"));
+  ddl_client.Close();
+
+  StopServer(server_thread);
+  EXPECT_FALSE(wire::TransactionWorkerPool::GetInstance().IsRunning());
+  peloton_worker_pool = true;
+  StopLogging();
+}
+
+TEST_F(LibeventServerTests, AsyncCommitAckTest) {
+  const int client_count = 4;
+  const int txn_count = 10;
+  catalog::Catalog::GetInstance()->CreateDatabase(DEFAULT_DB_NAME, nullptr);
+  StartLogging();
+  peloton_async_commit_ack = true;
+  peloton_worker_thread_count = 4;
+  peloton_analytic_worker_thread_count = 1;
+
+  // The commits are acknowledged from the network threads, and from the
+  // workers of the pool
+  std::vector<bool> worker_pool_modes = {false, true};
+  int port = 15743;
+  for (auto worker_pool : worker_pool_modes) {
+    peloton_worker_pool = worker_pool;
+    std::thread server_thread;
+    StartServer(server_thread, port);
+    std::string table = "ack_table_" + std::to_string(port);
+
+    TestClient ddl_client;
+    ASSERT_TRUE(ddl_client.Connect(port));
+    EXPECT_EQ("CZ",
+              ddl_client.Query("CREATE TABLE " + table + "(id INT);"));
+    auto &log_manager = logging::LogManager::GetInstance();
+    cid_t start_cid = log_manager.GetPersistentFlushedCommitId();
+
+    // A block spans several packets, its COMMIT reply waits for the flush
+    std::vector<std::thread> client_threads;
+    std::atomic<int> committed(0);
+    for (int client_itr = 0; client_itr < client_count; client_itr++) {
+      client_threads.emplace_back([&, client_itr]() {
+        TestClient client;
+        if (client.Connect(port) == false) return;
+        for (int txn_itr = 0; txn_itr < txn_count; txn_itr++) {
+          std::string insert = "INSERT INTO " + table + " VALUES (" +
+                               std::to_string(client_itr) + ");";
+          if (client.Query("BEGIN;") != "CZ") return;
+          if (client.Query(insert) != "CZ") return;
+          if (client.Query(insert) != "CZ") return;
+          if (client.Query("COMMIT;") != "CZ") return;
+          committed++;
+        }
+      });
+    }
+    for (auto &client_thread : client_threads) {
+      client_thread.join();
+    }
+    EXPECT_EQ(client_count * txn_count, committed.load());
+
+    // Every acknowledged commit is durable, they have commit ids of their
+    // own above the one flushed before
+    EXPECT_GE(log_manager.GetPersistentFlushedCommitId(),
+              start_cid + client_count * txn_count);
+    EXPECT_EQ(2 * client_count * txn_count, CountRows(port, table));
+    ddl_client.Close();
+
+    StopServer(server_thread);
+    port++;
+  }
+
+  peloton_worker_pool = true;
+  peloton_async_commit_ack = false;
+  StopLogging();
+}
+
+TEST_F(LibeventServerTests, ReuseportConnectionStormTest) {
+  const int port = 15742;
+  const int max_connections = 48;
+  const int rejected_count = 8;
+  catalog::Catalog::GetInstance()->CreateDatabase(DEFAULT_DB_NAME, nullptr);
+
+  // Every network thread accepts on its own socket
+  auto thread_count = QUERY_THREAD_COUNT;
+  auto connection_limit = FLAGS_max_connections;
+  QUERY_THREAD_COUNT = 4;
+  FLAGS_max_connections = max_connections;
+  peloton_reuseport_listeners = true;
+  std::thread server_thread;
+  StartServer(server_thread, port);
+  WaitForClosedConnections();
+
+  TestClient ddl_client;
+  ASSERT_TRUE(ddl_client.Connect(port));
+  EXPECT_EQ("CZ", ddl_client.Query("CREATE TABLE storm_table(id INT);"));
+
+  // The clients connect at once, all of them up to the limit are served
+  std::vector<std::unique_ptr<TestClient>> clients;
+  std::vector<std::thread> client_threads;
+  std::atomic<int> connected(0);
+  for (int client_itr = 1; client_itr < max_connections; client_itr++) {
+    clients.emplace_back(new TestClient());
+    auto client = clients.back().get();
+    client_threads.emplace_back([&connected, client, port]() {
+      if (client->Connect(port)) connected++;
+    });
+  }
+  for (auto &client_thread : client_threads) {
+    client_thread.join();
+  }
+  EXPECT_EQ(max_connections - 1, connected.load());
+
+  // Beyond the limit they are turned away like Postgres does
+  for (int client_itr = 0; client_itr < rejected_count; client_itr++) {
+    TestClient client;
+    EXPECT_FALSE(client.Connect(port));
+    EXPECT_EQ("53300", client.error_code);
+  }
+
+  for (size_t client_itr = 0; client_itr < clients.size(); client_itr++) {
+    EXPECT_EQ("CZ", clients[client_itr]->Query(
+                        "INSERT INTO storm_table VALUES (" +
+                        std::to_string(client_itr) + ");"));
+  }
+  clients.clear();
+  ddl_client.Close();
+
+  // The closed connections make room again
+  WaitForClosedConnections();
+  EXPECT_EQ(max_connections - 1, CountRows(port, "storm_table"));
+
+  StopServer(server_thread);
+  peloton_reuseport_listeners = false;
+  FLAGS_max_connections = connection_limit;
+  QUERY_THREAD_COUNT = thread_count;
+}
+
+}  // End test namespace
+}  // End peloton namespace
@@ -0,0 +1,92 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// marshal_test.cpp
+//
+// Identification: test/wire/marshal_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <arpa/inet.h>
+
+#include "common/harness.h"
+
+#include "type/value_factory.h"
+#include "wire/marshal.h"
+#include "wire/packet_manager.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Marshal Tests
+//===--------------------------------------------------------------------===//
+
+class MarshalTests : public PelotonTest {};
+
+static void AppendInt(std::string &buf, int32_t value) {
+  value = htonl(value);
+  buf.append(reinterpret_cast<char *>(&value), sizeof(int32_t));
+}
+
+TEST_F(MarshalTests, StringRefTest) {
+  std::string query("SELECT 1;", 10);
+  wire::InputPacket pkt(query.size(), query);
+
+  auto query_ref = wire::PacketGetStringRef(&pkt, pkt.len);
+  EXPECT_EQ("SELECT 1;", query_ref.to_string());
+  EXPECT_EQ(pkt.len, pkt.ptr);
+
+  // The string points into the packet
+  EXPECT_EQ(reinterpret_cast<const char *>(&(*pkt.Begin())),
+            query_ref.data());
+}
+
+TEST_F(MarshalTests, DetachedParamValueTest) {
+  // 'hello' as VARCHAR, '42' as INTEGER and 7 as a binary INTEGER
+  std::string buf;
+  AppendInt(buf, 5);
+  buf.append("hello");
+  AppendInt(buf, 2);
+  buf.append("42");
+  AppendInt(buf, 4);
+  AppendInt(buf, 7);
+
+  std::vector<int32_t> types = {POSTGRES_VALUE_TYPE_VARCHAR2,
+                                POSTGRES_VALUE_TYPE_INTEGER,
+                                POSTGRES_VALUE_TYPE_INTEGER};
+  std::vector<int16_t> formats = {0, 0, 1};
+  std::vector<type::Value> values(3);
+
+  wire::InputPacket pkt(buf.size(), buf);
+  auto packet_buf = pkt.DetachBuffer();
+  EXPECT_TRUE(pkt.IsDetached());
+  EXPECT_EQ(buf.size(),
+            wire::PacketManager::ReadParamValue(&pkt, 3, types, values,
+                                                formats));
+
+  EXPECT_EQ(type::Type::VARCHAR, values[0].GetTypeId());
+  EXPECT_EQ("hello", values[0].ToString());
+  EXPECT_EQ(6, values[0].GetLength());
+  EXPECT_EQ(42, values[1].GetAs<int32_t>());
+  EXPECT_EQ(7, values[2].GetAs<int32_t>());
+
+  // The varchar borrows the packet's memory
+  auto data = reinterpret_cast<const char *>(packet_buf->data());
+  EXPECT_GE(values[0].GetData(), data);
+  EXPECT_LT(values[0].GetData(), data + packet_buf->size());
+
+  // Values of a packet that is not detached own their data
+  wire::InputPacket copy_pkt(buf.size(), buf);
+  std::vector<type::Value> copy_values(3);
+  wire::PacketManager::ReadParamValue(&copy_pkt, 3, types, copy_values,
+                                      formats);
+  EXPECT_EQ("hello", copy_values[0].ToString());
+  EXPECT_EQ(42, copy_values[1].GetAs<int32_t>());
+}
+
+}  // End test namespace
+}  // End peloton namespace
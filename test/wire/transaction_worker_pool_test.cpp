@@ -0,0 +1,96 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// transaction_worker_pool_test.cpp
+//
+// Identification: test/wire/transaction_worker_pool_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "common/harness.h"
+#include "wire/packet_manager.h"
+#include "wire/transaction_worker_pool.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Transaction Worker Pool Tests
+//===--------------------------------------------------------------------===//
+
+class TransactionWorkerPoolTests : public PelotonTest {};
+
+TEST_F(TransactionWorkerPoolTests, WorkClassTest) {
+  auto &pool = wire::TransactionWorkerPool::GetInstance();
+  pool.Start(2, 1);
+  pool.ResetStats();
+
+  // Keep the only analytic worker busy
+  std::atomic<bool> release(false);
+  std::atomic<int> analytic_done(0);
+  for (int i = 0; i < 2; i++) {
+    pool.Submit(wire::WorkClass::ANALYTIC, [&] {
+      while (release.load() == false) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      analytic_done++;
+    });
+  }
+
+  // Short work does not wait behind the analytic work
+  std::atomic<int> oltp_done(0);
+  for (int i = 0; i < 10; i++) {
+    pool.Submit(wire::WorkClass::OLTP, [&] { oltp_done++; });
+  }
+  while (oltp_done.load() < 10) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  // The second analytic statement is not admitted yet
+  while (pool.GetQueueLength(wire::WorkClass::ANALYTIC) > 1) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(0, analytic_done.load());
+  EXPECT_EQ(1, pool.GetQueueLength(wire::WorkClass::ANALYTIC));
+
+  release = true;
+  pool.Stop();
+  EXPECT_EQ(2, analytic_done.load());
+  EXPECT_FALSE(pool.IsRunning());
+
+  EXPECT_EQ(10, pool.GetExecutedCount(wire::WorkClass::OLTP));
+  EXPECT_EQ(2, pool.GetExecutedCount(wire::WorkClass::ANALYTIC));
+  EXPECT_GT(pool.GetMaxQueueTime(wire::WorkClass::ANALYTIC), 0);
+  EXPECT_LE(pool.GetMaxQueueTime(wire::WorkClass::OLTP),
+            pool.GetTotalQueueTime(wire::WorkClass::OLTP));
+}
+
+TEST_F(TransactionWorkerPoolTests, AnalyticQueryTest) {
+  EXPECT_TRUE(wire::PacketManager::IsAnalyticQuery(
+      "SELECT COUNT(*) FROM foo WHERE id > 5;"));
+  EXPECT_TRUE(wire::PacketManager::IsAnalyticQuery(
+      "select * from foo join bar on foo.id = bar.id where foo.id = 1;"));
+  EXPECT_TRUE(wire::PacketManager::IsAnalyticQuery(" SELECT * FROM foo;"));
+  EXPECT_TRUE(wire::PacketManager::IsAnalyticQuery("COPY foo FROM STDIN;"));
+  EXPECT_FALSE(wire::PacketManager::IsAnalyticQuery(
+      "SELECT name FROM foo WHERE id = 5;"));
+  EXPECT_FALSE(
+      wire::PacketManager::IsAnalyticQuery("INSERT INTO foo VALUES (1);"));
+  EXPECT_FALSE(wire::PacketManager::IsAnalyticQuery("BEGIN;"));
+
+  // Only the text the reference covers is classified, as in a packet
+  const char *packet = "SELECT a FROM foo WHERE id = 1;SELECT COUNT(*);";
+  EXPECT_FALSE(wire::PacketManager::IsAnalyticQuery(
+      boost::string_ref(packet, 31)));
+  EXPECT_TRUE(wire::PacketManager::IsAnalyticQuery(boost::string_ref(packet)));
+}
+
+}  // End test namespace
+}  // End peloton namespace